@@ -0,0 +1,193 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+
+
+
+#include "BmpFontAtlas.h"
+#include <stdio.h>
+
+#define BMP_FONT "BMP_FONT"
+
+#ifdef WIN32
+#else
+#pragma pack(2)
+typedef struct tagBITMAPFILEHEADER {
+    AX_U16 bfType;
+    AX_U32 bfSize;
+    AX_U16 bfReserved1;
+    AX_U16 bfReserved2;
+    AX_U32 bfOffBits;
+} BITMAPFILEHEADER;
+#pragma pack()
+
+typedef struct tagBITMAPINFOHEADER {
+    AX_U32 biSize;
+    AX_S32 biWidth;
+    AX_S32 biHeight;
+    AX_U16 biPlanes;
+    AX_U16 biBitCount;
+    AX_U32 biCompression;
+    AX_U32 biSizeImage;
+    AX_S32 biXPelsPerMeter;
+    AX_S32 biYPelsPerMeter;
+    AX_U32 biClrUsed;
+    AX_U32 biClrImportant;
+} BITMAPINFOHEADER;
+#endif
+
+#define MIN_BITMAP_FILE_SIZE    (sizeof(BITMAPFILEHEADER) + sizeof(BITMAPINFOHEADER))
+
+static AX_U8 reverse8(AX_U8 c)
+{
+    c = (c & 0x55) << 1 | (c & 0xAA) >> 1;
+    c = (c & 0x33) << 2 | (c & 0xCC) >> 2;
+    c = (c & 0x0F) << 4 | (c & 0xF0) >> 4;
+    return c;
+}
+
+const AX_U8 *CBmpFontAtlas::Load(const AX_CHAR *pBmpFile, AX_U16 &u16w, AX_U16 &u16h, AX_U32 &u32Size)
+{
+    if (!pBmpFile) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lck(m_mtx);
+    if (!m_vecBits.empty()) {
+        if (m_strFile != pBmpFile) {
+            /* spans and bits are referenced by every CBmpOSD, never replaced */
+            LOG_M_E(BMP_FONT, "%s is loaded already, can not load %s", m_strFile.c_str(), pBmpFile);
+            return nullptr;
+        }
+
+        u16w = m_uWidth;
+        u16h = m_uHeight;
+        u32Size = m_vecBits.size();
+        return m_vecBits.data();
+    }
+
+    FILE *fp = fopen((char *)pBmpFile, "rb");
+    if (NULL == fp) {
+        return nullptr;
+    }
+
+    fseek(fp, 0, SEEK_END);
+    AX_U32 fsize = ftell(fp);
+    if (fsize <= MIN_BITMAP_FILE_SIZE) {
+        fclose(fp);
+        return nullptr;
+    }
+
+    std::vector<AX_U8> vecData(fsize);
+    rewind(fp);
+    if (fread(vecData.data(), 1, fsize, fp) != fsize) {
+        fclose(fp);
+        return nullptr;
+    }
+
+    fclose(fp);
+
+    BITMAPFILEHEADER *phd = (BITMAPFILEHEADER *)&vecData[0];
+    BITMAPINFOHEADER *pif = (BITMAPINFOHEADER *)&vecData[sizeof(BITMAPFILEHEADER)];
+    if (phd->bfType != 0x4D42 || phd->bfOffBits >= fsize) {
+        /* Not a bitmap */
+        return nullptr;
+    }
+
+    if (pif->biBitCount != 1) {
+        /* VO only support single-bit bitmap */
+        return nullptr;
+    }
+
+    AX_U16 uWidth = (AX_U16)pif->biWidth;
+    AX_U16 uHeight = (AX_U16)pif->biHeight;
+    AX_U32 uWidthBytes = (((uWidth + 7) / 8 + 3) / 4) * 4;
+    if (fsize - phd->bfOffBits < uWidthBytes * uHeight) {
+        LOG_M_E(BMP_FONT, "%s: %d bytes of bits for %dx%d", pBmpFile, fsize - phd->bfOffBits, uWidth, uHeight);
+        return nullptr;
+    }
+
+    m_vecBits.assign(vecData.begin() + phd->bfOffBits, vecData.end());
+    for (auto &c : m_vecBits) {
+        c = reverse8(c);
+    }
+
+    m_strFile = pBmpFile;
+    m_uWidth = uWidth;
+    m_uHeight = uHeight;
+
+    u16w = m_uWidth;
+    u16h = m_uHeight;
+    u32Size = m_vecBits.size();
+
+    return m_vecBits.data();
+}
+
+const BMP_FONT_SCALED_T *CBmpFontAtlas::GetScaled(AX_U8 nScale)
+{
+    if (0 == nScale) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lck(m_mtx);
+    if (m_vecBits.empty()) {
+        return nullptr;
+    }
+
+    std::unique_ptr<BMP_FONT_SCALED_T> &pScaled = m_mapScaled[nScale];
+    if (!pScaled) {
+        pScaled.reset(new BMP_FONT_SCALED_T);
+        Expand(nScale, *pScaled);
+    }
+
+    return pScaled.get();
+}
+
+/* same pixels as the bit by bit drawing: every bit of the symbol bytes, also the padding bits of the last byte */
+AX_VOID CBmpFontAtlas::Expand(AX_U8 nScale, BMP_FONT_SCALED_T &tScaled) const
+{
+    AX_U16 uSymbolWidthBytes = (m_uWidth / BMP_FONT_SYMBOL_NUM + 7) / 8;
+    AX_U16 uFontWidthBytes = (((m_uWidth + 7) / 8 + 3) / 4) * 4;
+    AX_U16 uBits = uSymbolWidthBytes * 8;
+
+    tScaled.nScale = nScale;
+    tScaled.nAdvance = uBits * nScale;
+    tScaled.nRows = m_uHeight;
+
+    for (AX_U32 s = 0; s < BMP_FONT_SYMBOL_NUM; s++) {
+        BMP_FONT_GLYPH_T &tGlyph = tScaled.arrGlyphs[s];
+        const AX_U8 *src = m_vecBits.data() + s * uSymbolWidthBytes;
+
+        tGlyph.vecRowStart.resize(m_uHeight + 1);
+        tGlyph.vecSpans.clear();
+        for (AX_U16 j = 0; j < m_uHeight; j++) {
+            tGlyph.vecRowStart[j] = tGlyph.vecSpans.size();
+
+            const AX_U8 *row = src + j * uFontWidthBytes;
+            AX_U16 k = 0;
+            while (k < uBits) {
+                if (0 == ((row[k / 8] >> (k % 8)) & 0x1)) {
+                    k++;
+                    continue;
+                }
+
+                AX_U16 nStart = k;
+                while (k < uBits && ((row[k / 8] >> (k % 8)) & 0x1)) {
+                    k++;
+                }
+
+                BMP_FONT_SPAN_T tSpan;
+                tSpan.nX = nStart * nScale;
+                tSpan.nLen = (k - nStart) * nScale;
+                tGlyph.vecSpans.push_back(tSpan);
+            }
+        }
+        tGlyph.vecRowStart[m_uHeight] = tGlyph.vecSpans.size();
+    }
+}
@@ -0,0 +1,90 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+
+
+
+#ifndef _BMP_FONT_ATLAS_7A41C2E6_3F0B_4D8C_9E52_1B6D0F8A93C4_H_
+#define _BMP_FONT_ATLAS_7A41C2E6_3F0B_4D8C_9E52_1B6D0F8A93C4_H_
+
+#include "global.h"
+#include "Singleton.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/* symbols of font.bmp side by side: space - 0-9 : F H P V */
+#define BMP_FONT_SYMBOL_NUM (17)
+
+/* run of set pixels in a row of a scaled symbol */
+typedef struct {
+    AX_U16 nX;
+    AX_U16 nLen;
+} BMP_FONT_SPAN_T;
+
+typedef struct {
+    /* spans of font row j are [vecRowStart[j], vecRowStart[j + 1]), each row is nScale pixels high */
+    std::vector<AX_U32> vecRowStart;
+    std::vector<BMP_FONT_SPAN_T> vecSpans;
+} BMP_FONT_GLYPH_T;
+
+typedef struct {
+    AX_U8 nScale;
+    AX_U16 nAdvance;    // symbol cell width in scaled pixels
+    AX_U16 nRows;       // font rows, not scaled
+    BMP_FONT_GLYPH_T arrGlyphs[BMP_FONT_SYMBOL_NUM];
+} BMP_FONT_SCALED_T;
+
+/**
+ *  Single-bit bmp font loaded once and shared by all CBmpOSD, symbols pre-expanded into spans per scale
+ */
+class CBmpFontAtlas : public CSingleton<CBmpFontAtlas>
+{
+    friend class CSingleton<CBmpFontAtlas>;
+
+public:
+    /* loads the file on first call, later calls with the same file return the loaded bits */
+    const AX_U8 *Load(const AX_CHAR *pBmpFile, AX_U16 &u16w, AX_U16 &u16h, AX_U32 &u32Size);
+
+    /* bits are rows of (((width + 7) / 8 + 3) / 4) * 4 bytes, leftmost pixel in bit 0 */
+    const AX_U8 *GetBits(AX_VOID) const {
+        return m_vecBits.empty() ? nullptr : m_vecBits.data();
+    }
+    AX_U16 GetWidth(AX_VOID) const {
+        return m_uWidth;
+    }
+    AX_U16 GetHeight(AX_VOID) const {
+        return m_uHeight;
+    }
+
+    /* nullptr if no font is loaded or nScale is 0 */
+    const BMP_FONT_SCALED_T *GetScaled(AX_U8 nScale);
+
+private:
+    CBmpFontAtlas(AX_VOID) = default;
+    virtual ~CBmpFontAtlas(AX_VOID) = default;
+
+    AX_BOOL Init(AX_VOID) override {
+        return AX_TRUE;
+    };
+
+    AX_VOID Expand(AX_U8 nScale, BMP_FONT_SCALED_T &tScaled) const;
+
+private:
+    std::mutex m_mtx;
+    std::string m_strFile;
+    std::vector<AX_U8> m_vecBits;
+    AX_U16 m_uWidth{0};
+    AX_U16 m_uHeight{0};
+    std::map<AX_U8, std::unique_ptr<BMP_FONT_SCALED_T>> m_mapScaled;
+};
+
+#endif /* _BMP_FONT_ATLAS_7A41C2E6_3F0B_4D8C_9E52_1B6D0F8A93C4_H_ */
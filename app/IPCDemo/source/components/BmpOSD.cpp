@@ -11,44 +11,12 @@
 
 
 #include "BmpOSD.h"
+#include "BmpFontAtlas.h"
 #include <stdlib.h>
+#include <chrono>
+#include <vector>
 
-#ifdef WIN32
-#else
-#pragma pack(2)
-typedef struct tagBITMAPFILEHEADER {
-    AX_U16 bfType;
-    AX_U32 bfSize;
-    AX_U16 bfReserved1;
-    AX_U16 bfReserved2;
-    AX_U32 bfOffBits;
-} BITMAPFILEHEADER;
-#pragma pack()
-
-typedef struct tagBITMAPINFOHEADER {
-    AX_U32 biSize;
-    AX_S32 biWidth;
-    AX_S32 biHeight;
-    AX_U16 biPlanes;
-    AX_U16 biBitCount;
-    AX_U32 biCompression;
-    AX_U32 biSizeImage;
-    AX_S32 biXPelsPerMeter;
-    AX_S32 biYPelsPerMeter;
-    AX_U32 biClrUsed;
-    AX_U32 biClrImportant;
-} BITMAPINFOHEADER;
-#endif
-
-#define MIN_BITMAP_FILE_SIZE    (sizeof(BITMAPFILEHEADER) + sizeof(BITMAPINFOHEADER))
-
-static AX_U8 reverse8(AX_U8 c)
-{
-    c = (c & 0x55) << 1 | (c & 0xAA) >> 1;
-    c = (c & 0x33) << 2 | (c & 0xCC) >> 2;
-    c = (c & 0x0F) << 4 | (c & 0xF0) >> 4;
-    return c;
-}
+#define BMP_OSD "BMP_OSD"
 
 static AX_U32 FONT_MAP[256] = {
     0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
@@ -71,8 +39,7 @@ static AX_U32 FONT_MAP[256] = {
 
 //////////////////////////////////////////////////////////////////////////
 CBmpOSD::CBmpOSD(AX_VOID)
-    : m_pData(nullptr),
-      m_pFont(nullptr),
+    : m_pFont(nullptr),
       m_uWidth(0),
       m_uHight(0)
 {
@@ -80,71 +47,18 @@ CBmpOSD::CBmpOSD(AX_VOID)
 
 CBmpOSD::~CBmpOSD(AX_VOID)
 {
-    Free();
-}
-
-AX_VOID CBmpOSD::Free(AX_VOID)
-{
-    if (m_pData) {
-        free(m_pData);
-        m_pData = nullptr;
-    }
 }
 
-AX_U8 *CBmpOSD::LoadBmp(const AX_CHAR *pBmpFile, AX_U16 &u16w, AX_U16 &u16h, AX_U32 &u32Size)
+/* the font is loaded once by CBmpFontAtlas and shared, not copied per CBmpOSD */
+const AX_U8 *CBmpOSD::LoadBmp(const AX_CHAR *pBmpFile, AX_U16 &u16w, AX_U16 &u16h, AX_U32 &u32Size)
 {
-    Free();
-
-    FILE *fp = fopen((char *)pBmpFile, "rb");
-    if (NULL == fp) {
-        return nullptr;
-    }
-
-    fseek(fp, 0, SEEK_END);
-    AX_U32 fsize = ftell(fp);
-    if (fsize <= MIN_BITMAP_FILE_SIZE) {
-        fclose(fp);
-        return nullptr;
-    }
-
-    m_pData = (AX_U8 *)malloc(fsize);
-    if (NULL == m_pData) {
-        fclose(fp);
-        return nullptr;
-    }
-
-    rewind(fp);
-    if (fread(m_pData, 1, fsize, fp) != fsize) {
-        Free();
-        fclose(fp);
-        return nullptr;
-    }
-
-    fclose(fp);
-
-    BITMAPFILEHEADER *phd = (BITMAPFILEHEADER *)&m_pData[0];
-    BITMAPINFOHEADER *pif = (BITMAPINFOHEADER *)&m_pData[sizeof(BITMAPFILEHEADER)];
-    if (phd->bfType != 0x4D42) {
-        /* Not a bitmap */
-        Free();
+    const AX_U8 *p = CBmpFontAtlas::GetInstance()->Load(pBmpFile, u16w, u16h, u32Size);
+    if (!p) {
         return nullptr;
     }
 
-    if (pif->biBitCount != 1) {
-        /* VO only support single-bit bitmap */
-        Free();
-        return nullptr;
-    }
-
-    u16w = (AX_U16)pif->biWidth;
-    u16h = (AX_U16)pif->biHeight;
     m_uWidth = u16w;
     m_uHight = u16h;
-    u32Size = fsize - phd->bfOffBits;
-    AX_U8 *p = &m_pData[phd->bfOffBits];
-    for (AX_U32 i = 0; i < u32Size; ++i) {
-        p[i] = reverse8(p[i]);
-    }
     m_pFont = p;
 
     return p;
@@ -160,7 +74,7 @@ AX_U8  *CBmpOSD::GetString(const AX_CHAR *pNumStri, AX_U16 &u16w, AX_U16 &u16h,
         return nullptr;
     }
 
-    AX_U16 uSymbolWidth = m_uWidth / 17;
+    AX_U16 uSymbolWidth = m_uWidth / BMP_FONT_SYMBOL_NUM;
     AX_U16 uSymbolWidthBytes = (uSymbolWidth + 7) / 8;
     u16w = 128;//uSymbolWidth * uLen;
     u16h = m_uHight;
@@ -172,7 +86,7 @@ AX_U8  *CBmpOSD::GetString(const AX_CHAR *pNumStri, AX_U16 &u16w, AX_U16 &u16h,
 
     for (AX_U16 i = 0; i < uLen; i++) {
         AX_U8 *dst = pBuf + i * uSymbolWidthBytes;
-        AX_U8 *src = m_pFont + FONT_MAP[(AX_U8)pNumStri[i]] * uSymbolWidthBytes;
+        const AX_U8 *src = m_pFont + FONT_MAP[(AX_U8)pNumStri[i]] * uSymbolWidthBytes;
         for (AX_U16 j = 0; j < m_uHight; j++) {
             for (AX_U16 k = 0; k < uSymbolWidthBytes; k++) {
                 dst[j * uStrWidthBytes + k] = src[ j * uFontWidthBytes + k];
@@ -213,7 +127,7 @@ AX_BOOL CBmpOSD::FillString(const AX_CHAR *pNumStri, AX_S16 x, AX_S16 y, AX_U8 *
         y = 0;
     }
 
-    AX_U16 uSymbolWidth = m_uWidth / 17;
+    AX_U16 uSymbolWidth = m_uWidth / BMP_FONT_SYMBOL_NUM;
     AX_U16 uSymbolWidthBytes = (uSymbolWidth + 7) / 8;
 
     AX_U16 uBmpWidthBytes = (((u16w + 7) / 8 + 3) / 4) * 4;
@@ -233,7 +147,7 @@ AX_BOOL CBmpOSD::FillString(const AX_CHAR *pNumStri, AX_S16 x, AX_S16 y, AX_U8 *
     for (AX_U16 i = 0; i < uLen; i++) {
         //AX_U8 uDigit = pNumStri[i] - '0';
         AX_U8 *dst = pBmp + y * uBmpWidthBytes + (x + i) * uSymbolWidthBytes;
-        AX_U8 *src = m_pFont + FONT_MAP[(AX_U8)pNumStri[i]] * uSymbolWidthBytes;
+        const AX_U8 *src = m_pFont + FONT_MAP[(AX_U8)pNumStri[i]] * uSymbolWidthBytes;
         for (AX_U16 j = 0; j < m_uHight; j++) {
             for (AX_U16 k = 0; k < uSymbolWidthBytes; k++) {
                 dst[j * uBmpWidthBytes + k] = src[j * uFontWidthBytes + k];
@@ -263,9 +177,13 @@ AX_BOOL CBmpOSD::FillString(const AX_CHAR *pNumStri, AX_S16 x, AX_S16 y, CYuvHan
         y = 0;
     }
 
-    AX_U16 uSymbolWidth = m_uWidth / 17;
+    const BMP_FONT_SCALED_T *pScaled = CBmpFontAtlas::GetInstance()->GetScaled(nScale);
+    if (!pScaled) {
+        return AX_FALSE;
+    }
+
+    AX_U16 uSymbolWidth = m_uWidth / BMP_FONT_SYMBOL_NUM;
     AX_U16 uSymbolWidthBytes = (uSymbolWidth + 7) / 8;
-    AX_U16 uFontWidthBytes = (((m_uWidth + 7) / 8 + 3) / 4) * 4;
 
     if ((x + uSymbolWidthBytes * uLen * 8 ) > u16w) {
         x = u16w - uSymbolWidthBytes * uLen * 8;
@@ -281,17 +199,17 @@ AX_BOOL CBmpOSD::FillString(const AX_CHAR *pNumStri, AX_S16 x, AX_S16 y, CYuvHan
         y = 0;
     }
 
+    /* x, y are in font pixels, each one is nScale x nScale on the image */
+    AX_S32 nY = y * nScale;
     for (AX_U16 i = 0; i < uLen; i++) {
-        AX_U8 *src = m_pFont + FONT_MAP[(AX_U8)pNumStri[i]] * uSymbolWidthBytes;
-        for (AX_U16 j = 0; j < m_uHight; j++) {
-            for (AX_U16 k = 0; k < uSymbolWidthBytes; k++) {
-                AX_U8 dot8 = src[ j * uFontWidthBytes + k];
-                for (AX_U16 dot = 0; dot < 8; dot++){
-                    if ((dot8 & 0x1) == 1) {
-                        yuvHandler->DrawPoint(x + i * uSymbolWidthBytes * 8 + k * 8 + dot, y + j, nScale, CYuvHandler::YUV_WHITE);
-                    }
-
-                    dot8 = dot8 >> 1;
+        const BMP_FONT_GLYPH_T &tGlyph = pScaled->arrGlyphs[FONT_MAP[(AX_U8)pNumStri[i]]];
+        AX_S32 nX = x * nScale + i * pScaled->nAdvance;
+        for (AX_U16 j = 0; j < pScaled->nRows; j++) {
+            AX_U32 nBegin = tGlyph.vecRowStart[j];
+            AX_U32 nEnd = tGlyph.vecRowStart[j + 1];
+            for (AX_U8 r = 0; r < nScale; r++) {
+                for (AX_U32 n = nBegin; n < nEnd; n++) {
+                    yuvHandler->DrawSpan(nX + tGlyph.vecSpans[n].nX, nY + j * nScale + r, tGlyph.vecSpans[n].nLen, CYuvHandler::YUV_WHITE);
                 }
             }
         }
@@ -299,3 +217,26 @@ AX_BOOL CBmpOSD::FillString(const AX_CHAR *pNumStri, AX_S16 x, AX_S16 y, CYuvHan
 
     return AX_TRUE;
 }
+
+AX_F32 CBmpOSD::Benchmark(AX_U16 nWidth, AX_U16 nHeight, AX_U32 nLoops)
+{
+    if (!m_pFont || 0 == nLoops) {
+        return 0;
+    }
+
+    std::vector<AX_U8> vecImage(CYuvHandler::CalcImgSize(nWidth, nHeight, AX_YUV420_SEMIPLANAR));
+    CYuvHandler yuv(vecImage.data(), nWidth, nHeight, AX_YUV420_SEMIPLANAR);
+
+    /* the scale of CStage::DrawTimeRect */
+    AX_U8 nScale = (nWidth + 720) / 720 * 2;
+    AX_CHAR szText[] = "2022-12-31 23:59:59";
+
+    auto tStart = std::chrono::steady_clock::now();
+    for (AX_U32 i = 0; i < nLoops; ++i) {
+        szText[18] = '0' + i % 10;
+        FillString(szText, 4, 4, &yuv, nWidth, nHeight, nScale);
+    }
+    auto tEnd = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<AX_F32, std::milli>(tEnd - tStart).count() / nLoops;
+}
@@ -25,18 +25,17 @@ public:
     CBmpOSD(AX_VOID);
     ~CBmpOSD(AX_VOID);
 
-    AX_U8*  LoadBmp(const AX_CHAR *pBmpFile, AX_U16 &u16w, AX_U16 &u16h, AX_U32 &u32Size);
+    const AX_U8* LoadBmp(const AX_CHAR *pBmpFile, AX_U16 &u16w, AX_U16 &u16h, AX_U32 &u32Size);
     AX_U8*  GetString(const AX_CHAR *pNumStri, AX_U16 &u16w, AX_U16 &u16h, AX_U32 &u32Size);
     AX_VOID FreeString(AX_U8 * pStr);
     AX_BOOL FillString(const AX_CHAR *pNumStri, AX_S16 x, AX_S16 y, AX_U8* pBmp, AX_U16 u16w, AX_U16 u16h);
     AX_BOOL FillString(const AX_CHAR *pNumStri, AX_S16 x, AX_S16 y, CYuvHandler *yuvHandler, AX_U16 u16w, AX_U16 u16h, AX_U8 nScale = 1);
 
-private:
-    AX_VOID Free(AX_VOID);
+    /* ms per timestamp drawn on a nWidth x nHeight NV12 image */
+    AX_F32  Benchmark(AX_U16 nWidth, AX_U16 nHeight, AX_U32 nLoops);
 
 private:
-    AX_U8 *m_pData;
-    AX_U8 *m_pFont;
+    const AX_U8 *m_pFont;
     AX_U16 m_uWidth;
     AX_U16 m_uHight;
 };
@@ -0,0 +1,365 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+
+
+
+#include "PrivacyMask.h"
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define PRIVACY_MASK_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define PRIVACY_MASK_SSE
+#endif
+
+AX_BOOL CPrivacyMask::ClipRect(const PRIVACY_MASK_RECT_T &tRect, AX_U32 nWidth, AX_U32 nHeight,
+                               AX_U32 &x0, AX_U32 &y0, AX_U32 &x1, AX_U32 &y1) const
+{
+    /* even corners, so that a chroma sample is either masked or not */
+    x0 = std::min(tRect.nX, nWidth) & ~1;
+    y0 = std::min(tRect.nY, nHeight) & ~1;
+    x1 = std::min((std::min(tRect.nX, nWidth) + std::min(tRect.nW, nWidth) + 1) & ~1, nWidth & ~1);
+    y1 = std::min((std::min(tRect.nY, nHeight) + std::min(tRect.nH, nHeight) + 1) & ~1, nHeight & ~1);
+
+    return (x0 < x1 && y0 < y1) ? AX_TRUE : AX_FALSE;
+}
+
+AX_VOID CPrivacyMask::Mosaic(AX_U8 *pY, AX_U8 *pUV, AX_U32 nStride, AX_U32 nWidth, AX_U32 nHeight, const PRIVACY_MASK_RECT_T &tRect,
+                             AX_U32 nBlock)
+{
+    AX_U32 x0, y0, x1, y1;
+    if (!pY || !pUV || !ClipRect(tRect, nWidth, nHeight, x0, y0, x1, y1)) {
+        return;
+    }
+
+    nBlock = std::min(std::max(nBlock, (AX_U32)2), (AX_U32)PRIVACY_MASK_MAX_BLOCK) & ~1;
+
+    /* blocks are on the image grid, a box moving over the scene keeps the same cells */
+    MosaicPlane(pY, nStride, x0, x1, y0, y1, nBlock, nBlock, 1);
+    MosaicPlane(pUV, nStride, x0, x1, y0 / 2, y1 / 2, nBlock, nBlock / 2, 2);
+}
+
+AX_VOID CPrivacyMask::Blur(AX_U8 *pY, AX_U8 *pUV, AX_U32 nStride, AX_U32 nWidth, AX_U32 nHeight, const PRIVACY_MASK_RECT_T &tRect,
+                           AX_U32 nRadius)
+{
+    AX_U32 x0, y0, x1, y1;
+    if (!pY || !pUV || !ClipRect(tRect, nWidth, nHeight, x0, y0, x1, y1)) {
+        return;
+    }
+
+    nRadius = std::min(std::max(nRadius, (AX_U32)1), (AX_U32)PRIVACY_MASK_MAX_RADIUS);
+
+    BlurPlane(pY, nStride, x0, x1, y0, y1, nRadius, 1);
+    BlurPlane(pUV, nStride, x0, x1, y0 / 2, y1 / 2, std::max(nRadius / 2, (AX_U32)1), 2);
+}
+
+AX_VOID CPrivacyMask::Apply(PRIVACY_MASK_TYPE_E eType, AX_U8 *pY, AX_U8 *pUV, AX_U32 nStride, AX_U32 nWidth, AX_U32 nHeight,
+                            const PRIVACY_MASK_RECT_T &tRect, AX_U32 nSize)
+{
+    switch (eType) {
+    case PRIVACY_MASK_MOSAIC:
+        Mosaic(pY, pUV, nStride, nWidth, nHeight, tRect, nSize);
+        break;
+    case PRIVACY_MASK_BLUR:
+        Blur(pY, pUV, nStride, nWidth, nHeight, tRect, nSize);
+        break;
+    default:
+        break;
+    }
+}
+
+AX_VOID CPrivacyMask::MosaicPlane(AX_U8 *pPlane, AX_U32 nStride, AX_U32 x0, AX_U32 x1, AX_U32 y0, AX_U32 y1,
+                                  AX_U32 nBlockW, AX_U32 nBlockH, AX_U32 nComps)
+{
+    AX_U32 w = x1 - x0;
+    m_vecSum.resize(w);
+    m_vecRow.resize(w);
+    AX_U16 *pSum = m_vecSum.data();
+    AX_U8 *pRow = m_vecRow.data();
+
+    for (AX_U32 by = y0 / nBlockH * nBlockH; by < y1; by += nBlockH) {
+        AX_U32 r0 = std::max(by, y0);
+        AX_U32 r1 = std::min(by + nBlockH, y1);
+
+        /* column sums of the block row, then one value per block and component */
+        memset(pSum, 0, w * sizeof(AX_U16));
+        for (AX_U32 r = r0; r < r1; r++) {
+            AddRow(pSum, pPlane + (size_t)r * nStride + x0, w);
+        }
+
+        for (AX_U32 bx = x0 / nBlockW * nBlockW; bx < x1; bx += nBlockW) {
+            AX_U32 c0 = std::max(bx, x0);
+            AX_U32 c1 = std::min(bx + nBlockW, x1);
+            AX_U32 n = (c1 - c0) / nComps * (r1 - r0);
+            for (AX_U32 c = 0; c < nComps; c++) {
+                AX_U32 nTotal = 0;
+                for (AX_U32 i = c0 + c; i < c1; i += nComps) {
+                    nTotal += pSum[i - x0];
+                }
+
+                AX_U8 nMean = (AX_U8)((nTotal + n / 2) / n);
+                for (AX_U32 i = c0 + c; i < c1; i += nComps) {
+                    pRow[i - x0] = nMean;
+                }
+            }
+        }
+
+        for (AX_U32 r = r0; r < r1; r++) {
+            memcpy(pPlane + (size_t)r * nStride + x0, pRow, w);
+        }
+    }
+}
+
+AX_VOID CPrivacyMask::BlurPlane(AX_U8 *pPlane, AX_U32 nStride, AX_U32 x0, AX_U32 x1, AX_U32 y0, AX_U32 y1, AX_U32 nRadius, AX_U32 nComps)
+{
+    AX_S32 w = x1 - x0;
+    AX_S32 h = y1 - y0;
+    AX_S32 r = nRadius;
+    AX_U32 n = 2 * nRadius + 1;
+    AX_U16 nHalf = n / 2;
+    AX_U16 nInv = (65536 + n - 1) / n;
+
+    m_vecSum.assign(w, 0);
+    m_vecTmp.resize((size_t)w * h);
+    AX_U16 *pSum = m_vecSum.data();
+    AX_U8 *pTmp = m_vecTmp.data();
+
+    /* rows outside the rectangle repeat its edge, nothing outside is read */
+    auto Row = [&](AX_S32 y) {
+        y = std::min(std::max(y, 0), h - 1);
+        return pPlane + (size_t)(y0 + y) * nStride + x0;
+    };
+
+    /* vertical box by column sums sliding down the rectangle */
+    for (AX_S32 k = -r; k <= r; k++) {
+        AddRow(pSum, Row(k), w);
+    }
+    for (AX_S32 y = 0; y < h; y++) {
+        DivideRow(pSum, pTmp + (size_t)y * w, w, nHalf, nInv);
+        if (y + 1 < h) {
+            SlideRow(pSum, Row(y + r + 1), Row(y - r), w);
+        }
+    }
+
+    /* horizontal box per component, the row padded with its edge values */
+    AX_S32 m = w / nComps;
+    m_vecRow.resize(m + 2 * r + 16);
+    m_vecOut.resize(m);
+    AX_U8 *pPad = m_vecRow.data();
+    AX_U8 *pOut = m_vecOut.data();
+    for (AX_S32 y = 0; y < h; y++) {
+        const AX_U8 *pSrc = pTmp + (size_t)y * w;
+        AX_U8 *pDst = pPlane + (size_t)(y0 + y) * nStride + x0;
+        if (1 == nComps) {
+            memset(pPad, pSrc[0], r);
+            memcpy(pPad + r, pSrc, m);
+            memset(pPad + r + m, pSrc[m - 1], r + 1);
+            TapRow(pSum, pPad, m, n);
+            DivideRow(pSum, pDst, m, nHalf, nInv);
+            continue;
+        }
+
+        for (AX_U32 c = 0; c < nComps; c++) {
+            memset(pPad, pSrc[c], r);
+            for (AX_S32 i = 0; i < m; i++) {
+                pPad[r + i] = pSrc[i * nComps + c];
+            }
+            memset(pPad + r + m, pSrc[(m - 1) * nComps + c], r + 1);
+
+            TapRow(pSum, pPad, m, n);
+            DivideRow(pSum, pOut, m, nHalf, nInv);
+            for (AX_S32 i = 0; i < m; i++) {
+                pDst[i * nComps + c] = pOut[i];
+            }
+        }
+    }
+}
+
+AX_VOID CPrivacyMask::AddRow(AX_U16 *pSum, const AX_U8 *pRow, AX_U32 n)
+{
+    AX_U32 i = 0;
+#if defined(PRIVACY_MASK_NEON)
+    for (; i + 16 <= n; i += 16) {
+        uint8x16_t vRow = vld1q_u8(pRow + i);
+        vst1q_u16(pSum + i, vaddw_u8(vld1q_u16(pSum + i), vget_low_u8(vRow)));
+        vst1q_u16(pSum + i + 8, vaddw_u8(vld1q_u16(pSum + i + 8), vget_high_u8(vRow)));
+    }
+#elif defined(PRIVACY_MASK_SSE)
+    const __m128i vZero = _mm_setzero_si128();
+    for (; i + 16 <= n; i += 16) {
+        __m128i vRow = _mm_loadu_si128((const __m128i *)(pRow + i));
+        __m128i vLo = _mm_add_epi16(_mm_loadu_si128((const __m128i *)(pSum + i)), _mm_unpacklo_epi8(vRow, vZero));
+        __m128i vHi = _mm_add_epi16(_mm_loadu_si128((const __m128i *)(pSum + i + 8)), _mm_unpackhi_epi8(vRow, vZero));
+        _mm_storeu_si128((__m128i *)(pSum + i), vLo);
+        _mm_storeu_si128((__m128i *)(pSum + i + 8), vHi);
+    }
+#endif
+    for (; i < n; i++) {
+        pSum[i] += pRow[i];
+    }
+}
+
+AX_VOID CPrivacyMask::SlideRow(AX_U16 *pSum, const AX_U8 *pAdd, const AX_U8 *pSub, AX_U32 n)
+{
+    AX_U32 i = 0;
+#if defined(PRIVACY_MASK_NEON)
+    for (; i + 16 <= n; i += 16) {
+        uint8x16_t vAdd = vld1q_u8(pAdd + i);
+        uint8x16_t vSub = vld1q_u8(pSub + i);
+        vst1q_u16(pSum + i, vsubw_u8(vaddw_u8(vld1q_u16(pSum + i), vget_low_u8(vAdd)), vget_low_u8(vSub)));
+        vst1q_u16(pSum + i + 8, vsubw_u8(vaddw_u8(vld1q_u16(pSum + i + 8), vget_high_u8(vAdd)), vget_high_u8(vSub)));
+    }
+#elif defined(PRIVACY_MASK_SSE)
+    const __m128i vZero = _mm_setzero_si128();
+    for (; i + 16 <= n; i += 16) {
+        __m128i vAdd = _mm_loadu_si128((const __m128i *)(pAdd + i));
+        __m128i vSub = _mm_loadu_si128((const __m128i *)(pSub + i));
+        __m128i vLo = _mm_loadu_si128((const __m128i *)(pSum + i));
+        __m128i vHi = _mm_loadu_si128((const __m128i *)(pSum + i + 8));
+        vLo = _mm_sub_epi16(_mm_add_epi16(vLo, _mm_unpacklo_epi8(vAdd, vZero)), _mm_unpacklo_epi8(vSub, vZero));
+        vHi = _mm_sub_epi16(_mm_add_epi16(vHi, _mm_unpackhi_epi8(vAdd, vZero)), _mm_unpackhi_epi8(vSub, vZero));
+        _mm_storeu_si128((__m128i *)(pSum + i), vLo);
+        _mm_storeu_si128((__m128i *)(pSum + i + 8), vHi);
+    }
+#endif
+    for (; i < n; i++) {
+        pSum[i] = pSum[i] + pAdd[i] - pSub[i];
+    }
+}
+
+AX_VOID CPrivacyMask::TapRow(AX_U16 *pSum, const AX_U8 *pRow, AX_U32 n, AX_U32 nTaps)
+{
+    AX_U32 i = 0;
+#if defined(PRIVACY_MASK_NEON)
+    for (; i + 16 <= n; i += 16) {
+        uint16x8_t vLo = vdupq_n_u16(0);
+        uint16x8_t vHi = vdupq_n_u16(0);
+        for (AX_U32 k = 0; k < nTaps; k++) {
+            uint8x16_t vRow = vld1q_u8(pRow + i + k);
+            vLo = vaddw_u8(vLo, vget_low_u8(vRow));
+            vHi = vaddw_u8(vHi, vget_high_u8(vRow));
+        }
+        vst1q_u16(pSum + i, vLo);
+        vst1q_u16(pSum + i + 8, vHi);
+    }
+#elif defined(PRIVACY_MASK_SSE)
+    const __m128i vZero = _mm_setzero_si128();
+    for (; i + 16 <= n; i += 16) {
+        __m128i vLo = _mm_setzero_si128();
+        __m128i vHi = _mm_setzero_si128();
+        for (AX_U32 k = 0; k < nTaps; k++) {
+            __m128i vRow = _mm_loadu_si128((const __m128i *)(pRow + i + k));
+            vLo = _mm_add_epi16(vLo, _mm_unpacklo_epi8(vRow, vZero));
+            vHi = _mm_add_epi16(vHi, _mm_unpackhi_epi8(vRow, vZero));
+        }
+        _mm_storeu_si128((__m128i *)(pSum + i), vLo);
+        _mm_storeu_si128((__m128i *)(pSum + i + 8), vHi);
+    }
+#endif
+    if (i >= n) {
+        return;
+    }
+
+    /* the rest by running sum */
+    AX_U16 nTotal = 0;
+    for (AX_U32 k = 0; k < nTaps; k++) {
+        nTotal += pRow[i + k];
+    }
+    for (; i < n; i++) {
+        pSum[i] = nTotal;
+        nTotal = nTotal + pRow[i + nTaps] - pRow[i];
+    }
+}
+
+AX_VOID CPrivacyMask::DivideRow(const AX_U16 *pSum, AX_U8 *pDst, AX_U32 n, AX_U16 nHalf, AX_U16 nInv)
+{
+    AX_U32 i = 0;
+#if defined(PRIVACY_MASK_NEON)
+    const uint16x8_t vHalf = vdupq_n_u16(nHalf);
+    const uint16x4_t vInv = vdup_n_u16(nInv);
+    for (; i + 16 <= n; i += 16) {
+        uint16x8_t vLo = vaddq_u16(vld1q_u16(pSum + i), vHalf);
+        uint16x8_t vHi = vaddq_u16(vld1q_u16(pSum + i + 8), vHalf);
+        vLo = vcombine_u16(vshrn_n_u32(vmull_u16(vget_low_u16(vLo), vInv), 16), vshrn_n_u32(vmull_u16(vget_high_u16(vLo), vInv), 16));
+        vHi = vcombine_u16(vshrn_n_u32(vmull_u16(vget_low_u16(vHi), vInv), 16), vshrn_n_u32(vmull_u16(vget_high_u16(vHi), vInv), 16));
+        vst1q_u8(pDst + i, vcombine_u8(vmovn_u16(vLo), vmovn_u16(vHi)));
+    }
+#elif defined(PRIVACY_MASK_SSE)
+    const __m128i vHalf = _mm_set1_epi16((short)nHalf);
+    const __m128i vInv = _mm_set1_epi16((short)nInv);
+    for (; i + 16 <= n; i += 16) {
+        __m128i vLo = _mm_mulhi_epu16(_mm_add_epi16(_mm_loadu_si128((const __m128i *)(pSum + i)), vHalf), vInv);
+        __m128i vHi = _mm_mulhi_epu16(_mm_add_epi16(_mm_loadu_si128((const __m128i *)(pSum + i + 8)), vHalf), vInv);
+        _mm_storeu_si128((__m128i *)(pDst + i), _mm_packus_epi16(vLo, vHi));
+    }
+#endif
+    for (; i < n; i++) {
+        pDst[i] = (AX_U8)((((AX_U32)pSum[i] + nHalf) * nInv) >> 16);
+    }
+}
+
+AX_F32 CPrivacyMask::Benchmark(PRIVACY_MASK_TYPE_E eType, AX_U32 nSize, AX_U32 nWidth, AX_U32 nHeight, AX_U32 nLoops)
+{
+    nWidth &= ~1;
+    nHeight &= ~1;
+    if (0 == nLoops || nWidth < 256 || nHeight < 256) {
+        return 0;
+    }
+
+    std::vector<AX_U8> vecImage((size_t)nWidth * nHeight * 3 / 2);
+    for (AX_U32 y = 0; y < nHeight * 3 / 2; y++) {
+        for (AX_U32 x = 0; x < nWidth; x++) {
+            vecImage[(size_t)y * nWidth + x] = (AX_U8)((x * 7 + y * 13) & 0xFF);
+        }
+    }
+
+    AX_U32 nSeed = 1;
+    auto Rand = [&nSeed](AX_U32 nMax) {
+        nSeed = nSeed * 1103515245 + 12345;
+        return (nSeed >> 8) % nMax;
+    };
+
+    /* 10 faces and 10 plates */
+    std::vector<PRIVACY_MASK_RECT_T> vecRects;
+    for (AX_U32 i = 0; i < 20; i++) {
+        PRIVACY_MASK_RECT_T tRect;
+        tRect.nW = 48 + Rand(nWidth / 10);
+        tRect.nH = (i < 10) ? tRect.nW * 5 / 4 : tRect.nW / 3;
+        tRect.nX = Rand(nWidth - tRect.nW);
+        tRect.nY = Rand(nHeight - std::min(tRect.nH, nHeight / 2));
+        vecRects.push_back(tRect);
+    }
+
+    CPrivacyMask tMask;
+    AX_U64 nArea = 0;
+    for (auto &tRect : vecRects) {
+        AX_U32 x0, y0, x1, y1;
+        if (tMask.ClipRect(tRect, nWidth, nHeight, x0, y0, x1, y1)) {
+            nArea += (AX_U64)(x1 - x0) * (y1 - y0);
+        }
+    }
+
+    AX_U8 *pY = vecImage.data();
+    AX_U8 *pUV = pY + (size_t)nWidth * nHeight;
+    auto tStart = std::chrono::steady_clock::now();
+    for (AX_U32 i = 0; i < nLoops; i++) {
+        for (auto &tRect : vecRects) {
+            tMask.Apply(eType, pY, pUV, nWidth, nWidth, nHeight, tRect, nSize);
+        }
+    }
+    auto tEnd = std::chrono::steady_clock::now();
+
+    AX_F32 fMs = std::chrono::duration<AX_F32, std::milli>(tEnd - tStart).count() / nLoops;
+    return fMs * 1000000 / nArea;
+}
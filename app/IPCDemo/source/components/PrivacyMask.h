@@ -0,0 +1,79 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+
+
+
+#ifndef _PRIVACY_MASK_4B8E21D3_96A0_4C7F_B5E2_0F3A6C91D58B_H_
+#define _PRIVACY_MASK_4B8E21D3_96A0_4C7F_B5E2_0F3A6C91D58B_H_
+
+#include "global.h"
+#include <vector>
+
+#define PRIVACY_MASK_MAX_BLOCK (64)
+#define PRIVACY_MASK_MAX_RADIUS (15)   // (2 * radius + 1) * 255 stays in AX_U16
+
+typedef enum {
+    PRIVACY_MASK_MOSAIC = 0,
+    PRIVACY_MASK_BLUR,
+    PRIVACY_MASK_BUTT
+} PRIVACY_MASK_TYPE_E;
+
+typedef struct {
+    AX_U32 nX;
+    AX_U32 nY;
+    AX_U32 nW;
+    AX_U32 nH;
+} PRIVACY_MASK_RECT_T;
+
+/**
+ *  Mosaic or box blur of rectangles on a NV12 image, in place.
+ *  Rectangles are clipped to the image and aligned to even pixels for chroma.
+ */
+class CPrivacyMask
+{
+public:
+    CPrivacyMask(AX_VOID) = default;
+    ~CPrivacyMask(AX_VOID) = default;
+
+    /* pUV is the interleaved chroma plane, both planes are nStride bytes per row */
+    AX_VOID Mosaic(AX_U8 *pY, AX_U8 *pUV, AX_U32 nStride, AX_U32 nWidth, AX_U32 nHeight, const PRIVACY_MASK_RECT_T &tRect, AX_U32 nBlock);
+    AX_VOID Blur(AX_U8 *pY, AX_U8 *pUV, AX_U32 nStride, AX_U32 nWidth, AX_U32 nHeight, const PRIVACY_MASK_RECT_T &tRect, AX_U32 nRadius);
+
+    /* nSize is the mosaic block or the blur radius */
+    AX_VOID Apply(PRIVACY_MASK_TYPE_E eType, AX_U8 *pY, AX_U8 *pUV, AX_U32 nStride, AX_U32 nWidth, AX_U32 nHeight,
+                  const PRIVACY_MASK_RECT_T &tRect, AX_U32 nSize);
+
+    /* ms per megapixel of masked area, face and plate sized boxes on a nWidth x nHeight image */
+    static AX_F32 Benchmark(PRIVACY_MASK_TYPE_E eType, AX_U32 nSize, AX_U32 nWidth, AX_U32 nHeight, AX_U32 nLoops);
+
+private:
+    AX_BOOL ClipRect(const PRIVACY_MASK_RECT_T &tRect, AX_U32 nWidth, AX_U32 nHeight,
+                     AX_U32 &x0, AX_U32 &y0, AX_U32 &x1, AX_U32 &y1) const;
+
+    /* columns [x0, x1) and rows [y0, y1) of a plane, nComps interleaved components per pixel */
+    AX_VOID MosaicPlane(AX_U8 *pPlane, AX_U32 nStride, AX_U32 x0, AX_U32 x1, AX_U32 y0, AX_U32 y1,
+                        AX_U32 nBlockW, AX_U32 nBlockH, AX_U32 nComps);
+    AX_VOID BlurPlane(AX_U8 *pPlane, AX_U32 nStride, AX_U32 x0, AX_U32 x1, AX_U32 y0, AX_U32 y1, AX_U32 nRadius, AX_U32 nComps);
+
+    static AX_VOID AddRow(AX_U16 *pSum, const AX_U8 *pRow, AX_U32 n);
+    static AX_VOID SlideRow(AX_U16 *pSum, const AX_U8 *pAdd, const AX_U8 *pSub, AX_U32 n);
+    /* sum[i] = row[i] + ... + row[i + nTaps - 1], row holds n + nTaps bytes */
+    static AX_VOID TapRow(AX_U16 *pSum, const AX_U8 *pRow, AX_U32 n, AX_U32 nTaps);
+    /* dst = ((sum + nHalf) * nInv) >> 16 */
+    static AX_VOID DivideRow(const AX_U16 *pSum, AX_U8 *pDst, AX_U32 n, AX_U16 nHalf, AX_U16 nInv);
+
+private:
+    std::vector<AX_U16> m_vecSum;
+    std::vector<AX_U8> m_vecRow;
+    std::vector<AX_U8> m_vecTmp;
+    std::vector<AX_U8> m_vecOut;
+};
+
+#endif /* _PRIVACY_MASK_4B8E21D3_96A0_4C7F_B5E2_0F3A6C91D58B_H_ */
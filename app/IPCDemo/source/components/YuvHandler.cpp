@@ -11,8 +11,10 @@
 
 
 #include "YuvHandler.h"
+#include <chrono>
 #include <fstream>
 #include <string.h>
+#include <vector>
 using namespace std;
 
 ///
@@ -205,6 +207,26 @@ AX_VOID CYuvHandler::DrawPoint(AX_U8 *y, AX_U8 *u, AX_U8 *v, AX_U16 x0, AX_U16 y
     }
 }
 
+AX_VOID CYuvHandler::GetPlanes(AX_U8 *&pY, AX_U8 *&pU, AX_U8 *&pV) const
+{
+    pY = m_pImage;
+    pU = m_pImage;
+    pV = m_pImage;
+    switch (m_eType) {
+    case AX_YUV420_PLANAR:
+        pU = m_pImage + m_stride * m_nHeight;
+        pV = pU + m_stride * m_nHeight / 4;
+        break;
+    case AX_YUV420_SEMIPLANAR:
+    case AX_YUV420_SEMIPLANAR_VU:
+        pU = m_pImage + m_stride * m_nHeight;
+        pV = pU;
+        break;
+    default:
+        break;
+    }
+}
+
 AX_VOID CYuvHandler::DrawPoint(AX_S16 x,
                                AX_S16 y,
                                AX_U8 nScale/* = 1*/,
@@ -212,60 +234,196 @@ AX_VOID CYuvHandler::DrawPoint(AX_S16 x,
                                AX_S16 y_offset/* = 0*/,
                                YUV_COLOR eColor/* = YUV_GREEN*/)
 {
-    if (!m_pImage) {
+    /* nScale x nScale block */
+    FillRect((AX_S32)x * nScale - x_offset, (AX_S32)y * nScale - y_offset, nScale, nScale, eColor);
+}
+
+AX_VOID CYuvHandler::DrawSpan(AX_S16 x, AX_S16 y, AX_U16 nLen, YUV_COLOR eColor/* = YUV_GREEN*/)
+{
+    if (!m_pImage || y < 0 || y >= m_nHeight) {
         return;
     }
 
-    AX_U8 *pY = nullptr;
-    AX_U8 *pU = nullptr;
-    AX_U8 *pV = nullptr;
+    AX_S32 x0 = (x < 0) ? 0 : x;
+    AX_S32 x1 = (AX_S32)x + nLen;
+    x1 = (x1 > m_nWidth) ? m_nWidth : x1;
+    if (x0 >= x1) {
+        return;
+    }
+
+    const YUV_COLOR_T &tColor = g_YuvColors[eColor];
+    AX_U8 *pY = m_pImage + y * m_stride;
+    AX_U8 *pUV = m_pImage + m_stride * m_nHeight;
     switch (m_eType) {
     case AX_YUV420_PLANAR:
-        pY = m_pImage;
-        pU = m_pImage + m_stride * m_nHeight;
-        pV = pU + m_stride * m_nHeight / 4;
+        memset(pY + x0, tColor.Y, x1 - x0);
+        pUV += (y / 2) * (m_stride / 2) + x0 / 2;
+        memset(pUV, tColor.U, (x1 - 1) / 2 - x0 / 2 + 1);
+        memset(pUV + m_stride * m_nHeight / 4, tColor.V, (x1 - 1) / 2 - x0 / 2 + 1);
         break;
+
     case AX_YUV420_SEMIPLANAR:
+        /* as DrawPoint, Y only for the bright colors, UV only for the others */
+        if (tColor.Y == 0xFF) {
+            memset(pY + x0, tColor.Y, x1 - x0);
+        }
+        else {
+            pUV += (y / 2) * m_stride + x0 / 2 * 2;
+            AX_U32 nPairs = (x1 - 1) / 2 - x0 / 2 + 1;
+            if (tColor.U == tColor.V) {
+                memset(pUV, tColor.U, nPairs * 2);
+            }
+            else {
+                for (AX_U32 i = 0; i < nPairs; ++i) {
+                    pUV[i * 2]     = tColor.U;
+                    pUV[i * 2 + 1] = tColor.V;
+                }
+            }
+        }
+        break;
+
     case AX_YUV420_SEMIPLANAR_VU:
-        pY = m_pImage;
-        pU = m_pImage + m_stride * m_nHeight;
-        pV = pU;
+        memset(pY + x0, tColor.Y, x1 - x0);
+        pUV += (y / 2) * m_stride + x0 / 2 * 2;
+        for (AX_S32 i = 0; i < (x1 - 1) / 2 - x0 / 2 + 1; ++i) {
+            pUV[i * 2]     = tColor.V;
+            pUV[i * 2 + 1] = tColor.U;
+        }
         break;
+
     case AX_YUV422_INTERLEAVED_UYVY:
-    case AX_YUV422_INTERLEAVED_YUYV:
-        pY = m_pImage;
-        pU = pY;
-        pV = pY;
+    case AX_YUV422_INTERLEAVED_YUYV: {
+        /* whole macro pixels, as DrawPoint */
+        AX_U8 arrMacro[4] = {tColor.U, tColor.Y, tColor.V, tColor.Y};
+        if (AX_YUV422_INTERLEAVED_YUYV == m_eType) {
+            arrMacro[0] = tColor.Y;
+            arrMacro[1] = tColor.U;
+            arrMacro[2] = tColor.Y;
+            arrMacro[3] = tColor.V;
+        }
+        AX_U8 *p = m_pImage + y * m_stride * 2 + x0 / 2 * 4;
+        for (AX_S32 i = x0 / 2; i <= (x1 - 1) / 2; ++i, p += 4) {
+            memcpy(p, arrMacro, 4);
+        }
         break;
+    }
+
     default:
         break;
     }
+}
 
-    AX_S16 nXStart = 0;
-    AX_S16 nYStart = 0;
-    for(uint32_t hScale = 0; hScale < nScale; hScale++) {
-        for(uint32_t wScale = 0; wScale < nScale; wScale++) {
-            nXStart = x * nScale + hScale - x_offset;
-            nYStart = y * nScale + wScale - y_offset;
-            if (nXStart < 0 || nXStart > m_nWidth) {
-                break;
-            }
+AX_VOID CYuvHandler::DrawVSpan(AX_S16 x, AX_S16 y, AX_U16 nLen, YUV_COLOR eColor/* = YUV_GREEN*/)
+{
+    if (!m_pImage || x < 0 || x >= m_nWidth) {
+        return;
+    }
 
-            if (nYStart < 0 || nYStart > m_nHeight) {
-                break;
+    AX_S32 y0 = (y < 0) ? 0 : y;
+    AX_S32 y1 = (AX_S32)y + nLen;
+    y1 = (y1 > m_nHeight) ? m_nHeight : y1;
+    if (y0 >= y1) {
+        return;
+    }
+
+    const YUV_COLOR_T &tColor = g_YuvColors[eColor];
+    AX_U8 *pY = m_pImage + y0 * m_stride + x;
+    AX_U8 *pUV = m_pImage + m_stride * m_nHeight;
+    switch (m_eType) {
+    case AX_YUV420_PLANAR: {
+        for (AX_S32 i = y0; i < y1; ++i, pY += m_stride) {
+            *pY = tColor.Y;
+        }
+        AX_U8 *pU = pUV + (y0 / 2) * (m_stride / 2) + x / 2;
+        AX_U8 *pV = pU + m_stride * m_nHeight / 4;
+        for (AX_S32 i = y0 / 2; i <= (y1 - 1) / 2; ++i, pU += m_stride / 2, pV += m_stride / 2) {
+            *pU = tColor.U;
+            *pV = tColor.V;
+        }
+        break;
+    }
+
+    case AX_YUV420_SEMIPLANAR:
+        if (tColor.Y == 0xFF) {
+            for (AX_S32 i = y0; i < y1; ++i, pY += m_stride) {
+                *pY = tColor.Y;
+            }
+        }
+        else {
+            pUV += (y0 / 2) * m_stride + x / 2 * 2;
+            for (AX_S32 i = y0 / 2; i <= (y1 - 1) / 2; ++i, pUV += m_stride) {
+                pUV[0] = tColor.U;
+                pUV[1] = tColor.V;
             }
+        }
+        break;
+
+    case AX_YUV420_SEMIPLANAR_VU:
+        for (AX_S32 i = y0; i < y1; ++i, pY += m_stride) {
+            *pY = tColor.Y;
+        }
+        pUV += (y0 / 2) * m_stride + x / 2 * 2;
+        for (AX_S32 i = y0 / 2; i <= (y1 - 1) / 2; ++i, pUV += m_stride) {
+            pUV[0] = tColor.V;
+            pUV[1] = tColor.U;
+        }
+        break;
 
-            DrawPoint(pY, pU, pV, nXStart, nYStart, eColor);
+    case AX_YUV422_INTERLEAVED_UYVY:
+    case AX_YUV422_INTERLEAVED_YUYV: {
+        AX_U8 arrMacro[4] = {tColor.U, tColor.Y, tColor.V, tColor.Y};
+        if (AX_YUV422_INTERLEAVED_YUYV == m_eType) {
+            arrMacro[0] = tColor.Y;
+            arrMacro[1] = tColor.U;
+            arrMacro[2] = tColor.Y;
+            arrMacro[3] = tColor.V;
+        }
+        AX_U8 *p = m_pImage + y0 * m_stride * 2 + x / 2 * 4;
+        for (AX_S32 i = y0; i < y1; ++i, p += m_stride * 2) {
+            memcpy(p, arrMacro, 4);
         }
+        break;
+    }
+
+    default:
+        break;
+    }
+}
+
+AX_VOID CYuvHandler::FillRect(AX_S32 x, AX_S32 y, AX_S32 w, AX_S32 h, YUV_COLOR eColor/* = YUV_GREEN*/)
+{
+    AX_S32 x0 = (x < 0) ? 0 : x;
+    AX_S32 y0 = (y < 0) ? 0 : y;
+    AX_S32 x1 = (x + w > m_nWidth) ? m_nWidth : x + w;
+    AX_S32 y1 = (y + h > m_nHeight) ? m_nHeight : y + h;
+    if (!m_pImage || x0 >= x1 || y0 >= y1) {
+        return;
+    }
+
+    if (x1 - x0 == 1) {
+        DrawVSpan(x0, y0, y1 - y0, eColor);
+        return;
+    }
+
+    for (AX_S32 i = y0; i < y1; ++i) {
+        DrawSpan(x0, i, x1 - x0, eColor);
     }
 }
 
+/*
+ * Same pixels as Bresenham point by point, drawn as runs: rows of a x-major line and columns of a y-major line.
+ * nScale > 1 puts a nScale x nScale block on each point, its top left corner on the line.
+ */
 const AX_U8 *CYuvHandler::DrawLine(AX_S16 x0, AX_S16 y0, AX_S16 x1, AX_S16 y1, YUV_COLOR eColor/* = YUV_GREEN*/, AX_U8 nScale/* = 1*/)
 {
     if (!m_pImage) {
         return nullptr;
     }
 
+    if (0 == nScale) {
+        return m_pImage;
+    }
+
     x0 = (x0 < 0) ? 0 : x0;
     y0 = (y0 < 0) ? 0 : y0;
     x1 = (x1 < 0) ? 0 : x1;
@@ -276,50 +434,51 @@ const AX_U8 *CYuvHandler::DrawLine(AX_S16 x0, AX_S16 y0, AX_S16 x1, AX_S16 y1, Y
     x1 = (x1 >= m_nWidth)  ? m_nWidth  - 1 : x1;
     y1 = (y1 >= m_nHeight) ? m_nHeight - 1 : y1;
 
-    AX_U16 dx = (x0 > x1) ? (x0 - x1) : (x1 - x0);
-    AX_U16 dy = (y0 > y1) ? (y0 - y1) : (y1 - y0);
+    AX_S32 dx = (x0 > x1) ? (x0 - x1) : (x1 - x0);
+    AX_S32 dy = (y0 > y1) ? (y0 - y1) : (y1 - y0);
 
-    AX_S16 xstep = (x0 < x1) ? 1 : -1;
-    AX_S16 ystep = (y0 < y1) ? 1 : -1;
-    AX_S16 nstep = 0, eps = 0;
+    AX_S32 xstep = (x0 < x1) ? 1 : -1;
+    AX_S32 ystep = (y0 < y1) ? 1 : -1;
+    AX_S32 nstep = 0, eps = 0;
 
-    AX_U8 *pY = nullptr;
-    AX_U8 *pU = nullptr;
-    AX_U8 *pV = nullptr;
-    switch (m_eType) {
-    case AX_YUV420_PLANAR:
-        pY = m_pImage;
-        pU = m_pImage + m_stride * m_nHeight;
-        pV = pU + m_stride * m_nHeight / 4;
-        break;
-    case AX_YUV420_SEMIPLANAR:
-    case AX_YUV420_SEMIPLANAR_VU:
-        pY = m_pImage;
-        pU = m_pImage + m_stride * m_nHeight;
-        pV = pU;
-        break;
-    case AX_YUV422_INTERLEAVED_UYVY:
-    case AX_YUV422_INTERLEAVED_YUYV:
-        pY = m_pImage;
-        pU = pY;
-        pV = pY;
-        break;
-    default:
-        break;
+    if (0 == dx || 0 == dy) {
+        FillRect(AX_MIN(x0, x1), AX_MIN(y0, y1), dx + nScale, dy + nScale, eColor);
+        return m_pImage;
     }
 
-    AX_U16 x = x0;
-    AX_U16 y = y0;
-    if (dx > dy) {
-        while (nstep <= dx) {
-            if (nScale == 1) {
-                DrawPoint(pY, pU, pV, x, y, eColor);
+    AX_S32 x = x0;
+    AX_S32 y = y0;
+    if (dx == dy && 1 == nScale) {
+        /* diagonal, one pixel per row */
+        AX_U8 *pY = nullptr;
+        AX_U8 *pU = nullptr;
+        AX_U8 *pV = nullptr;
+        GetPlanes(pY, pU, pV);
+        if (AX_YUV420_SEMIPLANAR == m_eType && g_YuvColors[eColor].Y == 0xFF) {
+            AX_U8 *p = pY + y * m_stride + x;
+            AX_S32 nNext = ystep * m_stride + xstep;
+            for (; nstep <= dx; ++nstep, p += nNext) {
+                *p = g_YuvColors[eColor].Y;
             }
-            else {
-                DrawPoint(x, y, nScale, x*(nScale-1), y*(nScale-1), eColor);
+        }
+        else {
+            for (; nstep <= dx; ++nstep, x += xstep, y += ystep) {
+                DrawPoint(pY, pU, pV, x, y, eColor);
             }
+        }
+        return m_pImage;
+    }
+
+    AX_S32 nRun = (dx > dy) ? x : y;
+    if (dx > dy) {
+        while (nstep <= dx) {
             eps += dy;
-            if ((eps << 1) >= dx) {
+            AX_BOOL bStep = ((eps << 1) >= dx) ? AX_TRUE : AX_FALSE;
+            if (bStep || nstep == dx) {
+                FillRect(AX_MIN(nRun, x), y, (nRun > x ? nRun - x : x - nRun) + nScale, nScale, eColor);
+                nRun = x + xstep;
+            }
+            if (bStep) {
                 y += ystep;
                 eps -= dx;
             }
@@ -328,14 +487,13 @@ const AX_U8 *CYuvHandler::DrawLine(AX_S16 x0, AX_S16 y0, AX_S16 x1, AX_S16 y1, Y
         }
     } else {
         while (nstep <= dy) {
-            if (nScale == 1) {
-                DrawPoint(pY, pU, pV, x, y, eColor);
-            }
-            else {
-                DrawPoint(x, y, nScale, x*(nScale-1), y*(nScale-1), eColor);
-            }
             eps += dx;
-            if ((eps << 1) >= dy) {
+            AX_BOOL bStep = ((eps << 1) >= dy) ? AX_TRUE : AX_FALSE;
+            if (bStep || nstep == dy) {
+                FillRect(x, AX_MIN(nRun, y), nScale, (nRun > y ? nRun - y : y - nRun) + nScale, eColor);
+                nRun = y + ystep;
+            }
+            if (bStep) {
                 x += xstep;
                 eps -= dy;
             }
@@ -344,7 +502,7 @@ const AX_U8 *CYuvHandler::DrawLine(AX_S16 x0, AX_S16 y0, AX_S16 x1, AX_S16 y1, Y
         }
     }
 
-    return pY;
+    return m_pImage;
 }
 
 const AX_U8 *CYuvHandler::DrawRect(AX_S16 x0, AX_S16 y0, AX_U16 w, AX_U16 h, YUV_COLOR eColor/* = YUV_GREEN*/)
@@ -353,6 +511,7 @@ const AX_U8 *CYuvHandler::DrawRect(AX_S16 x0, AX_S16 y0, AX_U16 w, AX_U16 h, YUV
         return nullptr;
     }
 
+    /* four spans, end points clamped into the image as DrawLine does */
     if (w > 0 && h > 0) {
         DrawLine(x0, y0, x0 + w, y0, eColor);
         DrawLine(x0, y0, x0, y0 + h, eColor);
@@ -363,6 +522,33 @@ const AX_U8 *CYuvHandler::DrawRect(AX_S16 x0, AX_S16 y0, AX_U16 w, AX_U16 h, YUV
     return m_pImage;
 }
 
+AX_F32 CYuvHandler::Benchmark(AX_IMG_FORMAT_E eType, AX_U16 nWidth, AX_U16 nHeight, AX_U32 nBoxes)
+{
+    std::vector<AX_U8> vecImage(CalcImgSize(nWidth, nHeight, eType));
+    if (vecImage.empty() || 0 == nBoxes) {
+        return 0;
+    }
+
+    CYuvHandler yuv(vecImage.data(), nWidth, nHeight, eType);
+
+    /* boxes of ProcOSD sizes, spread over the frame */
+    AX_U32 nSeed = 1;
+    auto Rand = [&nSeed](AX_U32 nMax) {
+        nSeed = nSeed * 1103515245 + 12345;
+        return (nSeed >> 8) % nMax;
+    };
+
+    auto tStart = std::chrono::steady_clock::now();
+    for (AX_U32 i = 0; i < nBoxes; ++i) {
+        AX_U16 w = 32 + Rand(nWidth / 4);
+        AX_U16 h = 32 + Rand(nHeight / 3);
+        yuv.DrawRect(Rand(nWidth - w), Rand(nHeight - h), w, h, (YUV_COLOR)(i % YUV_COLOR_MAX));
+    }
+    auto tEnd = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<AX_F32, std::micro>(tEnd - tStart).count() / nBoxes;
+}
+
 AX_U32 CYuvHandler::GetClipImage(AX_S16 x0, AX_S16 y0, AX_U16 &w, AX_U16 &h, AX_U8 *pClipImage)
 {
     AX_U32 clipSize = 0;
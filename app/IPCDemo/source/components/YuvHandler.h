@@ -57,7 +57,18 @@ public:
 
     AX_VOID DrawPoint(AX_S16 x, AX_S16 y, AX_U8 nScale = 1, AX_S16 x_offset = 0, AX_S16 y_offset = 0, YUV_COLOR eColor = YUV_GREEN);
 
+    /* Horizontal run of nLen pixels from (x, y), clipped to image, same planes as DrawPoint written by memset */
+    AX_VOID DrawSpan(AX_S16 x, AX_S16 y, AX_U16 nLen, YUV_COLOR eColor = YUV_GREEN);
+    /* Vertical run of nLen pixels from (x, y), clipped to image */
+    AX_VOID DrawVSpan(AX_S16 x, AX_S16 y, AX_U16 nLen, YUV_COLOR eColor = YUV_GREEN);
+    /* Filled w x h block, clipped to image */
+    AX_VOID FillRect(AX_S32 x, AX_S32 y, AX_S32 w, AX_S32 h, YUV_COLOR eColor = YUV_GREEN);
+
+    /* us per DrawRect of boxes in ProcOSD sizes on a nWidth x nHeight image */
+    static AX_F32 Benchmark(AX_IMG_FORMAT_E eType, AX_U16 nWidth, AX_U16 nHeight, AX_U32 nBoxes);
+
 private:
+    AX_VOID GetPlanes(AX_U8 *&pY, AX_U8 *&pU, AX_U8 *&pV) const;
     AX_VOID DrawPoint(AX_U8 *y, AX_U8 *u, AX_U8 *v, AX_U16 x0, AX_U16 y0, YUV_COLOR eColor);
     AX_VOID FreeImage(AX_VOID);
 
@@ -0,0 +1,62 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+#include "AiScheduler.h"
+#include "TimeUtil.h"
+
+CAiScheduler::CAiScheduler(AX_VOID)
+{
+    Reset();
+}
+
+AX_VOID CAiScheduler::Reset(AX_VOID)
+{
+    m_fCurFps = 0;
+    m_fAccum = 0;
+    m_bActive = AX_TRUE;
+    m_nLastActiveTick = 0;
+    m_nLastStepTick = 0;
+}
+
+AX_BOOL CAiScheduler::Schedule(AX_U32 nSrcFps, AX_U32 nMaxFps, AX_U32 nMinFps, AX_BOOL bMotion, AX_U32 nTargets)
+{
+    if (0 == nSrcFps) {
+        return AX_FALSE;
+    }
+
+    nMaxFps = AX_MIN(nMaxFps, nSrcFps);
+    nMinFps = AX_MIN(nMinFps, nMaxFps);
+
+    AX_U64 nTick = CTimeUtils::GetTickCount();
+
+    if (bMotion || nTargets > 0 || 0 == m_nLastActiveTick) {
+        // fast attack
+        m_bActive = AX_TRUE;
+        m_nLastActiveTick = nTick;
+        m_fCurFps = nMaxFps;
+    } else if (nTick - m_nLastActiveTick >= AI_SCHED_IDLE_HOLD_TIME) {
+        // slow release, one step per hold time
+        m_bActive = AX_FALSE;
+        if (nTick - m_nLastStepTick >= AI_SCHED_IDLE_HOLD_TIME) {
+            m_fCurFps *= AI_SCHED_STEP_DOWN_RATIO;
+            m_nLastStepTick = nTick;
+        }
+    }
+
+    m_fCurFps = AX_MIN(AX_MAX(m_fCurFps, (AX_F32)nMinFps), (AX_F32)nMaxFps);
+
+    // spread sent frames evenly over source frames
+    m_fAccum += m_fCurFps;
+    if (m_fAccum >= nSrcFps) {
+        m_fAccum -= nSrcFps;
+        return AX_TRUE;
+    }
+
+    return AX_FALSE;
+}
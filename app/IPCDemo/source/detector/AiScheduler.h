@@ -0,0 +1,45 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+#pragma once
+#include "global.h"
+
+/**
+ * Motion gated AI frame scheduler
+ * Runs NPU at max fps while there is motion or tracked targets, steps down to the
+ * heartbeat (min) fps after the scene keeps idle, and jumps back on activity.
+ */
+#define AI_SCHED_IDLE_HOLD_TIME (2000) // ms idle before each step down
+#define AI_SCHED_STEP_DOWN_RATIO (0.5)
+
+class CAiScheduler
+{
+public:
+    CAiScheduler(AX_VOID);
+
+    AX_VOID Reset(AX_VOID);
+
+    /* returns AX_TRUE if current source frame should be sent to NPU */
+    AX_BOOL Schedule(AX_U32 nSrcFps, AX_U32 nMaxFps, AX_U32 nMinFps, AX_BOOL bMotion, AX_U32 nTargets);
+
+    AX_F32 GetCurFps(AX_VOID) const {
+        return m_fCurFps;
+    }
+
+    AX_BOOL IsActive(AX_VOID) const {
+        return m_bActive;
+    }
+
+private:
+    AX_F32 m_fCurFps;
+    AX_F32 m_fAccum;
+    AX_BOOL m_bActive;
+    AX_U64 m_nLastActiveTick;
+    AX_U64 m_nLastStepTick;
+};
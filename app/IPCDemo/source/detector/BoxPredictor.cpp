@@ -0,0 +1,151 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+#include "BoxPredictor.h"
+
+#define PREDICTOR_CLAMP(_v_, _min_, _max_) AX_MIN(AX_MAX(_v_, _min_), _max_)
+
+// Observe objects of one category
+#define ObjectObserve(Obj, eObj) \
+    do { \
+        if (pResult->p##Obj##s) { \
+            AX_U32 nSize = AX_MIN(pResult->n##Obj##Size, MAX_DECT_BOX_COUNT); \
+            for (AX_U32 i = 0; i < nSize; i++) { \
+                Observe(eObj, pResult->p##Obj##s[i].u64TrackId, pResult->p##Obj##s[i].tBox, u64Pts); \
+            } \
+        } \
+    } while (0)
+
+// Predict objects of one category
+#define ObjectPredict(Obj, eObj) \
+    do { \
+        for (AX_U32 i = 0; i < tResult.n##Obj##Size; i++) { \
+            Extrapolate(eObj, tResult.t##Obj##s[i].u64TrackId, u64Pts, tResult.t##Obj##s[i].tBox); \
+        } \
+    } while (0)
+
+AX_VOID CBoxPredictor::Update(const AI_Detection_Result_t *pResult, AX_U64 u64Pts)
+{
+    std::lock_guard<std::mutex> lck(m_mutex);
+
+    for (auto &mapTrack : m_mapTrack) {
+        for (auto &kv : mapTrack) {
+            kv.second.bSeen = AX_FALSE;
+        }
+    }
+
+    if (pResult) {
+        ObjectObserve(Face, BOX_PREDICTOR_OBJECT_FACE);
+        ObjectObserve(Body, BOX_PREDICTOR_OBJECT_BODY);
+        ObjectObserve(Vehicle, BOX_PREDICTOR_OBJECT_VEHICLE);
+        ObjectObserve(Plate, BOX_PREDICTOR_OBJECT_PLATE);
+        ObjectObserve(Cycle, BOX_PREDICTOR_OBJECT_CYCLE);
+    }
+
+    // tracks missing from this result are lost
+    for (auto &mapTrack : m_mapTrack) {
+        for (auto it = mapTrack.begin(); it != mapTrack.end();) {
+            if (!it->second.bSeen) {
+                it = mapTrack.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+AX_VOID CBoxPredictor::Predict(DETECT_RESULT_T &tResult, AX_U64 u64Pts)
+{
+    std::lock_guard<std::mutex> lck(m_mutex);
+
+    ObjectPredict(Face, BOX_PREDICTOR_OBJECT_FACE);
+    ObjectPredict(Vehicle, BOX_PREDICTOR_OBJECT_VEHICLE);
+    ObjectPredict(Plate, BOX_PREDICTOR_OBJECT_PLATE);
+    ObjectPredict(Cycle, BOX_PREDICTOR_OBJECT_CYCLE);
+
+    // body poses share index with bodies, move points along with the box
+    for (AX_U32 i = 0; i < tResult.nBodySize; i++) {
+        AI_Detection_Box_t tBox = tResult.tBodys[i].tBox;
+        if (!Extrapolate(BOX_PREDICTOR_OBJECT_BODY, tResult.tBodys[i].u64TrackId, u64Pts, tResult.tBodys[i].tBox)
+            || i >= tResult.nPoseSize) {
+            continue;
+        }
+
+        AX_F32 fDx = tResult.tBodys[i].tBox.fX - tBox.fX;
+        AX_F32 fDy = tResult.tBodys[i].tBox.fY - tBox.fY;
+        AI_Detection_PoseResult_t &tPose = tResult.tPoses[i];
+        for (AX_U8 j = 0; j < tPose.nPointNum; j++) {
+            if (tPose.tPoint[j].fX > 0 || tPose.tPoint[j].fY > 0) {
+                tPose.tPoint[j].fX = PREDICTOR_CLAMP(tPose.tPoint[j].fX + fDx, 0.0f, 1.0f);
+                tPose.tPoint[j].fY = PREDICTOR_CLAMP(tPose.tPoint[j].fY + fDy, 0.0f, 1.0f);
+            }
+        }
+    }
+}
+
+AX_VOID CBoxPredictor::Observe(BOX_PREDICTOR_OBJECT_E eObject, AX_U64 u64TrackId, const AI_Detection_Box_t &tBox, AX_U64 u64Pts)
+{
+    if (0 == u64TrackId) {
+        return;
+    }
+
+    std::unordered_map<AX_U64, BOX_TRACK_STATE_T> &mapTrack = m_mapTrack[eObject];
+    auto it = mapTrack.find(u64TrackId);
+    BOX_TRACK_STATE_T *pTrack = nullptr;
+    if (it != mapTrack.end()) {
+        pTrack = &it->second;
+        if (u64Pts > pTrack->u64Pts && u64Pts - pTrack->u64Pts <= BOX_PREDICTOR_MAX_INTERVAL) {
+            AX_F32 fDt = (AX_F32)(u64Pts - pTrack->u64Pts);
+            AX_F32 fAlpha = BOX_PREDICTOR_VELOCITY_ALPHA;
+
+            pTrack->fVx = fAlpha * (tBox.fX - pTrack->tBox.fX) / fDt + (1 - fAlpha) * pTrack->fVx;
+            pTrack->fVy = fAlpha * (tBox.fY - pTrack->tBox.fY) / fDt + (1 - fAlpha) * pTrack->fVy;
+            pTrack->fVw = fAlpha * (tBox.fW - pTrack->tBox.fW) / fDt + (1 - fAlpha) * pTrack->fVw;
+            pTrack->fVh = fAlpha * (tBox.fH - pTrack->tBox.fH) / fDt + (1 - fAlpha) * pTrack->fVh;
+        } else if (u64Pts != pTrack->u64Pts) {
+            pTrack->fVx = pTrack->fVy = pTrack->fVw = pTrack->fVh = 0;
+        }
+    } else {
+        if (mapTrack.size() >= BOX_PREDICTOR_TRACK_NUM) {
+            return;
+        }
+
+        pTrack = &mapTrack[u64TrackId];
+        pTrack->fVx = pTrack->fVy = pTrack->fVw = pTrack->fVh = 0;
+    }
+
+    pTrack->bSeen = AX_TRUE;
+    pTrack->u64Pts = u64Pts;
+    pTrack->tBox = tBox;
+}
+
+AX_BOOL CBoxPredictor::Extrapolate(BOX_PREDICTOR_OBJECT_E eObject, AX_U64 u64TrackId, AX_U64 u64Pts, AI_Detection_Box_t &tBox)
+{
+    if (0 == u64TrackId) {
+        return AX_FALSE;
+    }
+
+    auto it = m_mapTrack[eObject].find(u64TrackId);
+    if (it == m_mapTrack[eObject].end() || u64Pts <= it->second.u64Pts) {
+        return AX_FALSE;
+    }
+
+    const BOX_TRACK_STATE_T *pTrack = &it->second;
+
+    AX_F32 fDt = (AX_F32)AX_MIN(u64Pts - pTrack->u64Pts, (AX_U64)BOX_PREDICTOR_MAX_HORIZON);
+
+    AX_F32 fW = PREDICTOR_CLAMP(pTrack->tBox.fW + pTrack->fVw * fDt, 0.0f, 1.0f);
+    AX_F32 fH = PREDICTOR_CLAMP(pTrack->tBox.fH + pTrack->fVh * fDt, 0.0f, 1.0f);
+    tBox.fX = PREDICTOR_CLAMP(pTrack->tBox.fX + pTrack->fVx * fDt, 0.0f, 1.0f - fW);
+    tBox.fY = PREDICTOR_CLAMP(pTrack->tBox.fY + pTrack->fVy * fDt, 0.0f, 1.0f - fH);
+    tBox.fW = fW;
+    tBox.fH = fH;
+
+    return AX_TRUE;
+}
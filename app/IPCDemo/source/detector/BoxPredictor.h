@@ -0,0 +1,67 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+#pragma once
+#include <mutex>
+#include <unordered_map>
+#include "global.h"
+#include "OptionHelper.h"
+#include "Singleton.h"
+
+/**
+ * Per-track constant velocity box predictor
+ * NPU results arrive at AI fps, overlays are drawn at video fps. Boxes are
+ * extrapolated from the detected frame PTS to the encoded frame PTS (us).
+ */
+#define BOX_PREDICTOR_TRACK_NUM (2 * MAX_DECT_BOX_COUNT) // per object type, previous + current result
+#define BOX_PREDICTOR_MAX_HORIZON (500000)  // us, extrapolate no further than this
+#define BOX_PREDICTOR_MAX_INTERVAL (2000000) // us, older observation restarts velocity
+#define BOX_PREDICTOR_VELOCITY_ALPHA (0.5)  // weight of new velocity measurement
+
+typedef enum _BOX_PREDICTOR_OBJECT_E {
+    BOX_PREDICTOR_OBJECT_FACE = 0,
+    BOX_PREDICTOR_OBJECT_BODY,
+    BOX_PREDICTOR_OBJECT_VEHICLE,
+    BOX_PREDICTOR_OBJECT_PLATE,
+    BOX_PREDICTOR_OBJECT_CYCLE,
+    BOX_PREDICTOR_OBJECT_BUTT
+} BOX_PREDICTOR_OBJECT_E;
+
+typedef struct _BOX_TRACK_STATE_T {
+    AX_BOOL bSeen;
+    AX_U64 u64Pts;
+    AI_Detection_Box_t tBox;
+    AX_F32 fVx, fVy, fVw, fVh; // relative per us
+} BOX_TRACK_STATE_T;
+
+class CBoxPredictor : public CSingleton<CBoxPredictor> {
+    friend class CSingleton<CBoxPredictor>;
+
+public:
+    /* feed a published NPU result, pResult is null if nothing detected */
+    AX_VOID Update(const AI_Detection_Result_t *pResult, AX_U64 u64Pts);
+    /* move boxes (and body poses) of tResult to u64Pts */
+    AX_VOID Predict(DETECT_RESULT_T &tResult, AX_U64 u64Pts);
+
+private:
+    CBoxPredictor(AX_VOID) noexcept = default;
+    virtual ~CBoxPredictor(AX_VOID) = default;
+
+    /* virtual function of CSingleton */
+    AX_BOOL Init(AX_VOID) override {
+        return AX_TRUE;
+    };
+
+    AX_VOID Observe(BOX_PREDICTOR_OBJECT_E eObject, AX_U64 u64TrackId, const AI_Detection_Box_t &tBox, AX_U64 u64Pts);
+    AX_BOOL Extrapolate(BOX_PREDICTOR_OBJECT_E eObject, AX_U64 u64TrackId, AX_U64 u64Pts, AI_Detection_Box_t &tBox);
+
+private:
+    std::mutex m_mutex;
+    std::unordered_map<AX_U64, BOX_TRACK_STATE_T> m_mapTrack[BOX_PREDICTOR_OBJECT_BUTT]; // track id -> state
+};
@@ -0,0 +1,372 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+#include <algorithm>
+#include <dirent.h>
+#include <sys/prctl.h>
+#include <sys/stat.h>
+#include "DetectBench.h"
+#include "Detector.h"
+#include "MediaFrame.h"
+#include "picojson.h"
+
+#define DETECT_BENCH "AI_BENCH"
+
+#define DETECT_BENCH_ENABLE_ENV_STR "AI_BENCH_ENABLE"
+#define DETECT_BENCH_INPUT_ENV_STR "AI_BENCH_INPUT"
+#define DETECT_BENCH_FRAMES_ENV_STR "AI_BENCH_FRAMES"
+#define DETECT_BENCH_FPS_ENV_STR "AI_BENCH_FPS"
+#define DETECT_BENCH_INFLIGHT_ENV_STR "AI_BENCH_INFLIGHT"
+#define DETECT_BENCH_REPORT_ENV_STR "AI_BENCH_REPORT"
+
+#define DETECT_BENCH_DEFAULT_FRAMES (1000)
+#define DETECT_BENCH_DEFAULT_INFLIGHT (4)
+#define DETECT_BENCH_DEFAULT_REPORT "./ai_bench.json"
+
+namespace {
+AX_U32 GetEnvU32(const AX_CHAR *szName, AX_U32 nDefault)
+{
+    const AX_CHAR *szValue = getenv(szName);
+    return szValue ? (AX_U32)atoi(szValue) : nDefault;
+}
+
+/* nearest rank, vec must be sorted */
+AX_F32 Percentile(const std::vector<AX_U32> &vec, AX_U32 nPercent)
+{
+    if (vec.empty()) {
+        return 0;
+    }
+
+    size_t nRank = (vec.size() * nPercent + 99) / 100;
+    return vec[nRank ? nRank - 1 : 0] / 1000.0;
+}
+
+AX_VOID WriteStat(FILE *fp, const AX_CHAR *szName, std::vector<AX_U32> &vec, AX_BOOL bLast)
+{
+    std::sort(vec.begin(), vec.end());
+
+    AX_U64 nSum = 0;
+    for (auto nValue : vec) {
+        nSum += nValue;
+    }
+
+    fprintf(fp, "  \"%s\": {\"avg\": %.3f, \"p50\": %.3f, \"p95\": %.3f, \"p99\": %.3f, \"max\": %.3f}%s\n",
+            szName, vec.empty() ? 0 : nSum / 1000.0 / vec.size(),
+            Percentile(vec, 50), Percentile(vec, 95), Percentile(vec, 99), Percentile(vec, 100),
+            bLast ? "" : ",");
+}
+} // namespace
+
+AX_BOOL CDetectBench::LoadConfig(AX_VOID)
+{
+    if (0 == GetEnvU32(DETECT_BENCH_ENABLE_ENV_STR, 0)) {
+        return AX_FALSE;
+    }
+
+    const AX_CHAR *szInput = getenv(DETECT_BENCH_INPUT_ENV_STR);
+    if (!szInput) {
+        LOG_M_E(DETECT_BENCH, "%s is not set", DETECT_BENCH_INPUT_ENV_STR);
+        return AX_FALSE;
+    }
+
+    const AX_CHAR *szReport = getenv(DETECT_BENCH_REPORT_ENV_STR);
+
+    m_tConfig.strInput = szInput;
+    m_tConfig.strReport = szReport ? szReport : DETECT_BENCH_DEFAULT_REPORT;
+    m_tConfig.nFrames = GetEnvU32(DETECT_BENCH_FRAMES_ENV_STR, DETECT_BENCH_DEFAULT_FRAMES);
+    m_tConfig.nFps = GetEnvU32(DETECT_BENCH_FPS_ENV_STR, 0);
+    m_tConfig.nInflight = GetEnvU32(DETECT_BENCH_INFLIGHT_ENV_STR, DETECT_BENCH_DEFAULT_INFLIGHT);
+
+    // detector in-flight table keeps one spare slot
+    m_tConfig.nInflight = AX_MIN(AX_MAX(m_tConfig.nInflight, (AX_U32)1), (AX_U32)(DETECTOR_INFLIGHT_SLOT_NUM - 1));
+
+    return AX_TRUE;
+}
+
+AX_BOOL CDetectBench::LoadFrame(FILE *fp)
+{
+    DETECT_BENCH_FRAME_T tFrame;
+    AX_S32 nRet = AX_SYS_MemAlloc(&tFrame.nPhyAddr, &tFrame.pVirAddr, m_nFrameSize, 256, NULL);
+    if (AX_SDK_PASS != nRet) {
+        LOG_M_E(DETECT_BENCH, "AX_SYS_MemAlloc() failed, size:0x%x, error: 0x%x", m_nFrameSize, nRet);
+        return AX_FALSE;
+    }
+
+    if (1 != fread(tFrame.pVirAddr, m_nFrameSize, 1, fp)) {
+        AX_SYS_MemFree(tFrame.nPhyAddr, tFrame.pVirAddr);
+        return AX_FALSE;
+    }
+
+    m_vecFrame.push_back(tFrame);
+
+    return AX_TRUE;
+}
+
+AX_BOOL CDetectBench::LoadFrames(AX_VOID)
+{
+    struct stat tStat;
+    if (0 != stat(m_tConfig.strInput.c_str(), &tStat)) {
+        LOG_M_E(DETECT_BENCH, "input(%s) not found", m_tConfig.strInput.c_str());
+        return AX_FALSE;
+    }
+
+    if (S_ISDIR(tStat.st_mode)) {
+        std::vector<std::string> vecFile;
+        DIR *pDir = opendir(m_tConfig.strInput.c_str());
+        if (pDir) {
+            struct dirent *pEntry = nullptr;
+            while ((pEntry = readdir(pDir)) != nullptr) {
+                if (DT_REG == pEntry->d_type) {
+                    vecFile.push_back(m_tConfig.strInput + "/" + pEntry->d_name);
+                }
+            }
+            closedir(pDir);
+        }
+
+        std::sort(vecFile.begin(), vecFile.end());
+
+        for (auto &strFile : vecFile) {
+            if (m_vecFrame.size() >= DETECT_BENCH_MAX_LOAD_FRAMES) {
+                break;
+            }
+
+            struct stat tFileStat;
+            if (0 != stat(strFile.c_str(), &tFileStat) || (AX_U32)tFileStat.st_size != m_nFrameSize) {
+                LOG_M_W(DETECT_BENCH, "skip %s, should be %d*%d NV12", strFile.c_str(), m_nWidth, m_nHeight);
+                continue;
+            }
+
+            FILE *fp = fopen(strFile.c_str(), "rb");
+            if (fp) {
+                LoadFrame(fp);
+                fclose(fp);
+            }
+        }
+    } else {
+        FILE *fp = fopen(m_tConfig.strInput.c_str(), "rb");
+        if (fp) {
+            while (m_vecFrame.size() < DETECT_BENCH_MAX_LOAD_FRAMES && LoadFrame(fp)) {
+            }
+            fclose(fp);
+        }
+    }
+
+    if (m_vecFrame.empty()) {
+        LOG_M_E(DETECT_BENCH, "no %d*%d NV12 frame loaded from %s", m_nWidth, m_nHeight, m_tConfig.strInput.c_str());
+        return AX_FALSE;
+    }
+
+    LOG_M(DETECT_BENCH, "loaded %d frames from %s", (AX_U32)m_vecFrame.size(), m_tConfig.strInput.c_str());
+
+    return AX_TRUE;
+}
+
+AX_VOID CDetectBench::FreeFrames(AX_VOID)
+{
+    for (auto &tFrame : m_vecFrame) {
+        AX_SYS_MemFree(tFrame.nPhyAddr, tFrame.pVirAddr);
+    }
+
+    m_vecFrame.clear();
+}
+
+AX_BOOL CDetectBench::Start(AX_U32 nWidth, AX_U32 nHeight)
+{
+    if (m_bRunning || m_pThread || !LoadConfig()) {
+        return AX_FALSE;
+    }
+
+    m_nWidth = nWidth;
+    m_nHeight = nHeight;
+    m_nFrameSize = nWidth * nHeight * 3 / 2;
+
+    if (!LoadFrames()) {
+        return AX_FALSE;
+    }
+
+    for (auto &tSlot : m_arrSlot) {
+        tSlot.bValid = AX_FALSE;
+        tSlot.nSeq = 0;
+    }
+    m_nInflight = 0;
+    m_nSubmitted = 0;
+    m_nDropped = 0;
+    m_nLost = 0;
+    m_vecLatency.clear();
+    m_vecHandler.clear();
+    m_vecLatency.reserve(m_tConfig.nFrames);
+    m_vecHandler.reserve(m_tConfig.nFrames);
+
+    LOG_M(DETECT_BENCH, "start: frames %d, fps %d, inflight %d", m_tConfig.nFrames, m_tConfig.nFps, m_tConfig.nInflight);
+
+    m_bRunning = AX_TRUE;
+    m_pThread = new std::thread(&CDetectBench::BenchThreadFunc, this);
+
+    return AX_TRUE;
+}
+
+AX_VOID CDetectBench::Stop(AX_VOID)
+{
+    if (!m_pThread) {
+        return;
+    }
+
+    m_bRunning = AX_FALSE;
+    m_cv.notify_all();
+
+    if (m_pThread->joinable()) {
+        m_pThread->join();
+    }
+
+    delete m_pThread;
+    m_pThread = nullptr;
+}
+
+AX_VOID CDetectBench::OnResult(AX_U64 nSeq, const std::chrono::steady_clock::time_point &tpStart,
+                               const std::chrono::steady_clock::time_point &tpEnd)
+{
+    std::lock_guard<std::mutex> lck(m_mutex);
+
+    DETECT_BENCH_SLOT_T &tSlot = m_arrSlot[nSeq % DETECT_BENCH_SLOT_NUM];
+    if (!tSlot.bValid || tSlot.nSeq != nSeq) {
+        return;
+    }
+
+    m_vecLatency.push_back((AX_U32)std::chrono::duration_cast<std::chrono::microseconds>(tpEnd - tSlot.tpSubmit).count());
+    m_vecHandler.push_back((AX_U32)std::chrono::duration_cast<std::chrono::microseconds>(tpEnd - tpStart).count());
+
+    tSlot.bValid = AX_FALSE;
+    --m_nInflight;
+    m_cv.notify_all();
+}
+
+/* caller holds m_mutex */
+AX_VOID CDetectBench::EvictTimeout(const std::chrono::steady_clock::time_point &tpNow)
+{
+    for (AX_U32 i = 0; i < DETECT_BENCH_SLOT_NUM; i++) {
+        DETECT_BENCH_SLOT_T &tSlot = m_arrSlot[i];
+        if (tSlot.bValid
+            && std::chrono::duration_cast<std::chrono::milliseconds>(tpNow - tSlot.tpSubmit).count() > DETECTOR_INFLIGHT_TIMEOUT) {
+            tSlot.bValid = AX_FALSE;
+            --m_nInflight;
+            ++m_nLost;
+        }
+    }
+}
+
+AX_BOOL CDetectBench::WaitInflight(AX_U32 nMax)
+{
+    std::unique_lock<std::mutex> lck(m_mutex);
+    while (m_bRunning && m_nInflight > nMax) {
+        m_cv.wait_for(lck, std::chrono::milliseconds(100));
+        EvictTimeout(std::chrono::steady_clock::now());
+    }
+
+    return m_bRunning ? AX_TRUE : AX_FALSE;
+}
+
+AX_VOID CDetectBench::BenchThreadFunc(AX_VOID)
+{
+    prctl(PR_SET_NAME, "IPC_AI_BENCH");
+
+    auto tpBegin = std::chrono::steady_clock::now();
+
+    for (AX_U32 nSeq = 1; nSeq <= m_tConfig.nFrames; nSeq++) {
+        if (!WaitInflight(m_tConfig.nInflight - 1)) {
+            break;
+        }
+
+        if (m_tConfig.nFps > 0) {
+            std::this_thread::sleep_until(tpBegin + std::chrono::microseconds((AX_U64)(nSeq - 1) * 1000000 / m_tConfig.nFps));
+        }
+
+        const DETECT_BENCH_FRAME_T &tData = m_vecFrame[(nSeq - 1) % m_vecFrame.size()];
+
+        CMediaFrame tFrame;
+        tFrame.bIvpsFrame = AX_TRUE;
+        tFrame.nFrameID = nSeq;
+        tFrame.tVideoFrame.u32Width = m_nWidth;
+        tFrame.tVideoFrame.u32Height = m_nHeight;
+        tFrame.tVideoFrame.enImgFormat = AX_YUV420_SEMIPLANAR;
+        tFrame.tVideoFrame.u32FrameSize = m_nFrameSize;
+        tFrame.tVideoFrame.u32PicStride[0] = m_nWidth;
+        tFrame.tVideoFrame.u32PicStride[1] = m_nWidth;
+        tFrame.tVideoFrame.u64PhyAddr[0] = tData.nPhyAddr;
+        tFrame.tVideoFrame.u64PhyAddr[1] = tData.nPhyAddr + m_nWidth * m_nHeight;
+        tFrame.tVideoFrame.u64VirAddr[0] = (AX_U64)(uintptr_t)tData.pVirAddr;
+        tFrame.tVideoFrame.u64VirAddr[1] = tFrame.tVideoFrame.u64VirAddr[0] + m_nWidth * m_nHeight;
+        tFrame.tVideoFrame.u64SeqNum = nSeq;
+
+        auto tpSubmit = std::chrono::steady_clock::now();
+        tFrame.tVideoFrame.u64PTS = (AX_U64)std::chrono::duration_cast<std::chrono::microseconds>(tpSubmit.time_since_epoch()).count();
+
+        {
+            std::lock_guard<std::mutex> lck(m_mutex);
+            DETECT_BENCH_SLOT_T &tSlot = m_arrSlot[nSeq % DETECT_BENCH_SLOT_NUM];
+            tSlot.bValid = AX_TRUE;
+            tSlot.nSeq = nSeq;
+            tSlot.tpSubmit = tpSubmit;
+            ++m_nInflight;
+            ++m_nSubmitted;
+        }
+
+        if (!CDetector::GetInstance()->ProcessFrame(&tFrame)) {
+            std::lock_guard<std::mutex> lck(m_mutex);
+            DETECT_BENCH_SLOT_T &tSlot = m_arrSlot[nSeq % DETECT_BENCH_SLOT_NUM];
+            if (tSlot.bValid && tSlot.nSeq == nSeq) {
+                tSlot.bValid = AX_FALSE;
+                --m_nInflight;
+                ++m_nDropped;
+            }
+        }
+    }
+
+    // drain, undelivered results are counted as lost
+    WaitInflight(0);
+
+    AX_U32 nElapsed = (AX_U32)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - tpBegin).count();
+
+    {
+        std::lock_guard<std::mutex> lck(m_mutex);
+        Report(nElapsed);
+    }
+
+    // frames of lost results may still be in NPU, they are freed by CDetector::Cleanup
+    m_bRunning = AX_FALSE;
+}
+
+/* caller holds m_mutex */
+AX_VOID CDetectBench::Report(AX_U32 nElapsed)
+{
+    AX_U32 nCompleted = (AX_U32)m_vecLatency.size();
+    AX_F32 fThroughput = nElapsed ? nCompleted * 1000.0 / nElapsed : 0;
+
+    LOG_M(DETECT_BENCH, "done: submitted %d, completed %d, dropped %d, lost %d, elapsed %d(ms), throughput %.2f fps",
+          m_nSubmitted, nCompleted, m_nDropped, m_nLost, nElapsed, fThroughput);
+
+    FILE *fp = fopen(m_tConfig.strReport.c_str(), "w");
+    if (!fp) {
+        LOG_M_E(DETECT_BENCH, "open report(%s) fail", m_tConfig.strReport.c_str());
+        return;
+    }
+
+    fprintf(fp, "{\n");
+    fprintf(fp, "  \"input\": %s,\n", picojson::value(m_tConfig.strInput).serialize().c_str());
+    fprintf(fp, "  \"width\": %d,\n  \"height\": %d,\n", m_nWidth, m_nHeight);
+    fprintf(fp, "  \"target_fps\": %d,\n  \"inflight\": %d,\n", m_tConfig.nFps, m_tConfig.nInflight);
+    fprintf(fp, "  \"submitted\": %d,\n  \"completed\": %d,\n  \"dropped\": %d,\n  \"lost\": %d,\n",
+            m_nSubmitted, nCompleted, m_nDropped, m_nLost);
+    fprintf(fp, "  \"elapsed_ms\": %d,\n  \"throughput_fps\": %.2f,\n", nElapsed, fThroughput);
+    WriteStat(fp, "latency_ms", m_vecLatency, AX_FALSE);
+    WriteStat(fp, "handler_ms", m_vecHandler, AX_TRUE);
+    fprintf(fp, "}\n");
+    fclose(fp);
+
+    LOG_M(DETECT_BENCH, "report saved to %s", m_tConfig.strReport.c_str());
+}
@@ -0,0 +1,112 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "global.h"
+#include "Singleton.h"
+
+/**
+ * Offline detector benchmark
+ * Replaces live frames with a directory of YUV files or one YUV sequence file and drives
+ * CDetector::ProcessFrame at a fixed or unthrottled rate, keeping up to N frames in flight.
+ * End-to-end latency is measured from submit to the end of the result handler.
+ * Frames are kept until the detector is destroyed, a lost result may still be read by NPU.
+ *
+ * Environment:
+ *   AI_BENCH_ENABLE=1
+ *   AI_BENCH_INPUT=<dir or .yuv>     NV12 frames of the AI resolution
+ *   AI_BENCH_FRAMES=<n>              frames to submit, input is looped (default 1000)
+ *   AI_BENCH_FPS=<n>                 submit rate, 0 is unthrottled (default 0)
+ *   AI_BENCH_INFLIGHT=<n>            frames in flight (default 4)
+ *   AI_BENCH_REPORT=<path>           json report (default ./ai_bench.json)
+ */
+#define DETECT_BENCH_MAX_LOAD_FRAMES (16)
+#define DETECT_BENCH_SLOT_NUM (32)
+
+typedef struct _DETECT_BENCH_CONFIG_T {
+    std::string strInput;
+    std::string strReport;
+    AX_U32 nFrames;
+    AX_U32 nFps;
+    AX_U32 nInflight;
+} DETECT_BENCH_CONFIG_T;
+
+typedef struct _DETECT_BENCH_FRAME_T {
+    AX_U64 nPhyAddr;
+    AX_VOID *pVirAddr;
+} DETECT_BENCH_FRAME_T;
+
+typedef struct _DETECT_BENCH_SLOT_T {
+    AX_BOOL bValid;
+    AX_U64 nSeq;
+    std::chrono::steady_clock::time_point tpSubmit;
+} DETECT_BENCH_SLOT_T;
+
+class CDetectBench : public CSingleton<CDetectBench> {
+    friend class CSingleton<CDetectBench>;
+
+public:
+    /* starts only if AI_BENCH_ENABLE is set, frames must be nWidth x nHeight NV12 */
+    AX_BOOL Start(AX_U32 nWidth, AX_U32 nHeight);
+    AX_VOID Stop(AX_VOID);
+    /* after the detector handle is destroyed */
+    AX_VOID FreeFrames(AX_VOID);
+
+    /* called by the result handler, tpStart is the time the result was received */
+    AX_VOID OnResult(AX_U64 nSeq, const std::chrono::steady_clock::time_point &tpStart,
+                     const std::chrono::steady_clock::time_point &tpEnd);
+
+    AX_BOOL IsRunning(AX_VOID) const {
+        return m_bRunning ? AX_TRUE : AX_FALSE;
+    }
+
+private:
+    CDetectBench(AX_VOID) noexcept = default;
+    virtual ~CDetectBench(AX_VOID) = default;
+
+    /* virtual function of CSingleton */
+    AX_BOOL Init(AX_VOID) override {
+        return AX_TRUE;
+    };
+
+    AX_BOOL LoadConfig(AX_VOID);
+    AX_BOOL LoadFrames(AX_VOID);
+    AX_BOOL LoadFrame(FILE *fp);
+    AX_VOID BenchThreadFunc(AX_VOID);
+    AX_BOOL WaitInflight(AX_U32 nMax);
+    AX_VOID EvictTimeout(const std::chrono::steady_clock::time_point &tpNow);
+    AX_VOID Report(AX_U32 nElapsed);
+
+private:
+    DETECT_BENCH_CONFIG_T m_tConfig;
+    AX_U32 m_nWidth{0};
+    AX_U32 m_nHeight{0};
+    AX_U32 m_nFrameSize{0};
+    std::vector<DETECT_BENCH_FRAME_T> m_vecFrame;
+
+    std::thread *m_pThread{nullptr};
+    std::atomic<AX_BOOL> m_bRunning{AX_FALSE};
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    DETECT_BENCH_SLOT_T m_arrSlot[DETECT_BENCH_SLOT_NUM];
+    AX_U32 m_nInflight{0};
+    AX_U32 m_nSubmitted{0};
+    AX_U32 m_nDropped{0};
+    AX_U32 m_nLost{0};
+    std::vector<AX_U32> m_vecLatency; // us
+    std::vector<AX_U32> m_vecHandler; // us
+};
@@ -17,7 +17,10 @@
 #include "PrintHelper.h"
 #include "WebServer.h"
 #include "picojson.h"
+#include "SkelMetaParser.h"
+#include "BoxPredictor.h"
 #include "ConfigParser.h"
+#include "DetectBench.h"
 
 #define DETECTION           "DETECTION"
 
@@ -52,6 +55,13 @@
 #define DETECTOR_API_RUN_START(_API_NAME_) m_apiElapsed.reset()
 #define DETECTOR_API_RUN_END(_API_NAME_) LOG_M_I(DETECTION, "Run API(%s) elapsed: %d(ms)", #_API_NAME_, m_apiElapsed.ms());
 
+// Attribute string copy, always terminated
+#define ATTR_STRING_SET(_dst_, _src_) \
+    do { \
+        strncpy(_dst_, _src_, sizeof(_dst_) - 1); \
+        _dst_[sizeof(_dst_) - 1] = '\0'; \
+    } while(0)
+
 // Object Define
 #define ObjectDefinition(Obj) \
     int Obj##_size = 0; \
@@ -80,24 +90,11 @@
 #define ObjectCreate(Obj) \
     do { \
         if (Obj##_size > 0) { \
-            pDetectionResult->n##Obj##Size = Obj##_size; \
-            pDetectionResult->p##Obj##s = new AI_Detection_##Obj##Result_t[Obj##_size]; \
+            pDetectionResult->p##Obj##s = m_tResultArena.NewArray<AI_Detection_##Obj##Result_t>(Obj##_size); \
+            pDetectionResult->n##Obj##Size = pDetectionResult->p##Obj##s ? Obj##_size : 0; \
             if (strcasecmp("body", #Obj) == 0) { \
-                pDetectionResult->nPoseSize = Obj##_size; \
-                pDetectionResult->pPoses = new AI_Detection_PoseResult_t[Obj##_size]; \
-            } \
-        } \
-    } while(0)
-
-// Object Destory
-#define ObjectDestroy(Obj) \
-    do { \
-        if (pDetectionResult->p##Obj##s != nullptr) { \
-            delete[] pDetectionResult->p##Obj##s; \
-            pDetectionResult->p##Obj##s = nullptr; \
-            if ((strcasecmp("body", #Obj) == 0) && (pDetectionResult->pPoses != nullptr)) { \
-                delete[] pDetectionResult->pPoses; \
-                pDetectionResult->pPoses = nullptr; \
+                pDetectionResult->pPoses = m_tResultArena.NewArray<AI_Detection_PoseResult_t>(Obj##_size); \
+                pDetectionResult->nPoseSize = pDetectionResult->pPoses ? Obj##_size : 0; \
             } \
         } \
     } while(0)
@@ -416,256 +413,201 @@ AX_BOOL get_detector_handle_param(DETECTOR_CONFIG_PARAM_T &stConfigParam) {
     return AX_TRUE;
 }
 
-void BodyAttrResult(const AX_SKEL_OBJECT_ITEM_S &stObjectItem, AI_Body_Attr_t &human_attr, JpegDataInfo &JpegInfo)
+void PlateAttrParse(const CSkelMetaParser &tParser, AI_Plat_Attr_t &plat_attr, JpegDataInfo &JpegInfo)
 {
-    picojson::value obj;
+    plat_attr.bExist = AX_TRUE;
+    // color
+    if (!tParser.GetString("color", "name", plat_attr.szPlateColor, sizeof(plat_attr.szPlateColor))) {
+        ATTR_STRING_SET(plat_attr.szPlateColor, "unknown");
+    }
+
+    // style
+    if (!tParser.GetString("style", "name", plat_attr.szPlateType, sizeof(plat_attr.szPlateType))) {
+        ATTR_STRING_SET(plat_attr.szPlateType, "unknown");
+    }
 
+    // code
+    tParser.GetString("code_result", plat_attr.szPlateCode, sizeof(plat_attr.szPlateCode));
+
+    /* picojson threw on a missing or non bool code_killed, such a plate is now taken as not recognized */
+    AX_BOOL bKilled = AX_TRUE;
+    tParser.GetBool("code_killed", bKilled);
+    plat_attr.bValid = bKilled ? AX_FALSE : AX_TRUE;
+
+    if (CDetector::GetInstance()->IsPlateIdentify()) {
+        strncpy(JpegInfo.tPlateInfo.szColor, plat_attr.szPlateColor, sizeof(JpegInfo.tPlateInfo.szColor) - 1);
+
+        JpegInfo.tPlateInfo.bExist = AX_TRUE;
+        JpegInfo.tPlateInfo.bValid = plat_attr.bValid;
+        strncpy(JpegInfo.tPlateInfo.szNumVal, plat_attr.szPlateCode, sizeof(JpegInfo.tPlateInfo.szNumVal) - 1);
+
+        if (plat_attr.bValid) {
+            strncpy(JpegInfo.tPlateInfo.szNum, plat_attr.szPlateCode, sizeof(JpegInfo.tPlateInfo.szNum) - 1);
+        }
+        else {
+            strncpy(JpegInfo.tPlateInfo.szNum, "unknown", sizeof(JpegInfo.tPlateInfo.szNum) - 1);
+        }
+    }
+}
+
+void BodyAttrResult(const AX_SKEL_OBJECT_ITEM_S &stObjectItem, AI_Body_Attr_t &human_attr, JpegDataInfo &JpegInfo)
+{
     JpegInfo.eType = JPEG_TYPE_BODY;
 
     human_attr.bExist = AX_FALSE;
-    human_attr.strSafetyCap = "";
-    human_attr.strHairLength = "";
+    human_attr.szSafetyCap[0] = '\0';
+    human_attr.szHairLength[0] = '\0';
 
     for (size_t i = 0; i < stObjectItem.nMetaInfoSize; i++) {
         if (!strcmp(stObjectItem.pstMetaInfo[i].pstrType, "human_safety_cap")) {
-            std::string value = stObjectItem.pstMetaInfo[i].pstrValue;
-            std::string strParseRet = picojson::parse(obj, value);
-            if (!strParseRet.empty() || !obj.is<picojson::object>()) {
+            CSkelMetaParser tParser(stObjectItem.pstMetaInfo[i].pstrValue);
+            if (!tParser.IsValid()) {
                 break;
             }
 
             human_attr.bExist = AX_TRUE;
-            human_attr.strSafetyCap = PICO_ROOT["safety_cap"].PICO_OBJECT["name"].PICO_STRING;
+            tParser.GetString("safety_cap", "name", human_attr.szSafetyCap, sizeof(human_attr.szSafetyCap));
         } else if (!strcmp(stObjectItem.pstMetaInfo[i].pstrType, "human_attr")) {
-            std::string value = stObjectItem.pstMetaInfo[i].pstrValue;
-            std::string strParseRet = picojson::parse(obj, value);
-            if (!strParseRet.empty() || !obj.is<picojson::object>()) {
+            CSkelMetaParser tParser(stObjectItem.pstMetaInfo[i].pstrValue);
+            if (!tParser.IsValid()) {
                 break;
             }
 
             human_attr.bExist = AX_TRUE;
-            human_attr.strHairLength = PICO_ROOT["hair_length"].PICO_OBJECT["name"].PICO_STRING;
+            tParser.GetString("hair_length", "name", human_attr.szHairLength, sizeof(human_attr.szHairLength));
         }
     }
 }
 
 void VehicleAttrResult(const AX_SKEL_OBJECT_ITEM_S &stObjectItem, AI_Vehicle_Attr_t &vehicle_attr, JpegDataInfo &JpegInfo) {
-    DETECTOR_CONFIG_PARAM_T tConf = CDetector::GetInstance()->GetConfig();
-
-    picojson::value obj;
-
     JpegInfo.eType = JPEG_TYPE_VEHICLE;
 
     vehicle_attr.bExist = AX_FALSE;
-    vehicle_attr.strVehicleColor = "";
-    vehicle_attr.strVehicleSubclass = "";
+    vehicle_attr.szVehicleColor[0] = '\0';
+    vehicle_attr.szVehicleSubclass[0] = '\0';
     vehicle_attr.plate_attr.bExist = AX_FALSE;
     vehicle_attr.plate_attr.bValid = AX_FALSE;
-    vehicle_attr.plate_attr.strPlateColor = "";
-    vehicle_attr.plate_attr.strPlateType = "";
-    vehicle_attr.plate_attr.strPlateCode = "";
+    vehicle_attr.plate_attr.szPlateColor[0] = '\0';
+    vehicle_attr.plate_attr.szPlateType[0] = '\0';
+    vehicle_attr.plate_attr.szPlateCode[0] = '\0';
 
     for (size_t i = 0; i < stObjectItem.nMetaInfoSize; i++) {
         if (!strcmp(stObjectItem.pstMetaInfo[i].pstrType, "vehicle_cls")) {
-            std::string value = stObjectItem.pstMetaInfo[i].pstrValue;
-            std::string strParseRet = picojson::parse(obj, value);
-            if (!strParseRet.empty() || !obj.is<picojson::object>()) {
+            CSkelMetaParser tParser(stObjectItem.pstMetaInfo[i].pstrValue);
+            if (!tParser.IsValid()) {
                 break;
             }
 
             vehicle_attr.bExist = AX_TRUE;
-            vehicle_attr.strVehicleSubclass = PICO_ROOT["classifications"].PICO_OBJECT["name"].PICO_STRING;
+            tParser.GetString("classifications", "name", vehicle_attr.szVehicleSubclass, sizeof(vehicle_attr.szVehicleSubclass));
         } else if (!strcmp(stObjectItem.pstMetaInfo[i].pstrType, "vehicle_attr")) {
-            std::string value = stObjectItem.pstMetaInfo[i].pstrValue;
-            std::string strParseRet = picojson::parse(obj, value);
-            if (!strParseRet.empty() || !obj.is<picojson::object>()) {
+            CSkelMetaParser tParser(stObjectItem.pstMetaInfo[i].pstrValue);
+            if (!tParser.IsValid()) {
                 break;
             }
 
             vehicle_attr.bExist = AX_TRUE;
-            vehicle_attr.strVehicleColor = PICO_ROOT["color"].PICO_OBJECT["name"].PICO_STRING;
+            tParser.GetString("color", "name", vehicle_attr.szVehicleColor, sizeof(vehicle_attr.szVehicleColor));
         } else if (!strcmp(stObjectItem.pstMetaInfo[i].pstrType, "plate_attr")) {
-            std::string value = stObjectItem.pstMetaInfo[i].pstrValue;
-            std::string strParseRet = picojson::parse(obj, value);
-            if (!strParseRet.empty() || !obj.is<picojson::object>()) {
+            CSkelMetaParser tParser(stObjectItem.pstMetaInfo[i].pstrValue);
+            if (!tParser.IsValid()) {
                 break;
             }
 
-            vehicle_attr.plate_attr.bExist = AX_TRUE;
-            // color
-            vehicle_attr.plate_attr.strPlateColor = "unknown";
-            if (PICO_ROOT.end() != PICO_ROOT.find("color")) {
-                vehicle_attr.plate_attr.strPlateColor = PICO_ROOT["color"].PICO_OBJECT["name"].PICO_STRING;
-            }
-
-            // style
-            vehicle_attr.plate_attr.strPlateType = "unknown";
-            if (PICO_ROOT.end() != PICO_ROOT.find("style")) {
-                vehicle_attr.plate_attr.strPlateType = PICO_ROOT["style"].PICO_OBJECT["name"].PICO_STRING;
-            }
-
-            // code
-            vehicle_attr.plate_attr.strPlateCode = PICO_ROOT["code_result"].PICO_STRING;
-
-            if (PICO_ROOT["code_killed"].PICO_BOOL) {
-                vehicle_attr.plate_attr.bValid = AX_FALSE;
-            } else {
-                vehicle_attr.plate_attr.bValid = AX_TRUE;
-            }
-
-            if (tConf.bPlateIdentify) {
-                strncpy(JpegInfo.tPlateInfo.szColor, (const AX_CHAR *)vehicle_attr.plate_attr.strPlateColor.c_str(), sizeof(JpegInfo.tPlateInfo.szColor) - 1);
-
-                JpegInfo.tPlateInfo.bExist = AX_TRUE;
-                JpegInfo.tPlateInfo.bValid = vehicle_attr.plate_attr.bValid;
-                strncpy(JpegInfo.tPlateInfo.szNumVal, (const AX_CHAR *)vehicle_attr.plate_attr.strPlateCode.c_str(), sizeof(JpegInfo.tPlateInfo.szNum) - 1);
-
-                if (vehicle_attr.plate_attr.bValid) {
-                    strncpy(JpegInfo.tPlateInfo.szNum, (const AX_CHAR *)vehicle_attr.plate_attr.strPlateCode.c_str(), sizeof(JpegInfo.tPlateInfo.szNum) - 1);
-                }
-                else {
-                    strncpy(JpegInfo.tPlateInfo.szNum, "unknown", sizeof(JpegInfo.tPlateInfo.szNum) - 1);
-                }
-            }
+            PlateAttrParse(tParser, vehicle_attr.plate_attr, JpegInfo);
 
             LOG_M(DETECTION, "Vehicle: [Plate] color:%s, style:%s, code:%s, valid:%d",
-                    vehicle_attr.plate_attr.strPlateColor.c_str(), vehicle_attr.plate_attr.strPlateType.c_str(),
-                    vehicle_attr.plate_attr.strPlateCode.c_str(), vehicle_attr.plate_attr.bValid);
+                    vehicle_attr.plate_attr.szPlateColor, vehicle_attr.plate_attr.szPlateType,
+                    vehicle_attr.plate_attr.szPlateCode, vehicle_attr.plate_attr.bValid);
         }
     }
 }
 
 void CycleAttrResult(const AX_SKEL_OBJECT_ITEM_S &stObjectItem, AI_Cycle_Attr_t &cycle_attr, JpegDataInfo &JpegInfo) {
-    picojson::value obj;
-
     JpegInfo.eType = JPEG_TYPE_CYCLE;
 
     cycle_attr.bExist = AX_FALSE;
-    cycle_attr.strCycleSubclass = "";
+    cycle_attr.szCycleSubclass[0] = '\0';
 
     for (size_t i = 0; i < stObjectItem.nMetaInfoSize; i++) {
         if (!strcmp(stObjectItem.pstMetaInfo[i].pstrType, "cycle_attr")) {
-            std::string value = stObjectItem.pstMetaInfo[i].pstrValue;
-            std::string strParseRet = picojson::parse(obj, value);
-            if (!strParseRet.empty() || !obj.is<picojson::object>()) {
+            CSkelMetaParser tParser(stObjectItem.pstMetaInfo[i].pstrValue);
+            if (!tParser.IsValid()) {
                 break;
             }
 
             cycle_attr.bExist = AX_TRUE;
-            cycle_attr.strCycleSubclass = PICO_ROOT["classifications"].PICO_OBJECT["name"].PICO_STRING;
+            tParser.GetString("classifications", "name", cycle_attr.szCycleSubclass, sizeof(cycle_attr.szCycleSubclass));
         }
     }
 }
 
 void FaceAttrResult(const AX_SKEL_OBJECT_ITEM_S &stObjectItem, AI_Face_Attr_t &face_attr, JpegDataInfo &JpegInfo)
 {
-    picojson::value obj;
-
     JpegInfo.eType = JPEG_TYPE_FACE;
     JpegInfo.tFaceInfo.bExist = AX_FALSE;
 
     face_attr.bExist = AX_FALSE;
     face_attr.nAge = 0;
     face_attr.nGender = 0;
-    face_attr.strRespirator = "";
+    face_attr.szRespirator[0] = '\0';
 
     for (size_t i = 0; i < stObjectItem.nMetaInfoSize; i++) {
         if (!strcmp(stObjectItem.pstMetaInfo[i].pstrType, "face_attr")) {
-            std::string value = stObjectItem.pstMetaInfo[i].pstrValue;
-            std::string strParseRet = picojson::parse(obj, value);
-            if (!strParseRet.empty() || !obj.is<picojson::object>()) {
+            CSkelMetaParser tParser(stObjectItem.pstMetaInfo[i].pstrValue);
+            if (!tParser.IsValid()) {
                 break;
             }
 
             face_attr.bExist = AX_TRUE;
             // age
-            face_attr.nAge = PICO_ROOT["age"].PICO_VALUE;
+            AX_F64 fAge = 0;
+            if (tParser.GetNumber("age", fAge)) {
+                face_attr.nAge = (AX_U8)fAge;
+            }
 
             // gender
-            if (PICO_ROOT["gender"].PICO_OBJECT["name"].PICO_STRING == "male") {
-                face_attr.nGender = 1;
-            }
-            else {
-                face_attr.nGender = 0;
-            }
+            AX_CHAR szGender[AI_ATTR_STRING_LEN] = {0};
+            tParser.GetString("gender", "name", szGender, sizeof(szGender));
+            face_attr.nGender = (0 == strcmp(szGender, "male")) ? 1 : 0;
 
             // respirator
-            face_attr.strRespirator = PICO_ROOT["respirator"].PICO_OBJECT["name"].PICO_STRING;
+            tParser.GetString("respirator", "name", face_attr.szRespirator, sizeof(face_attr.szRespirator));
 
             JpegInfo.tFaceInfo.bExist = AX_TRUE;
             JpegInfo.tFaceInfo.nAge = face_attr.nAge;
             JpegInfo.tFaceInfo.nGender = face_attr.nGender;
-            strncpy(JpegInfo.tFaceInfo.szMask, (const AX_CHAR *)face_attr.strRespirator.c_str(), sizeof(JpegInfo.tFaceInfo.szMask) - 1);
+            strncpy(JpegInfo.tFaceInfo.szMask, face_attr.szRespirator, sizeof(JpegInfo.tFaceInfo.szMask) - 1);
 
             LOG_M(DETECTION, "Face: age:%d, gender:%s, respirator:%s",
                     face_attr.nAge, face_attr.nGender ? "male":"female",
-                    face_attr.strRespirator.c_str());
+                    face_attr.szRespirator);
         }
     }
 }
 
 void PlateAttrResult(const AX_SKEL_OBJECT_ITEM_S &stObjectItem, AI_Plat_Attr_t &plat_attr, JpegDataInfo &JpegInfo) {
-    DETECTOR_CONFIG_PARAM_T tConf = CDetector::GetInstance()->GetConfig();
-
-    picojson::value obj;
-
     JpegInfo.eType = JPEG_TYPE_PLATE;
     JpegInfo.tPlateInfo.bExist = AX_FALSE;
 
     plat_attr.bExist = AX_FALSE;
     plat_attr.bValid = AX_FALSE;
-    plat_attr.strPlateColor = "";
-    plat_attr.strPlateType = "";
-    plat_attr.strPlateCode = "";
+    plat_attr.szPlateColor[0] = '\0';
+    plat_attr.szPlateType[0] = '\0';
+    plat_attr.szPlateCode[0] = '\0';
 
     for (size_t i = 0; i < stObjectItem.nMetaInfoSize; i++) {
         if (!strcmp(stObjectItem.pstMetaInfo[i].pstrType, "plate_attr")) {
-            std::string value = stObjectItem.pstMetaInfo[i].pstrValue;
-            std::string strParseRet = picojson::parse(obj, value);
-            if (!strParseRet.empty() || !obj.is<picojson::object>()) {
+            CSkelMetaParser tParser(stObjectItem.pstMetaInfo[i].pstrValue);
+            if (!tParser.IsValid()) {
                 break;
             }
 
-            plat_attr.bExist = AX_TRUE;
-            // color
-            plat_attr.strPlateColor = "unknown";
-            if (PICO_ROOT.end() != PICO_ROOT.find("color")) {
-                plat_attr.strPlateColor = PICO_ROOT["color"].PICO_OBJECT["name"].PICO_STRING;
-            }
-
-            // style
-            plat_attr.strPlateType = "unknown";
-            if (PICO_ROOT.end() != PICO_ROOT.find("style")) {
-                plat_attr.strPlateType = PICO_ROOT["style"].PICO_OBJECT["name"].PICO_STRING;
-            }
-
-            // code
-            plat_attr.strPlateCode = PICO_ROOT["code_result"].PICO_STRING;
-
-            if (PICO_ROOT["code_killed"].PICO_BOOL) {
-                plat_attr.bValid = AX_FALSE;
-            } else {
-                plat_attr.bValid = AX_TRUE;
-            }
-
-            if (tConf.bPlateIdentify) {
-                strncpy(JpegInfo.tPlateInfo.szColor, (const AX_CHAR *)plat_attr.strPlateColor.c_str(), sizeof(JpegInfo.tPlateInfo.szColor) - 1);
-
-                JpegInfo.tPlateInfo.bExist = AX_TRUE;
-                JpegInfo.tPlateInfo.bValid = plat_attr.bValid;
-                strncpy(JpegInfo.tPlateInfo.szNumVal, (const AX_CHAR *)plat_attr.strPlateCode.c_str(), sizeof(JpegInfo.tPlateInfo.szNum) - 1);
-
-                if (plat_attr.bValid) {
-                    strncpy(JpegInfo.tPlateInfo.szNum, (const AX_CHAR *)plat_attr.strPlateCode.c_str(), sizeof(JpegInfo.tPlateInfo.szNum) - 1);
-                }
-                else {
-                    strncpy(JpegInfo.tPlateInfo.szNum, "unknown", sizeof(JpegInfo.tPlateInfo.szNum) - 1);
-                }
-            }
+            PlateAttrParse(tParser, plat_attr, JpegInfo);
 
             LOG_M(DETECTION, "Plate: color:%s, style:%s, code:%s, valid:%d",
-                    plat_attr.strPlateColor.c_str(), plat_attr.strPlateType.c_str(),
-                    plat_attr.strPlateCode.c_str(), plat_attr.bValid);
+                    plat_attr.szPlateColor, plat_attr.szPlateType,
+                    plat_attr.szPlateCode, plat_attr.bValid);
         }
     }
 }
@@ -684,8 +626,214 @@ AX_VOID AsyncRecvAlgorithmResultThread(AX_VOID *__this)
 }
 } //namespace
 
+//////////////////////////////////////////////////////////////////
+CFrameInflightTable::CFrameInflightTable(AX_VOID)
+{
+    static_assert((DETECTOR_INFLIGHT_SLOT_NUM & (DETECTOR_INFLIGHT_SLOT_NUM - 1)) == 0,
+                  "DETECTOR_INFLIGHT_SLOT_NUM must be power of 2");
+
+    Clear();
+    memset(&m_tStat, 0x00, sizeof(m_tStat));
+}
+
+AX_VOID CFrameInflightTable::Insert(AX_U64 nFrameId, const FRAME_ALGORITHM_RESULT_ST &tResult)
+{
+    FRAME_INFLIGHT_SLOT_T &tSlot = m_arrSlot[nFrameId & (DETECTOR_INFLIGHT_SLOT_NUM - 1)];
+
+    if (tSlot.bValid) {
+        // older generation still occupies this slot, drop it
+        Release(tSlot);
+        m_tStat.nCollisions ++;
+    }
+
+    tSlot.bValid = AX_TRUE;
+    tSlot.nFrameId = nFrameId;
+    tSlot.tResult = tResult;
+
+    m_tStat.nDepth ++;
+    m_tStat.nMaxDepth = AX_MAX(m_tStat.nMaxDepth, m_tStat.nDepth);
+}
+
+FRAME_ALGORITHM_RESULT_ST *CFrameInflightTable::Find(AX_U64 nFrameId)
+{
+    FRAME_INFLIGHT_SLOT_T &tSlot = m_arrSlot[nFrameId & (DETECTOR_INFLIGHT_SLOT_NUM - 1)];
+
+    if (tSlot.bValid && tSlot.nFrameId == nFrameId) {
+        return &tSlot.tResult;
+    }
+
+    return nullptr;
+}
+
+AX_VOID CFrameInflightTable::Remove(AX_U64 nFrameId)
+{
+    FRAME_INFLIGHT_SLOT_T &tSlot = m_arrSlot[nFrameId & (DETECTOR_INFLIGHT_SLOT_NUM - 1)];
+
+    if (tSlot.bValid && tSlot.nFrameId == nFrameId) {
+        Release(tSlot);
+    }
+}
+
+AX_VOID CFrameInflightTable::Retire(const AX_SKEL_RESULT_S *pResult)
+{
+    for (AX_U32 i = 0; i < DETECTOR_INFLIGHT_SLOT_NUM; i++) {
+        FRAME_INFLIGHT_SLOT_T &tSlot = m_arrSlot[i];
+
+        if (!tSlot.bValid || tSlot.nFrameId > pResult->nFrameId) {
+            continue;
+        }
+
+        AX_BOOL bCached = AX_FALSE;
+        for (AX_U32 j = 0; j < pResult->nCacheListSize; j++) {
+            if (tSlot.nFrameId == (AX_U32)pResult->pstCacheList[j].nFrameId) {
+                bCached = AX_TRUE;
+                break;
+            }
+        }
+
+        if (!bCached) {
+            Release(tSlot);
+        }
+    }
+}
+
+AX_VOID CFrameInflightTable::Evict(const std::chrono::steady_clock::time_point &tpNow, AX_U32 nTimeout)
+{
+    for (AX_U32 i = 0; i < DETECTOR_INFLIGHT_SLOT_NUM; i++) {
+        FRAME_INFLIGHT_SLOT_T &tSlot = m_arrSlot[i];
+
+        if (tSlot.bValid
+            && std::chrono::duration_cast<std::chrono::milliseconds>(tpNow - tSlot.tResult.m_tpStart).count() > nTimeout) {
+            Release(tSlot);
+            m_tStat.nTimeouts ++;
+        }
+    }
+}
+
+AX_VOID CFrameInflightTable::Clear(AX_VOID)
+{
+    for (AX_U32 i = 0; i < DETECTOR_INFLIGHT_SLOT_NUM; i++) {
+        m_arrSlot[i].bValid = AX_FALSE;
+        m_arrSlot[i].nFrameId = 0;
+    }
+
+    m_tStat.nDepth = 0;
+}
+
+FRAME_INFLIGHT_STAT_T CFrameInflightTable::PopStat(AX_VOID)
+{
+    FRAME_INFLIGHT_STAT_T tStat = m_tStat;
+
+    m_tStat.nMaxDepth = m_tStat.nDepth;
+    m_tStat.nCollisions = 0;
+    m_tStat.nTimeouts = 0;
+
+    return tStat;
+}
+
+AX_VOID CFrameInflightTable::Release(FRAME_INFLIGHT_SLOT_T &tSlot)
+{
+    tSlot.bValid = AX_FALSE;
+
+    if (m_tStat.nDepth > 0) {
+        m_tStat.nDepth --;
+    }
+}
+
+//////////////////////////////////////////////////////////////////
+CResultArena::CResultArena(AX_U32 nSize)
+{
+    m_nCapacity = nSize;
+    m_nOffset = 0;
+    m_nRequired = 0;
+    m_pBlock = (AX_U8 *)malloc(m_nCapacity);
+    if (!m_pBlock) {
+        m_nCapacity = 0;
+    }
+
+    m_vecSpill.reserve(8);
+
+    memset(&m_tStat, 0x00, sizeof(m_tStat));
+    m_tStat.nCapacity = m_nCapacity;
+}
+
+CResultArena::~CResultArena(AX_VOID)
+{
+    Reset();
+
+    if (m_pBlock) {
+        free(m_pBlock);
+        m_pBlock = nullptr;
+    }
+}
+
+AX_VOID *CResultArena::Alloc(AX_U32 nSize)
+{
+    nSize = ALIGN_UP(nSize, DETECTOR_RESULT_ARENA_ALIGN);
+    if (0 == nSize) {
+        return nullptr;
+    }
+
+    m_nRequired += nSize;
+
+    if (m_pBlock && m_nOffset + nSize <= m_nCapacity) {
+        AX_VOID *p = m_pBlock + m_nOffset;
+        m_nOffset += nSize;
+        return p;
+    }
+
+    // block exhausted, spill to heap until next reset grows the block
+    AX_U8 *pSpill = (AX_U8 *)malloc(nSize);
+    if (pSpill) {
+        m_vecSpill.push_back(pSpill);
+        m_tStat.nHeapAllocs ++;
+    }
+
+    return pSpill;
+}
+
+AX_VOID CResultArena::Reset(AX_VOID)
+{
+    for (auto pSpill : m_vecSpill) {
+        free(pSpill);
+    }
+    m_vecSpill.clear();
+
+    m_tStat.nUsed = m_nRequired;
+    m_tStat.nMaxUsed = AX_MAX(m_tStat.nMaxUsed, m_nRequired);
+
+    if (m_nRequired > m_nCapacity) {
+        AX_U32 nCapacity = ALIGN_UP(m_nRequired, 4096);
+        AX_U8 *pBlock = (AX_U8 *)malloc(nCapacity);
+        if (pBlock) {
+            if (m_pBlock) {
+                free(m_pBlock);
+            }
+
+            m_pBlock = pBlock;
+            m_nCapacity = nCapacity;
+            m_tStat.nCapacity = nCapacity;
+            m_tStat.nHeapAllocs ++;
+        }
+    }
+
+    m_nOffset = 0;
+    m_nRequired = 0;
+}
+
+RESULT_ARENA_STAT_T CResultArena::PopStat(AX_VOID)
+{
+    RESULT_ARENA_STAT_T tStat = m_tStat;
+
+    m_tStat.nMaxUsed = m_tStat.nUsed;
+    m_tStat.nHeapAllocs = 0;
+
+    return tStat;
+}
+
 //////////////////////////////////////////////////////////////////
 CDetector::CDetector(AX_VOID)
+    : m_tResultArena(DETECTOR_RESULT_ARENA_SIZE)
 {
     m_bFinished = AX_TRUE;
     m_bForcedExit = AX_FALSE;
@@ -718,6 +866,11 @@ AX_VOID CDetector::BindCropStage(CTrackCropStage* pStage)
     m_pTrackCropStage = pStage;
 }
 
+AX_VOID CDetector::SetRTSPServer(AXRtspServer* pRtspServer)
+{
+    m_pRtspServer = pRtspServer;
+}
+
 AX_BOOL CDetector::InitConfigParam(AX_VOID)
 {
     //Running config
@@ -868,6 +1021,9 @@ AX_BOOL CDetector::Startup(AX_VOID)
     //Load perf test info
     LoadPerfTestInfo();
 
+    //Offline benchmark, replaces live frames until done
+    CDetectBench::GetInstance()->Start(m_perfTestInfo.nWidth, m_perfTestInfo.nHeight);
+
     LOG_M(DETECTION, "---");
 
     return AX_TRUE;
@@ -877,6 +1033,8 @@ AX_VOID CDetector::Cleanup(AX_VOID)
 {
     LOG_M(DETECTION, "+++");
 
+    CDetectBench::GetInstance()->Stop();
+
     m_bForcedExit = AX_TRUE;
 
     WaitForFinish();
@@ -890,6 +1048,9 @@ AX_VOID CDetector::Cleanup(AX_VOID)
         m_stream_handle = nullptr;
     }
 
+    // NPU is done with the benchmark frames
+    CDetectBench::GetInstance()->FreeFrames();
+
     if (m_pObjectSearch) {
         m_pObjectSearch->Cleanup();
     }
@@ -993,11 +1154,9 @@ AX_BOOL CDetector::ProcessFrame(CMediaFrame* pFrame, AX_S32 nGaps /* = -1 */)
             return AX_FALSE;
         }
 
-        //Get feature info
+        //Pending enrollment takes a reference, detection goes on with the same frame
         if (gOptions.IsActivedSearch() && m_pObjectSearch) {
-            if (m_pObjectSearch->ProcessFeature(pFrame)) {
-                return AX_TRUE;
-            }
+            m_pObjectSearch->ProcessFeature(pFrame);
         }
 
         m_bFinished = AX_FALSE;
@@ -1026,11 +1185,11 @@ AX_BOOL CDetector::ProcessFrame(CMediaFrame* pFrame, AX_S32 nGaps /* = -1 */)
 
         {
             m_mutex.lock();
-            // here,save track result in m_mapDataResult
+            // here,save track result in in-flight table
             FRAME_ALGORITHM_RESULT_ST stAlgorithmResult;
             stAlgorithmResult.m_sVideoFrame = tFrame.stVFrame;
             stAlgorithmResult.m_tpStart = std::chrono::steady_clock::now();
-            m_mapDataResult[nFrame_id] = stAlgorithmResult;
+            m_tInflight.Insert(nFrame_id, stAlgorithmResult);
             m_mutex.unlock();
         }
 
@@ -1046,20 +1205,17 @@ AX_BOOL CDetector::ProcessFrame(CMediaFrame* pFrame, AX_S32 nGaps /* = -1 */)
             }
 
             m_mutex.lock();
-            auto iter = m_mapDataResult.find(nFrame_id);
-            if (iter != m_mapDataResult.end()) {
-                m_mapDataResult.erase(iter);
-            }
+            m_tInflight.Remove(nFrame_id);
             m_mutex.unlock();
 
             return AX_FALSE;
         }
         else {
             m_mutex.lock();
-            auto iter = m_mapDataResult.find(nFrame_id);
-            if (iter != m_mapDataResult.end()) {
+            FRAME_ALGORITHM_RESULT_ST *pAlgorithmResult = m_tInflight.Find(nFrame_id);
+            if (pAlgorithmResult) {
                 // update time point
-                iter->second.m_tpStart = std::chrono::steady_clock::now();
+                pAlgorithmResult->m_tpStart = std::chrono::steady_clock::now();
             }
             m_mutex.unlock();
         }
@@ -1137,6 +1293,11 @@ AX_BOOL CDetector::CreateHandle(AX_VOID) {
 
     LOG_M(DETECTION, "AI frame depth: %d, cache depth: %d", m_tConfigParam.nFrameDepth, m_tConfigParam.nCacheDepth);
 
+    if (m_tConfigParam.nFrameDepth + m_tConfigParam.nCacheDepth >= DETECTOR_INFLIGHT_SLOT_NUM) {
+        LOG_M_W(DETECTION, "AI frame depth + cache depth(%d) exceeds in-flight slots(%d)",
+                m_tConfigParam.nFrameDepth + m_tConfigParam.nCacheDepth, DETECTOR_INFLIGHT_SLOT_NUM);
+    }
+
     memset(&stHandleParam, 0x00, sizeof(AX_SKEL_HANDLE_PARAM_S));
     stHandleParam.ePPL = m_tConfigParam.ePPL;
     stHandleParam.nFrameDepth = m_tConfigParam.nFrameDepth;
@@ -1361,23 +1522,35 @@ AX_BOOL CDetector::DetectionResultHandler(AX_SKEL_RESULT_S *algorithm_result)
 
     m_mutex.lock();
     AX_U64 nActualFrameId = frame_id;
-    auto iter = m_mapDataResult.find(frame_id);
-    if (iter != m_mapDataResult.end()) {
-        AX_U32 nElapsed = (AX_U32)(std::chrono::duration_cast<std::chrono::milliseconds>(endTime - iter->second.m_tpStart).count());
+    AX_U64 u64FramePts = 0;
+    AX_BOOL bFramePts = AX_FALSE;
+    FRAME_ALGORITHM_RESULT_ST *pAlgorithmResult = m_tInflight.Find(frame_id);
+    if (pAlgorithmResult) {
+        AX_U32 nElapsed = (AX_U32)(std::chrono::duration_cast<std::chrono::milliseconds>(endTime - pAlgorithmResult->m_tpStart).count());
 
         bAddPerfInfo = AX_TRUE;
 
         tPerfInfo.nElapsed = nElapsed;
 
-        nActualFrameId = (AX_U32)iter->second.m_sVideoFrame.u64SeqNum;
+        nActualFrameId = (AX_U32)pAlgorithmResult->m_sVideoFrame.u64SeqNum;
+        u64FramePts = pAlgorithmResult->m_sVideoFrame.u64PTS;
+        bFramePts = AX_TRUE;
 
         LOG_M_I(DETECTION, "Frame_id(%lld) detect elapsed %d(ms)", frame_id, nElapsed);
     } else {
-        LOG_M_I(DETECTION, "m_mapDataResult frame_id(%lld) not found", frame_id);
+        LOG_M_I(DETECTION, "in-flight frame_id(%lld) not found", frame_id);
     }
 
     ClearAlgorithmData(algorithm_result);
 
+    m_tInflight.Evict(endTime, DETECTOR_INFLIGHT_TIMEOUT);
+
+    FRAME_INFLIGHT_STAT_T tInflightStat = m_tInflight.PopStat();
+    tPerfInfo.nInflightDepth = tInflightStat.nDepth;
+    tPerfInfo.nInflightMaxDepth = tInflightStat.nMaxDepth;
+    tPerfInfo.nInflightCollisions = tInflightStat.nCollisions;
+    tPerfInfo.nInflightTimeouts = tInflightStat.nTimeouts;
+
     m_mutex.unlock();
 
     do {
@@ -1416,6 +1589,13 @@ AX_BOOL CDetector::DetectionResultHandler(AX_SKEL_RESULT_S *algorithm_result)
             ObjectCreate(Plate);
             ObjectCreate(Cycle);
 
+            // search all objects of the frame at once
+            AX_BOOL bSearch = (gOptions.IsActivedSearchFromWeb() && m_pObjectSearch) ? AX_TRUE : AX_FALSE;
+            if (bSearch) {
+                m_vecSearchHit.resize(algorithm_result->nObjectSize);
+                m_pObjectSearch->SyncSearch(algorithm_result->pstObjectItems, algorithm_result->nObjectSize, m_vecSearchHit.data());
+            }
+
             for (size_t i = 0; i < algorithm_result->nObjectSize; i++) {
                 AX_SKEL_OBJECT_ITEM_S &stItem = algorithm_result->pstObjectItems[i];
                 const char *pstrObjectCategory = (const char *)stItem.pstrObjectCategory;
@@ -1442,8 +1622,8 @@ AX_BOOL CDetector::DetectionResultHandler(AX_SKEL_RESULT_S *algorithm_result)
                     //search
                     AX_BOOL isObjectTrack = AX_TRUE;
 
-                    if (gOptions.IsActivedSearchFromWeb() && m_pObjectSearch) {
-                        isObjectTrack = m_pObjectSearch->SyncSearch(&stItem);
+                    if (bSearch) {
+                        isObjectTrack = m_vecSearchHit[i];
 
                         if (isObjectTrack) {
                             strncpy(JpegInfo.tFaceInfo.szInfo, (const AX_CHAR *)"identified", sizeof(JpegInfo.tFaceInfo.szInfo) - 1);
@@ -1488,58 +1668,63 @@ AX_BOOL CDetector::DetectionResultHandler(AX_SKEL_RESULT_S *algorithm_result)
                 }
             }
 
-            gOptions.SetDetectResult(0, pDetectionResult);
+            gOptions.SetDetectResult(0, pDetectionResult, u64FramePts);
+            // without the frame PTS the velocities would be measured against 0
+            if (bFramePts) {
+                CBoxPredictor::GetInstance()->Update(pDetectionResult, u64FramePts);
+            }
+
+            if (m_pRtspServer && m_pRtspServer->IsMetaActive()) {
+                m_pRtspServer->SendDetectResult(gOptions.GetDetectResult(0), u64FramePts);
+            }
 
-            // Object Destroy
-            ObjectDestroy(Face);
-            ObjectDestroy(Body);
-            ObjectDestroy(Vehicle);
-            ObjectDestroy(Plate);
-            ObjectDestroy(Cycle);
+            // Objects are released as a unit
+            m_tResultArena.Reset();
         }
         else {
-            gOptions.SetDetectResult(0, NULL);
+            gOptions.SetDetectResult(0, NULL, u64FramePts);
+            if (bFramePts) {
+                CBoxPredictor::GetInstance()->Update(NULL, u64FramePts);
+            }
+
+            if (m_pRtspServer && m_pRtspServer->IsMetaActive()) {
+                m_pRtspServer->SendDetectResult(DETECT_RESULT_T(), u64FramePts);
+            }
         }
     }while(0);
 
+    m_nRecentTargets = tPerfInfo.tTargets.nBodys + tPerfInfo.tTargets.nVehicles
+                        + tPerfInfo.tTargets.nCycles + tPerfInfo.tTargets.nFaces
+                        + tPerfInfo.tTargets.nPlates;
+
     if (bAddPerfInfo) {
+        RESULT_ARENA_STAT_T tArenaStat = m_tResultArena.PopStat();
+        tPerfInfo.nArenaUsed = tArenaStat.nUsed;
+        tPerfInfo.nArenaMaxUsed = tArenaStat.nMaxUsed;
+        tPerfInfo.nArenaCapacity = tArenaStat.nCapacity;
+        tPerfInfo.nArenaHeapAllocs = tArenaStat.nHeapAllocs;
+
         gPrintHelper.Add(E_PH_MOD_DET_PERF, (AX_VOID *)&tPerfInfo);
     }
 
     AX_SKEL_Release(algorithm_result);
 
+    if (bAddPerfInfo && CDetectBench::GetInstance()->IsRunning()) {
+        CDetectBench::GetInstance()->OnResult(nActualFrameId, endTime, std::chrono::steady_clock::now());
+    }
+
     return AX_TRUE;
 }
 
 AX_BOOL CDetector::ClearAlgorithmData(AX_SKEL_RESULT_S *algorithm_result) {
-    for (auto iter = m_mapDataResult.begin(); iter != m_mapDataResult.end();) {
-        if (iter->first > algorithm_result->nFrameId) {//TODO
-            break;
-        }
-
-        AX_BOOL need_clear_algorithm_data = AX_TRUE;
-        for (AX_U32 i = 0; i < algorithm_result->nCacheListSize; i++) {
-            if (iter->first == (AX_U32)algorithm_result->pstCacheList[i].nFrameId) {
-                need_clear_algorithm_data = AX_FALSE;
-                break;
-            }
-        }
-
-        if (need_clear_algorithm_data) {
-            m_mapDataResult.erase(iter++);
-        } else {
-            ++iter;
-        }
-    }
+    m_tInflight.Retire(algorithm_result);
 
     return AX_TRUE;
 }
 
 AX_BOOL CDetector::ClearAlgorithmData(AX_VOID) {
     m_mutex.lock();
-    for (auto iter = m_mapDataResult.begin(); iter != m_mapDataResult.end();) {
-        m_mapDataResult.erase(iter++);
-    }
+    m_tInflight.Clear();
     m_mutex.unlock();
 
     return AX_TRUE;
@@ -1554,6 +1739,13 @@ AX_BOOL CDetector::WaitForFinish(AX_VOID) {
     return AX_TRUE;
 }
 
+AX_BOOL CDetector::IsPlateIdentify(AX_VOID)
+{
+    std::lock_guard<std::mutex> lck(m_stMutex);
+
+    return m_tConfigParam.bPlateIdentify;
+}
+
 DETECTOR_CONFIG_PARAM_T CDetector::GetConfig(AX_VOID)
 {
     std::lock_guard<std::mutex> lck(m_stMutex);
@@ -15,12 +15,15 @@
 #include <vector>
 #include <mutex>
 #include <thread>
+#include <new>
+#include <type_traits>
 #include <semaphore.h>
 #include "MediaFrame.h"
 #include "ax_skel_api.h"
 #include "TrackCropStage.h"
 #include "Search.h"
 #include "StageOptionHelper.h"
+#include "AXRtspServer.h"
 #include "Singleton.h"
 
 /**
@@ -31,6 +34,101 @@ struct FRAME_ALGORITHM_RESULT_ST {
     std::chrono::steady_clock::time_point m_tpStart;
 };
 
+/**
+ * In-flight NPU frames
+ * Slot index is frame id modulo slot num, the stored frame id is the generation tag.
+ * Slot num should cover (frame depth + cache depth), must be power of 2.
+ */
+#define DETECTOR_INFLIGHT_SLOT_NUM (16)
+#define DETECTOR_INFLIGHT_TIMEOUT (5000) // ms
+
+typedef struct _FRAME_INFLIGHT_SLOT_T {
+    AX_BOOL bValid;
+    AX_U64 nFrameId;
+    FRAME_ALGORITHM_RESULT_ST tResult;
+} FRAME_INFLIGHT_SLOT_T;
+
+typedef struct _FRAME_INFLIGHT_STAT_T {
+    AX_U32 nDepth;
+    AX_U32 nMaxDepth;
+    AX_U32 nCollisions;
+    AX_U32 nTimeouts;
+} FRAME_INFLIGHT_STAT_T;
+
+/* Not thread safe, protected by owner */
+class CFrameInflightTable
+{
+public:
+    CFrameInflightTable(AX_VOID);
+
+    AX_VOID Insert(AX_U64 nFrameId, const FRAME_ALGORITHM_RESULT_ST &tResult);
+    FRAME_ALGORITHM_RESULT_ST *Find(AX_U64 nFrameId);
+    AX_VOID Remove(AX_U64 nFrameId);
+    AX_VOID Retire(const AX_SKEL_RESULT_S *pResult);
+    AX_VOID Evict(const std::chrono::steady_clock::time_point &tpNow, AX_U32 nTimeout);
+    AX_VOID Clear(AX_VOID);
+    FRAME_INFLIGHT_STAT_T PopStat(AX_VOID);
+
+private:
+    AX_VOID Release(FRAME_INFLIGHT_SLOT_T &tSlot);
+
+private:
+    FRAME_INFLIGHT_SLOT_T m_arrSlot[DETECTOR_INFLIGHT_SLOT_NUM];
+    FRAME_INFLIGHT_STAT_T m_tStat;
+};
+
+/**
+ * Per-result bump arena
+ * Holds all object/pose arrays (with inline attribute strings) of one NPU result,
+ * released as a unit when the result is retired. Block grows to the high-water mark
+ * on reset, so steady state has no heap traffic.
+ */
+#define DETECTOR_RESULT_ARENA_SIZE (64 * 1024)
+#define DETECTOR_RESULT_ARENA_ALIGN (8)
+
+typedef struct _RESULT_ARENA_STAT_T {
+    AX_U32 nUsed;
+    AX_U32 nMaxUsed;
+    AX_U32 nCapacity;
+    AX_U32 nHeapAllocs;
+} RESULT_ARENA_STAT_T;
+
+/* Not thread safe, owned by result thread */
+class CResultArena
+{
+public:
+    CResultArena(AX_U32 nSize);
+    ~CResultArena(AX_VOID);
+
+    template <typename T>
+    T *NewArray(AX_U32 nCount) {
+        static_assert(std::is_trivially_destructible<T>::value, "arena objects are never destructed");
+
+        T *pArray = (T *)Alloc(sizeof(T) * nCount);
+        if (pArray) {
+            for (AX_U32 i = 0; i < nCount; i++) {
+                new (pArray + i) T();
+            }
+        }
+
+        return pArray;
+    }
+
+    AX_VOID Reset(AX_VOID);
+    RESULT_ARENA_STAT_T PopStat(AX_VOID);
+
+private:
+    AX_VOID *Alloc(AX_U32 nSize);
+
+private:
+    AX_U8 *m_pBlock;
+    AX_U32 m_nCapacity;
+    AX_U32 m_nOffset;
+    AX_U32 m_nRequired;
+    std::vector<AX_U8 *> m_vecSpill;
+    RESULT_ARENA_STAT_T m_tStat;
+};
+
 /* Donot use memset/memcpy */
 typedef struct _DETECTOR_CONFIG_PARAM_T {
     AX_SKEL_PPL_E ePPL;
@@ -176,7 +274,12 @@ public:
     AX_BOOL ProcessFrame(CMediaFrame* pFrame, AX_S32 nGaps = -1);
     AX_BOOL AsyncRecvDetectionResult(AX_VOID);
     AX_VOID BindCropStage(CTrackCropStage* pStage);
+    AX_VOID SetRTSPServer(AXRtspServer* pRtspServer);
     DETECTOR_CONFIG_PARAM_T GetConfig(AX_VOID);
+    AX_BOOL IsPlateIdentify(AX_VOID);
+    AX_U32 GetRecentTargets(AX_VOID) {
+        return m_nRecentTargets;
+    }
     AX_BOOL SetConfig(DETECTOR_CONFIG_PARAM_T *pConfig);
     AX_BOOL UpdateConfig(const AI_ATTR_T& tAiAttr);
     AX_BOOL SetRoi(DETECTOR_ROI_CONFIG_T *ptRoi);
@@ -215,16 +318,20 @@ protected:
 private:
     AX_SKEL_HANDLE m_stream_handle = nullptr;
     std::mutex m_mutex;
-    std::map<AX_U64, FRAME_ALGORITHM_RESULT_ST> m_mapDataResult;
+    CFrameInflightTable m_tInflight;
+    CResultArena m_tResultArena;
+    std::atomic<AX_U32> m_nRecentTargets{0};
     AX_BOOL m_bThreadRunning;
     thread *m_pGetResultThread = nullptr;
     CTrackCropStage *m_pTrackCropStage = nullptr;
+    AXRtspServer *m_pRtspServer = nullptr;
     CElapsedTimer m_apiElapsed;
     std::mutex m_stMutex;
     DETECTOR_CONFIG_PARAM_T m_tConfigParam;
 
     //Search
     CSearch *m_pObjectSearch = nullptr;
+    std::vector<AX_BOOL> m_vecSearchHit;
 
     //AI Perf Test
     PERF_TEST_INFO_T m_perfTestInfo;
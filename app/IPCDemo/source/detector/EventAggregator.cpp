@@ -0,0 +1,367 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+#include "EventAggregator.h"
+#include <string.h>
+#include <sys/prctl.h>
+#include <algorithm>
+#include <vector>
+#include "AppLog.h"
+#include "TimeUtil.h"
+#include "inifile.h"
+
+#define EVENT ("EVENT")
+#define EVENT_AGGR_POLL_INTERVAL (100) // ms
+
+AX_BOOL CEventAggregator::Init(AX_VOID) {
+    LoadConfig();
+
+    for (AX_U32 i = 0; i < E_EVENT_AGGR_SINK_MAX; i++) {
+        m_arrSinks[i].fTokens = (AX_F32)m_tConfig.nBurst;
+        m_arrSinks[i].nRefill = 0;
+        memset(&m_arrSinks[i].tStat, 0, sizeof(m_arrSinks[i].tStat));
+    }
+
+    return AX_TRUE;
+}
+
+AX_BOOL CEventAggregator::LoadConfig(AX_VOID) {
+    inifile::IniFile f;
+    std::string strIniFile{"./config/ive.conf"};
+    AX_S32 ret = f.Load(strIniFile);
+    if (0 != ret) {
+        LOG_M_E(EVENT, "load %s fail", strIniFile.c_str());
+        return AX_FALSE;
+    }
+
+    std::string strSect = "EVENT";
+    if (!f.HasSection(strSect)) {
+        /* defaults */
+        return AX_TRUE;
+    }
+
+    EVENT_AGGR_CONFIG_T tConfig;
+    AX_S32 nVal = 0;
+    if (0 == f.GetIntValue(strSect, "start hits", &nVal) && nVal > 0) {
+        tConfig.nStartHits = nVal;
+    }
+    if (0 == f.GetIntValue(strSect, "ongoing interval", &nVal) && nVal > 0) {
+        tConfig.nOngoingInterval = nVal;
+    }
+    if (0 == f.GetIntValue(strSect, "end debounce", &nVal) && nVal > 0) {
+        tConfig.nEndDebounce = nVal;
+    }
+    if (0 == f.GetIntValue(strSect, "rate", &nVal) && nVal > 0) {
+        tConfig.nRate = nVal;
+    }
+    if (0 == f.GetIntValue(strSect, "burst", &nVal) && nVal > 0) {
+        tConfig.nBurst = nVal;
+    }
+    if (0 == f.GetIntValue(strSect, "backlog", &nVal) && nVal > 0) {
+        tConfig.nBacklog = nVal;
+    }
+
+    SetConfig(tConfig);
+
+    LOG_M(EVENT, "start hits: %d, ongoing: %d ms, end debounce: %d ms, rate: %d/s, burst: %d, backlog: %d", m_tConfig.nStartHits,
+          m_tConfig.nOngoingInterval, m_tConfig.nEndDebounce, m_tConfig.nRate, m_tConfig.nBurst, m_tConfig.nBacklog);
+
+    return AX_TRUE;
+}
+
+AX_VOID CEventAggregator::SetWebServer(CWebServer *pWebServer) {
+    m_pWebServer = pWebServer;
+}
+
+AX_VOID CEventAggregator::SetRTSPServer(AXRtspServer *pRtspServer) {
+    m_pRtspServer = pRtspServer;
+}
+
+AX_VOID CEventAggregator::SetConfig(const EVENT_AGGR_CONFIG_T &tConfig) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    m_tConfig = tConfig;
+    m_tConfig.nStartHits = std::max(m_tConfig.nStartHits, (AX_U32)1);
+    m_tConfig.nRate = std::max(m_tConfig.nRate, (AX_U32)1);
+    m_tConfig.nBurst = std::max(m_tConfig.nBurst, (AX_U32)1);
+    m_tConfig.nBacklog = std::max(m_tConfig.nBacklog, (AX_U32)1);
+}
+
+AX_BOOL CEventAggregator::Start(AX_VOID) {
+    if (m_pThread) {
+        return AX_TRUE;
+    }
+
+    m_bThreadRunning = AX_TRUE;
+    m_pThread = new (std::nothrow) std::thread(&CEventAggregator::ThreadFunc, this);
+    if (!m_pThread) {
+        m_bThreadRunning = AX_FALSE;
+        LOG_M_E(EVENT, "create aggregator thread fail");
+        return AX_FALSE;
+    }
+
+    return AX_TRUE;
+}
+
+AX_VOID CEventAggregator::Stop(AX_VOID) {
+    if (!m_pThread) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lck(m_mtx);
+        m_bThreadRunning = AX_FALSE;
+        m_cv.notify_all();
+    }
+
+    if (m_pThread->joinable()) {
+        m_pThread->join();
+    }
+
+    delete m_pThread;
+    m_pThread = nullptr;
+
+    std::lock_guard<std::mutex> lck(m_mtx);
+    m_mapAreas.clear();
+    for (AX_U32 i = 0; i < E_EVENT_AGGR_SINK_MAX; i++) {
+        m_arrSinks[i].dqBacklog.clear();
+    }
+}
+
+AX_VOID CEventAggregator::ThreadFunc(AX_VOID) {
+    LOG_M(EVENT, "+++");
+    prctl(PR_SET_NAME, "IPC_EVENT_AGGR");
+
+    while (m_bThreadRunning) {
+        Poll(CTimeUtils::GetTickCount());
+
+        /* a start wakes it at once */
+        std::unique_lock<std::mutex> lck(m_mtx);
+        m_cv.wait_for(lck, std::chrono::milliseconds(EVENT_AGGR_POLL_INTERVAL), [this] { return !m_bThreadRunning || m_bWakeup; });
+        m_bWakeup = AX_FALSE;
+    }
+
+    LOG_M(EVENT, "---");
+}
+
+AX_U64 CEventAggregator::GetKey(const WEB_EVENTS_DATA_T &tEvent) {
+    AX_U32 nAreaId = 0;
+    AX_U64 nReason = 0;
+    switch (tEvent.eType) {
+        case E_WEB_EVENTS_TYPE_MD:
+            nAreaId = tEvent.tMD.nAreaID;
+            break;
+        case E_WEB_EVENTS_TYPE_OD:
+            nAreaId = tEvent.tOD.nAreaID;
+            break;
+        case E_WEB_EVENTS_TYPE_SCD:
+            nAreaId = tEvent.tSCD.nAreaID;
+            nReason = tEvent.tSCD.nReserved;
+            break;
+        default:
+            break;
+    }
+
+    return ((AX_U64)tEvent.eType << 56) | ((nReason & 0xFFFFFF) << 32) | nAreaId;
+}
+
+AX_VOID CEventAggregator::Trigger(const WEB_EVENTS_DATA_T &tEvent) {
+    Trigger(tEvent, CTimeUtils::GetTickCount());
+}
+
+AX_VOID CEventAggregator::Trigger(const WEB_EVENTS_DATA_T &tEvent, AX_U64 nNow) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+
+    for (AX_U32 i = 0; i < E_EVENT_AGGR_SINK_MAX; i++) {
+        m_arrSinks[i].tStat.nTriggers++;
+    }
+
+    AREA_T &tArea = m_mapAreas[GetKey(tEvent)];
+    if (tArea.nHits > 0 && nNow - tArea.nLast >= m_tConfig.nEndDebounce) {
+        /* quiet long enough, Poll has not got to it yet */
+        if (tArea.bActive) {
+            Raise(tArea, E_WEB_EVENTS_STATE_END, tArea.nLast);
+        }
+        tArea.bActive = AX_FALSE;
+        tArea.nHits = 0;
+    }
+
+    if (0 == tArea.nHits) {
+        tArea.nFirst = nNow;
+    }
+    tArea.tEvent = tEvent;
+    tArea.nHits++;
+    tArea.nLast = nNow;
+
+    if (!tArea.bActive && tArea.nHits >= m_tConfig.nStartHits) {
+        tArea.bActive = AX_TRUE;
+        Raise(tArea, E_WEB_EVENTS_STATE_START, nNow);
+
+        /* sent by the aggregator thread, detectors never wait for a sink */
+        m_bWakeup = AX_TRUE;
+        m_cv.notify_one();
+    }
+}
+
+AX_VOID CEventAggregator::Poll(AX_U64 nNow) {
+    std::vector<WEB_EVENTS_DATA_T> arrSend[E_EVENT_AGGR_SINK_MAX];
+    std::unique_lock<std::mutex> lck(m_mtx);
+
+    for (auto it = m_mapAreas.begin(); it != m_mapAreas.end();) {
+        AREA_T &tArea = it->second;
+        if (nNow - tArea.nLast >= m_tConfig.nEndDebounce) {
+            if (tArea.bActive) {
+                Raise(tArea, E_WEB_EVENTS_STATE_END, nNow);
+            }
+            it = m_mapAreas.erase(it);
+            continue;
+        }
+
+        if (tArea.bActive && nNow - tArea.nReport >= m_tConfig.nOngoingInterval) {
+            Raise(tArea, E_WEB_EVENTS_STATE_ONGOING, nNow);
+        }
+        ++it;
+    }
+
+    for (AX_U32 i = 0; i < E_EVENT_AGGR_SINK_MAX; i++) {
+        Drain((EVENT_AGGR_SINK_E)i, nNow, arrSend[i]);
+    }
+
+    /* sinks write sockets, Trigger must not wait for them */
+    lck.unlock();
+
+    std::vector<AX_U32> arrBytes[E_EVENT_AGGR_SINK_MAX];
+    for (AX_U32 i = 0; i < E_EVENT_AGGR_SINK_MAX; i++) {
+        for (auto &tEvent : arrSend[i]) {
+            arrBytes[i].push_back(Send((EVENT_AGGR_SINK_E)i, tEvent));
+        }
+    }
+
+    lck.lock();
+
+    for (AX_U32 i = 0; i < E_EVENT_AGGR_SINK_MAX; i++) {
+        SINK_T &tSink = m_arrSinks[i];
+        for (AX_U32 nBytes : arrBytes[i]) {
+            /* nobody is listening, nothing is charged */
+            if (0 == nBytes) {
+                tSink.fTokens = std::min(tSink.fTokens + 1.0f, (AX_F32)m_tConfig.nBurst);
+                continue;
+            }
+
+            tSink.tStat.nSent++;
+            tSink.tStat.nBytes += nBytes;
+        }
+    }
+
+    ReportStat(nNow);
+}
+
+AX_VOID CEventAggregator::Raise(AREA_T &tArea, WEB_EVENTS_STATE_E eState, AX_U64 nNow) {
+    WEB_EVENTS_DATA_T tEvent = tArea.tEvent;
+    tEvent.eState = eState;
+    tEvent.nCount = tArea.nHits;
+    tEvent.nDuration = (AX_U32)(tArea.nLast - tArea.nFirst);
+    tEvent.nTime = nNow;
+    tArea.nReport = nNow;
+
+    for (AX_U32 i = 0; i < E_EVENT_AGGR_SINK_MAX; i++) {
+        m_arrSinks[i].tStat.nEvents++;
+        Enqueue((EVENT_AGGR_SINK_E)i, tEvent);
+    }
+}
+
+AX_VOID CEventAggregator::Enqueue(EVENT_AGGR_SINK_E eSink, const WEB_EVENTS_DATA_T &tEvent) {
+    SINK_T &tSink = m_arrSinks[eSink];
+
+    if (E_WEB_EVENTS_STATE_ONGOING == tEvent.eState) {
+        AX_U64 nKey = GetKey(tEvent);
+        for (auto &tQueued : tSink.dqBacklog) {
+            if (E_WEB_EVENTS_STATE_ONGOING == tQueued.eState && GetKey(tQueued) == nKey) {
+                tQueued = tEvent;
+                tSink.tStat.nCoalesced++;
+                return;
+            }
+        }
+    }
+
+    if (tSink.dqBacklog.size() >= m_tConfig.nBacklog) {
+        auto itDrop = std::find_if(tSink.dqBacklog.begin(), tSink.dqBacklog.end(),
+                                   [](const WEB_EVENTS_DATA_T &t) { return E_WEB_EVENTS_STATE_ONGOING == t.eState; });
+        if (itDrop == tSink.dqBacklog.end()) {
+            if (E_WEB_EVENTS_STATE_ONGOING == tEvent.eState) {
+                tSink.tStat.nDropped++;
+                return;
+            }
+            itDrop = tSink.dqBacklog.begin();
+        }
+
+        tSink.dqBacklog.erase(itDrop);
+        tSink.tStat.nDropped++;
+    }
+
+    tSink.dqBacklog.push_back(tEvent);
+}
+
+AX_VOID CEventAggregator::Drain(EVENT_AGGR_SINK_E eSink, AX_U64 nNow, std::vector<WEB_EVENTS_DATA_T> &vecSend) {
+    SINK_T &tSink = m_arrSinks[eSink];
+
+    if (nNow > tSink.nRefill) {
+        tSink.fTokens = std::min(tSink.fTokens + (nNow - tSink.nRefill) * m_tConfig.nRate / 1000.0f, (AX_F32)m_tConfig.nBurst);
+    }
+    tSink.nRefill = nNow;
+
+    /* charged now, Poll gives the token back if the send reaches nobody */
+    while (!tSink.dqBacklog.empty() && tSink.fTokens >= 1.0f) {
+        vecSend.push_back(tSink.dqBacklog.front());
+        tSink.dqBacklog.pop_front();
+        tSink.fTokens -= 1.0f;
+    }
+}
+
+AX_U32 CEventAggregator::Send(EVENT_AGGR_SINK_E eSink, WEB_EVENTS_DATA_T &tEvent) {
+    switch (eSink) {
+        case E_EVENT_AGGR_SINK_WEB:
+            return m_pWebServer ? m_pWebServer->SendEventsData(&tEvent) : 0;
+        case E_EVENT_AGGR_SINK_RTSP:
+            return m_pRtspServer ? m_pRtspServer->SendEvent(tEvent) : 0;
+        default:
+            return 0;
+    }
+}
+
+AX_VOID CEventAggregator::ReportStat(AX_U64 nNow) {
+    if (0 == m_nStatTick) {
+        m_nStatTick = nNow;
+        return;
+    }
+
+    if (nNow - m_nStatTick < EVENT_AGGR_STAT_INTERVAL) {
+        return;
+    }
+
+    AX_F32 fSeconds = (nNow - m_nStatTick) / 1000.0f;
+    for (AX_U32 i = 0; i < E_EVENT_AGGR_SINK_MAX; i++) {
+        const EVENT_AGGR_STAT_T &tStat = m_arrSinks[i].tStat;
+        EVENT_AGGR_STAT_T &tLast = m_arrLastStat[i];
+        if (tStat.nTriggers != tLast.nTriggers) {
+            LOG_M_I(EVENT, "%s: triggers %.1f/s, events %.1f/s, sent %.1f/s, %.1f B/s, coalesced %lld, dropped %lld, backlog %d",
+                    (E_EVENT_AGGR_SINK_WEB == i) ? "web" : "rtsp", (tStat.nTriggers - tLast.nTriggers) / fSeconds,
+                    (tStat.nEvents - tLast.nEvents) / fSeconds, (tStat.nSent - tLast.nSent) / fSeconds,
+                    (tStat.nBytes - tLast.nBytes) / fSeconds, tStat.nCoalesced - tLast.nCoalesced, tStat.nDropped - tLast.nDropped,
+                    (AX_U32)m_arrSinks[i].dqBacklog.size());
+        }
+        tLast = tStat;
+    }
+
+    m_nStatTick = nNow;
+}
+
+EVENT_AGGR_STAT_T CEventAggregator::GetStat(EVENT_AGGR_SINK_E eSink) {
+    std::lock_guard<std::mutex> lck(m_mtx);
+    return m_arrSinks[eSink].tStat;
+}
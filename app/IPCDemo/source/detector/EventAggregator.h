@@ -0,0 +1,145 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "WebServer.h"
+#include "AXRtspServer.h"
+#include "Singleton.h"
+
+/**
+ * Event aggregator of MD/OD/SCD
+ * Detectors call Trigger() on every frame an area (or SCD reason) is triggering, the
+ * aggregator turns the level into:
+ *   start:   after "start hits" triggers
+ *   ongoing: every "ongoing interval" ms while triggers keep coming
+ *   end:     after "end debounce" ms without a trigger, so a flickering area stays one event
+ * Every sink (web events channel, RTSP metadata) owns a token bucket of "rate" events per
+ * second up to "burst", events beyond it wait in a backlog of "backlog" entries. A newer
+ * ongoing replaces the queued one of the same area, and a full backlog drops ongoing
+ * events before start/end.
+ * Settings are [EVENT] of ive.conf.
+ */
+#define EVENT_AGGR_START_HITS (1)
+#define EVENT_AGGR_ONGOING_INTERVAL (5000)  // ms
+#define EVENT_AGGR_END_DEBOUNCE (1000)      // ms
+#define EVENT_AGGR_RATE (5)                 // events per second of a sink
+#define EVENT_AGGR_BURST (10)
+#define EVENT_AGGR_BACKLOG (32)
+#define EVENT_AGGR_STAT_INTERVAL (60000)    // ms
+
+typedef enum _EVENT_AGGR_SINK_E {
+    E_EVENT_AGGR_SINK_WEB = 0,
+    E_EVENT_AGGR_SINK_RTSP,
+    E_EVENT_AGGR_SINK_MAX
+} EVENT_AGGR_SINK_E;
+
+typedef struct _EVENT_AGGR_CONFIG_T {
+    AX_U32 nStartHits;
+    AX_U32 nOngoingInterval;
+    AX_U32 nEndDebounce;
+    AX_U32 nRate;
+    AX_U32 nBurst;
+    AX_U32 nBacklog;
+
+    _EVENT_AGGR_CONFIG_T() {
+        nStartHits = EVENT_AGGR_START_HITS;
+        nOngoingInterval = EVENT_AGGR_ONGOING_INTERVAL;
+        nEndDebounce = EVENT_AGGR_END_DEBOUNCE;
+        nRate = EVENT_AGGR_RATE;
+        nBurst = EVENT_AGGR_BURST;
+        nBacklog = EVENT_AGGR_BACKLOG;
+    }
+} EVENT_AGGR_CONFIG_T;
+
+typedef struct _EVENT_AGGR_STAT_T {
+    AX_U64 nTriggers; // frames triggered by detectors
+    AX_U64 nEvents;   // start/ongoing/end raised
+    AX_U64 nSent;     // delivered to the sink
+    AX_U64 nBytes;    // bytes handed to the sink
+    AX_U64 nCoalesced;
+    AX_U64 nDropped;
+} EVENT_AGGR_STAT_T;
+
+class CEventAggregator : public CSingleton<CEventAggregator> {
+    friend class CSingleton<CEventAggregator>;
+
+public:
+    AX_VOID SetWebServer(CWebServer *pWebServer);
+    AX_VOID SetRTSPServer(AXRtspServer *pRtspServer);
+    AX_VOID SetConfig(const EVENT_AGGR_CONFIG_T &tConfig);
+
+    AX_BOOL Start(AX_VOID);
+    AX_VOID Stop(AX_VOID);
+
+    /* areas are told apart by type, area id and nReserved of the info (SCD reason),
+       nNow (ms) lets a simulation drive the clock */
+    AX_VOID Trigger(const WEB_EVENTS_DATA_T &tEvent);
+    AX_VOID Trigger(const WEB_EVENTS_DATA_T &tEvent, AX_U64 nNow);
+    /* raises ongoing/end and sends what the buckets allow outside the lock,
+       called by the aggregator thread only (or a simulation without Start) */
+    AX_VOID Poll(AX_U64 nNow);
+
+    EVENT_AGGR_STAT_T GetStat(EVENT_AGGR_SINK_E eSink);
+
+protected:
+    AX_BOOL LoadConfig(AX_VOID);
+
+private:
+    CEventAggregator(AX_VOID) noexcept = default;
+    virtual ~CEventAggregator(AX_VOID) = default;
+
+    /* virtual function of CSingleton */
+    AX_BOOL Init(AX_VOID) override;
+
+    typedef struct {
+        WEB_EVENTS_DATA_T tEvent; // last trigger
+        AX_BOOL bActive;
+        AX_U32 nHits;
+        AX_U64 nFirst;
+        AX_U64 nLast;
+        AX_U64 nReport;
+    } AREA_T;
+
+    typedef struct {
+        std::deque<WEB_EVENTS_DATA_T> dqBacklog;
+        AX_F32 fTokens;
+        AX_U64 nRefill;
+        EVENT_AGGR_STAT_T tStat;
+    } SINK_T;
+
+    static AX_U64 GetKey(const WEB_EVENTS_DATA_T &tEvent);
+    AX_VOID Raise(AREA_T &tArea, WEB_EVENTS_STATE_E eState, AX_U64 nNow);
+    AX_VOID Enqueue(EVENT_AGGR_SINK_E eSink, const WEB_EVENTS_DATA_T &tEvent);
+    AX_VOID Drain(EVENT_AGGR_SINK_E eSink, AX_U64 nNow, std::vector<WEB_EVENTS_DATA_T> &vecSend);
+    AX_U32 Send(EVENT_AGGR_SINK_E eSink, WEB_EVENTS_DATA_T &tEvent);
+    AX_VOID ReportStat(AX_U64 nNow);
+    AX_VOID ThreadFunc(AX_VOID);
+
+private:
+    CWebServer *m_pWebServer{nullptr};
+    AXRtspServer *m_pRtspServer{nullptr};
+    EVENT_AGGR_CONFIG_T m_tConfig;
+
+    std::mutex m_mtx;
+    std::map<AX_U64, AREA_T> m_mapAreas;
+    SINK_T m_arrSinks[E_EVENT_AGGR_SINK_MAX];
+    AX_U64 m_nStatTick{0};
+    EVENT_AGGR_STAT_T m_arrLastStat[E_EVENT_AGGR_SINK_MAX]{};
+
+    std::thread *m_pThread{nullptr};
+    AX_BOOL m_bThreadRunning{AX_FALSE};
+    AX_BOOL m_bWakeup{AX_FALSE};
+    std::condition_variable m_cv;
+};
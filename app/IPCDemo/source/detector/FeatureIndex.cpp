@@ -0,0 +1,546 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+#include <math.h>
+#include <algorithm>
+#include "FeatureIndex.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define FEATURE_INDEX_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define FEATURE_INDEX_SSE
+#endif
+
+#define FEATURE_INDEX_ALIGN_DIM(_dim_) (((_dim_) + 15) & ~15)
+#define FEATURE_INDEX_SCORE_SCALE (100.0f)
+
+/* int16 rows of unit vectors are kept within this norm, so a dot product never leaves AX_S32 */
+#define FEATURE_INDEX_S16_MAX_NORM (46000.0f)
+
+namespace {
+/* pTop holds nTop entries sorted by score, most rows fail the first compare */
+inline AX_VOID InsertTop(FEATURE_INDEX_RESULT_T *pTop, AX_U32 nTop, AX_F32 fScore, AX_U64 nObjectId)
+{
+    if (fScore <= pTop[nTop - 1].fScore) {
+        return;
+    }
+
+    AX_U32 k = nTop - 1;
+    for (; k > 0 && fScore > pTop[k - 1].fScore; k--) {
+        pTop[k] = pTop[k - 1];
+    }
+    pTop[k].fScore = fScore;
+    pTop[k].nObjectId = nObjectId;
+}
+
+inline AX_VOID ResetResult(FEATURE_INDEX_RESULT_T *pResults, AX_U32 nCount)
+{
+    for (AX_U32 i = 0; i < nCount; i++) {
+        pResults[i].fScore = -FEATURE_INDEX_SCORE_SCALE;
+        pResults[i].nObjectId = 0;
+        pResults[i].szKey[0] = 0;
+    }
+}
+} // namespace
+
+/* nDim must be a multiple of 4 */
+AX_F32 CFeatureIndex::Dot(const AX_F32 *pA, const AX_F32 *pB, AX_U32 nDim)
+{
+#if defined(FEATURE_INDEX_NEON)
+    float32x4_t vSum0 = vdupq_n_f32(0);
+    float32x4_t vSum1 = vdupq_n_f32(0);
+    AX_U32 i = 0;
+    for (; i + 8 <= nDim; i += 8) {
+        vSum0 = vmlaq_f32(vSum0, vld1q_f32(pA + i), vld1q_f32(pB + i));
+        vSum1 = vmlaq_f32(vSum1, vld1q_f32(pA + i + 4), vld1q_f32(pB + i + 4));
+    }
+    if (i < nDim) {
+        vSum0 = vmlaq_f32(vSum0, vld1q_f32(pA + i), vld1q_f32(pB + i));
+    }
+    vSum0 = vaddq_f32(vSum0, vSum1);
+    float32x2_t vSum = vadd_f32(vget_low_f32(vSum0), vget_high_f32(vSum0));
+    return vget_lane_f32(vpadd_f32(vSum, vSum), 0);
+#elif defined(FEATURE_INDEX_SSE)
+    __m128 vSum0 = _mm_setzero_ps();
+    __m128 vSum1 = _mm_setzero_ps();
+    AX_U32 i = 0;
+    for (; i + 8 <= nDim; i += 8) {
+        vSum0 = _mm_add_ps(vSum0, _mm_mul_ps(_mm_loadu_ps(pA + i), _mm_loadu_ps(pB + i)));
+        vSum1 = _mm_add_ps(vSum1, _mm_mul_ps(_mm_loadu_ps(pA + i + 4), _mm_loadu_ps(pB + i + 4)));
+    }
+    if (i < nDim) {
+        vSum0 = _mm_add_ps(vSum0, _mm_mul_ps(_mm_loadu_ps(pA + i), _mm_loadu_ps(pB + i)));
+    }
+    vSum0 = _mm_add_ps(vSum0, vSum1);
+    vSum0 = _mm_add_ps(vSum0, _mm_movehl_ps(vSum0, vSum0));
+    vSum0 = _mm_add_ss(vSum0, _mm_shuffle_ps(vSum0, vSum0, 1));
+    return _mm_cvtss_f32(vSum0);
+#else
+    AX_F32 fSum = 0;
+    for (AX_U32 i = 0; i < nDim; i++) {
+        fSum += pA[i] * pB[i];
+    }
+    return fSum;
+#endif
+}
+
+/* nDim must be a multiple of 16 */
+AX_S32 CFeatureIndex::Dot(const AX_S16 *pA, const AX_S16 *pB, AX_U32 nDim)
+{
+#if defined(FEATURE_INDEX_NEON)
+    int32x4_t vSum0 = vdupq_n_s32(0);
+    int32x4_t vSum1 = vdupq_n_s32(0);
+    for (AX_U32 i = 0; i < nDim; i += 8) {
+        int16x8_t vA = vld1q_s16(pA + i);
+        int16x8_t vB = vld1q_s16(pB + i);
+        vSum0 = vmlal_s16(vSum0, vget_low_s16(vA), vget_low_s16(vB));
+        vSum1 = vmlal_s16(vSum1, vget_high_s16(vA), vget_high_s16(vB));
+    }
+    vSum0 = vaddq_s32(vSum0, vSum1);
+    int32x2_t vSum = vadd_s32(vget_low_s32(vSum0), vget_high_s32(vSum0));
+    return vget_lane_s32(vpadd_s32(vSum, vSum), 0);
+#elif defined(FEATURE_INDEX_SSE)
+    __m128i vSum0 = _mm_setzero_si128();
+    __m128i vSum1 = _mm_setzero_si128();
+    for (AX_U32 i = 0; i < nDim; i += 16) {
+        vSum0 = _mm_add_epi32(vSum0, _mm_madd_epi16(_mm_loadu_si128((const __m128i *)(pA + i)), _mm_loadu_si128((const __m128i *)(pB + i))));
+        vSum1 = _mm_add_epi32(vSum1, _mm_madd_epi16(_mm_loadu_si128((const __m128i *)(pA + i + 8)), _mm_loadu_si128((const __m128i *)(pB + i + 8))));
+    }
+    vSum0 = _mm_add_epi32(vSum0, vSum1);
+    vSum0 = _mm_add_epi32(vSum0, _mm_shuffle_epi32(vSum0, _MM_SHUFFLE(1, 0, 3, 2)));
+    vSum0 = _mm_add_epi32(vSum0, _mm_shuffle_epi32(vSum0, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(vSum0);
+#else
+    AX_S32 nSum = 0;
+    for (AX_U32 i = 0; i < nDim; i++) {
+        nSum += (AX_S32)pA[i] * pB[i];
+    }
+    return nSum;
+#endif
+}
+
+/* nDim must be a multiple of 16, values within [-127, 127] */
+AX_S32 CFeatureIndex::Dot(const AX_S8 *pA, const AX_S8 *pB, AX_U32 nDim)
+{
+#if defined(FEATURE_INDEX_NEON)
+    int32x4_t vSum = vdupq_n_s32(0);
+    for (AX_U32 i = 0; i < nDim; i += 16) {
+        int8x16_t vA = vld1q_s8(pA + i);
+        int8x16_t vB = vld1q_s8(pB + i);
+        // two products of at most 127 * 127 still fit in int16
+        int16x8_t vProd = vmull_s8(vget_low_s8(vA), vget_low_s8(vB));
+        vProd = vmlal_s8(vProd, vget_high_s8(vA), vget_high_s8(vB));
+        vSum = vpadalq_s16(vSum, vProd);
+    }
+    int32x2_t vSum2 = vadd_s32(vget_low_s32(vSum), vget_high_s32(vSum));
+    return vget_lane_s32(vpadd_s32(vSum2, vSum2), 0);
+#elif defined(FEATURE_INDEX_SSE)
+    __m128i vSum = _mm_setzero_si128();
+    for (AX_U32 i = 0; i < nDim; i += 16) {
+        __m128i vA = _mm_loadu_si128((const __m128i *)(pA + i));
+        __m128i vB = _mm_loadu_si128((const __m128i *)(pB + i));
+        // sign extend to int16 by unpacking with itself and shifting back
+        __m128i vALo = _mm_srai_epi16(_mm_unpacklo_epi8(vA, vA), 8);
+        __m128i vAHi = _mm_srai_epi16(_mm_unpackhi_epi8(vA, vA), 8);
+        __m128i vBLo = _mm_srai_epi16(_mm_unpacklo_epi8(vB, vB), 8);
+        __m128i vBHi = _mm_srai_epi16(_mm_unpackhi_epi8(vB, vB), 8);
+        vSum = _mm_add_epi32(vSum, _mm_madd_epi16(vALo, vBLo));
+        vSum = _mm_add_epi32(vSum, _mm_madd_epi16(vAHi, vBHi));
+    }
+    vSum = _mm_add_epi32(vSum, _mm_shuffle_epi32(vSum, _MM_SHUFFLE(1, 0, 3, 2)));
+    vSum = _mm_add_epi32(vSum, _mm_shuffle_epi32(vSum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(vSum);
+#else
+    AX_S32 nSum = 0;
+    for (AX_U32 i = 0; i < nDim; i++) {
+        nSum += (AX_S32)pA[i] * pB[i];
+    }
+    return nSum;
+#endif
+}
+
+AX_BOOL CFeatureIndex::SetPrecision(FEATURE_INDEX_PRECISION_E ePrecision)
+{
+    std::lock_guard<std::mutex> lck(m_mutex);
+
+    if (!m_vecObjectId.empty()) {
+        return AX_FALSE;
+    }
+
+    m_ePrecision = ePrecision;
+
+    return AX_TRUE;
+}
+
+AX_VOID CFeatureIndex::SetFetcher(const FEATURE_INDEX_FETCHER &fetcher)
+{
+    std::lock_guard<std::mutex> lck(m_mutex);
+
+    m_fetcher = fetcher;
+}
+
+AX_VOID CFeatureIndex::Reserve(AX_U32 nCapacity, AX_U32 nFeatureSize /* = 0 */)
+{
+    std::lock_guard<std::mutex> lck(m_mutex);
+
+    if (nFeatureSize > 0 && 0 == m_nDim) {
+        CheckSize(nFeatureSize);
+    }
+
+    m_vecObjectId.reserve(nCapacity);
+    m_vecKey.reserve(nCapacity);
+    m_vecScale.reserve(nCapacity);
+    m_mapRow.reserve(nCapacity);
+    if (m_nStride > 0) {
+        switch (m_ePrecision) {
+            case FEATURE_INDEX_PRECISION_S16:
+                m_vecFeatureS16.reserve((size_t)nCapacity * m_nStride);
+                break;
+            case FEATURE_INDEX_PRECISION_S8:
+                m_vecFeatureS8.reserve((size_t)nCapacity * m_nStride);
+                break;
+            default:
+                m_vecFeature.reserve((size_t)nCapacity * m_nStride);
+                break;
+        }
+    }
+}
+
+/* caller holds m_mutex */
+AX_BOOL CFeatureIndex::CheckSize(AX_U32 nFeatureSize)
+{
+    if (0 == nFeatureSize || 0 != (nFeatureSize % sizeof(AX_F32))) {
+        return AX_FALSE;
+    }
+
+    AX_U32 nDim = nFeatureSize / sizeof(AX_F32);
+    if (0 == m_nDim) {
+        m_nDim = nDim;
+        m_nStride = FEATURE_INDEX_ALIGN_DIM(nDim);
+        m_vecScratch.resize(m_nStride);
+    }
+
+    return (nDim == m_nDim) ? AX_TRUE : AX_FALSE;
+}
+
+/* pDst has nStride floats, padding is zeroed */
+AX_VOID CFeatureIndex::Normalize(const AX_F32 *pSrc, AX_F32 *pDst, AX_U32 nDim, AX_U32 nStride)
+{
+    AX_F32 fNorm = 0;
+    for (AX_U32 i = 0; i < nDim; i++) {
+        fNorm += pSrc[i] * pSrc[i];
+    }
+
+    AX_F32 fScale = (fNorm > 0) ? 1.0f / sqrtf(fNorm) : 0;
+    for (AX_U32 i = 0; i < nDim; i++) {
+        pDst[i] = pSrc[i] * fScale;
+    }
+    for (AX_U32 i = nDim; i < nStride; i++) {
+        pDst[i] = 0;
+    }
+}
+
+/* symmetric per vector scale, returns the value of one step */
+template <typename T>
+AX_F32 CFeatureIndex::Quantize(const AX_F32 *pSrc, T *pDst, AX_U32 nStride)
+{
+    const AX_F32 fMaxValue = (1 == sizeof(T)) ? 127.0f : 32767.0f;
+
+    AX_F32 fMax = 0;
+    for (AX_U32 i = 0; i < nStride; i++) {
+        fMax = AX_MAX(fMax, fabsf(pSrc[i]));
+    }
+
+    AX_F32 fScale = fMax / fMaxValue;
+    if (2 == sizeof(T)) {
+        fScale = AX_MAX(fScale, 1.0f / FEATURE_INDEX_S16_MAX_NORM);
+    }
+
+    if (fMax <= 0) {
+        memset(pDst, 0x00, nStride * sizeof(T));
+        return 0;
+    }
+
+    AX_F32 fInv = 1.0f / fScale;
+    for (AX_U32 i = 0; i < nStride; i++) {
+        pDst[i] = (T)lrintf(pSrc[i] * fInv);
+    }
+
+    return fScale;
+}
+
+/* caller holds m_mutex and has checked the size */
+AX_VOID CFeatureIndex::AppendRow(AX_U64 nObjectId, const AX_U8 *pFeature, AX_U32 nFeatureSize, const std::string &strKey)
+{
+    AX_U32 nRow = (AX_U32)m_vecObjectId.size();
+
+    // features from SKEL are not guaranteed to be float aligned
+    memcpy(m_vecScratch.data(), pFeature, nFeatureSize);
+    Normalize(m_vecScratch.data(), m_vecScratch.data(), m_nDim, m_nStride);
+
+    switch (m_ePrecision) {
+        case FEATURE_INDEX_PRECISION_S16:
+            m_vecFeatureS16.resize((size_t)(nRow + 1) * m_nStride);
+            m_vecScale.push_back(Quantize(m_vecScratch.data(), &m_vecFeatureS16[(size_t)nRow * m_nStride], m_nStride));
+            break;
+        case FEATURE_INDEX_PRECISION_S8:
+            m_vecFeatureS8.resize((size_t)(nRow + 1) * m_nStride);
+            m_vecScale.push_back(Quantize(m_vecScratch.data(), &m_vecFeatureS8[(size_t)nRow * m_nStride], m_nStride));
+            break;
+        default:
+            m_vecFeature.insert(m_vecFeature.end(), m_vecScratch.begin(), m_vecScratch.end());
+            m_vecScale.push_back(1.0f);
+            break;
+    }
+
+    m_vecObjectId.push_back(nObjectId);
+    m_vecKey.push_back(strKey.substr(0, FEATURE_INDEX_KEY_SIZE - 1));
+    m_mapRow[nObjectId] = nRow;
+}
+
+AX_BOOL CFeatureIndex::Insert(AX_U64 nObjectId, const AX_U8 *pFeature, AX_U32 nFeatureSize, const std::string &strKey)
+{
+    if (!pFeature) {
+        return AX_FALSE;
+    }
+
+    std::lock_guard<std::mutex> lck(m_mutex);
+
+    if (!CheckSize(nFeatureSize) || m_mapRow.find(nObjectId) != m_mapRow.end()) {
+        return AX_FALSE;
+    }
+
+    AppendRow(nObjectId, pFeature, nFeatureSize, strKey);
+
+    return AX_TRUE;
+}
+
+AX_BOOL CFeatureIndex::Insert(AX_U32 nBatch, const AX_U64 *pObjectIds, const AX_U8 *pFeatures, AX_U32 nFeatureSize,
+                              const std::string *pKeys)
+{
+    if (!pObjectIds || !pFeatures || !pKeys) {
+        return AX_FALSE;
+    }
+
+    std::lock_guard<std::mutex> lck(m_mutex);
+
+    if (!CheckSize(nFeatureSize)) {
+        return AX_FALSE;
+    }
+
+    for (AX_U32 i = 0; i < nBatch; i++) {
+        if (m_mapRow.find(pObjectIds[i]) != m_mapRow.end()) {
+            return AX_FALSE;
+        }
+    }
+
+    for (AX_U32 i = 0; i < nBatch; i++) {
+        AppendRow(pObjectIds[i], pFeatures + (size_t)i * nFeatureSize, nFeatureSize, pKeys[i]);
+    }
+
+    return AX_TRUE;
+}
+
+AX_BOOL CFeatureIndex::Remove(AX_U64 nObjectId)
+{
+    std::lock_guard<std::mutex> lck(m_mutex);
+
+    auto iter = m_mapRow.find(nObjectId);
+    if (iter == m_mapRow.end()) {
+        return AX_FALSE;
+    }
+
+    AX_U32 nRow = iter->second;
+    AX_U32 nLast = (AX_U32)m_vecObjectId.size() - 1;
+
+    // move the last row into the hole, rows stay dense for scanning
+    if (nRow != nLast) {
+        switch (m_ePrecision) {
+            case FEATURE_INDEX_PRECISION_S16:
+                memcpy(&m_vecFeatureS16[(size_t)nRow * m_nStride], &m_vecFeatureS16[(size_t)nLast * m_nStride], m_nStride * sizeof(AX_S16));
+                break;
+            case FEATURE_INDEX_PRECISION_S8:
+                memcpy(&m_vecFeatureS8[(size_t)nRow * m_nStride], &m_vecFeatureS8[(size_t)nLast * m_nStride], m_nStride * sizeof(AX_S8));
+                break;
+            default:
+                memcpy(&m_vecFeature[(size_t)nRow * m_nStride], &m_vecFeature[(size_t)nLast * m_nStride], m_nStride * sizeof(AX_F32));
+                break;
+        }
+        m_vecScale[nRow] = m_vecScale[nLast];
+        m_vecObjectId[nRow] = m_vecObjectId[nLast];
+        m_vecKey[nRow].swap(m_vecKey[nLast]);
+        m_mapRow[m_vecObjectId[nRow]] = nRow;
+    }
+
+    switch (m_ePrecision) {
+        case FEATURE_INDEX_PRECISION_S16:
+            m_vecFeatureS16.resize((size_t)nLast * m_nStride);
+            break;
+        case FEATURE_INDEX_PRECISION_S8:
+            m_vecFeatureS8.resize((size_t)nLast * m_nStride);
+            break;
+        default:
+            m_vecFeature.resize((size_t)nLast * m_nStride);
+            break;
+    }
+    m_vecScale.pop_back();
+    m_vecObjectId.pop_back();
+    m_vecKey.pop_back();
+    m_mapRow.erase(iter);
+
+    return AX_TRUE;
+}
+
+AX_VOID CFeatureIndex::Clear(AX_VOID)
+{
+    std::lock_guard<std::mutex> lck(m_mutex);
+
+    m_vecFeature.clear();
+    m_vecFeatureS16.clear();
+    m_vecFeatureS8.clear();
+    m_vecScale.clear();
+    m_vecObjectId.clear();
+    m_vecKey.clear();
+    m_mapRow.clear();
+}
+
+AX_U32 CFeatureIndex::Size(AX_VOID)
+{
+    std::lock_guard<std::mutex> lck(m_mutex);
+
+    return (AX_U32)m_vecObjectId.size();
+}
+
+AX_U64 CFeatureIndex::MemorySize(AX_VOID)
+{
+    std::lock_guard<std::mutex> lck(m_mutex);
+
+    return m_vecFeature.size() * sizeof(AX_F32) + m_vecFeatureS16.size() * sizeof(AX_S16)
+           + m_vecFeatureS8.size() * sizeof(AX_S8) + m_vecScale.size() * sizeof(AX_F32);
+}
+
+/* caller holds m_mutex, pCandidates has nBatch * nCandidate entries */
+template <typename T>
+AX_VOID CFeatureIndex::Scan(const T *pRows, const T *pQueries, const AX_F32 *pQueryScales, AX_U32 nBatch, AX_U32 nCandidate,
+                            FEATURE_INDEX_RESULT_T *pCandidates)
+{
+    AX_U32 nRows = (AX_U32)m_vecObjectId.size();
+    const T *pRow = pRows;
+    for (AX_U32 r = 0; r < nRows; r++, pRow += m_nStride) {
+        AX_F32 fRowScale = m_vecScale[r] * FEATURE_INDEX_SCORE_SCALE;
+        for (AX_U32 q = 0; q < nBatch; q++) {
+            AX_F32 fScore = Dot(pRow, pQueries + (size_t)q * m_nStride, m_nStride) * fRowScale * pQueryScales[q];
+            InsertTop(pCandidates + q * nCandidate, nCandidate, fScore, m_vecObjectId[r]);
+        }
+    }
+
+    // keys are copied once per candidate rather than on every top k shuffle
+    for (AX_U32 c = 0; c < nBatch * nCandidate; c++) {
+        if (pCandidates[c].fScore <= -FEATURE_INDEX_SCORE_SCALE) {
+            continue;
+        }
+
+        const std::string &strKey = m_vecKey[m_mapRow[pCandidates[c].nObjectId]];
+        memcpy(pCandidates[c].szKey, strKey.c_str(), strKey.size() + 1);
+    }
+}
+
+AX_BOOL CFeatureIndex::Search(const AX_U8 *pFeatures, AX_U32 nFeatureSize, AX_U32 nBatch, AX_U32 nTopK,
+                              FEATURE_INDEX_RESULT_T *pResults)
+{
+    if (!pFeatures || !pResults || 0 == nBatch || 0 == nTopK || nTopK > FEATURE_INDEX_MAX_TOP_K) {
+        return AX_FALSE;
+    }
+
+    ResetResult(pResults, nBatch * nTopK);
+
+    std::vector<AX_F32> vecQuery;
+    std::vector<AX_F32> vecQueryScale(nBatch, 1.0f);
+    std::vector<FEATURE_INDEX_RESULT_T> vecCandidate;
+    FEATURE_INDEX_FETCHER fetcher;
+    AX_U32 nDim = 0;
+    AX_U32 nStride = 0;
+    AX_U32 nCandidate = nTopK;
+
+    {
+        std::lock_guard<std::mutex> lck(m_mutex);
+
+        if (0 == m_nDim || nFeatureSize != m_nDim * sizeof(AX_F32)) {
+            return AX_FALSE;
+        }
+
+        nDim = m_nDim;
+        nStride = m_nStride;
+
+        vecQuery.resize((size_t)nBatch * nStride);
+        for (AX_U32 q = 0; q < nBatch; q++) {
+            AX_F32 *pQuery = &vecQuery[(size_t)q * nStride];
+            memcpy(pQuery, pFeatures + (size_t)q * nFeatureSize, nFeatureSize);
+            Normalize(pQuery, pQuery, nDim, nStride);
+        }
+
+        if (FEATURE_INDEX_PRECISION_F32 != m_ePrecision && m_fetcher) {
+            fetcher = m_fetcher;
+            nCandidate = nTopK * FEATURE_INDEX_RERANK_FACTOR;
+        }
+
+        vecCandidate.resize(nBatch * nCandidate);
+        ResetResult(vecCandidate.data(), nBatch * nCandidate);
+
+        switch (m_ePrecision) {
+            case FEATURE_INDEX_PRECISION_S16: {
+                std::vector<AX_S16> vecQueryS16((size_t)nBatch * nStride);
+                for (AX_U32 q = 0; q < nBatch; q++) {
+                    vecQueryScale[q] = Quantize(&vecQuery[(size_t)q * nStride], &vecQueryS16[(size_t)q * nStride], nStride);
+                }
+                Scan(m_vecFeatureS16.data(), vecQueryS16.data(), vecQueryScale.data(), nBatch, nCandidate, vecCandidate.data());
+                break;
+            }
+            case FEATURE_INDEX_PRECISION_S8: {
+                std::vector<AX_S8> vecQueryS8((size_t)nBatch * nStride);
+                for (AX_U32 q = 0; q < nBatch; q++) {
+                    vecQueryScale[q] = Quantize(&vecQuery[(size_t)q * nStride], &vecQueryS8[(size_t)q * nStride], nStride);
+                }
+                Scan(m_vecFeatureS8.data(), vecQueryS8.data(), vecQueryScale.data(), nBatch, nCandidate, vecCandidate.data());
+                break;
+            }
+            default:
+                Scan(m_vecFeature.data(), vecQuery.data(), vecQueryScale.data(), nBatch, nCandidate, vecCandidate.data());
+                break;
+        }
+    }
+
+    // re-rank in float outside the lock, the fetcher may block on file access
+    if (fetcher) {
+        std::vector<AX_F32> vecExact(nStride);
+        for (AX_U32 q = 0; q < nBatch; q++) {
+            FEATURE_INDEX_RESULT_T *pCandidates = &vecCandidate[q * nCandidate];
+            for (AX_U32 c = 0; c < nCandidate && pCandidates[c].fScore > -FEATURE_INDEX_SCORE_SCALE; c++) {
+                if (fetcher(pCandidates[c].nObjectId, pCandidates[c].szKey, (AX_U8 *)vecExact.data(), nFeatureSize)) {
+                    Normalize(vecExact.data(), vecExact.data(), nDim, nStride);
+                    pCandidates[c].fScore = Dot(vecExact.data(), &vecQuery[(size_t)q * nStride], nStride) * FEATURE_INDEX_SCORE_SCALE;
+                } else {
+                    // removed meanwhile or unreadable, a quantised score must not compete with exact ones
+                    ResetResult(&pCandidates[c], 1);
+                }
+            }
+
+            std::stable_sort(pCandidates, pCandidates + nCandidate,
+                             [](const FEATURE_INDEX_RESULT_T &a, const FEATURE_INDEX_RESULT_T &b) { return a.fScore > b.fScore; });
+        }
+    }
+
+    for (AX_U32 q = 0; q < nBatch; q++) {
+        memcpy(pResults + q * nTopK, &vecCandidate[q * nCandidate], nTopK * sizeof(FEATURE_INDEX_RESULT_T));
+    }
+
+    return AX_TRUE;
+}
@@ -0,0 +1,102 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+#pragma once
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "global.h"
+
+/**
+ * CPU feature index
+ * Holds L2 normalised AX_F32 features row by row (stride padded to 16 elements) and scans
+ * them with NEON/SSE dot products. All queries of a batch are compared against a row
+ * while it is in cache, so one frame costs one pass over the gallery.
+ * Rows may be kept as int16 or int8 with a per-row scale to fit larger galleries; the
+ * integer scan then picks FEATURE_INDEX_RERANK_FACTOR x top k candidates, which are scored
+ * again in float against features from the fetcher.
+ * Score is cosine similarity * 100, the scale of the SKEL search threshold.
+ */
+#define FEATURE_INDEX_MAX_TOP_K (16)
+#define FEATURE_INDEX_RERANK_FACTOR (4)
+#define FEATURE_INDEX_KEY_SIZE (32)
+
+typedef enum _FEATURE_INDEX_PRECISION_E {
+    FEATURE_INDEX_PRECISION_F32 = 0,
+    FEATURE_INDEX_PRECISION_S16,
+    FEATURE_INDEX_PRECISION_S8
+} FEATURE_INDEX_PRECISION_E;
+
+typedef struct _FEATURE_INDEX_RESULT_T {
+    AX_F32 fScore;
+    AX_U64 nObjectId;
+    AX_CHAR szKey[FEATURE_INDEX_KEY_SIZE]; // copy of the row key, stays valid after the row is removed
+} FEATURE_INDEX_RESULT_T;
+
+/* full precision feature of an object for re-rank, called without index lock held, the row may be gone by then;
+ * a candidate whose fetch fails is dropped */
+typedef std::function<AX_BOOL(AX_U64 nObjectId, const AX_CHAR *szKey, AX_U8 *pFeature, AX_U32 nFeatureSize)> FEATURE_INDEX_FETCHER;
+
+class CFeatureIndex
+{
+public:
+    CFeatureIndex(AX_VOID) = default;
+
+    /* only while empty */
+    AX_BOOL SetPrecision(FEATURE_INDEX_PRECISION_E ePrecision);
+    AX_VOID SetFetcher(const FEATURE_INDEX_FETCHER &fetcher);
+
+    /* nFeatureSize in bytes, 0 takes the size of the first inserted feature */
+    AX_VOID Reserve(AX_U32 nCapacity, AX_U32 nFeatureSize = 0);
+    /* key is copied into the row, truncated to FEATURE_INDEX_KEY_SIZE - 1 */
+    AX_BOOL Insert(AX_U64 nObjectId, const AX_U8 *pFeature, AX_U32 nFeatureSize, const std::string &strKey);
+    /* pFeatures holds nBatch features back to back, nothing is inserted if any id exists */
+    AX_BOOL Insert(AX_U32 nBatch, const AX_U64 *pObjectIds, const AX_U8 *pFeatures, AX_U32 nFeatureSize, const std::string *pKeys);
+    AX_BOOL Remove(AX_U64 nObjectId);
+    AX_VOID Clear(AX_VOID);
+    AX_U32 Size(AX_VOID);
+    /* bytes held by rows */
+    AX_U64 MemorySize(AX_VOID);
+
+    /* pFeatures holds nBatch features back to back, pResults nBatch * nTopK entries sorted by score */
+    AX_BOOL Search(const AX_U8 *pFeatures, AX_U32 nFeatureSize, AX_U32 nBatch, AX_U32 nTopK, FEATURE_INDEX_RESULT_T *pResults);
+
+    /* nDim must be a multiple of 4 for AX_F32, of 16 for AX_S16 and AX_S8 */
+    static AX_F32 Dot(const AX_F32 *pA, const AX_F32 *pB, AX_U32 nDim);
+    static AX_S32 Dot(const AX_S16 *pA, const AX_S16 *pB, AX_U32 nDim);
+    static AX_S32 Dot(const AX_S8 *pA, const AX_S8 *pB, AX_U32 nDim);
+
+private:
+    AX_BOOL CheckSize(AX_U32 nFeatureSize);
+    AX_VOID AppendRow(AX_U64 nObjectId, const AX_U8 *pFeature, AX_U32 nFeatureSize, const std::string &strKey);
+
+    static AX_VOID Normalize(const AX_F32 *pSrc, AX_F32 *pDst, AX_U32 nDim, AX_U32 nStride);
+    template <typename T>
+    static AX_F32 Quantize(const AX_F32 *pSrc, T *pDst, AX_U32 nStride);
+    template <typename T>
+    AX_VOID Scan(const T *pRows, const T *pQueries, const AX_F32 *pQueryScales, AX_U32 nBatch, AX_U32 nCandidate,
+                 FEATURE_INDEX_RESULT_T *pCandidates);
+
+private:
+    std::mutex m_mutex;
+    FEATURE_INDEX_PRECISION_E m_ePrecision{FEATURE_INDEX_PRECISION_F32};
+    FEATURE_INDEX_FETCHER m_fetcher;
+    AX_U32 m_nDim{0};
+    AX_U32 m_nStride{0};
+    std::vector<AX_F32> m_vecFeature;
+    std::vector<AX_S16> m_vecFeatureS16;
+    std::vector<AX_S8> m_vecFeatureS8;
+    std::vector<AX_F32> m_vecScale;
+    std::vector<AX_U64> m_vecObjectId;
+    std::vector<std::string> m_vecKey;
+    std::unordered_map<AX_U64, AX_U32> m_mapRow;
+    std::vector<AX_F32> m_vecScratch;
+};
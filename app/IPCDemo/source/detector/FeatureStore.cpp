@@ -0,0 +1,821 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+#include <algorithm>
+#include <chrono>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#include "FeatureStore.h"
+
+#define FEATURE_STORE "FEATURE_STORE"
+
+#define FEATURE_STORE_ALIGN(_size_) (((_size_) + 3) & ~3)
+
+namespace {
+/* record layout of the previous format */
+typedef struct {
+    AX_U8 Info[FEATURE_STORE_INFO_SIZE];
+    AX_U32 FeatureSize;
+} LEGACY_FEATURE_HEADER_ST;
+
+AX_BOOL PwriteAll(AX_S32 nFd, const AX_VOID *pData, AX_U32 nSize, AX_U64 nOffset)
+{
+    const AX_U8 *p = (const AX_U8 *)pData;
+    while (nSize > 0) {
+        ssize_t nRet = pwrite(nFd, p, nSize, nOffset);
+        if (nRet <= 0) {
+            if (nRet < 0 && EINTR == errno) {
+                continue;
+            }
+            return AX_FALSE;
+        }
+        p += nRet;
+        nSize -= nRet;
+        nOffset += nRet;
+    }
+
+    return AX_TRUE;
+}
+
+AX_BOOL PreadAll(AX_S32 nFd, AX_VOID *pData, AX_U32 nSize, AX_U64 nOffset)
+{
+    AX_U8 *p = (AX_U8 *)pData;
+    while (nSize > 0) {
+        ssize_t nRet = pread(nFd, p, nSize, nOffset);
+        if (nRet <= 0) {
+            if (nRet < 0 && EINTR == errno) {
+                continue;
+            }
+            return AX_FALSE;
+        }
+        p += nRet;
+        nSize -= nRet;
+        nOffset += nRet;
+    }
+
+    return AX_TRUE;
+}
+
+AX_VOID SyncDir(const std::string &strPath)
+{
+    size_t nPos = strPath.rfind('/');
+    std::string strDir = (std::string::npos == nPos) ? "." : strPath.substr(0, nPos ? nPos : 1);
+
+    AX_S32 nFd = open(strDir.c_str(), O_RDONLY);
+    if (nFd >= 0) {
+        fsync(nFd);
+        close(nFd);
+    }
+}
+
+/* read-only mapping of the whole file, unmapped on scope exit */
+class CFileMap
+{
+public:
+    CFileMap(AX_S32 nFd, AX_U64 nSize) {
+        AX_VOID *pData = mmap(nullptr, nSize, PROT_READ, MAP_PRIVATE, nFd, 0);
+        if (MAP_FAILED != pData) {
+            m_pData = (const AX_U8 *)pData;
+            m_nSize = nSize;
+            madvise(pData, nSize, MADV_SEQUENTIAL | MADV_WILLNEED);
+        }
+    }
+
+    ~CFileMap(AX_VOID) {
+        if (m_pData) {
+            munmap((AX_VOID *)m_pData, m_nSize);
+        }
+    }
+
+    const AX_U8 *Data(AX_VOID) const {
+        return m_pData;
+    }
+
+private:
+    const AX_U8 *m_pData{nullptr};
+    AX_U64 m_nSize{0};
+};
+
+AX_U32 HeadCrc(const FEATURE_STORE_HEAD_T &tHead)
+{
+    FEATURE_STORE_HEAD_T tTmp = tHead;
+    tTmp.nCrc = 0;
+    return CFeatureStore::Crc32(0, &tTmp, sizeof(tTmp));
+}
+
+AX_U32 RecordCrc(const FEATURE_STORE_RECORD_T &tRecord, const AX_U8 *pFeature)
+{
+    FEATURE_STORE_RECORD_T tTmp = tRecord;
+    tTmp.nCrc = 0;
+    return CFeatureStore::Crc32(CFeatureStore::Crc32(0, &tTmp, sizeof(tTmp)), pFeature, tRecord.nFeatureSize);
+}
+
+AX_VOID FillHead(FEATURE_STORE_HEAD_T &tHead)
+{
+    memset(&tHead, 0x00, sizeof(tHead));
+    tHead.nMagic = FEATURE_STORE_MAGIC;
+    tHead.nVersion = FEATURE_STORE_VERSION;
+    tHead.nHeadSize = sizeof(FEATURE_STORE_HEAD_T);
+    tHead.nCrc = HeadCrc(tHead);
+}
+
+/* record header and padded feature into one buffer, so that a record is one write */
+AX_VOID BuildRecord(std::vector<AX_U8> &vecBuf, FEATURE_STORE_RECORD_TYPE_E eType, const std::string &strInfo,
+                    const AX_U8 *pFeature, AX_U32 nFeatureSize)
+{
+    vecBuf.assign(sizeof(FEATURE_STORE_RECORD_T) + FEATURE_STORE_ALIGN(nFeatureSize), 0);
+
+    FEATURE_STORE_RECORD_T tRecord;
+    memset(&tRecord, 0x00, sizeof(tRecord));
+    tRecord.nMagic = FEATURE_STORE_RECORD_MAGIC;
+    tRecord.nType = (AX_U8)eType;
+    tRecord.nFeatureSize = nFeatureSize;
+    memcpy(tRecord.szInfo, strInfo.c_str(), AX_MIN(strInfo.size(), (size_t)(FEATURE_STORE_INFO_SIZE - 1)));
+
+    if (nFeatureSize > 0) {
+        memcpy(&vecBuf[sizeof(tRecord)], pFeature, nFeatureSize);
+    }
+
+    tRecord.nCrc = RecordCrc(tRecord, &vecBuf[sizeof(tRecord)]);
+    memcpy(&vecBuf[0], &tRecord, sizeof(tRecord));
+}
+} // namespace
+
+CFeatureStore::~CFeatureStore(AX_VOID)
+{
+    Close();
+}
+
+/* slicing by 4, the whole file is checksummed on open */
+AX_U32 CFeatureStore::Crc32(AX_U32 nCrc, const AX_VOID *pData, AX_U32 nSize)
+{
+    static const std::vector<AX_U32> vecTable = [] {
+        std::vector<AX_U32> vec(4 * 256);
+        for (AX_U32 i = 0; i < 256; i++) {
+            AX_U32 c = i;
+            for (AX_U32 k = 0; k < 8; k++) {
+                c = (c & 1) ? (0xEDB88320 ^ (c >> 1)) : (c >> 1);
+            }
+            vec[i] = c;
+        }
+        for (AX_U32 i = 0; i < 256; i++) {
+            for (AX_U32 t = 1; t < 4; t++) {
+                vec[t * 256 + i] = (vec[(t - 1) * 256 + i] >> 8) ^ vec[vec[(t - 1) * 256 + i] & 0xFF];
+            }
+        }
+        return vec;
+    }();
+
+    const AX_U32 *T = vecTable.data();
+    const AX_U8 *p = (const AX_U8 *)pData;
+    nCrc = ~nCrc;
+
+    for (; nSize >= 4; nSize -= 4, p += 4) {
+        nCrc ^= (AX_U32)p[0] | ((AX_U32)p[1] << 8) | ((AX_U32)p[2] << 16) | ((AX_U32)p[3] << 24);
+        nCrc = T[768 + (nCrc & 0xFF)] ^ T[512 + ((nCrc >> 8) & 0xFF)] ^ T[256 + ((nCrc >> 16) & 0xFF)] ^ T[nCrc >> 24];
+    }
+    for (; nSize > 0; nSize--, p++) {
+        nCrc = T[(nCrc ^ *p) & 0xFF] ^ (nCrc >> 8);
+    }
+
+    return ~nCrc;
+}
+
+AX_U32 CFeatureStore::RecordSize(AX_U32 nFeatureSize)
+{
+    return sizeof(FEATURE_STORE_RECORD_T) + FEATURE_STORE_ALIGN(nFeatureSize);
+}
+
+std::string CFeatureStore::RecordInfo(const FEATURE_STORE_RECORD_T &tRecord)
+{
+    return std::string(tRecord.szInfo, strnlen(tRecord.szInfo, FEATURE_STORE_INFO_SIZE));
+}
+
+AX_BOOL CFeatureStore::Open(const std::string &strPath)
+{
+    Close();
+
+    {
+        std::lock_guard<std::mutex> lckAppend(m_mtxAppend);
+        std::lock_guard<std::mutex> lck(m_mutex);
+
+        m_strPath = strPath;
+        m_mapIndex.clear();
+        m_nLiveBytes = 0;
+        m_nDeadBytes = 0;
+        m_nCompactFailDead = 0;
+
+        m_nFd = open(m_strPath.c_str(), O_RDWR | O_CREAT, 0666);
+        if (m_nFd < 0) {
+            LOG_M_E(FEATURE_STORE, "open %s fail: %s", m_strPath.c_str(), strerror(errno));
+            return AX_FALSE;
+        }
+
+        struct stat tStat;
+        fstat(m_nFd, &tStat);
+        m_nFileSize = tStat.st_size;
+
+        FEATURE_STORE_HEAD_T tHead;
+        if (0 == m_nFileSize) {
+            FillHead(tHead);
+            if (!PwriteAll(m_nFd, &tHead, sizeof(tHead), 0) || 0 != fdatasync(m_nFd)) {
+                LOG_M_E(FEATURE_STORE, "init %s fail", m_strPath.c_str());
+                close(m_nFd);
+                m_nFd = -1;
+                return AX_FALSE;
+            }
+            m_nFileSize = sizeof(tHead);
+        } else if (m_nFileSize < sizeof(tHead) || !PreadAll(m_nFd, &tHead, sizeof(tHead), 0) || FEATURE_STORE_MAGIC != tHead.nMagic) {
+            if (!Migrate()) {
+                return AX_FALSE;
+            }
+        } else if (!CheckHead(tHead)) {
+            close(m_nFd);
+            m_nFd = -1;
+            return AX_FALSE;
+        }
+
+        if (!Recover()) {
+            close(m_nFd);
+            m_nFd = -1;
+            m_mapIndex.clear();
+            return AX_FALSE;
+        }
+
+        LOG_M(FEATURE_STORE, "%s opened, live: %d, live bytes: %lld, dead bytes: %lld",
+              m_strPath.c_str(), (AX_U32)m_mapIndex.size(), m_nLiveBytes, m_nDeadBytes);
+
+        m_bCompactRunning = AX_TRUE;
+        m_bCompactPending = NeedCompact();
+    }
+
+    m_pCompactThread = new std::thread(&CFeatureStore::CompactThreadFunc, this);
+
+    return AX_TRUE;
+}
+
+AX_VOID CFeatureStore::Close(AX_VOID)
+{
+    if (m_pCompactThread) {
+        {
+            std::lock_guard<std::mutex> lck(m_mutex);
+            m_bCompactRunning = AX_FALSE;
+            m_cvCompact.notify_all();
+        }
+
+        if (m_pCompactThread->joinable()) {
+            m_pCompactThread->join();
+        }
+
+        delete m_pCompactThread;
+        m_pCompactThread = nullptr;
+    }
+
+    // waits for a Compact called by the user and for an append in flight
+    std::lock_guard<std::mutex> lckCompact(m_mtxCompact);
+    std::lock_guard<std::mutex> lckAppend(m_mtxAppend);
+    std::lock_guard<std::mutex> lck(m_mutex);
+    if (m_nFd >= 0) {
+        close(m_nFd);
+        m_nFd = -1;
+    }
+    m_mapIndex.clear();
+}
+
+AX_BOOL CFeatureStore::CheckHead(const FEATURE_STORE_HEAD_T &tHead)
+{
+    if (HeadCrc(tHead) != tHead.nCrc) {
+        LOG_M_E(FEATURE_STORE, "%s: head checksum mismatch", m_strPath.c_str());
+        return AX_FALSE;
+    }
+
+    // a newer layout is refused rather than migrated, so it is never overwritten
+    if (FEATURE_STORE_VERSION != tHead.nVersion || sizeof(FEATURE_STORE_HEAD_T) != tHead.nHeadSize) {
+        LOG_M_E(FEATURE_STORE, "%s: unsupported version %d, head size %d", m_strPath.c_str(), tHead.nVersion, tHead.nHeadSize);
+        return AX_FALSE;
+    }
+
+    return AX_TRUE;
+}
+
+/* caller holds m_mtxAppend and m_mutex, replays the log and cuts off a torn tail, a corrupt record mid file fails the open */
+AX_BOOL CFeatureStore::Recover(AX_VOID)
+{
+    CFileMap tMap(m_nFd, m_nFileSize);
+    const AX_U8 *pBase = tMap.Data();
+    if (!pBase) {
+        LOG_M_E(FEATURE_STORE, "mmap %s fail: %s", m_strPath.c_str(), strerror(errno));
+        return AX_FALSE;
+    }
+
+    // records are 4 bytes aligned, the head is read in place
+    auto IsRecord = [&](AX_U64 nOffset) -> AX_BOOL {
+        if (nOffset + sizeof(FEATURE_STORE_RECORD_T) > m_nFileSize) {
+            return AX_FALSE;
+        }
+        const FEATURE_STORE_RECORD_T &tRecord = *(const FEATURE_STORE_RECORD_T *)(pBase + nOffset);
+        return (FEATURE_STORE_RECORD_MAGIC == tRecord.nMagic
+                && tRecord.nFeatureSize <= FEATURE_STORE_MAX_FEATURE_SIZE
+                && nOffset + RecordSize(tRecord.nFeatureSize) <= m_nFileSize
+                && tRecord.nCrc == RecordCrc(tRecord, pBase + nOffset + sizeof(FEATURE_STORE_RECORD_T))) ? AX_TRUE : AX_FALSE;
+    };
+
+    AX_U64 nOffset = sizeof(FEATURE_STORE_HEAD_T);
+
+    while (nOffset < m_nFileSize) {
+        if (!IsRecord(nOffset)) {
+            // a torn write only hits the tail, a valid record behind a bad one means the bad one may be a lost
+            // DEL, replaying around it would bring the deleted feature back
+            for (AX_U64 nNext = nOffset + 4; nNext < m_nFileSize; nNext += 4) {
+                if (IsRecord(nNext)) {
+                    LOG_M_E(FEATURE_STORE, "%s: corrupt record at %lld followed by valid records, file left untouched",
+                            m_strPath.c_str(), nOffset);
+                    return AX_FALSE;
+                }
+            }
+            break;
+        }
+
+        const FEATURE_STORE_RECORD_T &tRecord = *(const FEATURE_STORE_RECORD_T *)(pBase + nOffset);
+        std::string strInfo = RecordInfo(tRecord);
+        AX_U32 nRecordSize = RecordSize(tRecord.nFeatureSize);
+        auto iter = m_mapIndex.find(strInfo);
+
+        if (FEATURE_STORE_RECORD_PUT == tRecord.nType) {
+            if (iter != m_mapIndex.end()) {
+                m_nDeadBytes += RecordSize(iter->second.nFeatureSize);
+                m_nLiveBytes -= RecordSize(iter->second.nFeatureSize);
+            }
+            m_mapIndex[strInfo] = {nOffset, tRecord.nFeatureSize};
+            m_nLiveBytes += nRecordSize;
+        } else {
+            if (iter != m_mapIndex.end()) {
+                m_nDeadBytes += RecordSize(iter->second.nFeatureSize);
+                m_nLiveBytes -= RecordSize(iter->second.nFeatureSize);
+                m_mapIndex.erase(iter);
+            }
+            m_nDeadBytes += nRecordSize;
+        }
+
+        nOffset += nRecordSize;
+    }
+
+    if (nOffset != m_nFileSize) {
+        LOG_M_W(FEATURE_STORE, "%s: drop %lld bytes of incomplete record at %lld", m_strPath.c_str(), m_nFileSize - nOffset, nOffset);
+        if (0 != ftruncate(m_nFd, nOffset) || 0 != fdatasync(m_nFd)) {
+            LOG_M_E(FEATURE_STORE, "truncate %s fail: %s", m_strPath.c_str(), strerror(errno));
+            return AX_FALSE;
+        }
+        m_nFileSize = nOffset;
+    }
+
+    return AX_TRUE;
+}
+
+/* caller holds m_mtxAppend and m_mutex, a previous format file is a run of headed features, a torn last one aside */
+AX_BOOL CFeatureStore::IsLegacy(AX_VOID)
+{
+    AX_U64 nOffset = 0;
+    AX_U32 nCount = 0;
+
+    while (nOffset + sizeof(LEGACY_FEATURE_HEADER_ST) <= m_nFileSize) {
+        LEGACY_FEATURE_HEADER_ST tLegacy;
+        if (!PreadAll(m_nFd, &tLegacy, sizeof(tLegacy), nOffset)
+            || 0 == tLegacy.FeatureSize || tLegacy.FeatureSize > FEATURE_STORE_MAX_FEATURE_SIZE) {
+            return AX_FALSE;
+        }
+        if (nOffset + sizeof(tLegacy) + tLegacy.FeatureSize > m_nFileSize) {
+            break;
+        }
+
+        nOffset += sizeof(tLegacy) + tLegacy.FeatureSize;
+        nCount++;
+    }
+
+    return (nCount > 0) ? AX_TRUE : AX_FALSE;
+}
+
+/* caller holds m_mtxAppend and m_mutex, rewrites a file of the previous format, the original is kept aside */
+AX_BOOL CFeatureStore::Migrate(AX_VOID)
+{
+    if (!IsLegacy()) {
+        LOG_M_E(FEATURE_STORE, "%s: unrecognized file format, left untouched", m_strPath.c_str());
+        close(m_nFd);
+        m_nFd = -1;
+        return AX_FALSE;
+    }
+
+    LOG_M(FEATURE_STORE, "migrate %s to feature store format", m_strPath.c_str());
+
+    std::string strBackup = m_strPath + ".legacy";
+    if (0 != link(m_strPath.c_str(), strBackup.c_str())) {
+        LOG_M_E(FEATURE_STORE, "backup %s to %s fail: %s", m_strPath.c_str(), strBackup.c_str(), strerror(errno));
+        close(m_nFd);
+        m_nFd = -1;
+        return AX_FALSE;
+    }
+
+    std::string strTmp = m_strPath + ".tmp";
+    AX_S32 nTmpFd = open(strTmp.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+    if (nTmpFd < 0) {
+        LOG_M_E(FEATURE_STORE, "open %s fail: %s", strTmp.c_str(), strerror(errno));
+        unlink(strBackup.c_str());
+        close(m_nFd);
+        m_nFd = -1;
+        return AX_FALSE;
+    }
+
+    FEATURE_STORE_HEAD_T tHead;
+    FillHead(tHead);
+    AX_BOOL bRet = PwriteAll(nTmpFd, &tHead, sizeof(tHead), 0);
+    AX_U64 nWriteOffset = sizeof(tHead);
+
+    AX_U64 nOffset = 0;
+    AX_U32 nCount = 0;
+    std::vector<AX_U8> vecFeature;
+    std::vector<AX_U8> vecRecord;
+
+    while (bRet && nOffset + sizeof(LEGACY_FEATURE_HEADER_ST) <= m_nFileSize) {
+        LEGACY_FEATURE_HEADER_ST tLegacy;
+        if (!PreadAll(m_nFd, &tLegacy, sizeof(tLegacy), nOffset)
+            || 0 == tLegacy.FeatureSize || tLegacy.FeatureSize > FEATURE_STORE_MAX_FEATURE_SIZE
+            || nOffset + sizeof(tLegacy) + tLegacy.FeatureSize > m_nFileSize) {
+            break;
+        }
+
+        vecFeature.resize(tLegacy.FeatureSize);
+        if (!PreadAll(m_nFd, vecFeature.data(), tLegacy.FeatureSize, nOffset + sizeof(tLegacy))) {
+            break;
+        }
+
+        std::string strInfo((const AX_CHAR *)tLegacy.Info, strnlen((const AX_CHAR *)tLegacy.Info, FEATURE_STORE_INFO_SIZE));
+        BuildRecord(vecRecord, FEATURE_STORE_RECORD_PUT, strInfo, vecFeature.data(), tLegacy.FeatureSize);
+        bRet = PwriteAll(nTmpFd, vecRecord.data(), vecRecord.size(), nWriteOffset);
+        nWriteOffset += vecRecord.size();
+        nOffset += sizeof(tLegacy) + tLegacy.FeatureSize;
+        nCount++;
+    }
+
+    if (bRet) {
+        bRet = (0 == fsync(nTmpFd)) ? AX_TRUE : AX_FALSE;
+    }
+    close(nTmpFd);
+
+    if (!bRet || 0 != rename(strTmp.c_str(), m_strPath.c_str())) {
+        LOG_M_E(FEATURE_STORE, "migrate %s fail", m_strPath.c_str());
+        unlink(strTmp.c_str());
+        unlink(strBackup.c_str());
+        close(m_nFd);
+        m_nFd = -1;
+        return AX_FALSE;
+    }
+    SyncDir(m_strPath);
+
+    LOG_M(FEATURE_STORE, "migrated %d features, original kept as %s", nCount, strBackup.c_str());
+
+    return Reopen();
+}
+
+/* caller holds m_mtxAppend and m_mutex */
+AX_BOOL CFeatureStore::Reopen(AX_VOID)
+{
+    if (m_nFd >= 0) {
+        close(m_nFd);
+    }
+
+    m_nFd = open(m_strPath.c_str(), O_RDWR);
+    if (m_nFd < 0) {
+        LOG_M_E(FEATURE_STORE, "open %s fail: %s", m_strPath.c_str(), strerror(errno));
+        return AX_FALSE;
+    }
+
+    struct stat tStat;
+    fstat(m_nFd, &tStat);
+    m_nFileSize = tStat.st_size;
+
+    return AX_TRUE;
+}
+
+AX_BOOL CFeatureStore::Load(const FEATURE_STORE_VISITOR &visitor)
+{
+    std::unique_lock<std::mutex> lck(m_mutex);
+
+    if (m_nFd < 0) {
+        return AX_FALSE;
+    }
+
+    if (m_mapIndex.empty()) {
+        return AX_TRUE;
+    }
+
+    CFileMap tMap(m_nFd, m_nFileSize);
+    const AX_U8 *pBase = tMap.Data();
+    if (!pBase) {
+        LOG_M_E(FEATURE_STORE, "mmap %s fail: %s", m_strPath.c_str(), strerror(errno));
+        return AX_FALSE;
+    }
+
+    // file order keeps the walk over the mapping sequential
+    std::vector<std::pair<AX_U64, std::string>> vecOrder;
+    vecOrder.reserve(m_mapIndex.size());
+    for (auto &tEntry : m_mapIndex) {
+        vecOrder.emplace_back(tEntry.second.nOffset, tEntry.first);
+    }
+
+    // records are never rewritten and the mapping keeps this file alive across a compaction,
+    // so the visit goes without the lock and Get is not held off by the gallery load
+    lck.unlock();
+
+    std::sort(vecOrder.begin(), vecOrder.end());
+    for (auto &tOrder : vecOrder) {
+        const FEATURE_STORE_RECORD_T &tRecord = *(const FEATURE_STORE_RECORD_T *)(pBase + tOrder.first);
+        if (!visitor(tOrder.second, pBase + tOrder.first + sizeof(FEATURE_STORE_RECORD_T), tRecord.nFeatureSize)) {
+            break;
+        }
+    }
+
+    return AX_TRUE;
+}
+
+/* caller holds m_mtxAppend but not m_mutex, the caller moves m_nFileSize past the record */
+AX_BOOL CFeatureStore::Append(FEATURE_STORE_RECORD_TYPE_E eType, const std::string &strInfo, const AX_U8 *pFeature,
+                              AX_U32 nFeatureSize, AX_U64 &nOffset)
+{
+    if (m_nFd < 0) {
+        return AX_FALSE;
+    }
+
+    std::vector<AX_U8> vecRecord;
+    BuildRecord(vecRecord, eType, strInfo, pFeature, nFeatureSize);
+
+    if (!PwriteAll(m_nFd, vecRecord.data(), vecRecord.size(), m_nFileSize) || 0 != fdatasync(m_nFd)) {
+        LOG_M_E(FEATURE_STORE, "append %s fail: %s", m_strPath.c_str(), strerror(errno));
+        // a partial record is cut off here, or by Recover on next open
+        if (0 != ftruncate(m_nFd, m_nFileSize)) {
+            LOG_M_E(FEATURE_STORE, "truncate %s fail: %s", m_strPath.c_str(), strerror(errno));
+        }
+        return AX_FALSE;
+    }
+
+    nOffset = m_nFileSize;
+
+    return AX_TRUE;
+}
+
+AX_BOOL CFeatureStore::Put(const std::string &strInfo, const AX_U8 *pFeature, AX_U32 nFeatureSize)
+{
+    if (strInfo.empty() || !pFeature || 0 == nFeatureSize || nFeatureSize > FEATURE_STORE_MAX_FEATURE_SIZE) {
+        return AX_FALSE;
+    }
+
+    std::lock_guard<std::mutex> lckAppend(m_mtxAppend);
+
+    std::string strKey = strInfo.substr(0, FEATURE_STORE_INFO_SIZE - 1);
+    AX_U64 nOffset = 0;
+    if (!Append(FEATURE_STORE_RECORD_PUT, strKey, pFeature, nFeatureSize, nOffset)) {
+        return AX_FALSE;
+    }
+
+    std::lock_guard<std::mutex> lck(m_mutex);
+    m_nFileSize = nOffset + RecordSize(nFeatureSize);
+
+    auto iter = m_mapIndex.find(strKey);
+    if (iter != m_mapIndex.end()) {
+        m_nDeadBytes += RecordSize(iter->second.nFeatureSize);
+        m_nLiveBytes -= RecordSize(iter->second.nFeatureSize);
+    }
+
+    m_mapIndex[strKey] = {nOffset, nFeatureSize};
+    m_nLiveBytes += RecordSize(nFeatureSize);
+
+    if (NeedCompact()) {
+        m_bCompactPending = AX_TRUE;
+        m_cvCompact.notify_all();
+    }
+
+    return AX_TRUE;
+}
+
+AX_BOOL CFeatureStore::Delete(const std::string &strInfo)
+{
+    std::lock_guard<std::mutex> lckAppend(m_mtxAppend);
+
+    // the index only changes under m_mtxAppend, the entry stays while the tombstone is written
+    std::string strKey = strInfo.substr(0, FEATURE_STORE_INFO_SIZE - 1);
+    if (!IsExist(strKey)) {
+        return AX_FALSE;
+    }
+
+    AX_U64 nOffset = 0;
+    if (!Append(FEATURE_STORE_RECORD_DEL, strKey, nullptr, 0, nOffset)) {
+        return AX_FALSE;
+    }
+
+    std::lock_guard<std::mutex> lck(m_mutex);
+    m_nFileSize = nOffset + RecordSize(0);
+
+    auto iter = m_mapIndex.find(strKey);
+    m_nDeadBytes += RecordSize(iter->second.nFeatureSize) + RecordSize(0);
+    m_nLiveBytes -= RecordSize(iter->second.nFeatureSize);
+    m_mapIndex.erase(iter);
+
+    if (NeedCompact()) {
+        m_bCompactPending = AX_TRUE;
+        m_cvCompact.notify_all();
+    }
+
+    return AX_TRUE;
+}
+
+AX_BOOL CFeatureStore::Get(const std::string &strInfo, AX_U8 *pFeature, AX_U32 nFeatureSize)
+{
+    std::lock_guard<std::mutex> lck(m_mutex);
+
+    auto iter = m_mapIndex.find(strInfo.substr(0, FEATURE_STORE_INFO_SIZE - 1));
+    if (iter == m_mapIndex.end() || iter->second.nFeatureSize != nFeatureSize || !pFeature) {
+        return AX_FALSE;
+    }
+
+    return PreadAll(m_nFd, pFeature, nFeatureSize, iter->second.nOffset + sizeof(FEATURE_STORE_RECORD_T));
+}
+
+AX_BOOL CFeatureStore::IsExist(const std::string &strInfo)
+{
+    std::lock_guard<std::mutex> lck(m_mutex);
+
+    return (m_mapIndex.find(strInfo.substr(0, FEATURE_STORE_INFO_SIZE - 1)) != m_mapIndex.end()) ? AX_TRUE : AX_FALSE;
+}
+
+AX_U32 CFeatureStore::Size(AX_VOID)
+{
+    std::lock_guard<std::mutex> lck(m_mutex);
+
+    return (AX_U32)m_mapIndex.size();
+}
+
+/* caller holds m_mutex, after a failed compaction another FEATURE_STORE_COMPACT_MIN_BYTES must die first */
+AX_BOOL CFeatureStore::NeedCompact(AX_VOID) const
+{
+    return (m_nDeadBytes >= FEATURE_STORE_COMPACT_MIN_BYTES && m_nDeadBytes > m_nLiveBytes
+            && m_nDeadBytes >= m_nCompactFailDead + FEATURE_STORE_COMPACT_MIN_BYTES) ? AX_TRUE : AX_FALSE;
+}
+
+/* copies live records of nSrcFd in file order behind a new head and updates their offsets */
+AX_BOOL CFeatureStore::WriteFile(AX_S32 nFd, AX_S32 nSrcFd, std::unordered_map<std::string, FEATURE_STORE_ENTRY_T> &mapIndex,
+                                 AX_U64 &nFileSize)
+{
+    std::vector<std::pair<AX_U64, FEATURE_STORE_ENTRY_T *>> vecOrder;
+    vecOrder.reserve(mapIndex.size());
+    for (auto &tEntry : mapIndex) {
+        vecOrder.emplace_back(tEntry.second.nOffset, &tEntry.second);
+    }
+    std::sort(vecOrder.begin(), vecOrder.end());
+
+    FEATURE_STORE_HEAD_T tHead;
+    FillHead(tHead);
+    AX_BOOL bRet = PwriteAll(nFd, &tHead, sizeof(tHead), 0);
+    AX_U64 nWriteOffset = sizeof(tHead);
+
+    // records are copied verbatim, checksums stay valid
+    std::vector<AX_U8> vecRecord;
+    for (auto &tOrder : vecOrder) {
+        if (!bRet) {
+            break;
+        }
+
+        FEATURE_STORE_ENTRY_T *pEntry = tOrder.second;
+        vecRecord.resize(RecordSize(pEntry->nFeatureSize));
+        bRet = (PreadAll(nSrcFd, vecRecord.data(), vecRecord.size(), pEntry->nOffset)
+                && PwriteAll(nFd, vecRecord.data(), vecRecord.size(), nWriteOffset)) ? AX_TRUE : AX_FALSE;
+        pEntry->nOffset = nWriteOffset;
+        nWriteOffset += vecRecord.size();
+    }
+
+    if (bRet) {
+        bRet = (0 == fdatasync(nFd)) ? AX_TRUE : AX_FALSE;
+    }
+    nFileSize = nWriteOffset;
+
+    return bRet;
+}
+
+/* caller holds m_mtxCompact, m_mutex is taken to snapshot the index and to switch files, appends only wait for the tail */
+AX_BOOL CFeatureStore::DoCompact(AX_VOID)
+{
+    auto tpStart = std::chrono::steady_clock::now();
+
+    std::string strTmp;
+    std::unordered_map<std::string, FEATURE_STORE_ENTRY_T> mapIndex;
+    AX_U64 nSnapSize = 0;
+    AX_S32 nSrcFd = -1;
+
+    {
+        std::lock_guard<std::mutex> lck(m_mutex);
+        if (m_nFd < 0) {
+            return AX_FALSE;
+        }
+
+        // m_nFd is only closed or replaced by Close and compaction, both held off by m_mtxCompact
+        nSrcFd = m_nFd;
+        strTmp = m_strPath + ".tmp";
+        mapIndex = m_mapIndex;
+        nSnapSize = m_nFileSize;
+    }
+
+    AX_S32 nFd = open(strTmp.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0666);
+    if (nFd < 0) {
+        LOG_M_E(FEATURE_STORE, "open %s fail: %s", strTmp.c_str(), strerror(errno));
+        return AX_FALSE;
+    }
+
+    // the file is append only, so records below nSnapSize stay as they are while Put and Delete go on
+    AX_U64 nWriteOffset = 0;
+    AX_BOOL bRet = WriteFile(nFd, nSrcFd, mapIndex, nWriteOffset);
+
+    // appends are held off from here, Get and Load go on against the old file until the switch
+    std::lock_guard<std::mutex> lckAppend(m_mtxAppend);
+
+    AX_U64 nOldSize = m_nFileSize;
+    if (bRet && m_nFileSize > nSnapSize) {
+        // records appended during the copy are moved as they are, PUT and DEL alike
+        std::vector<AX_U8> vecTail(m_nFileSize - nSnapSize);
+        bRet = (PreadAll(m_nFd, vecTail.data(), vecTail.size(), nSnapSize)
+                && PwriteAll(nFd, vecTail.data(), vecTail.size(), nWriteOffset)
+                && 0 == fdatasync(nFd)) ? AX_TRUE : AX_FALSE;
+    }
+    close(nFd);
+
+    // old file stays valid until rename, a crash leaves either old or new file; m_nFd still reads the old one
+    if (!bRet || 0 != rename(strTmp.c_str(), m_strPath.c_str())) {
+        LOG_M_E(FEATURE_STORE, "compact %s fail", m_strPath.c_str());
+        unlink(strTmp.c_str());
+        return AX_FALSE;
+    }
+    SyncDir(m_strPath);
+
+    std::lock_guard<std::mutex> lck(m_mutex);
+
+    for (auto &tEntry : m_mapIndex) {
+        if (tEntry.second.nOffset >= nSnapSize) {
+            tEntry.second.nOffset = tEntry.second.nOffset - nSnapSize + nWriteOffset;
+        } else {
+            // not touched since the snapshot, a Put in between would have moved it to the tail
+            tEntry.second.nOffset = mapIndex[tEntry.first].nOffset;
+        }
+    }
+
+    if (!Reopen()) {
+        return AX_FALSE;
+    }
+    m_nDeadBytes = m_nFileSize - sizeof(FEATURE_STORE_HEAD_T) - m_nLiveBytes;
+
+    LOG_M(FEATURE_STORE, "compact %s: %lld -> %lld bytes, elapsed %d(ms)", m_strPath.c_str(), nOldSize, m_nFileSize,
+          (AX_U32)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - tpStart).count());
+
+    return AX_TRUE;
+}
+
+AX_BOOL CFeatureStore::Compact(AX_VOID)
+{
+    std::lock_guard<std::mutex> lckCompact(m_mtxCompact);
+
+    AX_BOOL bRet = DoCompact();
+
+    std::lock_guard<std::mutex> lck(m_mutex);
+    m_nCompactFailDead = bRet ? 0 : m_nDeadBytes;
+    if (!bRet) {
+        LOG_M_W(FEATURE_STORE, "%s: compaction retried after %d more dead bytes", m_strPath.c_str(), FEATURE_STORE_COMPACT_MIN_BYTES);
+    }
+
+    return bRet;
+}
+
+AX_VOID CFeatureStore::CompactThreadFunc(AX_VOID)
+{
+    prctl(PR_SET_NAME, "IPC_FEATURE_CMP");
+
+    std::unique_lock<std::mutex> lck(m_mutex);
+    while (m_bCompactRunning) {
+        m_cvCompact.wait(lck, [this] { return !m_bCompactRunning || m_bCompactPending; });
+
+        if (m_bCompactRunning && m_bCompactPending) {
+            m_bCompactPending = AX_FALSE;
+
+            lck.unlock();
+            Compact();
+            lck.lock();
+        }
+    }
+}
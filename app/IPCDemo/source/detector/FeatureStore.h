@@ -0,0 +1,133 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include "global.h"
+
+/**
+ * Append-only feature database
+ * Enrollment appends a checksummed PUT record, deletion appends a DEL tombstone, both
+ * followed by fdatasync, so each costs one write and a torn write only loses the tail
+ * record, which is cut off on next open. A corrupt record mid file fails the open, as
+ * replaying around a lost DEL would bring the deleted feature back.
+ * Dead records are dropped by a background compaction that copies a snapshot of the live
+ * records into a new file without the lock, then takes the lock to add what was appended
+ * meanwhile and renames it over the old one. A failed compaction is not retried before
+ * another FEATURE_STORE_COMPACT_MIN_BYTES of records have died.
+ * Writers are serialised by their own lock and only take the index lock to publish a record,
+ * so Get is never held off by an fdatasync.
+ * Open and Load scan a read-only mapping of the file, Load hands out feature pointers into
+ * it, so startup does no per-record read or allocation. Load visits the live records as of
+ * its call without holding any lock.
+ * Files of the previous format (bare info/size headers, no checksum) are migrated on open and
+ * kept as <path>.legacy, a file of neither format is refused.
+ */
+#define FEATURE_STORE_MAGIC (0x53465841) // "AXFS"
+#define FEATURE_STORE_RECORD_MAGIC (0x52465841) // "AXFR"
+#define FEATURE_STORE_VERSION (1)
+#define FEATURE_STORE_INFO_SIZE (32)
+#define FEATURE_STORE_MAX_FEATURE_SIZE (64 * 1024)
+#define FEATURE_STORE_COMPACT_MIN_BYTES (64 * 1024) // compact once dead bytes exceed both this and live bytes
+
+typedef enum _FEATURE_STORE_RECORD_TYPE_E {
+    FEATURE_STORE_RECORD_PUT = 1,
+    FEATURE_STORE_RECORD_DEL = 2
+} FEATURE_STORE_RECORD_TYPE_E;
+
+typedef struct _FEATURE_STORE_HEAD_T {
+    AX_U32 nMagic;
+    AX_U16 nVersion;
+    AX_U16 nHeadSize;
+    AX_U32 nReserved;
+    AX_U32 nCrc; // crc32 of head (nCrc as 0)
+} FEATURE_STORE_HEAD_T;
+
+/* followed by feature data, padded to 4 bytes */
+typedef struct _FEATURE_STORE_RECORD_T {
+    AX_U32 nMagic;
+    AX_U8 nType;
+    AX_U8 nReserved[3];
+    AX_U32 nFeatureSize;
+    AX_U32 nCrc; // crc32 of record (nCrc as 0) and feature data
+    AX_CHAR szInfo[FEATURE_STORE_INFO_SIZE];
+} FEATURE_STORE_RECORD_T;
+
+typedef struct _FEATURE_STORE_ENTRY_T {
+    AX_U64 nOffset;
+    AX_U32 nFeatureSize;
+} FEATURE_STORE_ENTRY_T;
+
+/* pFeature points into the file mapping, valid during the call only and not aligned; return AX_FALSE to stop loading */
+typedef std::function<AX_BOOL(const std::string &strInfo, const AX_U8 *pFeature, AX_U32 nFeatureSize)> FEATURE_STORE_VISITOR;
+
+class CFeatureStore
+{
+public:
+    CFeatureStore(AX_VOID) = default;
+    ~CFeatureStore(AX_VOID);
+
+    AX_BOOL Open(const std::string &strPath);
+    AX_VOID Close(AX_VOID);
+
+    /* live features in file order as of the call, visited without the store locks */
+    AX_BOOL Load(const FEATURE_STORE_VISITOR &visitor);
+
+    /* info is truncated to FEATURE_STORE_INFO_SIZE - 1, an existing entry is replaced */
+    AX_BOOL Put(const std::string &strInfo, const AX_U8 *pFeature, AX_U32 nFeatureSize);
+    AX_BOOL Delete(const std::string &strInfo);
+    /* nFeatureSize must match the stored size */
+    AX_BOOL Get(const std::string &strInfo, AX_U8 *pFeature, AX_U32 nFeatureSize);
+    AX_BOOL IsExist(const std::string &strInfo);
+    AX_U32 Size(AX_VOID);
+
+    AX_BOOL Compact(AX_VOID);
+
+    static AX_U32 Crc32(AX_U32 nCrc, const AX_VOID *pData, AX_U32 nSize);
+
+private:
+    AX_BOOL Recover(AX_VOID);
+    AX_BOOL IsLegacy(AX_VOID);
+    AX_BOOL Migrate(AX_VOID);
+    AX_BOOL Append(FEATURE_STORE_RECORD_TYPE_E eType, const std::string &strInfo, const AX_U8 *pFeature, AX_U32 nFeatureSize,
+                   AX_U64 &nOffset);
+    static AX_BOOL WriteFile(AX_S32 nFd, AX_S32 nSrcFd, std::unordered_map<std::string, FEATURE_STORE_ENTRY_T> &mapIndex,
+                             AX_U64 &nFileSize);
+    AX_BOOL Reopen(AX_VOID);
+    AX_BOOL NeedCompact(AX_VOID) const;
+    AX_BOOL DoCompact(AX_VOID);
+    AX_VOID CompactThreadFunc(AX_VOID);
+
+    AX_BOOL CheckHead(const FEATURE_STORE_HEAD_T &tHead);
+
+    static AX_U32 RecordSize(AX_U32 nFeatureSize);
+    static std::string RecordInfo(const FEATURE_STORE_RECORD_T &tRecord);
+
+private:
+    std::mutex m_mutex; // index, counters; m_nFd and m_nFileSize change under m_mtxAppend and m_mutex both
+    std::mutex m_mtxAppend; // one writer at a time, held across pwrite and fdatasync without m_mutex
+    std::mutex m_mtxCompact; // one compaction at a time, order m_mtxCompact, m_mtxAppend, m_mutex
+    std::string m_strPath;
+    AX_S32 m_nFd{-1};
+    AX_U64 m_nFileSize{0};
+    std::unordered_map<std::string, FEATURE_STORE_ENTRY_T> m_mapIndex;
+    AX_U64 m_nLiveBytes{0};
+    AX_U64 m_nDeadBytes{0};
+    AX_U64 m_nCompactFailDead{0}; // dead bytes when the last compaction failed, 0 after success
+
+    std::thread *m_pCompactThread{nullptr};
+    std::condition_variable m_cvCompact;
+    AX_BOOL m_bCompactRunning{AX_FALSE};
+    AX_BOOL m_bCompactPending{AX_FALSE};
+};
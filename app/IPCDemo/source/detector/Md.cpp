@@ -9,6 +9,7 @@
  **********************************************************************************/
 #include "Md.h"
 #include <errno.h>
+#include <new>
 #include <stdlib.h>
 #include <string.h>
 #include "AppLog.h"
@@ -16,6 +17,7 @@
 #include "inifile.h"
 
 #define MD ("MD")
+#define MD_SOFT_BENCH_ENV_STR "MD_SOFT_BENCH"
 #define IS_MDCHN_CREATE(ch) ((ch) >= 0)
 
 static inline AX_U32 GetConfidenceMBCount(AX_U8 nConfidence, const AX_IVES_RECT_S &stArea, const AX_IVES_MB_SIZE_S &stMB) {
@@ -40,14 +42,23 @@ AX_BOOL CMD::Startup(AX_U32 nWidth, AX_U32 nHeight) {
         return AX_TRUE;
     }
 
-    AX_S32 ret = AX_IVES_MD_Init();
-    if (0 != ret) {
-        LOG_M_E(MD, "MD init fail, ret = 0x%x", ret);
-        return AX_FALSE;
-    }
-
     LoadConfig();
 
+    if (!m_bSoft) {
+        AX_S32 ret = AX_IVES_MD_Init();
+        if (0 != ret) {
+            LOG_M_E(MD, "MD init fail, ret = 0x%x", ret);
+            return AX_FALSE;
+        }
+    } else {
+        LOG_M(MD, "MD by soft engine, mb: %dx%d, learn shift: %d", m_stMbSize.u32W, m_stMbSize.u32H, m_nLearnShift);
+
+        if (getenv(MD_SOFT_BENCH_ENV_STR)) {
+            LOG_M(MD, "soft MD 1080p: %.3f ms/frame", CMotionDetector::Benchmark(1920, 1080, 100));
+            LOG_M(MD, "soft MD 4K: %.3f ms/frame", CMotionDetector::Benchmark(3840, 2160, 50));
+        }
+    }
+
     m_mdImgW = nWidth;
     m_mdImgH = nHeight;
 
@@ -66,10 +77,12 @@ AX_VOID CMD::Cleanup(AX_VOID) {
     if (m_bInited) {
         DestoryAreas();
 
-        AX_S32 ret = AX_IVES_MD_DeInit();
-        if (0 != ret) {
-            /* ignore error */
-            LOG_M_E(MD, "MD de-init fail, ret = 0x%x", ret);
+        if (!m_bSoft) {
+            AX_S32 ret = AX_IVES_MD_DeInit();
+            if (0 != ret) {
+                /* ignore error */
+                LOG_M_E(MD, "MD de-init fail, ret = 0x%x", ret);
+            }
         }
 
         m_bInited = AX_FALSE;
@@ -89,6 +102,8 @@ AX_VOID CMD::DestoryAreas(AX_VOID) {
                 }
             }
 
+            delete m->pSoft;
+            delete m->pRegion;
             free(m);
             m = nullptr;
         }
@@ -96,6 +111,10 @@ AX_VOID CMD::DestoryAreas(AX_VOID) {
 
     m_vecAreas.clear();
     m_vecRslts.clear();
+
+    std::lock_guard<std::mutex> lckRegion(m_mtxRegion);
+    m_vecRegions.clear();
+    m_nRegionSeqNum = 0;
 }
 
 AX_BOOL CMD::LoadConfig(AX_VOID) {
@@ -123,6 +142,18 @@ AX_BOOL CMD::LoadConfig(AX_VOID) {
         }
         f.GetIntValue(strSect, "threshold Y", &m_nThrdY);
         f.GetIntValue(strSect, "confidence", &m_nConfidenceY);
+
+        m_bSoft = AX_FALSE;
+        if (0 == f.GetStringValue(strSect, "engine", &strVal)) {
+            m_bSoft = (strVal == "soft") ? AX_TRUE : AX_FALSE;
+        }
+        f.GetIntValue(strSect, "learn shift", &m_nLearnShift);
+        f.GetIntValue(strSect, "region hold", &m_nRegionHold);
+        f.GetIntValue(strSect, "roi qp", &m_nRoiQp);
+        if (m_nRoiQp < -51 || m_nRoiQp > 51) {
+            LOG_M_W(MD, "roi qp %d out of [-51, 51], ROI disabled", m_nRoiQp);
+            m_nRoiQp = 0;
+        }
     } else {
         LOG_M_E(MD, "invalid %s file: no section: %s", strIniFile.c_str(), strSect.c_str());
         return AX_FALSE;
@@ -184,7 +215,26 @@ AX_S32 CMD::AddArea(AX_U32 x, AX_U32 y, AX_U32 w, AX_U32 h, AX_U32 nWidth, AX_U3
     pArea->stAttr.u8ThrY = m_nThrdY;
     pArea->nConfidence = GetConfidenceMBCount(m_nConfidenceY, stArea, m_stMbSize);
 
-    if (m_bInited) {
+    pArea->pRegion = new (std::nothrow) CMotionRegion();
+    if (!pArea->pRegion || !pArea->pRegion->Init(stArea.u32X, stArea.u32Y, stArea.u32W / m_stMbSize.u32W, stArea.u32H / m_stMbSize.u32H,
+                                                 m_stMbSize.u32W, m_stMbSize.u32H, m_nRegionHold)) {
+        LOG_M_E(MD, "init motion region of area [%d, %d, %d, %d] fail", stArea.u32X, stArea.u32Y, stArea.u32W, stArea.u32H);
+        delete pArea->pRegion;
+        free(pArea);
+        return -1;
+    }
+
+    if (m_bSoft) {
+        pArea->pSoft = new (std::nothrow) CMotionDetector();
+        if (!pArea->pSoft || !pArea->pSoft->Init(stArea.u32X, stArea.u32Y, stArea.u32W, stArea.u32H, m_stMbSize.u32W,
+                                                 m_stMbSize.u32H, m_nThrdY, m_nLearnShift)) {
+            LOG_M_E(MD, "init soft MD of area [%d, %d, %d, %d] fail", stArea.u32X, stArea.u32Y, stArea.u32W, stArea.u32H);
+            delete pArea->pSoft;
+            delete pArea->pRegion;
+            free(pArea);
+            return -1;
+        }
+    } else if (m_bInited) {
         if (nAreaId < 0) {
             pArea->stAttr.mdChn = (AX_S32)nCount;
         } else {
@@ -193,6 +243,7 @@ AX_S32 CMD::AddArea(AX_U32 x, AX_U32 y, AX_U32 w, AX_U32 h, AX_U32 nWidth, AX_U3
         AX_S32 ret = AX_IVES_MD_CreateChn(pArea->stAttr.mdChn, &pArea->stAttr);
         if (0 != ret) {
             LOG_M_E(MD, "Create MD channel %d fail, ret = 0x%x", pArea->stAttr.mdChn, ret);
+            delete pArea->pRegion;
             free(pArea);
             return -1;
         }
@@ -236,6 +287,8 @@ AX_BOOL CMD::RemoveArea(AX_S32 nAreaId) {
                 }
             }
 
+            delete m_vecAreas[i]->pSoft;
+            delete m_vecAreas[i]->pRegion;
             free(m_vecAreas[i]);
             m_vecAreas[i] = nullptr;
             m_vecRslts[i] = 0;
@@ -256,10 +309,33 @@ const std::vector<AX_U8> &CMD::ProcessFrame(const CMediaFrame *pFrame) {
     AX_S32 ret;
     AX_IVES_IMAGE_S *pstImg = (AX_IVES_IMAGE_S *)&pFrame->tVideoFrame;
 
+    m_vecFrameRegions.clear();
+
     const AX_U32 nAreaCount = m_vecAreas.size();
     for (AX_U32 i = 0; i < nAreaCount; ++i) {
         MD_AREA_ATTR_T *m = m_vecAreas[i];
-        if (m) {
+        if (!m) {
+            continue;
+        }
+
+        const AX_U8 *pBlocks = nullptr;
+        AX_U32 nSumThrs = 0;
+        AX_U64 nTick1 = 0;
+        AX_U64 nTick2 = 0;
+
+        if (m->pSoft) {
+            const AX_IVES_RECT_S &stArea = m->stAttr.stArea;
+            if (0 == pstImg->u64VirAddr[0] || stArea.u32X + stArea.u32W > pstImg->u32Width
+                || stArea.u32Y + stArea.u32H > pstImg->u32Height) {
+                LOG_M_E(MD, "frame id: %lld, %dx%d not valid for area %d", pstImg->u64SeqNum, pstImg->u32Width, pstImg->u32Height, i);
+                continue;
+            }
+
+            nTick1 = CTimeUtils::GetTickCount();
+            nSumThrs = m->pSoft->Process((const AX_U8 *)pstImg->u64VirAddr[0], pstImg->u32PicStride[0]);
+            nTick2 = CTimeUtils::GetTickCount();
+            pBlocks = m->pSoft->GetBlocks().data();
+        } else {
             if (!IS_MDCHN_CREATE(m->stAttr.mdChn)) {
                 m->stAttr.mdChn = i;
                 ret = AX_IVES_MD_CreateChn(m->stAttr.mdChn, &m_vecAreas[i]->stAttr);
@@ -271,35 +347,59 @@ const std::vector<AX_U8> &CMD::ProcessFrame(const CMediaFrame *pFrame) {
             }
 
             AX_MD_MB_THR_S stThrs{0, nullptr};
-            AX_U64 nTick1 = CTimeUtils::GetTickCount();
+            nTick1 = CTimeUtils::GetTickCount();
             ret = AX_IVES_MD_Process(m->stAttr.mdChn, pstImg, &stThrs);
-            AX_U64 nTick2 = CTimeUtils::GetTickCount();
+            nTick2 = CTimeUtils::GetTickCount();
             if (0 != ret) {
                 LOG_M_E(MD, "frame id: %lld, MD process area %d fail, ret = 0x%x", pstImg->u64SeqNum, i, ret);
                 continue;
-            } else {
-                AX_U32 nSumThrs = 0;
-                for (AX_U32 k = 0; k < stThrs.u32Count; ++k) {
-                    nSumThrs += stThrs.pMbThrs[k];
-                }
+            }
 
-                AX_U8 nLastRslt = m_vecRslts[i];
+            for (AX_U32 k = 0; k < stThrs.u32Count; ++k) {
+                nSumThrs += stThrs.pMbThrs[k];
+            }
 
-                /* marked 1 if the count of '1' mb > confidence */
-                m_vecRslts[i] = (nSumThrs >= m->nConfidence) ? 1 : 0;
-                LOG_M_I(MD, "frame id: %lld, area %d md: %d, elapsed: %lld ms", pstImg->u64SeqNum, i, m_vecRslts[i], nTick2 - nTick1);
+            if (stThrs.u32Count == (m->stAttr.stArea.u32W / m->stAttr.stMbSize.u32W) * (m->stAttr.stArea.u32H / m->stAttr.stMbSize.u32H)) {
+                pBlocks = stThrs.pMbThrs;
+            }
+        }
 
-                if (1 == m_vecRslts[i] && nLastRslt != m_vecRslts[i]) {
-                    SendWebEvent(i);
-                }
+        if (pBlocks && m->pRegion) {
+            for (auto &tRegion : m->pRegion->Update(pBlocks)) {
+                m_vecFrameRegions.push_back({(AX_S32)i, tRegion});
             }
         }
+
+        /* marked 1 if the count of '1' mb > confidence */
+        m_vecRslts[i] = (nSumThrs >= m->nConfidence) ? 1 : 0;
+        LOG_M_I(MD, "frame id: %lld, area %d md: %d, elapsed: %lld ms", pstImg->u64SeqNum, i, m_vecRslts[i], nTick2 - nTick1);
+
+        /* every triggering frame, CEventAggregator makes start/ongoing/end of it */
+        if (1 == m_vecRslts[i]) {
+            SendWebEvent(i);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lckRegion(m_mtxRegion);
+        m_vecRegions.swap(m_vecFrameRegions);
+        m_nRegionSeqNum = pstImg->u64SeqNum;
+        m_nRegionImgW = pstImg->u32Width;
+        m_nRegionImgH = pstImg->u32Height;
     }
 
     LOG_M_D(MD, "---");
     return m_vecRslts;
 }
 
+AX_U64 CMD::GetRegions(std::vector<MD_REGION_T> &vecRegions, AX_U32 &nImgW, AX_U32 &nImgH) {
+    std::lock_guard<std::mutex> lck(m_mtxRegion);
+    vecRegions = m_vecRegions;
+    nImgW = m_nRegionImgW;
+    nImgH = m_nRegionImgH;
+    return m_nRegionSeqNum;
+}
+
 AX_BOOL CMD::SetThresholdY(AX_S32 nAreaId, AX_U8 nThrd, AX_U8 nConfidence) {
     if (nAreaId < 0) {
         LOG_M_E(MD, "invalid area id %d", nAreaId);
@@ -314,6 +414,9 @@ AX_BOOL CMD::SetThresholdY(AX_S32 nAreaId, AX_U8 nThrd, AX_U8 nConfidence) {
         return AX_FALSE;
     } else {
         m_vecAreas[nAreaId]->stAttr.u8ThrY = nThrd;
+        if (m_vecAreas[nAreaId]->pSoft) {
+            m_vecAreas[nAreaId]->pSoft->SetThresholdY(nThrd);
+        }
         m_vecAreas[nAreaId]->nConfidence =
             GetConfidenceMBCount(nConfidence, m_vecAreas[nAreaId]->stAttr.stArea, m_vecAreas[nAreaId]->stAttr.stMbSize);
     }
@@ -322,20 +425,15 @@ AX_BOOL CMD::SetThresholdY(AX_S32 nAreaId, AX_U8 nThrd, AX_U8 nConfidence) {
     return AX_TRUE;
 }
 
-AX_VOID CMD::SetWebServer(CWebServer *pWebServer) {
-    m_pWebServer = pWebServer;
-}
-
 AX_VOID CMD::GetDefaultThresholdY(AX_U8 &nThrd, AX_U8 &nConfidence) {
     nThrd = m_nThrdY;
     nConfidence = m_nConfidenceY;
 }
 
 AX_VOID CMD::SendWebEvent(AX_S32 nAreaId) {
-    if (m_pWebServer) {
-        WEB_EVENTS_DATA_T tEvent;
-        tEvent.eType = E_WEB_EVENTS_TYPE_MD;
-        tEvent.tMD.nAreaID = nAreaId;
-        m_pWebServer->SendEventsData(&tEvent);
-    }
+    WEB_EVENTS_DATA_T tEvent;
+    tEvent.eType = E_WEB_EVENTS_TYPE_MD;
+    tEvent.tMD.nAreaID = nAreaId;
+
+    CEventAggregator::GetInstance()->Trigger(tEvent);
 }
\ No newline at end of file
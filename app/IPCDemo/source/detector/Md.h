@@ -12,19 +12,32 @@
 #include <vector>
 #include "ax_ives_api.h"
 #include "MediaFrame.h"
-#include "WebServer.h"
+#include "EventAggregator.h"
 #include "Singleton.h"
+#include "MotionDetector.h"
+#include "MotionRegion.h"
 
+/**
+ * engine of ive.conf [MD]:
+ *   ives: AX_IVES_MD channel per area (default)
+ *   soft: CMotionDetector per area on the Y plane, no IVES channel limit
+ */
 typedef struct {
     AX_MD_CHN_ATTR_S stAttr;
     AX_U32 nConfidence;
+    CMotionDetector *pSoft; /* soft engine only */
+    CMotionRegion *pRegion;
 } MD_AREA_ATTR_T;
 
+typedef struct {
+    AX_S32 nAreaId;
+    MOTION_REGION_T tRegion;
+} MD_REGION_T;
+
 class CMD : public CSingleton<CMD> {
     friend class CSingleton<CMD>;
 
 public:
-    AX_VOID SetWebServer(CWebServer *pWebServer);
 
     AX_BOOL Startup(AX_U32 nWidth, AX_U32 nHeight);
     AX_VOID Cleanup(AX_VOID);
@@ -40,6 +53,13 @@ public:
     /* process and return md results */
     const std::vector<AX_U8> &ProcessFrame(const CMediaFrame *pFrame);
 
+    /* motion regions of all areas in the last processed frame, in pixels of its nImgW x nImgH image,
+       returns its frame id, 0 if no frame was processed since Startup */
+    AX_U64 GetRegions(std::vector<MD_REGION_T> &vecRegions, AX_U32 &nImgW, AX_U32 &nImgH);
+
+    /* relative QP encoders give motion regions (ive.conf [MD] roi qp), 0 means no ROI */
+    AX_S32 GetRoiQp(AX_VOID) const { return m_nRoiQp; }
+
 protected:
     AX_BOOL IsEqualArea(const AX_IVES_RECT_S &a, const AX_IVES_RECT_S &b) const {
         return ((a.u32X == b.u32X) && (a.u32Y == b.u32Y) && (a.u32W == b.u32W) && (a.u32H == b.u32H)) ? AX_TRUE : AX_FALSE;
@@ -63,12 +83,23 @@ private:
     std::mutex m_mutx;
     std::vector<MD_AREA_ATTR_T *> m_vecAreas;
     std::vector<AX_U8> m_vecRslts;
+    std::vector<MD_REGION_T> m_vecFrameRegions;
     AX_BOOL m_bInited{AX_FALSE};
     AX_S32 m_nConfidenceY{20};
     AX_S32 m_nThrdY{50};
     AX_IVES_MB_SIZE_S m_stMbSize{32,32};
+    AX_BOOL m_bSoft{AX_FALSE};
+    AX_S32 m_nLearnShift{MOTION_DETECTOR_DEFAULT_LEARN_SHIFT};
+    AX_S32 m_nRegionHold{MOTION_REGION_DEFAULT_HOLD};
+    AX_S32 m_nRoiQp{0};
     AX_U32 m_mdImgW{0};
     AX_U32 m_mdImgH{0};
 
-    CWebServer *m_pWebServer{nullptr};
+    /* published regions, not guarded by m_mutx so readers never wait for a frame */
+    std::mutex m_mtxRegion;
+    std::vector<MD_REGION_T> m_vecRegions;
+    AX_U64 m_nRegionSeqNum{0};
+    AX_U32 m_nRegionImgW{0};
+    AX_U32 m_nRegionImgH{0};
+
 };
\ No newline at end of file
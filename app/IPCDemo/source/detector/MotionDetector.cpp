@@ -0,0 +1,255 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include "MotionDetector.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define MOTION_DETECTOR_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define MOTION_DETECTOR_SSE
+#endif
+
+#define MOTION_DETECTOR_MAX_LEARN_SHIFT (7) // (255 << shift) + 255 stays in AX_U16
+
+AX_BOOL CMotionDetector::Init(AX_U32 nX, AX_U32 nY, AX_U32 nW, AX_U32 nH, AX_U32 nMbW, AX_U32 nMbH, AX_U8 nThrY,
+                              AX_U32 nLearnShift /* = MOTION_DETECTOR_DEFAULT_LEARN_SHIFT */)
+{
+    if (nMbW < 2 || nMbH < 2 || (nMbW & 1) || (nMbH & 1) || (nX & 1) || (nY & 1)) {
+        return AX_FALSE;
+    }
+
+    if (0 == nW || 0 == nH || (nW % nMbW) || (nH % nMbH)) {
+        return AX_FALSE;
+    }
+
+    m_nX = nX;
+    m_nY = nY;
+    m_nW = nW / 2;
+    m_nH = nH / 2;
+    m_nBlockW = nMbW / 2;
+    m_nBlockH = nMbH / 2;
+    m_nCols = nW / nMbW;
+    m_nRows = nH / nMbH;
+    m_nThrY = nThrY;
+    m_nLearnShift = std::min(std::max(nLearnShift, (AX_U32)1), (AX_U32)MOTION_DETECTOR_MAX_LEARN_SHIFT);
+
+    m_vecBackground.assign((size_t)m_nW * m_nH, 0);
+    m_vecRow.assign(m_nW, 0);
+    m_vecSad.assign((size_t)m_nCols * m_nRows, 0);
+    m_vecBlock.assign((size_t)m_nCols * m_nRows, 0);
+    m_bPrimed = AX_FALSE;
+
+    return AX_TRUE;
+}
+
+AX_VOID CMotionDetector::SetThresholdY(AX_U8 nThrY)
+{
+    m_nThrY = nThrY;
+}
+
+AX_VOID CMotionDetector::Reset(AX_VOID)
+{
+    m_bPrimed = AX_FALSE;
+    std::fill(m_vecBlock.begin(), m_vecBlock.end(), 0);
+}
+
+AX_U32 CMotionDetector::Process(const AX_U8 *pY, AX_U32 nStride)
+{
+    if (!pY || 0 == m_nW) {
+        return 0;
+    }
+
+    const AX_U8 *pBase = pY + (size_t)m_nY * nStride + m_nX;
+    std::fill(m_vecSad.begin(), m_vecSad.end(), 0);
+
+    for (AX_U32 r = 0; r < m_nH; r++) {
+        const AX_U8 *pRow0 = pBase + (size_t)2 * r * nStride;
+        const AX_U8 *pRow1 = pRow0 + nStride;
+        AX_U8 *pBg = m_vecBackground.data() + (size_t)r * m_nW;
+
+        if (!m_bPrimed) {
+            Downsample(pRow0, pRow1, pBg, m_nW);
+            continue;
+        }
+
+        // the row is compared and learnt while in cache, the downsampled frame is never stored
+        AX_U8 *pRow = m_vecRow.data();
+        Downsample(pRow0, pRow1, pRow, m_nW);
+
+        AX_U32 *pSad = m_vecSad.data() + (r / m_nBlockH) * m_nCols;
+        for (AX_U32 c = 0; c < m_nCols; c++) {
+            pSad[c] += Sad(pRow + c * m_nBlockW, pBg + c * m_nBlockW, m_nBlockW);
+        }
+
+        Learn(pBg, pRow, m_nW, m_nLearnShift);
+    }
+
+    if (!m_bPrimed) {
+        m_bPrimed = AX_TRUE;
+        std::fill(m_vecBlock.begin(), m_vecBlock.end(), 0);
+        return 0;
+    }
+
+    const AX_U32 nThrSad = (AX_U32)m_nThrY * m_nBlockW * m_nBlockH;
+    AX_U32 nMoving = 0;
+    for (size_t i = 0; i < m_vecSad.size(); i++) {
+        m_vecBlock[i] = (m_vecSad[i] >= nThrSad) ? 1 : 0;
+        nMoving += m_vecBlock[i];
+    }
+
+    return nMoving;
+}
+
+AX_VOID CMotionDetector::Downsample(const AX_U8 *pRow0, const AX_U8 *pRow1, AX_U8 *pDst, AX_U32 n)
+{
+    AX_U32 i = 0;
+#if defined(MOTION_DETECTOR_NEON)
+    for (; i + 16 <= n; i += 16) {
+        uint16x8_t vLo = vpaddlq_u8(vld1q_u8(pRow0 + 2 * i));
+        uint16x8_t vHi = vpaddlq_u8(vld1q_u8(pRow0 + 2 * i + 16));
+        vLo = vpadalq_u8(vLo, vld1q_u8(pRow1 + 2 * i));
+        vHi = vpadalq_u8(vHi, vld1q_u8(pRow1 + 2 * i + 16));
+        vst1q_u8(pDst + i, vcombine_u8(vrshrn_n_u16(vLo, 2), vrshrn_n_u16(vHi, 2)));
+    }
+#elif defined(MOTION_DETECTOR_SSE)
+    const __m128i vMask = _mm_set1_epi16(0x00FF);
+    const __m128i vRound = _mm_set1_epi16(2);
+    for (; i + 16 <= n; i += 16) {
+        __m128i vA0 = _mm_loadu_si128((const __m128i *)(pRow0 + 2 * i));
+        __m128i vA1 = _mm_loadu_si128((const __m128i *)(pRow0 + 2 * i + 16));
+        __m128i vB0 = _mm_loadu_si128((const __m128i *)(pRow1 + 2 * i));
+        __m128i vB1 = _mm_loadu_si128((const __m128i *)(pRow1 + 2 * i + 16));
+        // even and odd pixels of both rows summed in int16
+        __m128i vLo = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(vA0, vMask), _mm_srli_epi16(vA0, 8)),
+                                    _mm_add_epi16(_mm_and_si128(vB0, vMask), _mm_srli_epi16(vB0, 8)));
+        __m128i vHi = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(vA1, vMask), _mm_srli_epi16(vA1, 8)),
+                                    _mm_add_epi16(_mm_and_si128(vB1, vMask), _mm_srli_epi16(vB1, 8)));
+        vLo = _mm_srli_epi16(_mm_add_epi16(vLo, vRound), 2);
+        vHi = _mm_srli_epi16(_mm_add_epi16(vHi, vRound), 2);
+        _mm_storeu_si128((__m128i *)(pDst + i), _mm_packus_epi16(vLo, vHi));
+    }
+#endif
+    for (; i < n; i++) {
+        pDst[i] = (AX_U8)((pRow0[2 * i] + pRow0[2 * i + 1] + pRow1[2 * i] + pRow1[2 * i + 1] + 2) >> 2);
+    }
+}
+
+AX_U32 CMotionDetector::Sad(const AX_U8 *pA, const AX_U8 *pB, AX_U32 n)
+{
+    AX_U32 nSum = 0;
+    AX_U32 i = 0;
+#if defined(MOTION_DETECTOR_NEON)
+    uint32x4_t vSum = vdupq_n_u32(0);
+    for (; i + 16 <= n; i += 16) {
+        vSum = vpadalq_u16(vSum, vpaddlq_u8(vabdq_u8(vld1q_u8(pA + i), vld1q_u8(pB + i))));
+    }
+    uint32x2_t vSum2 = vadd_u32(vget_low_u32(vSum), vget_high_u32(vSum));
+    nSum = vget_lane_u32(vpadd_u32(vSum2, vSum2), 0);
+#elif defined(MOTION_DETECTOR_SSE)
+    __m128i vSum = _mm_setzero_si128();
+    for (; i + 16 <= n; i += 16) {
+        vSum = _mm_add_epi64(vSum, _mm_sad_epu8(_mm_loadu_si128((const __m128i *)(pA + i)),
+                                                _mm_loadu_si128((const __m128i *)(pB + i))));
+    }
+    nSum = (AX_U32)_mm_cvtsi128_si32(vSum) + (AX_U32)_mm_cvtsi128_si32(_mm_srli_si128(vSum, 8));
+#endif
+    for (; i < n; i++) {
+        nSum += (pA[i] > pB[i]) ? (pA[i] - pB[i]) : (pB[i] - pA[i]);
+    }
+
+    return nSum;
+}
+
+AX_VOID CMotionDetector::Learn(AX_U8 *pBg, const AX_U8 *pCur, AX_U32 n, AX_U32 nShift)
+{
+    AX_U32 i = 0;
+    // bg = (bg * (2^shift - 1) + cur + round) >> shift
+#if defined(MOTION_DETECTOR_NEON)
+    const int16x8_t vShl = vdupq_n_s16((int16_t)nShift);
+    const int16x8_t vShr = vdupq_n_s16(-(int16_t)nShift);
+    for (; i + 16 <= n; i += 16) {
+        uint8x16_t vBg = vld1q_u8(pBg + i);
+        uint8x16_t vCur = vld1q_u8(pCur + i);
+        uint16x8_t vBgLo = vmovl_u8(vget_low_u8(vBg));
+        uint16x8_t vBgHi = vmovl_u8(vget_high_u8(vBg));
+        uint16x8_t vLo = vaddw_u8(vsubq_u16(vshlq_u16(vBgLo, vShl), vBgLo), vget_low_u8(vCur));
+        uint16x8_t vHi = vaddw_u8(vsubq_u16(vshlq_u16(vBgHi, vShl), vBgHi), vget_high_u8(vCur));
+        vst1q_u8(pBg + i, vcombine_u8(vmovn_u16(vrshlq_u16(vLo, vShr)), vmovn_u16(vrshlq_u16(vHi, vShr))));
+    }
+#elif defined(MOTION_DETECTOR_SSE)
+    const __m128i vZero = _mm_setzero_si128();
+    const __m128i vCount = _mm_cvtsi32_si128((int)nShift);
+    const __m128i vRound = _mm_set1_epi16((short)(1 << (nShift - 1)));
+    for (; i + 16 <= n; i += 16) {
+        __m128i vBg = _mm_loadu_si128((const __m128i *)(pBg + i));
+        __m128i vCur = _mm_loadu_si128((const __m128i *)(pCur + i));
+        __m128i vBgLo = _mm_unpacklo_epi8(vBg, vZero);
+        __m128i vBgHi = _mm_unpackhi_epi8(vBg, vZero);
+        __m128i vLo = _mm_add_epi16(_mm_sub_epi16(_mm_sll_epi16(vBgLo, vCount), vBgLo), _mm_unpacklo_epi8(vCur, vZero));
+        __m128i vHi = _mm_add_epi16(_mm_sub_epi16(_mm_sll_epi16(vBgHi, vCount), vBgHi), _mm_unpackhi_epi8(vCur, vZero));
+        vLo = _mm_srl_epi16(_mm_add_epi16(vLo, vRound), vCount);
+        vHi = _mm_srl_epi16(_mm_add_epi16(vHi, vRound), vCount);
+        _mm_storeu_si128((__m128i *)(pBg + i), _mm_packus_epi16(vLo, vHi));
+    }
+#endif
+    for (; i < n; i++) {
+        pBg[i] = (AX_U8)((((AX_U32)pBg[i] << nShift) - pBg[i] + pCur[i] + (1 << (nShift - 1))) >> nShift);
+    }
+}
+
+AX_F32 CMotionDetector::Benchmark(AX_U32 nWidth, AX_U32 nHeight, AX_U32 nFrames)
+{
+    const AX_U32 nMb = 32;
+    nWidth = nWidth / nMb * nMb;
+    nHeight = nHeight / nMb * nMb;
+
+    CMotionDetector md;
+    if (0 == nFrames || !md.Init(0, 0, nWidth, nHeight, nMb, nMb, 20)) {
+        return 0;
+    }
+
+    // textured still background with a bright square moving over it
+    std::vector<AX_U8> vecY((size_t)nWidth * nHeight);
+    for (AX_U32 y = 0; y < nHeight; y++) {
+        for (AX_U32 x = 0; x < nWidth; x++) {
+            vecY[(size_t)y * nWidth + x] = (AX_U8)((x * 7 + y * 13) & 0x7F);
+        }
+    }
+
+    const AX_U32 nSquare = nHeight / 4;
+    AX_U64 nTotalUs = 0;
+    for (AX_U32 f = 0; f <= nFrames; f++) {
+        AX_U32 nLeft = (f * 16) % (nWidth - nSquare);
+        for (AX_U32 y = nHeight / 4; y < nHeight / 4 + nSquare; y++) {
+            memset(vecY.data() + (size_t)y * nWidth + nLeft, 0xF0, nSquare);
+        }
+
+        auto tpStart = std::chrono::steady_clock::now();
+        md.Process(vecY.data(), nWidth);
+        auto tpEnd = std::chrono::steady_clock::now();
+
+        // first frame only primes the background
+        if (f > 0) {
+            nTotalUs += std::chrono::duration_cast<std::chrono::microseconds>(tpEnd - tpStart).count();
+        }
+
+        for (AX_U32 y = nHeight / 4; y < nHeight / 4 + nSquare; y++) {
+            for (AX_U32 x = nLeft; x < nLeft + nSquare; x++) {
+                vecY[(size_t)y * nWidth + x] = (AX_U8)((x * 7 + y * 13) & 0x7F);
+            }
+        }
+    }
+
+    return (AX_F32)nTotalUs / 1000 / nFrames;
+}
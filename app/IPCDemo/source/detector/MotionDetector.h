@@ -0,0 +1,76 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+#pragma once
+#include <vector>
+#include "global.h"
+
+/**
+ * Software motion detector of one area
+ * The Y plane of the area is downsampled 2x2 and compared with a running background
+ * of the same size, a block (one MB of the full resolution) is moving when its mean
+ * absolute difference reaches the Y threshold. Downsampling, SAD and background
+ * update are done row by row in one pass with NEON/SSE kernels.
+ * Depends on nothing but the Y plane, so it runs on any channel and off-device.
+ */
+#define MOTION_DETECTOR_DEFAULT_LEARN_SHIFT (3) // background moves 1/8 towards each frame
+
+class CMotionDetector
+{
+public:
+    CMotionDetector(AX_VOID) = default;
+
+    /* area in pixels of the Y plane, x/y even, w/h multiples of the MB size */
+    AX_BOOL Init(AX_U32 nX, AX_U32 nY, AX_U32 nW, AX_U32 nH, AX_U32 nMbW, AX_U32 nMbH, AX_U8 nThrY,
+                 AX_U32 nLearnShift = MOTION_DETECTOR_DEFAULT_LEARN_SHIFT);
+    AX_VOID SetThresholdY(AX_U8 nThrY);
+    /* next frame becomes the background */
+    AX_VOID Reset(AX_VOID);
+
+    /* pY is the Y plane of the whole frame, returns the count of moving blocks */
+    AX_U32 Process(const AX_U8 *pY, AX_U32 nStride);
+
+    /* one byte per block row by row, 1 is moving, valid after Process */
+    const std::vector<AX_U8> &GetBlocks(AX_VOID) const {
+        return m_vecBlock;
+    }
+    AX_U32 GetCols(AX_VOID) const {
+        return m_nCols;
+    }
+    AX_U32 GetRows(AX_VOID) const {
+        return m_nRows;
+    }
+
+    /* ms per frame of a full frame area with 32x32 MB, synthetic moving content */
+    static AX_F32 Benchmark(AX_U32 nWidth, AX_U32 nHeight, AX_U32 nFrames);
+
+    /* one downsampled row of n pixels from two source rows */
+    static AX_VOID Downsample(const AX_U8 *pRow0, const AX_U8 *pRow1, AX_U8 *pDst, AX_U32 n);
+    static AX_U32 Sad(const AX_U8 *pA, const AX_U8 *pB, AX_U32 n);
+    /* pBg += (pCur - pBg) >> nShift, rounded */
+    static AX_VOID Learn(AX_U8 *pBg, const AX_U8 *pCur, AX_U32 n, AX_U32 nShift);
+
+private:
+    AX_U32 m_nX{0};
+    AX_U32 m_nY{0};
+    AX_U32 m_nW{0};  // downsampled
+    AX_U32 m_nH{0};  // downsampled
+    AX_U32 m_nBlockW{0};  // downsampled
+    AX_U32 m_nBlockH{0};  // downsampled
+    AX_U32 m_nCols{0};
+    AX_U32 m_nRows{0};
+    AX_U8 m_nThrY{0};
+    AX_U32 m_nLearnShift{MOTION_DETECTOR_DEFAULT_LEARN_SHIFT};
+    AX_BOOL m_bPrimed{AX_FALSE};
+
+    std::vector<AX_U8> m_vecBackground;
+    std::vector<AX_U8> m_vecRow;
+    std::vector<AX_U32> m_vecSad;
+    std::vector<AX_U8> m_vecBlock;
+};
@@ -0,0 +1,191 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+#include <algorithm>
+#include "MotionRegion.h"
+
+#define MOTION_REGION_MAX_HOLD (254)
+
+AX_BOOL CMotionRegion::Init(AX_U32 nX, AX_U32 nY, AX_U32 nCols, AX_U32 nRows, AX_U32 nMbW, AX_U32 nMbH,
+                            AX_U32 nHold /* = MOTION_REGION_DEFAULT_HOLD */, AX_U32 nMargin /* = MOTION_REGION_DEFAULT_MARGIN */,
+                            AX_U32 nMaxRegions /* = MOTION_REGION_MAX_NUM */)
+{
+    if (0 == nCols || 0 == nRows || 0 == nMbW || 0 == nMbH || 0 == nMaxRegions) {
+        return AX_FALSE;
+    }
+
+    m_nX = nX;
+    m_nY = nY;
+    m_nCols = nCols;
+    m_nRows = nRows;
+    m_nMbW = nMbW;
+    m_nMbH = nMbH;
+    m_nHold = std::min(nHold, (AX_U32)MOTION_REGION_MAX_HOLD);
+    m_nMargin = nMargin;
+    m_nMaxRegions = nMaxRegions;
+
+    m_vecHold.assign((size_t)nCols * nRows, 0);
+    m_vecVisited.assign((size_t)nCols * nRows, 0);
+    m_vecStack.reserve((size_t)nCols * nRows);
+    m_vecBox.reserve(nMaxRegions * 2);
+    m_vecRegions.reserve(nMaxRegions);
+
+    return AX_TRUE;
+}
+
+AX_VOID CMotionRegion::Reset(AX_VOID)
+{
+    std::fill(m_vecHold.begin(), m_vecHold.end(), 0);
+    m_vecRegions.clear();
+}
+
+const std::vector<MOTION_REGION_T> &CMotionRegion::Update(const AX_U8 *pBlocks)
+{
+    m_vecRegions.clear();
+    m_vecBox.clear();
+
+    if (!pBlocks || m_vecHold.empty()) {
+        return m_vecRegions;
+    }
+
+    const AX_U32 nCount = m_nCols * m_nRows;
+    for (AX_U32 i = 0; i < nCount; i++) {
+        if (pBlocks[i]) {
+            m_vecHold[i] = (AX_U8)(m_nHold + 1);
+        } else if (m_vecHold[i] > 0) {
+            m_vecHold[i]--;
+        }
+    }
+
+    std::fill(m_vecVisited.begin(), m_vecVisited.end(), 0);
+
+    // components are seeded from moving blocks only, held blocks just join them
+    for (AX_U32 nSeed = 0; nSeed < nCount; nSeed++) {
+        if (!pBlocks[nSeed] || m_vecVisited[nSeed]) {
+            continue;
+        }
+
+        BOX_T tBox = {nSeed % m_nCols, nSeed / m_nCols, nSeed % m_nCols, nSeed / m_nCols, 0};
+
+        m_vecStack.clear();
+        m_vecStack.push_back(nSeed);
+        m_vecVisited[nSeed] = 1;
+
+        while (!m_vecStack.empty()) {
+            AX_U32 nIndex = m_vecStack.back();
+            m_vecStack.pop_back();
+
+            AX_U32 c = nIndex % m_nCols;
+            AX_U32 r = nIndex / m_nCols;
+            tBox.nLeft = std::min(tBox.nLeft, c);
+            tBox.nRight = std::max(tBox.nRight, c);
+            tBox.nTop = std::min(tBox.nTop, r);
+            tBox.nBottom = std::max(tBox.nBottom, r);
+            tBox.nMoving += pBlocks[nIndex] ? 1 : 0;
+
+            AX_U32 nR0 = (r > 0) ? r - 1 : 0;
+            AX_U32 nR1 = std::min(r + 1, m_nRows - 1);
+            AX_U32 nC0 = (c > 0) ? c - 1 : 0;
+            AX_U32 nC1 = std::min(c + 1, m_nCols - 1);
+            for (AX_U32 rr = nR0; rr <= nR1; rr++) {
+                for (AX_U32 cc = nC0; cc <= nC1; cc++) {
+                    AX_U32 nNext = rr * m_nCols + cc;
+                    if (!m_vecVisited[nNext] && m_vecHold[nNext] > 0) {
+                        m_vecVisited[nNext] = 1;
+                        m_vecStack.push_back(nNext);
+                    }
+                }
+            }
+        }
+
+        tBox.nLeft = (tBox.nLeft > m_nMargin) ? tBox.nLeft - m_nMargin : 0;
+        tBox.nTop = (tBox.nTop > m_nMargin) ? tBox.nTop - m_nMargin : 0;
+        tBox.nRight = std::min(tBox.nRight + m_nMargin, m_nCols - 1);
+        tBox.nBottom = std::min(tBox.nBottom + m_nMargin, m_nRows - 1);
+
+        m_vecBox.push_back(tBox);
+    }
+
+    Merge();
+
+    for (auto &tBox : m_vecBox) {
+        MOTION_REGION_T tRegion;
+        tRegion.nX = m_nX + tBox.nLeft * m_nMbW;
+        tRegion.nY = m_nY + tBox.nTop * m_nMbH;
+        tRegion.nW = (tBox.nRight - tBox.nLeft + 1) * m_nMbW;
+        tRegion.nH = (tBox.nBottom - tBox.nTop + 1) * m_nMbH;
+        tRegion.nMoving = tBox.nMoving;
+        m_vecRegions.push_back(tRegion);
+    }
+
+    return m_vecRegions;
+}
+
+AX_BOOL CMotionRegion::IsTouched(const BOX_T &a, const BOX_T &b)
+{
+    return (a.nLeft <= b.nRight + 1 && b.nLeft <= a.nRight + 1 && a.nTop <= b.nBottom + 1 && b.nTop <= a.nBottom + 1)
+           ? AX_TRUE : AX_FALSE;
+}
+
+CMotionRegion::BOX_T CMotionRegion::Union(const BOX_T &a, const BOX_T &b)
+{
+    BOX_T tBox;
+    tBox.nLeft = std::min(a.nLeft, b.nLeft);
+    tBox.nTop = std::min(a.nTop, b.nTop);
+    tBox.nRight = std::max(a.nRight, b.nRight);
+    tBox.nBottom = std::max(a.nBottom, b.nBottom);
+    tBox.nMoving = a.nMoving + b.nMoving;
+    return tBox;
+}
+
+AX_U32 CMotionRegion::BoxArea(const BOX_T &a)
+{
+    return (a.nRight - a.nLeft + 1) * (a.nBottom - a.nTop + 1);
+}
+
+AX_VOID CMotionRegion::Merge(AX_VOID)
+{
+    // touching boxes, until nothing changes since a union may reach further boxes
+    AX_BOOL bMerged = AX_TRUE;
+    while (bMerged) {
+        bMerged = AX_FALSE;
+        for (size_t i = 0; i < m_vecBox.size(); i++) {
+            for (size_t j = i + 1; j < m_vecBox.size();) {
+                if (IsTouched(m_vecBox[i], m_vecBox[j])) {
+                    m_vecBox[i] = Union(m_vecBox[i], m_vecBox[j]);
+                    m_vecBox.erase(m_vecBox.begin() + j);
+                    bMerged = AX_TRUE;
+                } else {
+                    j++;
+                }
+            }
+        }
+    }
+
+    // too many regions: merge the pair growing the covered area least
+    while (m_vecBox.size() > m_nMaxRegions) {
+        size_t nBestI = 0;
+        size_t nBestJ = 1;
+        AX_S32 nBestGrow = -1;
+        for (size_t i = 0; i < m_vecBox.size(); i++) {
+            for (size_t j = i + 1; j < m_vecBox.size(); j++) {
+                // boxes do not touch any more, so the union covers both
+                AX_S32 nGrow = (AX_S32)(BoxArea(Union(m_vecBox[i], m_vecBox[j])) - BoxArea(m_vecBox[i]) - BoxArea(m_vecBox[j]));
+                if (nBestGrow < 0 || nGrow < nBestGrow) {
+                    nBestGrow = nGrow;
+                    nBestI = i;
+                    nBestJ = j;
+                }
+            }
+        }
+
+        m_vecBox[nBestI] = Union(m_vecBox[nBestI], m_vecBox[nBestJ]);
+        m_vecBox.erase(m_vecBox.begin() + nBestJ);
+    }
+}
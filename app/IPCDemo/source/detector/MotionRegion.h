@@ -0,0 +1,78 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+#pragma once
+#include <vector>
+#include "global.h"
+
+/**
+ * Motion regions of one MD area
+ * Turns the per-MB motion bitmap into bounding regions. A block stays active for a few
+ * frames after it last moved (hysteresis), active blocks are grouped into 8-connected
+ * components and a component is kept only if one of its blocks moves in this frame,
+ * so held blocks bridge gaps of a moving object but never raise a region by themselves.
+ * Boxes are grown by a margin of blocks and overlapping ones are merged.
+ */
+#define MOTION_REGION_DEFAULT_HOLD (3)   // frames a block stays active after it last moved
+#define MOTION_REGION_DEFAULT_MARGIN (1) // blocks added around a region
+#define MOTION_REGION_MAX_NUM (16)
+
+typedef struct _MOTION_REGION_T {
+    AX_U32 nX;  // pixels of the frame
+    AX_U32 nY;
+    AX_U32 nW;
+    AX_U32 nH;
+    AX_U32 nMoving;  // blocks moving in this frame
+} MOTION_REGION_T;
+
+class CMotionRegion
+{
+public:
+    CMotionRegion(AX_VOID) = default;
+
+    /* grid of nCols x nRows MBs of nMbW x nMbH pixels, placed at (nX, nY) of the frame */
+    AX_BOOL Init(AX_U32 nX, AX_U32 nY, AX_U32 nCols, AX_U32 nRows, AX_U32 nMbW, AX_U32 nMbH,
+                 AX_U32 nHold = MOTION_REGION_DEFAULT_HOLD, AX_U32 nMargin = MOTION_REGION_DEFAULT_MARGIN,
+                 AX_U32 nMaxRegions = MOTION_REGION_MAX_NUM);
+    AX_VOID Reset(AX_VOID);
+
+    /* pBlocks holds one byte per MB row by row, non-zero is moving */
+    const std::vector<MOTION_REGION_T> &Update(const AX_U8 *pBlocks);
+
+private:
+    typedef struct {
+        AX_U32 nLeft;  // blocks, inclusive
+        AX_U32 nTop;
+        AX_U32 nRight;
+        AX_U32 nBottom;
+        AX_U32 nMoving;
+    } BOX_T;
+
+    static AX_BOOL IsTouched(const BOX_T &a, const BOX_T &b);
+    static BOX_T Union(const BOX_T &a, const BOX_T &b);
+    static AX_U32 BoxArea(const BOX_T &a);
+    AX_VOID Merge(AX_VOID);
+
+private:
+    AX_U32 m_nX{0};
+    AX_U32 m_nY{0};
+    AX_U32 m_nCols{0};
+    AX_U32 m_nRows{0};
+    AX_U32 m_nMbW{0};
+    AX_U32 m_nMbH{0};
+    AX_U32 m_nHold{MOTION_REGION_DEFAULT_HOLD};
+    AX_U32 m_nMargin{MOTION_REGION_DEFAULT_MARGIN};
+    AX_U32 m_nMaxRegions{MOTION_REGION_MAX_NUM};
+
+    std::vector<AX_U8> m_vecHold;      // frames left active, hold + 1 when moving now
+    std::vector<AX_U8> m_vecVisited;
+    std::vector<AX_U32> m_vecStack;
+    std::vector<BOX_T> m_vecBox;
+    std::vector<MOTION_REGION_T> m_vecRegions;
+};
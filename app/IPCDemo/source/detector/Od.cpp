@@ -274,7 +274,6 @@ const std::vector<AX_U8> &COD::ProcessFrame(const CMediaFrame *pFrame) {
 
             ++m->nFrameProcessed;
 
-            AX_U8 nLastRslt = m_vecRslts[i];
             AX_U64 nTick1 = CTimeUtils::GetTickCount();
             ret = AX_IVES_OD_Process(m->stAttr.odChn, &stImg, &m_vecRslts[i]);
             AX_U64 nTick2 = CTimeUtils::GetTickCount();
@@ -285,7 +284,8 @@ const std::vector<AX_U8> &COD::ProcessFrame(const CMediaFrame *pFrame) {
                 LOG_M_I(OD, "frame id: %lld (%lld), area %d od: %d, lux: %d, elapsed: %lld ms", stImg.pstImg->u64SeqNum,
                              m->nFrameProcessed, i, m_vecRslts[i], stImg.u32Lux, nTick2 - nTick1);
 
-                if (1 == m_vecRslts[i] && nLastRslt != m_vecRslts[i]) {
+                /* every triggering frame, CEventAggregator makes start/ongoing/end of it */
+                if (1 == m_vecRslts[i]) {
                     SendWebEvent(i);
                 }
             }
@@ -338,20 +338,15 @@ AX_BOOL COD::SetLuxThreshold(AX_S32 nAreaId, AX_U32 nThrd, AX_U32 nDiff) {
     return AX_TRUE;
 }
 
-AX_VOID COD::SetWebServer(CWebServer *pWebServer) {
-    m_pWebServer = pWebServer;
-}
-
 AX_VOID COD::GetDefaultThresholdY(AX_U8 &nThrd, AX_U8 &nConfidence) {
     nThrd = m_nThrdY;
     nConfidence = m_nConfidenceY;
 }
 
 AX_VOID COD::SendWebEvent(AX_S32 nAreaId) {
-    if (m_pWebServer) {
-        WEB_EVENTS_DATA_T tEvent;
-        tEvent.eType = E_WEB_EVENTS_TYPE_OD;
-        tEvent.tMD.nAreaID = nAreaId;
-        m_pWebServer->SendEventsData(&tEvent);
-    }
+    WEB_EVENTS_DATA_T tEvent;
+    tEvent.eType = E_WEB_EVENTS_TYPE_OD;
+    tEvent.tOD.nAreaID = nAreaId;
+
+    CEventAggregator::GetInstance()->Trigger(tEvent);
 }
@@ -12,7 +12,7 @@
 #include <vector>
 #include "MediaFrame.h"
 #include "ax_ives_api.h"
-#include "WebServer.h"
+#include "EventAggregator.h"
 #include "Singleton.h"
 
 typedef struct {
@@ -24,7 +24,6 @@ class COD : public CSingleton<COD> {
     friend class CSingleton<COD>;
 
 public:
-    AX_VOID SetWebServer(CWebServer *pWebServer);
 
     AX_BOOL Startup(AX_U32 nFrameRate, AX_U32 nWidth, AX_U32 nHeight);
     AX_VOID Cleanup(AX_VOID);
@@ -77,5 +76,4 @@ private:
     AX_S32 m_nLuxDiff{60};
     AX_BOOL m_bInited{AX_FALSE};
 
-    CWebServer *m_pWebServer{nullptr};
 };
\ No newline at end of file
@@ -8,16 +8,14 @@
  *
  **********************************************************************************/
 #include "Scd.h"
+#include <stdlib.h>
 #include <string>
 #include <string.h>
 #include "AppLog.h"
 #include "inifile.h"
 
 #define SCD "SCD"
-
-AX_VOID CSCD::SetWebServer(CWebServer *pWebServer) {
-    m_pWebServer = pWebServer;
-}
+#define SCD_SOFT_BENCH_ENV_STR "SCD_SOFT_BENCH"
 
 AX_BOOL CSCD::LoadConfig(AX_VOID) {
     inifile::IniFile f;
@@ -30,13 +28,42 @@ AX_BOOL CSCD::LoadConfig(AX_VOID) {
 
     f.GetIntValueOrDefault("SCD", "threshold", &m_nThrd, 60);
     f.GetIntValueOrDefault("SCD", "confidence", &m_nConfidence, 60);
+    f.GetIntValueOrDefault("SCD", "frames", &m_nFrames, 5);
+
+    std::string strEngine;
+    m_bSoft = (0 == f.GetStringValue("SCD", "engine", &strEngine) && strEngine == "soft") ? AX_TRUE : AX_FALSE;
 
     return AX_TRUE;
 }
 
+SCENE_DETECTOR_CONFIG_T CSCD::GetSoftConfig(AX_VOID) const {
+    SCENE_DETECTOR_CONFIG_T tConfig;
+    tConfig.nChangeThrd = (m_nThrd > 0) ? (AX_U32)m_nThrd : 1;
+    tConfig.nSensitivity = (m_nConfidence > 0) ? (AX_U32)m_nConfidence : 0;
+    tConfig.nFrames = (m_nFrames > 0) ? (AX_U32)m_nFrames : 1;
+    return tConfig;
+}
+
 AX_BOOL CSCD::Startup(AX_U32 nWidth, AX_U32 nHeight) {
     LoadConfig();
 
+    if (m_bSoft) {
+        std::lock_guard<std::mutex> lck(m_mtxSoft);
+        if (!m_tSoft.Init(nWidth, nHeight, GetSoftConfig())) {
+            LOG_M_E(SCD, "soft SCD init %dx%d fail", nWidth, nHeight);
+            return AX_FALSE;
+        }
+
+        LOG_M(SCD, "SCD by soft engine, threshold: %d, sensitivity: %d, frames: %d", m_nThrd, m_nConfidence, m_nFrames);
+
+        if (getenv(SCD_SOFT_BENCH_ENV_STR)) {
+            LOG_M(SCD, "soft SCD 1080p: %.3f ms/frame", CSceneDetector::Benchmark(1920, 1080, 200));
+            LOG_M(SCD, "soft SCD 4K: %.3f ms/frame", CSceneDetector::Benchmark(3840, 2160, 200));
+        }
+
+        return AX_TRUE;
+    }
+
     AX_S32 ret = AX_IVES_SCD_Init();
     if (0 != ret) {
         LOG_M_E(SCD, "AX_IVES_SCD_Init() fail, ret = 0x%x", ret);
@@ -66,6 +93,12 @@ AX_BOOL CSCD::Startup(AX_U32 nWidth, AX_U32 nHeight) {
 }
 
 AX_VOID CSCD::Cleanup(AX_VOID) {
+    if (m_bSoft) {
+        std::lock_guard<std::mutex> lck(m_mtxSoft);
+        m_tSoft.Reset();
+        return;
+    }
+
     if (m_chn > 0) {
         AX_IVES_SCD_DestoryChn(m_chn);
         m_chn = 0;
@@ -75,6 +108,43 @@ AX_VOID CSCD::Cleanup(AX_VOID) {
 }
 
 AX_BOOL CSCD::ProcessFrame(const CMediaFrame *pFrame) {
+    if (m_bSoft) {
+        const AX_VIDEO_FRAME_S &tFrame = pFrame->tVideoFrame;
+        if (0 == tFrame.u64VirAddr[0]) {
+            LOG_M_E(SCD, "frame %lld has no virtual address", tFrame.u64SeqNum);
+            return AX_FALSE;
+        }
+
+        SCENE_DETECTOR_EVENT_E eEvent;
+        SCENE_DETECTOR_EVENT_E eState;
+        SCENE_DETECTOR_STAT_T tStat;
+        {
+            /* Update may re-Init from the web thread, stat is copied with the result */
+            std::lock_guard<std::mutex> lck(m_mtxSoft);
+            if (tFrame.u32Width != m_tSoft.GetWidth() || tFrame.u32Height != m_tSoft.GetHeight()) {
+                LOG_M_E(SCD, "frame %lld: %dx%d, soft SCD is inited for %dx%d, skipped", tFrame.u64SeqNum, tFrame.u32Width,
+                        tFrame.u32Height, m_tSoft.GetWidth(), m_tSoft.GetHeight());
+                return AX_FALSE;
+            }
+
+            eEvent = m_tSoft.Process((const AX_U8 *)tFrame.u64VirAddr[0], tFrame.u32PicStride[0], tFrame.u32Width, tFrame.u32Height);
+            eState = m_tSoft.GetState();
+            tStat = m_tSoft.GetStat();
+        }
+
+        if (SCENE_DETECTOR_EVENT_NONE != eEvent) {
+            LOG_M(SCD, "frame %lld: %s, hist distance: %.1f, edge ratio: %.2f, luma ratio: %.2f", tFrame.u64SeqNum,
+                  CSceneDetector::EventName(eEvent), tStat.fHistDistance, tStat.fEdgeRatio, tStat.fLumaRatio);
+
+            SendWebEvent(eEvent);
+        } else if (SCENE_DETECTOR_EVENT_NONE != eState) {
+            /* still covered or defocused, keeps the event ongoing */
+            SendWebEvent(eState);
+        }
+
+        return AX_TRUE;
+    }
+
     if (m_chn <= 0) {
         LOG_M_E(SCD, "SCD channel is not created yet.");
         return AX_FALSE;
@@ -88,17 +158,34 @@ AX_BOOL CSCD::ProcessFrame(const CMediaFrame *pFrame) {
         return AX_FALSE;
     }
 
-    if (m_pWebServer && (1 == nChanged)) {
-        WEB_EVENTS_DATA_T tEvent;
-        memset(&tEvent, 0, sizeof(tEvent));
-        tEvent.eType = E_WEB_EVENTS_TYPE_SCD;
-        m_pWebServer->SendEventsData(&tEvent);
+    if (1 == nChanged) {
+        SendWebEvent(SCENE_DETECTOR_EVENT_CHANGE);
     }
 
     return AX_TRUE;
 }
 
+/* same SCD event for every reason, info tells which one and nReserved carries SCENE_DETECTOR_EVENT_E */
+AX_VOID CSCD::SendWebEvent(SCENE_DETECTOR_EVENT_E eEvent) {
+    WEB_EVENTS_DATA_T tEvent;
+    memset(&tEvent, 0, sizeof(tEvent));
+    tEvent.eType = E_WEB_EVENTS_TYPE_SCD;
+    tEvent.tSCD.nReserved = (AX_U64)eEvent;
+    snprintf(tEvent.tSCD.szDisplay, sizeof(tEvent.tSCD.szDisplay), "%s", CSceneDetector::EventName(eEvent));
+
+    CEventAggregator::GetInstance()->Trigger(tEvent);
+}
+
 AX_VOID CSCD::SetThreshold(AX_S32 nThreshold, AX_S32 nConfidence) {
+    if (m_bSoft) {
+        m_nThrd = nThreshold;
+        m_nConfidence = nConfidence;
+
+        std::lock_guard<std::mutex> lck(m_mtxSoft);
+        m_tSoft.SetConfig(GetSoftConfig());
+        return;
+    }
+
     if (m_chn > 0) {
         AX_SCD_CHN_ATTR_S stChnAttr;
         AX_S32 ret = AX_IVES_SCD_GetChnAttr(m_chn, &stChnAttr);
@@ -126,6 +213,11 @@ AX_VOID CSCD::GetThreshold(AX_S32 &nThreshold, AX_S32 &nConfidence) const {
 }
 
 AX_VOID CSCD::Update(AX_U32 u32W, AX_U32 u32H) {
+    if (m_bSoft) {
+        std::lock_guard<std::mutex> lck(m_mtxSoft);
+        m_tSoft.Init(u32W, u32H, GetSoftConfig());
+        return;
+    }
 
     if (m_chn <= 0) {
         return;
@@ -8,16 +8,23 @@
  *
  **********************************************************************************/
 #pragma once
+#include <mutex>
 #include "Singleton.h"
-#include "WebServer.h"
+#include "EventAggregator.h"
 #include "MediaFrame.h"
 #include "ax_ives_api.h"
+#include "SceneDetector.h"
 
+/**
+ * engine of ive.conf [SCD]:
+ *   ives: AX_IVES_SCD channel (default)
+ *   soft: CSceneDetector, threshold is the histogram distance (%) of a scene change,
+ *         confidence the defocus/cover sensitivity (0 ~ 100), "frames" the frames to confirm
+ */
 class CSCD : public CSingleton<CSCD> {
     friend class CSingleton<CSCD>;
 
 public:
-    AX_VOID SetWebServer(CWebServer *pWebServer);
     AX_BOOL Startup(AX_U32 nWidth, AX_U32 nHeight);
     AX_VOID Cleanup(AX_VOID);
     AX_BOOL ProcessFrame(const CMediaFrame *pFrame);
@@ -27,6 +34,8 @@ public:
 
 protected:
     AX_BOOL LoadConfig(AX_VOID);
+    AX_VOID SendWebEvent(SCENE_DETECTOR_EVENT_E eEvent);
+    SCENE_DETECTOR_CONFIG_T GetSoftConfig(AX_VOID) const;
 
 private:
     CSCD(AX_VOID) noexcept = default;
@@ -39,8 +48,12 @@ private:
     };
 
 private:
-    CWebServer *m_pWebServer{nullptr};
     SCD_CHN m_chn{0};
     AX_S32 m_nThrd{60};
     AX_S32 m_nConfidence{60};
+
+    AX_BOOL m_bSoft{AX_FALSE};
+    AX_S32 m_nFrames{5};
+    std::mutex m_mtxSoft;
+    CSceneDetector m_tSoft;
 };
\ No newline at end of file
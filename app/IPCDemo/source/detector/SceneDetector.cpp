@@ -0,0 +1,221 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "SceneDetector.h"
+
+#define SCENE_DETECTOR_LEARN_RATE (1.0f / 32)
+#define SCENE_DETECTOR_MIN_REF_EDGE (2.0f) // a flat scene has no edge to lose, defocus is not judged
+#define SCENE_DETECTOR_MIN_REF_LUMA (8.0f)
+
+AX_BOOL CSceneDetector::Init(AX_U32 nWidth, AX_U32 nHeight, const SCENE_DETECTOR_CONFIG_T &tConfig)
+{
+    if (nWidth < 4 || nHeight < 4) {
+        return AX_FALSE;
+    }
+
+    m_nWidth = nWidth;
+    m_nHeight = nHeight;
+    m_nGridW = std::min(nWidth / 2, (AX_U32)SCENE_DETECTOR_GRID_W);
+    m_nGridH = std::min(nHeight / 2, (AX_U32)SCENE_DETECTOR_GRID_H);
+
+    for (AX_U32 i = 0; i < m_nGridW; i++) {
+        m_arrCol[i] = (i * nWidth / m_nGridW) & ~1;
+    }
+
+    SetConfig(tConfig);
+    Reset();
+
+    return AX_TRUE;
+}
+
+AX_VOID CSceneDetector::SetConfig(const SCENE_DETECTOR_CONFIG_T &tConfig)
+{
+    m_tConfig = tConfig;
+    m_tConfig.nChangeThrd = std::min(std::max(m_tConfig.nChangeThrd, (AX_U32)1), (AX_U32)100);
+    m_tConfig.nSensitivity = std::min(m_tConfig.nSensitivity, (AX_U32)100);
+    m_tConfig.nFrames = std::max(m_tConfig.nFrames, (AX_U32)1);
+}
+
+AX_VOID CSceneDetector::Reset(AX_VOID)
+{
+    m_nFrames = 0;
+    m_ePending = SCENE_DETECTOR_EVENT_NONE;
+    m_nPendingFrames = 0;
+    m_eActive = SCENE_DETECTOR_EVENT_NONE;
+    memset(&m_tStat, 0, sizeof(m_tStat));
+    memset(m_arrRefHist, 0, sizeof(m_arrRefHist));
+    m_fRefEdge = 0;
+    m_fRefLuma = 0;
+}
+
+AX_VOID CSceneDetector::Sample(const AX_U8 *pY, AX_U32 nStride)
+{
+    memset(m_arrHist, 0, sizeof(m_arrHist));
+
+    AX_U32 nLuma = 0;
+    AX_U32 nEdge = 0;
+    for (AX_U32 gy = 0; gy < m_nGridH; gy++) {
+        const AX_U8 *pRow0 = pY + (size_t)((gy * m_nHeight / m_nGridH) & ~1) * nStride;
+        const AX_U8 *pRow1 = pRow0 + nStride;
+
+        for (AX_U32 gx = 0; gx < m_nGridW; gx++) {
+            AX_U32 x = m_arrCol[gx];
+            AX_S32 a = pRow0[x];
+            AX_S32 b = pRow0[x + 1];
+            AX_S32 c = pRow1[x];
+            AX_S32 d = pRow1[x + 1];
+            AX_U32 v = (AX_U32)(a + b + c + d + 2) >> 2;
+
+            m_arrHist[v * SCENE_DETECTOR_HIST_BINS / 256]++;
+            nLuma += v;
+            nEdge += abs(a - d) + abs(b - c);
+        }
+    }
+
+    AX_F32 fCells = (AX_F32)(m_nGridW * m_nGridH);
+    m_fLuma = nLuma / fCells;
+    m_fEdge = nEdge / fCells;
+}
+
+AX_VOID CSceneDetector::Learn(AX_BOOL bSeed)
+{
+    AX_F32 fCells = (AX_F32)(m_nGridW * m_nGridH);
+    AX_F32 fRate = bSeed ? 1.0f : SCENE_DETECTOR_LEARN_RATE;
+
+    for (AX_U32 i = 0; i < SCENE_DETECTOR_HIST_BINS; i++) {
+        m_arrRefHist[i] += (m_arrHist[i] / fCells - m_arrRefHist[i]) * fRate;
+    }
+    m_fRefEdge += (m_fEdge - m_fRefEdge) * fRate;
+    m_fRefLuma += (m_fLuma - m_fRefLuma) * fRate;
+}
+
+SCENE_DETECTOR_EVENT_E CSceneDetector::Process(const AX_U8 *pY, AX_U32 nStride, AX_U32 nWidth, AX_U32 nHeight)
+{
+    if (!pY || 0 == m_nGridW || nWidth != m_nWidth || nHeight != m_nHeight || nStride < nWidth) {
+        return SCENE_DETECTOR_EVENT_NONE;
+    }
+
+    Sample(pY, nStride);
+
+    if (0 == m_nFrames++) {
+        Learn(AX_TRUE);
+        return SCENE_DETECTOR_EVENT_NONE;
+    }
+
+    AX_F32 fCells = (AX_F32)(m_nGridW * m_nGridH);
+    AX_F32 fDistance = 0;
+    for (AX_U32 i = 0; i < SCENE_DETECTOR_HIST_BINS; i++) {
+        fDistance += fabsf(m_arrHist[i] / fCells - m_arrRefHist[i]);
+    }
+
+    m_tStat.fHistDistance = fDistance * 50;
+    m_tStat.fEdgeRatio = m_fEdge / std::max(m_fRefEdge, SCENE_DETECTOR_MIN_REF_EDGE);
+    m_tStat.fLumaRatio = m_fLuma / std::max(m_fRefLuma, SCENE_DETECTOR_MIN_REF_LUMA);
+    m_tStat.fMeanLuma = m_fLuma;
+
+    if (m_nFrames <= SCENE_DETECTOR_WARMUP_FRAMES) {
+        Learn(AX_FALSE);
+        return SCENE_DETECTOR_EVENT_NONE;
+    }
+
+    // sensitivity 50: covered below 32% of reference luma, defocused below 40% of reference edge
+    AX_F32 fSensitivity = m_tConfig.nSensitivity / 100.0f;
+    AX_F32 fCoverRatio = 0.15f + 0.35f * fSensitivity;
+    AX_F32 fDefocusRatio = 0.2f + 0.4f * fSensitivity;
+
+    SCENE_DETECTOR_EVENT_E eCondition = SCENE_DETECTOR_EVENT_NONE;
+    if (m_fRefLuma >= SCENE_DETECTOR_MIN_REF_LUMA && m_tStat.fLumaRatio < fCoverRatio) {
+        eCondition = SCENE_DETECTOR_EVENT_COVER;
+    } else if (m_fRefEdge >= SCENE_DETECTOR_MIN_REF_EDGE && m_tStat.fEdgeRatio < fDefocusRatio) {
+        eCondition = SCENE_DETECTOR_EVENT_DEFOCUS;
+    } else if (m_tStat.fHistDistance >= m_tConfig.nChangeThrd) {
+        eCondition = SCENE_DETECTOR_EVENT_CHANGE;
+    }
+
+    if (SCENE_DETECTOR_EVENT_NONE == eCondition) {
+        m_ePending = SCENE_DETECTOR_EVENT_NONE;
+        m_nPendingFrames = 0;
+        m_eActive = SCENE_DETECTOR_EVENT_NONE;
+        Learn(AX_FALSE);
+        return SCENE_DETECTOR_EVENT_NONE;
+    }
+
+    if (eCondition == m_eActive) {
+        return SCENE_DETECTOR_EVENT_NONE;
+    }
+
+    if (eCondition != m_ePending) {
+        m_ePending = eCondition;
+        m_nPendingFrames = 0;
+    }
+
+    if (++m_nPendingFrames < m_tConfig.nFrames) {
+        return SCENE_DETECTOR_EVENT_NONE;
+    }
+
+    m_ePending = SCENE_DETECTOR_EVENT_NONE;
+    m_nPendingFrames = 0;
+
+    if (SCENE_DETECTOR_EVENT_CHANGE == eCondition) {
+        // camera moved or the scene was rebuilt, this is the new normal
+        Learn(AX_TRUE);
+        m_eActive = SCENE_DETECTOR_EVENT_NONE;
+    } else {
+        m_eActive = eCondition;
+    }
+
+    return eCondition;
+}
+
+const AX_CHAR *CSceneDetector::EventName(SCENE_DETECTOR_EVENT_E eEvent)
+{
+    switch (eEvent) {
+        case SCENE_DETECTOR_EVENT_CHANGE:
+            return "scene change";
+        case SCENE_DETECTOR_EVENT_DEFOCUS:
+            return "defocus";
+        case SCENE_DETECTOR_EVENT_COVER:
+            return "covered";
+        default:
+            return "none";
+    }
+}
+
+AX_F32 CSceneDetector::Benchmark(AX_U32 nWidth, AX_U32 nHeight, AX_U32 nFrames)
+{
+    CSceneDetector scd;
+    SCENE_DETECTOR_CONFIG_T tConfig;
+    if (0 == nFrames || !scd.Init(nWidth, nHeight, tConfig)) {
+        return 0;
+    }
+
+    std::vector<AX_U8> vecY((size_t)nWidth * nHeight);
+    AX_U64 nTotalUs = 0;
+    for (AX_U32 f = 0; f < nFrames; f++) {
+        if (0 == f % 50) {
+            AX_U32 nSeed = f / 50 + 1;
+            for (size_t i = 0; i < vecY.size(); i++) {
+                vecY[i] = (AX_U8)((i * nSeed * 7 + (i / nWidth) * 13) & 0xFF);
+            }
+        }
+
+        auto tpStart = std::chrono::steady_clock::now();
+        scd.Process(vecY.data(), nWidth, nWidth, nHeight);
+        auto tpEnd = std::chrono::steady_clock::now();
+        nTotalUs += std::chrono::duration_cast<std::chrono::microseconds>(tpEnd - tpStart).count();
+    }
+
+    return (AX_F32)nTotalUs / 1000 / nFrames;
+}
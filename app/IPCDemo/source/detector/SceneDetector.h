@@ -0,0 +1,120 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+#pragma once
+#include "global.h"
+
+/**
+ * Software scene change and tamper detector
+ * The Y plane is sampled to a grid of at most SCENE_DETECTOR_GRID_W x SCENE_DETECTOR_GRID_H
+ * 2x2 cells, so only a few hundred KB of a 1080p frame are read. Luma histogram, edge
+ * energy (Roberts cross inside each cell, so a blur of a few pixels shows) and mean luma
+ * are gathered in the same pass and compared with a slowly learnt reference:
+ *   covered:      mean luma collapses below a ratio of the reference
+ *   defocused:    edge energy drops below a ratio of the reference
+ *   scene change: histogram distance (half L1, %) reaches the threshold
+ * A condition must hold for nFrames frames to raise an event. The reference stops
+ * learning while a condition is pending or active, and is re-seeded after a scene change.
+ */
+#define SCENE_DETECTOR_GRID_W (128)
+#define SCENE_DETECTOR_GRID_H (72)
+#define SCENE_DETECTOR_HIST_BINS (32)
+#define SCENE_DETECTOR_WARMUP_FRAMES (8)
+
+typedef enum _SCENE_DETECTOR_EVENT_E {
+    SCENE_DETECTOR_EVENT_NONE = 0,
+    SCENE_DETECTOR_EVENT_CHANGE,
+    SCENE_DETECTOR_EVENT_DEFOCUS,
+    SCENE_DETECTOR_EVENT_COVER
+} SCENE_DETECTOR_EVENT_E;
+
+typedef struct _SCENE_DETECTOR_CONFIG_T {
+    AX_U32 nChangeThrd;  // histogram distance (%) of a scene change, 1 ~ 100
+    AX_U32 nSensitivity; // 0 ~ 100, higher raises defocus and cover on a smaller drop
+    AX_U32 nFrames;      // consecutive frames before an event
+
+    _SCENE_DETECTOR_CONFIG_T() {
+        nChangeThrd = 60;
+        nSensitivity = 50;
+        nFrames = 5;
+    }
+} SCENE_DETECTOR_CONFIG_T;
+
+/* statistics of the last frame, ratios against the reference */
+typedef struct _SCENE_DETECTOR_STAT_T {
+    AX_F32 fHistDistance; // %
+    AX_F32 fEdgeRatio;
+    AX_F32 fLumaRatio;
+    AX_F32 fMeanLuma;
+} SCENE_DETECTOR_STAT_T;
+
+class CSceneDetector
+{
+public:
+    CSceneDetector(AX_VOID) = default;
+
+    AX_BOOL Init(AX_U32 nWidth, AX_U32 nHeight, const SCENE_DETECTOR_CONFIG_T &tConfig);
+    AX_VOID SetConfig(const SCENE_DETECTOR_CONFIG_T &tConfig);
+    const SCENE_DETECTOR_CONFIG_T &GetConfig(AX_VOID) const {
+        return m_tConfig;
+    }
+    AX_U32 GetWidth(AX_VOID) const {
+        return m_nWidth;
+    }
+    AX_U32 GetHeight(AX_VOID) const {
+        return m_nHeight;
+    }
+    /* learns the reference again from the next frame */
+    AX_VOID Reset(AX_VOID);
+
+    /* returns the event raised by this frame, an active condition is reported once,
+       a frame of another size than Init is skipped (NONE, nothing learnt) */
+    SCENE_DETECTOR_EVENT_E Process(const AX_U8 *pY, AX_U32 nStride, AX_U32 nWidth, AX_U32 nHeight);
+
+    /* condition currently held, NONE when the scene is normal */
+    SCENE_DETECTOR_EVENT_E GetState(AX_VOID) const {
+        return m_eActive;
+    }
+    const SCENE_DETECTOR_STAT_T &GetStat(AX_VOID) const {
+        return m_tStat;
+    }
+
+    static const AX_CHAR *EventName(SCENE_DETECTOR_EVENT_E eEvent);
+
+    /* ms per frame of nWidth x nHeight with a cut every 50 frames */
+    static AX_F32 Benchmark(AX_U32 nWidth, AX_U32 nHeight, AX_U32 nFrames);
+
+private:
+    AX_VOID Sample(const AX_U8 *pY, AX_U32 nStride);
+    AX_VOID Learn(AX_BOOL bSeed);
+
+private:
+    SCENE_DETECTOR_CONFIG_T m_tConfig;
+    AX_U32 m_nWidth{0};
+    AX_U32 m_nHeight{0};
+    AX_U32 m_nGridW{0};
+    AX_U32 m_nGridH{0};
+    AX_U32 m_nFrames{0};
+
+    /* this frame */
+    AX_U32 m_arrHist[SCENE_DETECTOR_HIST_BINS];
+    AX_F32 m_fEdge{0};
+    AX_F32 m_fLuma{0};
+    AX_U32 m_arrCol[SCENE_DETECTOR_GRID_W];
+
+    /* reference */
+    AX_F32 m_arrRefHist[SCENE_DETECTOR_HIST_BINS];
+    AX_F32 m_fRefEdge{0};
+    AX_F32 m_fRefLuma{0};
+
+    SCENE_DETECTOR_EVENT_E m_ePending{SCENE_DETECTOR_EVENT_NONE};
+    AX_U32 m_nPendingFrames{0};
+    SCENE_DETECTOR_EVENT_E m_eActive{SCENE_DETECTOR_EVENT_NONE};
+    SCENE_DETECTOR_STAT_T m_tStat{0, 0, 0, 0};
+};
@@ -37,16 +37,10 @@
 #define SEARCH_DEFAULT_ALGO_CONFIG_PATH "./config/search_config.json"
 
 #define SEARCH_WAITING_TIMEOUT 5000
-
-typedef struct {
-    AX_U8 Info[FEATURE_INFO_SIZE];
-    AX_U32 FeatureSize;
-} SEARCH_FEATURE_HEADER_ST;
-
-typedef struct {
-    SEARCH_FEATURE_HEADER_ST header;
-    AX_U8 Feature[0];
-} SEARCH_FEATURE_DB_ST;
+#define SEARCH_ENROLL_FRAME_TIMEOUT 10000 // ms, no detection frame came for a queued enrollment
+#define SEARCH_ENROLL_RESULT_TIMEOUT 3000 // ms, feature handle gave no result for a sent frame
+#define SEARCH_LOAD_BATCH_SIZE 256
+#define SEARCH_TRACK_EXPIRE 2000 // ms, a track not seen for this long is dropped from cache
 
 #define SEARCH_API_RUN_START(_API_NAME_) m_apiElapsed.reset()
 #define SEARCH_API_RUN_END(_API_NAME_) LOG_M_I(SEARCH, "Run API(%s) elapsed: %d(ms)", #_API_NAME_, m_apiElapsed.ms());
@@ -196,6 +190,59 @@ AX_BOOL get_search_init_param(SEARCH_PARAM_ST &stSearchParam, std::string config
         stSearchParam.capability = AI_SERACH_FACE_BASE_IMG_CAP_DEFAULT;
     }
 
+    if (PICO_ROOT["search_info"].PICO_OBJECT.end() != PICO_ROOT["search_info"].PICO_OBJECT.find("top_k")) {
+        stSearchParam.top_k = PICO_ROOT["search_info"].PICO_OBJECT["top_k"].PICO_VALUE;
+    }
+
+    if (stSearchParam.top_k == 0 || stSearchParam.top_k > FEATURE_INDEX_MAX_TOP_K) {
+        stSearchParam.top_k = 1;
+    }
+
+    if (PICO_ROOT["search_info"].PICO_OBJECT.end() != PICO_ROOT["search_info"].PICO_OBJECT.find("cpu_index")) {
+        stSearchParam.cpu_index = PICO_ROOT["search_info"].PICO_OBJECT["cpu_index"].PICO_BOOL ? AX_TRUE : AX_FALSE;
+    }
+
+    if (PICO_ROOT["search_info"].PICO_OBJECT.end() != PICO_ROOT["search_info"].PICO_OBJECT.find("cpu_index_bits")) {
+        stSearchParam.cpu_index_bits = PICO_ROOT["search_info"].PICO_OBJECT["cpu_index_bits"].PICO_VALUE;
+    }
+
+    if (stSearchParam.cpu_index_bits != 16 && stSearchParam.cpu_index_bits != 8) {
+        stSearchParam.cpu_index_bits = 32;
+    }
+
+    if (PICO_ROOT["search_info"].PICO_OBJECT.end() != PICO_ROOT["search_info"].PICO_OBJECT.find("track_cache")) {
+        stSearchParam.track_cache = PICO_ROOT["search_info"].PICO_OBJECT["track_cache"].PICO_BOOL ? AX_TRUE : AX_FALSE;
+    }
+
+    if (PICO_ROOT["search_info"].PICO_OBJECT.end() != PICO_ROOT["search_info"].PICO_OBJECT.find("track_cache_score")) {
+        stSearchParam.track_cache_score = PICO_ROOT["search_info"].PICO_OBJECT["track_cache_score"].PICO_VALUE;
+    }
+
+    if (PICO_ROOT["search_info"].PICO_OBJECT.end() != PICO_ROOT["search_info"].PICO_OBJECT.find("track_cache_ttl")) {
+        stSearchParam.track_cache_ttl = PICO_ROOT["search_info"].PICO_OBJECT["track_cache_ttl"].PICO_VALUE;
+    }
+
+    if (PICO_ROOT["search_info"].PICO_OBJECT.end() != PICO_ROOT["search_info"].PICO_OBJECT.find("track_max_search")) {
+        stSearchParam.track_max_search = PICO_ROOT["search_info"].PICO_OBJECT["track_max_search"].PICO_VALUE;
+    }
+
+    if (PICO_ROOT["search_info"].PICO_OBJECT.end() != PICO_ROOT["search_info"].PICO_OBJECT.find("track_avg_frames")) {
+        stSearchParam.track_avg_frames = PICO_ROOT["search_info"].PICO_OBJECT["track_avg_frames"].PICO_VALUE;
+    }
+
+    //default
+    if (stSearchParam.track_cache_score <= 0) {
+        stSearchParam.track_cache_score = stSearchParam.compare_score_threshold;
+    }
+
+    if (stSearchParam.track_max_search == 0) {
+        stSearchParam.track_max_search = 1;
+    }
+
+    if (stSearchParam.track_avg_frames == 0) {
+        stSearchParam.track_avg_frames = 1;
+    }
+
     return AX_TRUE;
 }
 }
@@ -208,17 +255,13 @@ CSearch::CSearch(AX_VOID)
 
     m_total_object_num = 0;
 
-    m_bFinished = AX_TRUE;
     m_bForedExit = AX_FALSE;
     m_bFeatureDataBaseLoaded = AX_FALSE;
 
     //Feature
-    memset(&m_feature_result, 0x00, sizeof(m_feature_result));
-    m_GetFeatureInfoStatus = 0;
     m_feature_handle = nullptr;
     m_bGetFeatureResultThreadRunning = AX_FALSE;
     m_pGetFeatureResultThread = nullptr;
-    m_bGetFeatureInfo = AX_FALSE;
 
     //Load
     m_bLoadFeatureDataBaseThreadRunning = AX_FALSE;
@@ -228,23 +271,6 @@ CSearch::CSearch(AX_VOID)
     m_stSearchParam.capability = 10000;
     m_stSearchParam.feature_algo_type = SEARCH_DEFAULT_ALGO_TYPE;
     m_stSearchParam.config_path = SEARCH_DEFAULT_ALGO_CONFIG_PATH;
-
-    // init mutex
-    if (0 != pthread_mutex_init(&m_condMutx, NULL)) {
-        LOG_M_W(SEARCH, "pthread_mutex_init() fail");
-    }
-
-    if (0 != pthread_condattr_init(&m_condattr)) {
-        LOG_M_W(SEARCH, "pthread_condattr_init() fail");
-    }
-
-    if (0 != pthread_condattr_setclock(&m_condattr, CLOCK_MONOTONIC)) {
-        LOG_M_W(SEARCH, "pthread_condattr_setclock() fail");
-     }
-
-     if (0 != pthread_cond_init(&m_cond, &m_condattr)) {
-         LOG_M_W(SEARCH, "pthread_cond_init() fail");
-     }
 }
 
 CSearch::~CSearch(AX_VOID)
@@ -305,12 +331,30 @@ AX_BOOL CSearch::Startup(AX_VOID)
         }
 
         LOG_M(SEARCH, "CreateGroup(%lld) for feature: %s", groupid, m_stSearchParam.object_types[0].c_str());
+
+        if (m_stSearchParam.cpu_index && groupid < SEARCH_GROUP_NUM) {
+            if (16 == m_stSearchParam.cpu_index_bits || 8 == m_stSearchParam.cpu_index_bits) {
+                m_arrIndex[groupid].SetPrecision((16 == m_stSearchParam.cpu_index_bits) ? FEATURE_INDEX_PRECISION_S16 : FEATURE_INDEX_PRECISION_S8);
+
+                // quantised candidates are re-ranked against the full precision features on disk
+                // keys are copies, an object deleted meanwhile fails the lookup and is dropped
+                m_arrIndex[groupid].SetFetcher([this](AX_U64 nObjectId, const AX_CHAR *szKey, AX_U8 *pFeature, AX_U32 nFeatureSize) {
+                    return m_tFeatureStore.Get(szKey, pFeature, nFeatureSize);
+                });
+            }
+
+            m_arrIndex[groupid].Reserve(m_stSearchParam.capability);
+        }
+    }
+
+    LOG_M(SEARCH, "Search by %s, top_k: %d", m_stSearchParam.cpu_index ? "cpu index" : "SKEL", m_stSearchParam.top_k);
+    if (m_stSearchParam.cpu_index) {
+        LOG_M(SEARCH, "cpu index bits: %d", m_stSearchParam.cpu_index_bits);
     }
 
     //Load database
     LoadFeatureDataBase();
 
-    m_bFinished = AX_TRUE;
     m_bForedExit = AX_FALSE;
 
     LOG_M(SEARCH, "---");
@@ -326,6 +370,20 @@ AX_VOID CSearch::Cleanup(AX_VOID)
 
     m_bGetFeatureResultThreadRunning = AX_FALSE;
 
+    if (m_pEnrollThread) {
+        m_enrollMutex.lock();
+        m_bEnrollThreadRunning = AX_FALSE;
+        m_cvEnroll.notify_all();
+        m_enrollMutex.unlock();
+
+        if (m_pEnrollThread->joinable()) {
+            m_pEnrollThread->join();
+        }
+
+        delete m_pEnrollThread;
+        m_pEnrollThread = nullptr;
+    }
+
     WaitForFinish();
 
     for (size_t i = 0; i < m_stSearchParam.object_types.size(); i++) {
@@ -334,11 +392,14 @@ AX_VOID CSearch::Cleanup(AX_VOID)
         DestoryGroup(groupid);
     }
 
-    m_featureMutex.lock();
-    if (m_feature_result.m_bUsed) {
-        memset(&m_feature_result, 0x00, sizeof(m_feature_result));
+    // frames held by queued requests are released, web waiters get failed
+    m_enrollMutex.lock();
+    for (auto &tRequest : m_dqEnroll) {
+        if (SEARCH_ENROLL_STAGE_DONE != tRequest.eStage) {
+            FinishEnroll(tRequest, SEARCH_ENROLL_STATUS_FAIL);
+        }
     }
-    m_featureMutex.unlock();
+    m_enrollMutex.unlock();
 
     m_mapMutex.lock();
     for (auto &groupObjectInfo : m_mapGroupObjectInfo) {
@@ -351,6 +412,13 @@ AX_VOID CSearch::Cleanup(AX_VOID)
     m_mapGroupObjectInfo.clear();
     m_mapMutex.unlock();
 
+    for (AX_U32 i = 0; i < SEARCH_GROUP_NUM; i++) {
+        m_arrIndex[i].Clear();
+        ClearTrackCache(i);
+    }
+
+    m_tFeatureStore.Close();
+
     m_setMutex.lock();
     for (auto &groupId : m_setGroupId) {
         AX_SKEL_Search_Destroy(groupId.second);
@@ -376,106 +444,129 @@ AX_VOID CSearch::Cleanup(AX_VOID)
 
 AX_VOID CSearch::AsyncLoadFeatureThread(AX_VOID)
 {
-    FILE* pFile = NULL;
-    AX_U32 db_file_size = 0;
-    AX_U32 total_len_read = 0;
-
     LOG_M(SEARCH, "Start load feature database");
 
     std::chrono::steady_clock::time_point beginTime = std::chrono::steady_clock::now();
 
-    //open database
-    pFile = fopen(m_FeatureDataBaseName.c_str(), "rb");
+    AX_U64 groupid = m_map_object_group_id["face"];
+    std::vector<std::string> vecInfo;
+    std::vector<AX_U8> vecFeature;
+    AX_U32 nFeatureSize = 0;
 
-    if (!pFile) {
-        goto EXIT;
-    }
+    vecInfo.reserve(SEARCH_LOAD_BATCH_SIZE);
 
-    fseek(pFile, 0, SEEK_END);
-    db_file_size = ftell(pFile);
-    rewind(pFile);
+    auto flush = [&]() {
+        if (vecInfo.size() > 0) {
+            AddObjectsToGroup(groupid, vecInfo, vecFeature.data(), nFeatureSize);
+            vecInfo.clear();
+            vecFeature.clear();
+        }
+    };
 
-    total_len_read = 0;
+    //open database, replays the log and migrates files of the previous format
+    if (m_tFeatureStore.Open(m_FeatureDataBaseName)) {
+        vecFeature.reserve((size_t)SEARCH_LOAD_BATCH_SIZE * 1024);
 
-    while(!m_bForedExit && total_len_read < db_file_size) {
-        AX_U64 groupid = m_map_object_group_id["face"];
-        AX_U64 object_id = m_map_group_object_id[groupid];
+        //features are copied from the file mapping into one batch buffer, no per record read or malloc
+        m_tFeatureStore.Load([&](const std::string &strInfo, const AX_U8 *feature, AX_U32 feature_size) {
+            if (m_bForedExit) {
+                return AX_FALSE;
+            }
 
-        if (m_mapGroupObjectInfo[groupid].size() > m_stSearchParam.capability) {
-            LOG_M_E(SEARCH, "Exceed the search capability (%d)", m_stSearchParam.capability);
-            break;
-        }
+            if (m_mapGroupObjectInfo[groupid].size() + vecInfo.size() >= m_stSearchParam.capability) {
+                LOG_M_E(SEARCH, "Exceed the search capability (%d)", m_stSearchParam.capability);
+                return AX_FALSE;
+            }
 
-        //SEARCH_FEATURE_DB_ST
-        SEARCH_FEATURE_HEADER_ST feature_item_header = {0};
+            if (feature_size != nFeatureSize || vecInfo.size() == SEARCH_LOAD_BATCH_SIZE) {
+                flush();
+                nFeatureSize = feature_size;
+            }
 
-        //read header
-        AX_U32 head_size = fread((AX_U8 *)&feature_item_header, 1, sizeof(feature_item_header), pFile);
+            vecInfo.emplace_back(strInfo);
+            vecFeature.insert(vecFeature.end(), feature, feature + feature_size);
 
-        //check header
-        if (head_size != sizeof(feature_item_header)) {
-            break;
-        }
+            return AX_TRUE;
+        });
 
-        //check feature size
-        if (feature_item_header.FeatureSize == 0) {
-            break;
+        if (!m_bForedExit) {
+            flush();
         }
+    }
 
-        total_len_read += head_size;
+    m_bFeatureDataBaseLoaded = AX_TRUE;
 
-        AX_U8 *feature = (AX_U8 *)malloc(feature_item_header.FeatureSize);
+    auto endTime = std::chrono::steady_clock::now();
+    AX_U32 nElapsed = (AX_U32)(std::chrono::duration_cast<std::chrono::milliseconds>(endTime - beginTime).count());
 
-        if (!feature) {
-            LOG_M_E(SEARCH, "Memory alloc (%d) fail", feature_item_header.FeatureSize);
-            break;
-        }
+    LOG_M(SEARCH, "Finish load feature database, loaded: %lld, elapsed: %d(ms), %.1f(ms) per 10k",
+          m_total_object_num, nElapsed, m_total_object_num > 0 ? nElapsed * 10000.0 / m_total_object_num : 0.0);
 
-        //read feature data
-        AX_U32 feature_size = fread(feature, 1, feature_item_header.FeatureSize, pFile);
+    return;
+}
 
-        //check feature data
-        if (feature_size != feature_item_header.FeatureSize) {
-            free(feature);
-            break;
-        }
+AX_BOOL CSearch::AddObjectsToGroup(AX_U64 groupid, const std::vector<std::string> &vecInfo, const AX_U8 *features, AX_U32 feature_size)
+{
+    AX_U32 nBatch = (AX_U32)vecInfo.size();
 
-        total_len_read += feature_size;
+    if (!IsGroupExist(groupid) || 0 == nBatch) {
+        return AX_FALSE;
+    }
 
-        SEARCH_OBJECT_INFO_ST object_info;
-        m_mapMutex.lock();
-        object_info.object_id = m_map_group_object_id[groupid];
-        m_mapMutex.unlock();
-        object_info.frame_id = 0;
-        object_info.track_id = 0;
-        object_info.feature_info = (AX_CHAR *)feature_item_header.Info;
+    std::vector<AX_U64> vecObjectId(nBatch);
+    std::vector<AX_VOID *> vecObjectInfo(nBatch);
 
-        if (!AddObjectToGroup(groupid, object_id, feature, feature_size, object_info, AX_FALSE)) {
-            free(feature);
-            continue;
-        }
+    m_mapMutex.lock();
+    AX_U64 base_object_id = m_map_group_object_id[groupid];
+    m_mapMutex.unlock();
 
-        free(feature);
+    for (AX_U32 i = 0; i < nBatch; i++) {
+        SEARCH_OBJECT_INFO_ST *pobject_info = new SEARCH_OBJECT_INFO_ST();
+        pobject_info->feature_info = vecInfo[i];
+        pobject_info->object_id = base_object_id + i;
+        pobject_info->frame_id = 0;
+        pobject_info->track_id = 0;
 
-        m_mapMutex.lock();
-        m_map_group_object_id[groupid] ++;
-        m_total_object_num ++;
-        m_mapMutex.unlock();
+        vecObjectId[i] = pobject_info->object_id;
+        vecObjectInfo[i] = pobject_info;
     }
 
-EXIT:
-    m_bFeatureDataBaseLoaded = AX_TRUE;
+    AX_S32 nRet = AX_SKEL_SUCC;
+    if (m_stSearchParam.cpu_index) {
+        nRet = (groupid < SEARCH_GROUP_NUM && m_arrIndex[groupid].Insert(nBatch, vecObjectId.data(), features, feature_size, vecInfo.data()))
+                    ? AX_SKEL_SUCC : AX_ERR_SKEL_ILLEGAL_PARAM;
+    }
+    else {
+        AX_SKEL_SEARCH_FEATURE_PARAM_S optparam = {0};
+        optparam.nBatchSize = nBatch;
+        optparam.pObjectIds = vecObjectId.data();
+        optparam.pFeatures = (AX_U8 *)features;
+        optparam.ppObjectInfos = vecObjectInfo.data();
 
-    if (pFile) {
-        fclose(pFile);
+        nRet = AX_SKEL_Search_InsertFeature(groupid, &optparam);
     }
 
-    auto endTime = std::chrono::steady_clock::now();
-    AX_U32 nElapsed = (AX_U32)(std::chrono::duration_cast<std::chrono::milliseconds>(endTime - beginTime).count());
+    if (AX_SKEL_SUCC != nRet) {
+        for (auto pobject_info : vecObjectInfo) {
+            delete (SEARCH_OBJECT_INFO_ST *)pobject_info;
+        }
 
-    LOG_M(SEARCH, "Finish load feature database, loaded: %lld, elapsed: %d(ms)", m_total_object_num, nElapsed);
+        LOG_M_E(SEARCH, "AX_SKEL_Search_InsertFeature groupid(%lld) batch(%d) failed: 0x%X", groupid, nBatch, nRet);
 
-    return;
+        return AX_FALSE;
+    }
+
+    m_mapMutex.lock();
+    for (AX_U32 i = 0; i < nBatch; i++) {
+        m_mapGroupObjectInfo[groupid][vecInfo[i]] = (SEARCH_OBJECT_INFO_ST *)vecObjectInfo[i];
+    }
+    m_map_group_object_id[groupid] += nBatch;
+    m_total_object_num += nBatch;
+    m_mapMutex.unlock();
+
+    ClearTrackCache(groupid);
+
+    return AX_TRUE;
 }
 
 AX_BOOL CSearch::LoadFeatureDataBase(AX_VOID)
@@ -671,14 +762,25 @@ AX_BOOL CSearch::AddObjectToGroup(AX_U64 groupid, AX_U64 object_id, const AX_U8
         optparam.pFeatures = (AX_U8 *)feature;
         optparam.ppObjectInfos = faceinfos;
 
-        nRet = AX_SKEL_Search_InsertFeature(groupid, &optparam);
+        if (m_stSearchParam.cpu_index) {
+            nRet = (groupid < SEARCH_GROUP_NUM && m_arrIndex[groupid].Insert(object_id, feature, feature_size, obj_info.feature_info))
+                        ? AX_SKEL_SUCC : AX_ERR_SKEL_ILLEGAL_PARAM;
+        }
+        else {
+            nRet = AX_SKEL_Search_InsertFeature(groupid, &optparam);
+        }
 
         if (AX_SKEL_SUCC == nRet) {
             if (bSaveFeature) {
                 bRet = SaveFeature(obj_info.feature_info, feature, feature_size);
 
                 if (!bRet) {
-                    AX_SKEL_Search_DeleteFeature(groupid, object_id, (AX_VOID **)&pobject_info);
+                    if (m_stSearchParam.cpu_index) {
+                        m_arrIndex[groupid].Remove(object_id);
+                    }
+                    else {
+                        AX_SKEL_Search_DeleteFeature(groupid, object_id, (AX_VOID **)&pobject_info);
+                    }
 
                     delete pobject_info;
                 }
@@ -686,6 +788,8 @@ AX_BOOL CSearch::AddObjectToGroup(AX_U64 groupid, AX_U64 object_id, const AX_U8
                     m_mapMutex.lock();
                     m_mapGroupObjectInfo[groupid][obj_info.feature_info] = pobject_info;
                     m_mapMutex.unlock();
+
+                    ClearTrackCache(groupid);
                 }
             }
             else {
@@ -693,6 +797,8 @@ AX_BOOL CSearch::AddObjectToGroup(AX_U64 groupid, AX_U64 object_id, const AX_U8
                 m_mapGroupObjectInfo[groupid][obj_info.feature_info] = pobject_info;
                 m_mapMutex.unlock();
 
+                ClearTrackCache(groupid);
+
                 bRet = AX_TRUE;
             }
         }
@@ -720,7 +826,13 @@ AX_BOOL CSearch::DeleteObjectFromGroup(AX_U64 groupid, std::string infoStr)
         if (iter != m_mapGroupObjectInfo[groupid].end()) {
             AX_U64 object_id = iter->second->object_id;
 
-            nRet = AX_SKEL_Search_DeleteFeature(groupid, object_id, (AX_VOID **)&obj_info);
+            if (m_stSearchParam.cpu_index) {
+                nRet = (groupid < SEARCH_GROUP_NUM && m_arrIndex[groupid].Remove(object_id))
+                            ? AX_SKEL_SUCC : AX_ERR_SKEL_ILLEGAL_PARAM;
+            }
+            else {
+                nRet = AX_SKEL_Search_DeleteFeature(groupid, object_id, (AX_VOID **)&obj_info);
+            }
 
             if (AX_SKEL_SUCC == nRet) {
                 m_mapMutex.lock();
@@ -728,6 +840,8 @@ AX_BOOL CSearch::DeleteObjectFromGroup(AX_U64 groupid, std::string infoStr)
                 m_mapGroupObjectInfo[groupid].erase(iter);
                 m_mapMutex.unlock();
 
+                ClearTrackCache(groupid);
+
                 bRet = DeleteFeature(infoStr);
 
                 LOG_M(SEARCH, "feature groupid(%lld)(%lld) %s deleted", groupid, object_id, infoStr.c_str());
@@ -754,7 +868,7 @@ AX_BOOL CSearch::Search(AX_U64 groupid, AX_U8 *features, int feature_cnt, int to
 
     if (IsGroupExist(groupid)) {
         AX_SKEL_SEARCH_PARAM_S optparam;
-        optparam.nBatchSize = 1;
+        optparam.nBatchSize = feature_cnt;
         optparam.nTop_k = top_k;
         optparam.pFeatures = features;
 
@@ -776,71 +890,240 @@ AX_BOOL CSearch::Search(AX_U64 groupid, AX_U8 *features, int feature_cnt, int to
 
 AX_BOOL CSearch::SyncSearch(AX_SKEL_OBJECT_ITEM_S *object_item)
 {
-    AX_BOOL bRet = AX_FALSE;
+    AX_BOOL bIdentified = AX_FALSE;
 
-    if (!gOptions.IsActivedSearchFromWeb()) {
-        return AX_TRUE;
+    if (!object_item) {
+        return AX_FALSE;
     }
 
-    if (!object_item) {
+    SyncSearch(object_item, 1, &bIdentified);
+
+    return bIdentified;
+}
+
+/* answers from cache when the track holds a trusted identity, or has used up its searches in this ttl window */
+AX_BOOL CSearch::TrackCacheLookup(SEARCH_TRACK_CACHE_T &tCache, AX_U64 nTick, AX_BOOL &bIdentified)
+{
+    bIdentified = tCache.bIdentified;
+
+    if (0 == tCache.nSearchCount) {
+        return AX_FALSE;
+    }
+
+    if (nTick - tCache.nLastSearch >= m_stSearchParam.track_cache_ttl) {
+        // verify again, with a fresh search budget
+        tCache.nSearchCount = 0;
         return AX_FALSE;
     }
 
+    if (tCache.bIdentified && tCache.fScore >= m_stSearchParam.track_cache_score) {
+        return AX_TRUE;
+    }
+
+    return (tCache.nSearchCount >= m_stSearchParam.track_max_search) ? AX_TRUE : AX_FALSE;
+}
+
+AX_VOID CSearch::ClearTrackCache(AX_U64 groupid)
+{
+    std::lock_guard<std::mutex> lck(m_trackCacheMutex);
+
+    // gallery changed, cached answers of this group may be stale
+    if (groupid < SEARCH_GROUP_NUM) {
+        m_mapTrackCache[groupid].clear();
+    }
+}
+
+AX_VOID CSearch::SyncSearch(AX_SKEL_OBJECT_ITEM_S *object_items, AX_U32 object_size, AX_BOOL *identified)
+{
+    if (!object_items || !identified) {
+        return;
+    }
+
+    AX_BOOL bSearch = gOptions.IsActivedSearchFromWeb();
+
+    for (AX_U32 i = 0; i < object_size; i++) {
+        identified[i] = bSearch ? AX_FALSE : AX_TRUE;
+    }
+
+    if (!bSearch) {
+        return;
+    }
+
     if (m_total_object_num == 0) {
         LOG_M_I(SEARCH, "no feature data list, ignore");
-        return AX_FALSE;
+        return;
     }
 
-    auto check_object = [&](char *object_category) -> AX_BOOL {
-        auto iterator = std::find_if(
-            m_stSearchParam.object_types.begin(), m_stSearchParam.object_types.end(),
-            [&](std::string &group_object) { return group_object == object_category; });
-        if (iterator == m_stSearchParam.object_types.end()) {
-            return AX_FALSE;
-        } else {
-            return AX_TRUE;
+    std::lock_guard<std::mutex> lck(m_trackCacheMutex);
+
+    AX_BOOL bTrackCache = m_stSearchParam.track_cache;
+    AX_U64 nTick = CTimeUtils::GetTickCount();
+    DET_SEARCH_INFO_T tSearchInfo = {0};
+
+    // drop tracks not seen for a while
+    if (bTrackCache && nTick - m_nTrackCacheSweep >= SEARCH_TRACK_EXPIRE) {
+        for (auto &mapTrackCache : m_mapTrackCache) {
+            for (auto iter = mapTrackCache.begin(); iter != mapTrackCache.end();) {
+                if (nTick - iter->second.nLastSeen >= SEARCH_TRACK_EXPIRE) {
+                    iter = mapTrackCache.erase(iter);
+                } else {
+                    ++iter;
+                }
+            }
+        }
+        m_nTrackCacheSweep = nTick;
+    }
+
+    auto OnMatch = [&](AX_U32 nBatch, AX_F32 fScore, AX_U64 nObjectId, const AX_CHAR *szName) {
+        if (fScore < m_stSearchParam.compare_score_threshold || !szName) {
+            return;
+        }
+
+        AX_U32 nItem = m_vecBatchItem[nBatch];
+
+        LOG_M(SEARCH, "Found(feature: %s, track_id: %lld, score: %.2f, name: %s, index: %lld)",
+                        object_items[nItem].pstrObjectCategory,
+                        object_items[nItem].nTrackId,
+                        fScore,
+                        szName,
+                        nObjectId);
+
+        identified[nItem] = AX_TRUE;
+
+        if (bTrackCache && fScore > m_vecBatchCache[nBatch]->fScore) {
+            m_vecBatchCache[nBatch]->bIdentified = AX_TRUE;
+            m_vecBatchCache[nBatch]->fScore = fScore;
         }
     };
 
-    char *object_category = (char *)object_item->pstrObjectCategory;
-    if (check_object(object_category) && object_item->nFeatureSize > 0) {
-        AX_U64 groupid = m_map_object_group_id[object_category];
-        AX_U8 *feature = (AX_U8 *)object_item->pstFeatureItem[0].pstrValue;
-        AX_SKEL_SEARCH_RESULT_S *search_result = nullptr;
+    AX_U32 top_k = m_stSearchParam.top_k;
 
-        bRet = Search(groupid, feature, 1, 1, &search_result);
+    for (auto &object_type : m_stSearchParam.object_types) {
+        AX_U64 groupid = m_map_object_group_id[object_type];
+        AX_U32 feature_size = 0;
 
-        if (!bRet) {
-            return AX_FALSE;
+        if (groupid >= SEARCH_GROUP_NUM) {
+            continue;
         }
 
-        bRet = AX_FALSE;
+        // gather features of this group, all of the same size
+        m_vecBatchItem.clear();
+        m_vecBatchCache.clear();
+        m_vecBatchFeature.clear();
+        for (AX_U32 i = 0; i < object_size; i++) {
+            AX_SKEL_OBJECT_ITEM_S &object_item = object_items[i];
+            if (!object_item.pstrObjectCategory || object_item.nFeatureSize == 0
+                || object_type != object_item.pstrObjectCategory) {
+                continue;
+            }
 
-        for (size_t i = 0; i < search_result->nBatchSize; i++) {
-            for (size_t j = 0; j < search_result->nTop_k; j++) {
-                if (search_result->pfScores[i * search_result->nTop_k + j] < m_stSearchParam.compare_score_threshold) {
+            if (feature_size == 0) {
+                feature_size = object_item.pstFeatureItem[0].nValueSize;
+            }
+
+            if (object_item.pstFeatureItem[0].nValueSize != feature_size) {
+                continue;
+            }
+
+            const AX_U8 *feature = (const AX_U8 *)object_item.pstFeatureItem[0].pstrValue;
+            tSearchInfo.nObjects ++;
+
+            if (!bTrackCache) {
+                m_vecBatchItem.push_back(i);
+                m_vecBatchFeature.insert(m_vecBatchFeature.end(), feature, feature + feature_size);
+                continue;
+            }
+
+            SEARCH_TRACK_CACHE_T &tCache = m_mapTrackCache[groupid][object_item.nTrackId];
+            tCache.nLastSeen = nTick;
+
+            if (TrackCacheLookup(tCache, nTick, identified[i])) {
+                tSearchInfo.nHits ++;
+                continue;
+            }
+
+            // AX_F32 features are averaged over frames, others are searched as is
+            AX_U32 nAvgFrames = (0 == feature_size % sizeof(AX_F32)) ? m_stSearchParam.track_avg_frames : 1;
+            if (nAvgFrames > 1) {
+                AX_U32 nDim = feature_size / sizeof(AX_F32);
+                if (0 == tCache.nAccumulated) {
+                    tCache.vecFeature.assign(nDim, 0);
+                }
+
+                for (AX_U32 d = 0; d < nDim; d++) {
+                    AX_F32 fValue;
+                    memcpy(&fValue, feature + d * sizeof(AX_F32), sizeof(AX_F32));
+                    tCache.vecFeature[d] += fValue;
+                }
+
+                if (++tCache.nAccumulated < nAvgFrames) {
+                    tSearchInfo.nPending ++;
                     continue;
                 }
 
-                int object_group_index = search_result->pObjectIds[i * search_result->nTop_k + j];
-                SEARCH_OBJECT_INFO_ST *object_info =
-                                        (SEARCH_OBJECT_INFO_ST *)search_result->ppObjectInfos[i * search_result->nTop_k + j];
+                for (AX_U32 d = 0; d < nDim; d++) {
+                    tCache.vecFeature[d] /= tCache.nAccumulated;
+                }
+                feature = (const AX_U8 *)tCache.vecFeature.data();
+                tCache.nAccumulated = 0;
+            }
 
-                LOG_M(SEARCH, "Found(feature: %s, track_id: %lld, score: %.2f, name: %s, index: %d)",
-                                object_category,
-                                object_item->nTrackId,
-                                search_result->pfScores[i * search_result->nTop_k + j],
-                                object_info->feature_info.c_str(),
-                                object_group_index);
+            tCache.nSearchCount ++;
+            tCache.nLastSearch = nTick;
+            tCache.bIdentified = AX_FALSE;
+            tCache.fScore = 0;
 
-                bRet = AX_TRUE;
+            m_vecBatchItem.push_back(i);
+            m_vecBatchCache.push_back(&tCache);
+            m_vecBatchFeature.insert(m_vecBatchFeature.end(), feature, feature + feature_size);
+        }
+
+        AX_U32 feature_cnt = (AX_U32)m_vecBatchItem.size();
+        if (feature_cnt == 0) {
+            continue;
+        }
+
+        tSearchInfo.nSearched += feature_cnt;
+
+        if (m_stSearchParam.cpu_index) {
+            m_vecBatchResult.resize(feature_cnt * top_k);
+            if (!m_arrIndex[groupid].Search(m_vecBatchFeature.data(), feature_size, feature_cnt, top_k, m_vecBatchResult.data())) {
+                continue;
+            }
+
+            for (AX_U32 n = 0; n < feature_cnt; n++) {
+                for (AX_U32 k = 0; k < top_k; k++) {
+                    const FEATURE_INDEX_RESULT_T &tResult = m_vecBatchResult[n * top_k + k];
+                    OnMatch(n, tResult.fScore, tResult.nObjectId, tResult.szKey);
+                }
             }
         }
+        else {
+            AX_SKEL_SEARCH_RESULT_S *search_result = nullptr;
 
-        AX_SKEL_Release(search_result);
+            if (!Search(groupid, m_vecBatchFeature.data(), feature_cnt, top_k, &search_result)) {
+                continue;
+            }
+
+            for (size_t n = 0; n < search_result->nBatchSize && n < feature_cnt; n++) {
+                for (size_t k = 0; k < search_result->nTop_k; k++) {
+                    size_t nIndex = n * search_result->nTop_k + k;
+                    SEARCH_OBJECT_INFO_ST *object_info = (SEARCH_OBJECT_INFO_ST *)search_result->ppObjectInfos[nIndex];
+                    OnMatch(n, search_result->pfScores[nIndex], search_result->pObjectIds[nIndex],
+                            object_info ? object_info->feature_info.c_str() : nullptr);
+                }
+            }
+
+            AX_SKEL_Release(search_result);
+        }
     }
 
-    return bRet;
+    if (tSearchInfo.nObjects > 0) {
+        for (auto &mapTrackCache : m_mapTrackCache) {
+            tSearchInfo.nTracks += mapTrackCache.size();
+        }
+        gPrintHelper.Add(E_PH_MOD_DET_SEARCH, (AX_VOID *)&tSearchInfo);
+    }
 }
 
 AX_BOOL CSearch::IsGroupExist(AX_U64 groupid)
@@ -859,116 +1142,154 @@ AX_BOOL CSearch::IsGroupExist(AX_U64 groupid)
     return bRet;
 }
 
-AX_BOOL CSearch::ProcessFeature(CMediaFrame* pFrame)
+AX_VOID CSearch::ProcessFeature(CMediaFrame* pFrame)
 {
-    AX_BOOL bRet = AX_FALSE;
+    if (m_bForedExit || 0 == m_nEnrollWaitFrame) {
+        return;
+    }
 
-    if (m_bForedExit) {
-        return bRet;
+    if (!gOptions.IsActivedSearchFromWeb()) {
+        return;
     }
 
-    //Get feature info
-    if (!gOptions.IsActivedSearchFromWeb() || !m_bGetFeatureInfo) {
-        return bRet;
+    std::lock_guard<std::mutex> lck(m_enrollMutex);
+    if (m_bForedExit) {
+        return;
     }
 
-    m_CaptureFeatureMutex.lock();
-    m_bGetFeatureInfo = AX_FALSE;
-    m_CaptureFeatureMutex.unlock();
+    // one frame held at a time, so it is fresh when sent and the IVPS pool is not drained
+    SEARCH_ENROLL_REQUEST_T *pWait = nullptr;
+    for (auto &tRequest : m_dqEnroll) {
+        if (SEARCH_ENROLL_STAGE_FRAME_READY == tRequest.eStage || SEARCH_ENROLL_STAGE_RUNNING == tRequest.eStage) {
+            return;
+        }
 
-    if (!m_feature_handle) {
-        LOG_M_E(SEARCH, "Stream handle not init");
-        goto PROC_EXIT;
+        if (!pWait && SEARCH_ENROLL_STAGE_WAIT_FRAME == tRequest.eStage) {
+            pWait = &tRequest;
+        }
     }
 
-    if (m_feature_result.m_bUsed) {
-        LOG_M_E(SEARCH, "Feature is running");
-        goto PROC_EXIT;
+    if (pWait) {
+        // detection goes on with the same frame, the worker releases its reference after sending
+        pFrame->AddRef();
+        pWait->pFrame = pFrame;
+        pWait->eStage = SEARCH_ENROLL_STAGE_FRAME_READY;
+        --m_nEnrollWaitFrame;
+
+        m_cvEnroll.notify_all();
     }
+}
 
-    LOG_M_I(SEARCH, "+++");
+AX_VOID CSearch::EnrollThreadFunc(AX_VOID)
+{
+    prctl(PR_SET_NAME, "IPC_SEARCH_ENROLL");
+
+    std::unique_lock<std::mutex> lck(m_enrollMutex);
+
+    while (m_bEnrollThreadRunning) {
+        auto tpNow = std::chrono::steady_clock::now();
+        SEARCH_ENROLL_REQUEST_T *pSend = nullptr;
+        AX_BOOL bRunning = AX_FALSE;
+
+        for (auto &tRequest : m_dqEnroll) {
+            if (SEARCH_ENROLL_STAGE_RUNNING == tRequest.eStage) {
+                AX_U32 nElapsed = (AX_U32)(std::chrono::duration_cast<std::chrono::milliseconds>(tpNow - tRequest.tpSend).count());
+                if (nElapsed >= SEARCH_ENROLL_RESULT_TIMEOUT) {
+                    LOG_M_E(SEARCH, "Enroll(%d) %s no result in %d(ms)", tRequest.nId, tRequest.strInfo.c_str(), nElapsed);
+                    FinishEnroll(tRequest, SEARCH_ENROLL_STATUS_FAIL);
+                } else {
+                    bRunning = AX_TRUE;
+                }
+            } else if (SEARCH_ENROLL_STAGE_WAIT_FRAME == tRequest.eStage) {
+                AX_U32 nElapsed = (AX_U32)(std::chrono::duration_cast<std::chrono::milliseconds>(tpNow - tRequest.tpSubmit).count());
+                if (nElapsed >= SEARCH_ENROLL_FRAME_TIMEOUT) {
+                    LOG_M_E(SEARCH, "Enroll(%d) %s no frame in %d(ms)", tRequest.nId, tRequest.strInfo.c_str(), nElapsed);
+                    FinishEnroll(tRequest, SEARCH_ENROLL_STATUS_FAIL);
+                }
+            } else if (SEARCH_ENROLL_STAGE_FRAME_READY == tRequest.eStage && !pSend) {
+                pSend = &tRequest;
+            }
+        }
 
-    if (!m_bForedExit) {
-        AX_VIDEO_FRAME_INFO_S tFrame = {0};
-        if (pFrame->bIvpsFrame) {
-            tFrame.stVFrame = pFrame->tVideoFrame;
-        } else {
-            tFrame = pFrame->tFrame.tFrameInfo;
+        // feature handle is created with frame depth 1
+        if (bRunning || !pSend) {
+            m_cvEnroll.wait_for(lck, std::chrono::milliseconds(100));
+            continue;
         }
 
-        m_bFinished = AX_FALSE;
+        AX_U32 nId = pSend->nId;
+        CMediaFrame *pFrame = pSend->pFrame;
+        pSend->pFrame = nullptr;
+        pSend->eStage = SEARCH_ENROLL_STAGE_RUNNING;
+        pSend->tpSend = tpNow;
+
+        lck.unlock();
 
         AX_SKEL_FRAME_S stFrame = {0};
-        stFrame.nFrameId = (AX_U64)pFrame->nFrameID;
+        stFrame.nFrameId = (AX_U64)nId;
         stFrame.pUserData = this;
-        
-        stFrame.stFrame = tFrame.stVFrame;
+        stFrame.stFrame = pFrame->bIvpsFrame ? pFrame->tVideoFrame : pFrame->tFrame.tFrameInfo.stVFrame;
 
-        AX_S32 nRet = AX_SKEL_SUCC;
+        AX_S32 nRet = AX_SKEL_SendFrame(m_feature_handle, &stFrame, 0);
 
-        {
-            m_featureMutex.lock();
-            m_feature_result.m_bUsed = AX_TRUE;
-            m_feature_result.m_sVideoFrame = tFrame.stVFrame;
-            m_feature_result.m_tpStart = std::chrono::steady_clock::now();
+        pFrame->FreeMem();
 
-            m_featureMutex.unlock();
-        }
-
-        nRet = AX_SKEL_SendFrame(m_feature_handle, &stFrame, 0);
-
-        m_bFinished = AX_TRUE;
+        lck.lock();
 
         if (AX_SKEL_SUCC != nRet) {
-            m_featureMutex.lock();
-            m_feature_result.m_bUsed = AX_FALSE;
-            m_featureMutex.unlock();
-        }
-        else {
-            bRet = AX_TRUE;
+            LOG_M_E(SEARCH, "Enroll(%d) AX_SKEL_SendFrame failed: 0x%X", nId, nRet);
+
+            SEARCH_ENROLL_REQUEST_T *pRequest = FindEnroll(nId);
+            if (pRequest && SEARCH_ENROLL_STAGE_RUNNING == pRequest->eStage) {
+                FinishEnroll(*pRequest, SEARCH_ENROLL_STATUS_FAIL);
+            }
         }
     }
+}
 
-    LOG_M_I(SEARCH, "---");
-
-PROC_EXIT:
-    if (!bRet) {
-        m_GetFeatureInfoStatus = 1;
-
-        pthread_mutex_lock(&m_condMutx);
-        pthread_cond_signal(&m_cond);    // send signal
-        pthread_mutex_unlock(&m_condMutx);
+SEARCH_ENROLL_REQUEST_T *CSearch::FindEnroll(AX_U32 nId)
+{
+    for (auto &tRequest : m_dqEnroll) {
+        if (tRequest.nId == nId) {
+            return &tRequest;
+        }
     }
 
-    return bRet;
+    return nullptr;
 }
 
-AX_BOOL CSearch::WaitForFinish(AX_VOID)
+AX_VOID CSearch::FinishEnroll(SEARCH_ENROLL_REQUEST_T &tRequest, AX_S32 nStatus)
 {
-    while(!m_bFinished) {
-        CTimeUtils::msSleep(10);
+    if (SEARCH_ENROLL_STAGE_WAIT_FRAME == tRequest.eStage) {
+        --m_nEnrollWaitFrame;
     }
 
-    //Wait handle finish
-    auto waitStart = std::chrono::steady_clock::now();
-    do {
-        m_featureMutex.lock();
-        AX_BOOL bFeatureRunning = m_feature_result.m_bUsed;
-        m_featureMutex.unlock();
+    if (tRequest.pFrame) {
+        tRequest.pFrame->FreeMem();
+        tRequest.pFrame = nullptr;
+    }
 
-        if (!bFeatureRunning) {
-            break;
-        }
+    tRequest.eStage = SEARCH_ENROLL_STAGE_DONE;
+    tRequest.nStatus = nStatus;
 
-        auto waitEnd = std::chrono::steady_clock::now();
-        AX_U32 nElapsed = (AX_U32)(std::chrono::duration_cast<std::chrono::milliseconds>(waitEnd - waitStart).count());
+    AX_U32 nElapsed = (AX_U32)(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - tRequest.tpSubmit).count());
+    LOG_M(SEARCH, "Enroll(%d) %s status: %d, elapsed %d(ms)", tRequest.nId, tRequest.strInfo.c_str(), nStatus, nElapsed);
 
-        if (nElapsed >= SEARCH_WAITING_TIMEOUT) {
-            break;
-        }
+    m_cvEnroll.notify_all();
+}
 
-        CTimeUtils::msSleep(10);
-    } while(1);
+AX_BOOL CSearch::WaitForFinish(AX_VOID)
+{
+    //Wait in-flight enrollment
+    std::unique_lock<std::mutex> lck(m_enrollMutex);
+    m_cvEnroll.wait_for(lck, std::chrono::milliseconds(SEARCH_WAITING_TIMEOUT), [this]() {
+        for (auto &tRequest : m_dqEnroll) {
+            if (SEARCH_ENROLL_STAGE_RUNNING == tRequest.eStage) {
+                return false;
+            }
+        }
+        return true;
+    });
 
     return AX_TRUE;
 }
@@ -1006,36 +1327,40 @@ AX_BOOL CSearch::AsyncRecvFeatureResult(AX_VOID)
 AX_BOOL CSearch::FeatureResultHandler(AX_SKEL_RESULT_S *algorithm_result)
 {
     AX_BOOL bRet = AX_FALSE;
-    auto endTime = std::chrono::steady_clock::now();
 
     if (!algorithm_result) {
         return AX_FALSE;
     }
 
-    bRet = AddFeatureToGroup(m_FeatureInfoStr, algorithm_result);
+    // frame id carries the request id
+    AX_U32 nId = (AX_U32)algorithm_result->nFrameId;
+    std::string strInfo;
+
+    m_enrollMutex.lock();
+    SEARCH_ENROLL_REQUEST_T *pRequest = FindEnroll(nId);
+    if (pRequest && SEARCH_ENROLL_STAGE_RUNNING == pRequest->eStage) {
+        strInfo = pRequest->strInfo;
+    }
+    m_enrollMutex.unlock();
 
-    m_featureMutex.lock();
-    if (m_feature_result.m_bUsed) {
-        AX_U32 nElapsed = (AX_U32)(std::chrono::duration_cast<std::chrono::milliseconds>(endTime - m_feature_result.m_tpStart).count());
+    if (strInfo.empty()) {
+        LOG_M_W(SEARCH, "Enroll(%d) finished already, result dropped", nId);
 
-        LOG_M_I(SEARCH, "Get feature elapsed %d(ms)", nElapsed);
+        AX_SKEL_Release(algorithm_result);
 
-        memset(&m_feature_result, 0x00, sizeof(m_feature_result));
+        return AX_FALSE;
     }
-    m_featureMutex.unlock();
+
+    bRet = AddFeatureToGroup(strInfo, algorithm_result);
 
     AX_SKEL_Release(algorithm_result);
 
-    if (bRet) {
-        m_GetFeatureInfoStatus = 0;
-    }
-    else {
-        m_GetFeatureInfoStatus = 1;
+    m_enrollMutex.lock();
+    pRequest = FindEnroll(nId);
+    if (pRequest && SEARCH_ENROLL_STAGE_RUNNING == pRequest->eStage) {
+        FinishEnroll(*pRequest, bRet ? SEARCH_ENROLL_STATUS_OK : SEARCH_ENROLL_STATUS_FAIL);
     }
-
-    pthread_mutex_lock(&m_condMutx);
-    pthread_cond_signal(&m_cond);    // send signal
-    pthread_mutex_unlock(&m_condMutx);
+    m_enrollMutex.unlock();
 
     return bRet;
 }
@@ -1122,6 +1447,9 @@ AX_BOOL CSearch::InitFeatureHandle(AX_VOID)
     m_bGetFeatureResultThreadRunning = AX_TRUE;
     m_pGetFeatureResultThread = new thread(AsyncRecvAlgorithmFeatureResultThread, this);
 
+    m_bEnrollThreadRunning = AX_TRUE;
+    m_pEnrollThread = new thread(&CSearch::EnrollThreadFunc, this);
+
     return AX_TRUE;
 }
 
@@ -1136,7 +1464,7 @@ AX_BOOL CSearch::SetHandleConfig(AX_VOID)
     return AX_TRUE;
 }
 
-AX_BOOL CSearch::GenerateFeatureName(const AX_CHAR *str)
+std::string CSearch::GenerateFeatureName(const AX_CHAR *str)
 {
     AX_CHAR sz_dat[128] = {0};
 
@@ -1154,9 +1482,7 @@ AX_BOOL CSearch::GenerateFeatureName(const AX_CHAR *str)
         snprintf(sz_dat, sizeof(sz_dat) - 1, "face_%s", str);
     }
 
-    m_FeatureInfoStr = sz_dat;
-
-    return AX_TRUE;
+    return sz_dat;
 }
 
 AX_BOOL CSearch::SaveFeature(std::string featureInfo, const AX_U8 *feature, AX_U32 feature_size)
@@ -1165,46 +1491,8 @@ AX_BOOL CSearch::SaveFeature(std::string featureInfo, const AX_U8 *feature, AX_U
         && featureInfo.size() > 0
         && feature
         && feature_size > 0) {
-         //try making the dir if not exist
-        if (access(m_stSearchParam.base_img_path.c_str(), 0) != 0) {
-            if (mkdir(m_stSearchParam.base_img_path.c_str(), S_IRWXU | S_IRWXG | S_IRWXO) != 0) {
-                LOG_M_E(SEARCH, "Could not create base_img path: %s", m_stSearchParam.base_img_path.c_str());
-                return AX_FALSE;
-            }
-        }
-
-        //SEARCH_FEATURE_DB_ST
-        AX_U32 data_size = sizeof(SEARCH_FEATURE_HEADER_ST) + feature_size;
-        AX_U8 *data_ptr = (AX_U8 *)malloc(data_size);
-
-        if (!data_ptr) {
-            LOG_M_E(SEARCH, "Memory alloc (%d) fail", data_size);
-
-            return AX_FALSE;
-        }
-
-        memset(data_ptr, 0x00, data_size);
-        memcpy(data_ptr, featureInfo.c_str(), (featureInfo.size() > (FEATURE_INFO_SIZE - 1)) ? (FEATURE_INFO_SIZE - 1) : featureInfo.size());
-        memcpy(data_ptr + FEATURE_INFO_SIZE, (AX_U8 *)&feature_size, sizeof(AX_U16));
-        memcpy(data_ptr + sizeof(SEARCH_FEATURE_HEADER_ST), feature, feature_size);
-
-        //open database
-        FILE* pFile = fopen(m_FeatureDataBaseName.c_str(), "a+");
-
-        if (!pFile) {
-            LOG_M_E(SEARCH, "Open feature databae: %s fail", m_FeatureDataBaseName.c_str());
-
-            free(data_ptr);
-
-            return AX_FALSE;
-        }
-
-        AX_U32 nWriteCount = fwrite(data_ptr, 1, data_size, pFile);
-
-        fclose(pFile);
-        free(data_ptr);
-
-        if (nWriteCount == data_size) {
+        //one appended record, no rewrite of the database
+        if (m_tFeatureStore.Put(featureInfo.substr(0, FEATURE_INFO_SIZE - 1), feature, feature_size)) {
             LOG_M_I(SEARCH, "Save feature to file_name: %s", m_FeatureDataBaseName.c_str());
 
             return AX_TRUE;
@@ -1225,113 +1513,119 @@ AX_BOOL CSearch::DeleteFeature(std::string featureInfo)
 
     if (m_FeatureDataBaseName.size() > 0
         && featureInfo.size() > 0) {
-        FILE* pFile = NULL;
-        AX_U32 db_file_size = 0;
-
-        //open database
-        pFile = fopen(m_FeatureDataBaseName.c_str(), "rb");
-
-        if (!pFile) {
-            LOG_M_E(SEARCH, "%s not exist", m_FeatureDataBaseName.c_str());
-            return AX_FALSE;
-        }
-
-        fseek(pFile, 0, SEEK_END);
-        db_file_size = ftell(pFile);
-        rewind(pFile);
-
-        AX_U8 *db_content = (AX_U8 *)malloc(db_file_size);
+        //tombstone appended, space is reclaimed by compaction
+        bRet = m_tFeatureStore.Delete(featureInfo);
+    }
 
-        if (!db_content) {
-            LOG_M_E(SEARCH, "Memory alloc (%d) fail", db_file_size);
+    if (!bRet) {
+        LOG_M_E(SEARCH, "%s not find", featureInfo.c_str());
+    }
 
-            fclose(pFile);
+    return bRet;
+}
 
-            return AX_FALSE;
-        }
+AX_S32 CSearch::GetFeatureInfo(const AX_CHAR *str, AX_U32 *pId /* = nullptr */, AX_U32 nWaitMs /* = SEARCH_ENROLL_WAIT_TIME */)
+{
+    if (!gOptions.IsActivedSearchFromWeb()) {
+        //not support
+        return SEARCH_ENROLL_STATUS_NOT_SUPPORT;
+    }
 
-        fread(db_content, 1, db_file_size, pFile);
+    if (!m_bFeatureDataBaseLoaded) {
+        //Database loading
+        return SEARCH_ENROLL_STATUS_LOADING;
+    }
 
-        fclose(pFile);
+    if (!m_feature_handle || m_bForedExit) {
+        return SEARCH_ENROLL_STATUS_FAIL;
+    }
 
-        AX_U32 total_len_read = 0;
-        AX_U8 *tmp_db_ptr = (AX_U8 *)db_content;
-        while(total_len_read < db_file_size) {
-            //SEARCH_FEATURE_DB_ST
-            SEARCH_FEATURE_HEADER_ST *feature_item_header = (SEARCH_FEATURE_HEADER_ST *)tmp_db_ptr;
-            AX_U32 nItemSize = sizeof(SEARCH_FEATURE_HEADER_ST) + feature_item_header->FeatureSize;
+    std::string strInfo = GenerateFeatureName(str);
 
-            if (featureInfo == (AX_CHAR *)feature_item_header->Info) {
-                // delete data
-                if (db_file_size > total_len_read + nItemSize) {
-                    memcpy(tmp_db_ptr, tmp_db_ptr + nItemSize, db_file_size - (total_len_read + nItemSize));
-                }
+    m_mapMutex.lock();
+    AX_BOOL bExist = (m_mapGroupObjectInfo[1].find(strInfo) != m_mapGroupObjectInfo[1].end()) ? AX_TRUE : AX_FALSE;
+    m_mapMutex.unlock();
 
-                //update to file
-                pFile = fopen(m_FeatureDataBaseName.c_str(), "wb");
+    if (bExist) {
+        LOG_M_E(SEARCH, "%s already exist", strInfo.c_str());
+        return SEARCH_ENROLL_STATUS_FAIL;
+    }
 
-                if (pFile) {
-                    if (db_file_size > nItemSize) {
-                        fwrite(db_content, 1, db_file_size - nItemSize, pFile);
-                    }
-                    fclose(pFile);
+    std::unique_lock<std::mutex> lck(m_enrollMutex);
 
-                    LOG_M(SEARCH, "db updated");
+    AX_U32 nPending = 0;
+    AX_BOOL bQueued = AX_FALSE;
+    for (auto &tRequest : m_dqEnroll) {
+        if (SEARCH_ENROLL_STAGE_DONE != tRequest.eStage) {
+            nPending++;
 
-                    bRet = AX_TRUE;
-                }
-                break;
+            if (tRequest.strInfo == strInfo) {
+                bQueued = AX_TRUE;
             }
-
-            total_len_read += nItemSize;
-            tmp_db_ptr += nItemSize;
         }
+    }
 
-        free(db_content);
+    if (nPending >= SEARCH_ENROLL_QUEUE_SIZE) {
+        LOG_M_W(SEARCH, "Enroll queue full (%d)", nPending);
+        return SEARCH_ENROLL_STATUS_BUSY;
     }
 
-    if (!bRet) {
-        LOG_M_E(SEARCH, "%s not find", featureInfo.c_str());
+    if (++m_nEnrollId == 0) {
+        m_nEnrollId = 1;
     }
 
-    return bRet;
-}
+    if (bQueued) {
+        if (str) {
+            LOG_M_E(SEARCH, "%s already queued", strInfo.c_str());
+            return SEARCH_ENROLL_STATUS_FAIL;
+        }
 
-AX_S32 CSearch::GetFeatureInfo(const AX_CHAR *str)
-{
-    if (!gOptions.IsActivedSearchFromWeb()) {
-        //not support
-        m_GetFeatureInfoStatus = 2;
+        // time named requests within one second
+        strInfo += "_" + std::to_string(m_nEnrollId);
+    }
 
-        return m_GetFeatureInfoStatus;
+    while (m_dqEnroll.size() >= SEARCH_ENROLL_QUEUE_SIZE + SEARCH_ENROLL_HISTORY_SIZE
+           && SEARCH_ENROLL_STAGE_DONE == m_dqEnroll.front().eStage) {
+        m_dqEnroll.pop_front();
     }
 
-    if (!m_bFeatureDataBaseLoaded) {
-        //Database loading
-        m_GetFeatureInfoStatus = 3;
+    SEARCH_ENROLL_REQUEST_T tRequest;
+    tRequest.nId = m_nEnrollId;
+    tRequest.strInfo = strInfo;
+    tRequest.tpSubmit = std::chrono::steady_clock::now();
+    m_dqEnroll.push_back(tRequest);
+    ++m_nEnrollWaitFrame;
 
-        return m_GetFeatureInfoStatus;
+    AX_U32 nId = tRequest.nId;
+    if (pId) {
+        *pId = nId;
     }
 
-    m_CaptureFeatureMutex.lock();
-    GenerateFeatureName(str);
-    m_CaptureFeatureMutex.unlock();
+    LOG_M(SEARCH, "Enroll(%d) %s queued, pending: %d", nId, strInfo.c_str(), nPending + 1);
 
-    auto iter = m_mapGroupObjectInfo[1].find(m_FeatureInfoStr);
-    if (iter != m_mapGroupObjectInfo[1].end()) {
-        LOG_M_E(SEARCH, "%s already exist", m_FeatureInfoStr.c_str());
-        return 1;
+    if (nWaitMs > 0) {
+        m_cvEnroll.wait_for(lck, std::chrono::milliseconds(nWaitMs), [&]() {
+            SEARCH_ENROLL_REQUEST_T *pRequest = FindEnroll(nId);
+            return (!pRequest || SEARCH_ENROLL_STAGE_DONE == pRequest->eStage);
+        });
     }
 
-    m_CaptureFeatureMutex.lock();
-    m_bGetFeatureInfo = AX_TRUE;
-    m_CaptureFeatureMutex.unlock();
+    SEARCH_ENROLL_REQUEST_T *pRequest = FindEnroll(nId);
 
-    m_GetFeatureInfoStatus = 1;
+    return pRequest ? pRequest->nStatus : SEARCH_ENROLL_STATUS_FAIL;
+}
 
-    Waitfor(2000);
+AX_S32 CSearch::GetEnrollStatus(AX_U32 nId)
+{
+    std::lock_guard<std::mutex> lck(m_enrollMutex);
 
-    return m_GetFeatureInfoStatus;
+    SEARCH_ENROLL_REQUEST_T *pRequest = FindEnroll(nId);
+    if (!pRequest) {
+        LOG_M_W(SEARCH, "Enroll(%d) not found", nId);
+        return SEARCH_ENROLL_STATUS_FAIL;
+    }
+
+    return pRequest->nStatus;
 }
 
 AX_S32 CSearch::DeleteFeatureInfo(const AX_CHAR *str)
@@ -1340,45 +1634,9 @@ AX_S32 CSearch::DeleteFeatureInfo(const AX_CHAR *str)
         return 1;
     }
 
-    m_CaptureFeatureMutex.lock();
-    GenerateFeatureName(str);
-    m_CaptureFeatureMutex.unlock();
-
-    if (!DeleteObjectFromGroup(1, m_FeatureInfoStr)) {
+    if (!DeleteObjectFromGroup(1, GenerateFeatureName(str))) {
         return 1;
     }
 
     return 0;
 }
-
-AX_S32 CSearch::Waitfor(AX_S32 msTimeOut /* = -1 */)
-{
-    AX_S32 ret = 0;
-
-    pthread_mutex_lock(&m_condMutx);
-
-    // msTimeOut = 0, code exec block
-    if (msTimeOut < 0) {
-        pthread_cond_wait(&m_cond, &m_condMutx);
-    }
-    else { // wiat for time = msTimeOut
-        struct timespec tv;
-        clock_gettime(CLOCK_MONOTONIC, &tv);
-        tv.tv_sec += msTimeOut / 1000;
-        tv.tv_nsec += (msTimeOut  % 1000) * 1000000;
-        if (tv.tv_nsec >= 1000000000) {
-            tv.tv_nsec -= 1000000000;
-            tv.tv_sec += 1;
-        }
-
-        ret = pthread_cond_timedwait(&m_cond, &m_condMutx, &tv);
-        if (ret != 0) {
-            LOG_M_E(SEARCH, "pthread_cond_timedwait error: %s", strerror(errno));
-        }
-    }
-
-    pthread_mutex_unlock(&m_condMutx);
-
-    return ret;
-}
-
@@ -11,7 +11,10 @@
 
 #include "global.h"
 #include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <mutex>
 #include <thread>
@@ -20,6 +23,8 @@
 #include "ax_skel_api.h"
 #include "AiSearch.h"
 #include "Singleton.h"
+#include "FeatureIndex.h"
+#include "FeatureStore.h"
 
 /**
  * Search
@@ -41,11 +46,29 @@ typedef struct _SEARCH_PARAM_ST {
     std::string base_img_path;
     std::string database_name;
     std::string feature_algo_type;
+    AX_U32 top_k;
+    AX_BOOL cpu_index; // search in CFeatureIndex instead of AX_SKEL_Search
+    AX_U32 cpu_index_bits; // 32, 16 or 8 bits per feature element in CFeatureIndex
+
+    //Track cache
+    AX_BOOL track_cache;
+    float track_cache_score;  // identity at or above this score is trusted until ttl, 0 as compare_score_threshold
+    AX_U32 track_cache_ttl;   // ms before a cached answer is verified again
+    AX_U32 track_max_search;  // searches of a track per ttl when no trusted identity is found
+    AX_U32 track_avg_frames;  // features averaged into one search
 
     _SEARCH_PARAM_ST (){
         ePPL = AX_SKEL_PPL_FACE_FEATURE;
         compare_score_threshold = AI_SERACH_FACE_COMPARE_SCORE_DEFAULT;
         capability = AI_SERACH_FACE_BASE_IMG_CAP_DEFAULT;
+        top_k = 1;
+        cpu_index = AX_FALSE;
+        cpu_index_bits = 32;
+        track_cache = AX_TRUE;
+        track_cache_score = 0;
+        track_cache_ttl = 5000;
+        track_max_search = 3;
+        track_avg_frames = 3;
 
         memset(&tRoi, 0x00, sizeof(tRoi));
 
@@ -56,11 +79,43 @@ typedef struct _SEARCH_PARAM_ST {
     }
 } SEARCH_PARAM_ST;
 
-struct SEARCH_FEATURE_RESULT_ST {
-    AX_BOOL m_bUsed;
-    AX_VIDEO_FRAME_S m_sVideoFrame;
-    std::chrono::steady_clock::time_point m_tpStart;
-};
+/* enrollment status reported to web, 0 ~ 3 are kept from the blocking interface */
+typedef enum _SEARCH_ENROLL_STATUS_E {
+    SEARCH_ENROLL_STATUS_OK = 0,
+    SEARCH_ENROLL_STATUS_FAIL = 1,
+    SEARCH_ENROLL_STATUS_NOT_SUPPORT = 2,
+    SEARCH_ENROLL_STATUS_LOADING = 3,
+    SEARCH_ENROLL_STATUS_PENDING = 4,
+    SEARCH_ENROLL_STATUS_BUSY = 5
+} SEARCH_ENROLL_STATUS_E;
+
+#define SEARCH_ENROLL_QUEUE_SIZE (4)       // unfinished requests
+#define SEARCH_ENROLL_HISTORY_SIZE (16)    // finished requests kept for status query
+#define SEARCH_ENROLL_WAIT_TIME (2000)     // ms, submitter waits this long before answering pending
+
+typedef enum _SEARCH_ENROLL_STAGE_E {
+    SEARCH_ENROLL_STAGE_WAIT_FRAME = 0,
+    SEARCH_ENROLL_STAGE_FRAME_READY,
+    SEARCH_ENROLL_STAGE_RUNNING,
+    SEARCH_ENROLL_STAGE_DONE
+} SEARCH_ENROLL_STAGE_E;
+
+typedef struct _SEARCH_ENROLL_REQUEST_T {
+    AX_U32 nId;                  // also the frame id sent to the feature handle
+    std::string strInfo;
+    SEARCH_ENROLL_STAGE_E eStage;
+    AX_S32 nStatus;
+    CMediaFrame *pFrame;         // reference held from FRAME_READY until sent
+    std::chrono::steady_clock::time_point tpSubmit;
+    std::chrono::steady_clock::time_point tpSend;
+
+    _SEARCH_ENROLL_REQUEST_T() {
+        nId = 0;
+        eStage = SEARCH_ENROLL_STAGE_WAIT_FRAME;
+        nStatus = SEARCH_ENROLL_STATUS_PENDING;
+        pFrame = nullptr;
+    }
+} SEARCH_ENROLL_REQUEST_T;
 
 typedef struct {
     AX_U64 object_id;
@@ -69,6 +124,29 @@ typedef struct {
     std::string feature_info;
 } SEARCH_OBJECT_INFO_ST;
 
+/* group id of face, body, vehicle and cycle is 1 ~ 4 */
+#define SEARCH_GROUP_NUM (5)
+
+/* search state of one track */
+typedef struct _SEARCH_TRACK_CACHE_T {
+    AX_BOOL bIdentified;
+    AX_F32 fScore;
+    AX_U32 nSearchCount;         // searches since the ttl window started
+    AX_U32 nAccumulated;         // features summed in vecFeature
+    std::vector<AX_F32> vecFeature;
+    AX_U64 nLastSeen;            // ms
+    AX_U64 nLastSearch;          // ms
+
+    _SEARCH_TRACK_CACHE_T() {
+        bIdentified = AX_FALSE;
+        fScore = 0;
+        nSearchCount = 0;
+        nAccumulated = 0;
+        nLastSeen = 0;
+        nLastSearch = 0;
+    }
+} SEARCH_TRACK_CACHE_T;
+
 #define SEARCH_API(_API_NAME_) pApi_##_API_NAME_
 #define SEACRH_API_DEF(_API_NAME_, _API_RET_, _API_PARAM_) \
                             _API_RET_ (* SEARCH_API(_API_NAME_))_API_PARAM_ = nullptr
@@ -94,13 +172,18 @@ public:
     AX_BOOL IsGroupExist(AX_U64 groupid);
 
     //Feature
-    AX_BOOL ProcessFeature(CMediaFrame* pFrame);
+    /* called with every detection frame, never consumes it: a reference is taken for a pending enrollment */
+    AX_VOID ProcessFeature(CMediaFrame* pFrame);
     AX_BOOL AsyncRecvFeatureResult(AX_VOID);
-    AX_S32 GetFeatureInfo(const AX_CHAR *str);
+    /* queues an enrollment and waits up to nWaitMs, SEARCH_ENROLL_STATUS_PENDING is returned after that */
+    AX_S32 GetFeatureInfo(const AX_CHAR *str, AX_U32 *pId = nullptr, AX_U32 nWaitMs = SEARCH_ENROLL_WAIT_TIME);
+    AX_S32 GetEnrollStatus(AX_U32 nId);
     AX_S32 DeleteFeatureInfo(const AX_CHAR *str);
 
     //Search
     AX_BOOL SyncSearch(AX_SKEL_OBJECT_ITEM_S *object_item);
+    /* all objects of one frame, one search per group */
+    AX_VOID SyncSearch(AX_SKEL_OBJECT_ITEM_S *object_items, AX_U32 object_size, AX_BOOL *identified);
 
 private:
     /* virtual function of CSingleton */
@@ -113,15 +196,25 @@ private:
     //Feature
     AX_BOOL SaveFeature(std::string featureInfo, const AX_U8 *feature, AX_U32 feature_size);
     AX_BOOL DeleteFeature(std::string featureInfo);
-    AX_BOOL GenerateFeatureName(const AX_CHAR *str);
+    std::string GenerateFeatureName(const AX_CHAR *str);
     AX_BOOL SetHandleConfig(AX_VOID);
     AX_BOOL InitFeatureHandle(AX_VOID);
     AX_BOOL FeatureResultHandler(AX_SKEL_RESULT_S *algorithm_result);
-    AX_S32 Waitfor(AX_S32 msTimeOut = -1);
+
+    //Enrollment, m_enrollMutex held
+    AX_VOID EnrollThreadFunc(AX_VOID);
+    SEARCH_ENROLL_REQUEST_T *FindEnroll(AX_U32 nId);
+    AX_VOID FinishEnroll(SEARCH_ENROLL_REQUEST_T &tRequest, AX_S32 nStatus);
 
     //Load
     AX_BOOL LoadFeatureDataBase(AX_VOID);
     AX_VOID AsyncLoadFeatureThread(AX_VOID);
+    /* features back to back, one insert call for the whole batch */
+    AX_BOOL AddObjectsToGroup(AX_U64 groupid, const std::vector<std::string> &vecInfo, const AX_U8 *features, AX_U32 feature_size);
+
+    //Track cache
+    AX_BOOL TrackCacheLookup(SEARCH_TRACK_CACHE_T &tCache, AX_U64 nTick, AX_BOOL &bIdentified);
+    AX_VOID ClearTrackCache(AX_U64 groupid);
 
     //Search
     AX_BOOL Search(AX_U64 groupid, AX_U8 *features, int feature_cnt, int top_k,
@@ -130,13 +223,11 @@ private:
 public:
     //Feature
     AX_BOOL m_bGetFeatureResultThreadRunning;
-    AX_S32 m_GetFeatureInfoStatus;
 
     //Load
     AX_BOOL m_bLoadFeatureDataBaseThreadRunning;
 
 protected:
-    AX_BOOL m_bFinished;
     AX_BOOL m_bForedExit;
     AX_BOOL m_bFeatureDataBaseLoaded;
 
@@ -153,19 +244,36 @@ private:
     std::mutex m_setMutex;
     std::mutex m_mapMutex;
 
+    //CPU index, per group id
+    CFeatureIndex m_arrIndex[SEARCH_GROUP_NUM];
+
+    //Feature database
+    CFeatureStore m_tFeatureStore;
+
+    //Batch search scratch, only used by the detection result thread
+    std::vector<AX_U32> m_vecBatchItem;
+    std::vector<AX_U8> m_vecBatchFeature;
+    std::vector<FEATURE_INDEX_RESULT_T> m_vecBatchResult;
+    std::vector<SEARCH_TRACK_CACHE_T *> m_vecBatchCache;
+
+    //Track cache, per group id and keyed by track id
+    std::unordered_map<AX_U64, SEARCH_TRACK_CACHE_T> m_mapTrackCache[SEARCH_GROUP_NUM];
+    std::mutex m_trackCacheMutex;
+    AX_U64 m_nTrackCacheSweep{0};
+
     //Feature
-    std::mutex m_featureMutex;
-    SEARCH_FEATURE_RESULT_ST m_feature_result;
     AX_SKEL_HANDLE m_feature_handle = nullptr;
     thread *m_pGetFeatureResultThread = nullptr;
-    AX_BOOL m_bGetFeatureInfo = AX_FALSE;
-    std::mutex m_CaptureFeatureMutex;
-    std::string m_FeatureInfoStr;
+
+    //Enrollment, the worker is the only sender of m_feature_handle and keeps one frame in flight
+    std::mutex m_enrollMutex;
+    std::condition_variable m_cvEnroll;
+    std::deque<SEARCH_ENROLL_REQUEST_T> m_dqEnroll;  // submit order, finished ones kept as history
+    std::atomic<AX_U32> m_nEnrollWaitFrame{0};
+    AX_U32 m_nEnrollId{0};
+    thread *m_pEnrollThread = nullptr;
+    AX_BOOL m_bEnrollThreadRunning{AX_FALSE};
 
     //Load
     thread *m_pLoadFeatureDataBaseThread = nullptr;
-
-    pthread_mutex_t m_condMutx;
-    pthread_cond_t m_cond;
-    pthread_condattr_t m_condattr;
 };
@@ -0,0 +1,420 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#include "SkelMetaParser.h"
+
+#define SKEL_META_KEY_MAX_LEN (64)
+
+namespace {
+AX_S32 HexValue(AX_CHAR c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    } else if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+
+    return -1;
+}
+
+/* p points to 4 hex digits */
+AX_S32 ParseHex4(const AX_CHAR *p) {
+    AX_S32 nCode = 0;
+    for (AX_U32 i = 0; i < 4; i++) {
+        AX_S32 nHex = HexValue(p[i]);
+        if (nHex < 0) {
+            return -1;
+        }
+        nCode = (nCode << 4) | nHex;
+    }
+
+    return nCode;
+}
+
+/* returns bytes written, 0 if out of space */
+AX_U32 PutUtf8(AX_U32 nCode, AX_CHAR *pOut, AX_U32 nLeft) {
+    AX_U8 szBuf[4];
+    AX_U32 nLen = 0;
+
+    if (nCode < 0x80) {
+        szBuf[nLen++] = (AX_U8)nCode;
+    } else if (nCode < 0x800) {
+        szBuf[nLen++] = (AX_U8)(0xC0 | (nCode >> 6));
+        szBuf[nLen++] = (AX_U8)(0x80 | (nCode & 0x3F));
+    } else if (nCode < 0x10000) {
+        szBuf[nLen++] = (AX_U8)(0xE0 | (nCode >> 12));
+        szBuf[nLen++] = (AX_U8)(0x80 | ((nCode >> 6) & 0x3F));
+        szBuf[nLen++] = (AX_U8)(0x80 | (nCode & 0x3F));
+    } else {
+        szBuf[nLen++] = (AX_U8)(0xF0 | (nCode >> 18));
+        szBuf[nLen++] = (AX_U8)(0x80 | ((nCode >> 12) & 0x3F));
+        szBuf[nLen++] = (AX_U8)(0x80 | ((nCode >> 6) & 0x3F));
+        szBuf[nLen++] = (AX_U8)(0x80 | (nCode & 0x3F));
+    }
+
+    if (nLen > nLeft) {
+        return 0;
+    }
+
+    memcpy(pOut, szBuf, nLen);
+
+    return nLen;
+}
+} // namespace
+
+CSkelMetaParser::CSkelMetaParser(const AX_CHAR *pJson)
+{
+    m_pRoot = pJson ? SkipSpace(pJson) : nullptr;
+    m_bValid = (m_pRoot && *m_pRoot == '{' && SkipValue(m_pRoot, 0)) ? AX_TRUE : AX_FALSE;
+}
+
+AX_BOOL CSkelMetaParser::HasKey(const AX_CHAR *pKey) const
+{
+    if (!m_bValid) {
+        return AX_FALSE;
+    }
+
+    return FindMember(m_pRoot, pKey) ? AX_TRUE : AX_FALSE;
+}
+
+AX_BOOL CSkelMetaParser::GetString(const AX_CHAR *pKey, AX_CHAR *pOut, AX_U32 nSize) const
+{
+    if (!m_bValid) {
+        return AX_FALSE;
+    }
+
+    return DecodeString(FindMember(m_pRoot, pKey), pOut, nSize);
+}
+
+AX_BOOL CSkelMetaParser::GetString(const AX_CHAR *pKey, const AX_CHAR *pSubKey, AX_CHAR *pOut, AX_U32 nSize) const
+{
+    if (!m_bValid) {
+        return AX_FALSE;
+    }
+
+    return DecodeString(FindMember(m_pRoot, pKey, pSubKey), pOut, nSize);
+}
+
+AX_BOOL CSkelMetaParser::GetNumber(const AX_CHAR *pKey, AX_F64 &fValue) const
+{
+    if (!m_bValid) {
+        return AX_FALSE;
+    }
+
+    return DecodeNumber(FindMember(m_pRoot, pKey), fValue);
+}
+
+AX_BOOL CSkelMetaParser::GetNumber(const AX_CHAR *pKey, const AX_CHAR *pSubKey, AX_F64 &fValue) const
+{
+    if (!m_bValid) {
+        return AX_FALSE;
+    }
+
+    return DecodeNumber(FindMember(m_pRoot, pKey, pSubKey), fValue);
+}
+
+AX_BOOL CSkelMetaParser::GetBool(const AX_CHAR *pKey, AX_BOOL &bValue) const
+{
+    if (!m_bValid) {
+        return AX_FALSE;
+    }
+
+    const AX_CHAR *p = FindMember(m_pRoot, pKey);
+    if (!p) {
+        return AX_FALSE;
+    }
+
+    if (0 == strncmp(p, "true", 4)) {
+        bValue = AX_TRUE;
+        return AX_TRUE;
+    } else if (0 == strncmp(p, "false", 5)) {
+        bValue = AX_FALSE;
+        return AX_TRUE;
+    }
+
+    return AX_FALSE;
+}
+
+const AX_CHAR *CSkelMetaParser::SkipSpace(const AX_CHAR *p)
+{
+    while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') {
+        p++;
+    }
+
+    return p;
+}
+
+/* p points to the opening quote, returns the position after the closing quote */
+const AX_CHAR *CSkelMetaParser::SkipString(const AX_CHAR *p)
+{
+    if (*p != '"') {
+        return nullptr;
+    }
+
+    p++;
+    while (*p != '"') {
+        if ((AX_U8)*p < 0x20) {
+            // terminator or raw control character
+            return nullptr;
+        }
+
+        if (*p == '\\') {
+            p++;
+            switch (*p) {
+                case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+                    break;
+                case 'u': {
+                    AX_S32 nCode = ParseHex4(p + 1);
+                    if (nCode < 0 || (nCode >= 0xDC00 && nCode <= 0xDFFF)) {
+                        return nullptr;
+                    }
+                    p += 4;
+                    if (nCode >= 0xD800 && nCode <= 0xDBFF) {
+                        // high surrogate must be followed by a low one
+                        AX_S32 nLow = (p[1] == '\\' && p[2] == 'u') ? ParseHex4(p + 3) : -1;
+                        if (nLow < 0xDC00 || nLow > 0xDFFF) {
+                            return nullptr;
+                        }
+                        p += 6;
+                    }
+                    break;
+                }
+                default:
+                    return nullptr;
+            }
+        }
+        p++;
+    }
+
+    return p + 1;
+}
+
+/* same leniency as picojson: number charset accepted as a whole by strtod */
+const AX_CHAR *CSkelMetaParser::SkipNumber(const AX_CHAR *p)
+{
+    const AX_CHAR *pEnd = p;
+    while ((*pEnd >= '0' && *pEnd <= '9') || *pEnd == '+' || *pEnd == '-'
+           || *pEnd == '.' || *pEnd == 'e' || *pEnd == 'E') {
+        pEnd++;
+    }
+
+    if (pEnd == p) {
+        return nullptr;
+    }
+
+    AX_CHAR *pParsed = nullptr;
+    strtod(p, &pParsed);
+
+    return (pParsed == pEnd) ? pEnd : nullptr;
+}
+
+/* p points to the first character of a value, returns the position after it */
+const AX_CHAR *CSkelMetaParser::SkipValue(const AX_CHAR *p, AX_U32 nDepth)
+{
+    if (nDepth > SKEL_META_MAX_DEPTH) {
+        return nullptr;
+    }
+
+    switch (*p) {
+        case '"':
+            return SkipString(p);
+        case '{':
+        case '[': {
+            AX_BOOL bObject = (*p == '{') ? AX_TRUE : AX_FALSE;
+            AX_CHAR cClose = bObject ? '}' : ']';
+
+            p = SkipSpace(p + 1);
+            if (*p == cClose) {
+                return p + 1;
+            }
+
+            while (1) {
+                if (bObject) {
+                    p = SkipString(p);
+                    if (!p) {
+                        return nullptr;
+                    }
+                    p = SkipSpace(p);
+                    if (*p != ':') {
+                        return nullptr;
+                    }
+                    p = SkipSpace(p + 1);
+                }
+
+                p = SkipValue(p, nDepth + 1);
+                if (!p) {
+                    return nullptr;
+                }
+
+                p = SkipSpace(p);
+                if (*p == ',') {
+                    p = SkipSpace(p + 1);
+                } else if (*p == cClose) {
+                    return p + 1;
+                } else {
+                    return nullptr;
+                }
+            }
+        }
+        case 't':
+            return (0 == strncmp(p, "true", 4)) ? p + 4 : nullptr;
+        case 'f':
+            return (0 == strncmp(p, "false", 5)) ? p + 5 : nullptr;
+        case 'n':
+            return (0 == strncmp(p, "null", 4)) ? p + 4 : nullptr;
+        default:
+            if ((*p >= '0' && *p <= '9') || *p == '-') {
+                return SkipNumber(p);
+            }
+            return nullptr;
+    }
+}
+
+/* pObject points to '{' of a validated object, returns the value of the last member named pKey */
+const AX_CHAR *CSkelMetaParser::FindMember(const AX_CHAR *pObject, const AX_CHAR *pKey)
+{
+    if (!pObject || *pObject != '{' || !pKey) {
+        return nullptr;
+    }
+
+    const AX_CHAR *pFound = nullptr;
+    const AX_CHAR *p = SkipSpace(pObject + 1);
+    AX_U32 nKeyLen = strlen(pKey);
+
+    while (*p == '"') {
+        const AX_CHAR *pKeyEnd = SkipString(p);
+        if (!pKeyEnd) {
+            return nullptr;
+        }
+
+        AX_BOOL bMatch = AX_FALSE;
+        AX_U32 nRawLen = pKeyEnd - p - 2;
+        if (nRawLen == nKeyLen && 0 == strncmp(p + 1, pKey, nKeyLen)) {
+            bMatch = AX_TRUE;
+        } else if (memchr(p + 1, '\\', nRawLen)) {
+            // escaped key, compare decoded
+            AX_CHAR szKey[SKEL_META_KEY_MAX_LEN];
+            if (DecodeString(p, szKey, sizeof(szKey)) && 0 == strcmp(szKey, pKey)) {
+                bMatch = AX_TRUE;
+            }
+        }
+
+        p = SkipSpace(SkipSpace(pKeyEnd) + 1);
+        if (bMatch) {
+            pFound = p;
+        }
+
+        p = SkipSpace(SkipValue(p, 0));
+        if (*p != ',') {
+            break;
+        }
+        p = SkipSpace(p + 1);
+    }
+
+    return pFound;
+}
+
+const AX_CHAR *CSkelMetaParser::FindMember(const AX_CHAR *pObject, const AX_CHAR *pKey, const AX_CHAR *pSubKey)
+{
+    return FindMember(FindMember(pObject, pKey), pSubKey);
+}
+
+/* p points to the opening quote, output is truncated at a UTF8 character boundary */
+AX_BOOL CSkelMetaParser::DecodeString(const AX_CHAR *p, AX_CHAR *pOut, AX_U32 nSize)
+{
+    if (!p || *p != '"' || !pOut || 0 == nSize) {
+        return AX_FALSE;
+    }
+
+    AX_U32 nLen = 0;
+    AX_U32 nLeft = nSize - 1;
+    AX_BOOL bTruncated = AX_FALSE;
+
+    p++;
+    while (*p != '"' && !bTruncated) {
+        if (*p != '\\') {
+            if (nLen < nLeft) {
+                pOut[nLen++] = *p++;
+            } else {
+                bTruncated = AX_TRUE;
+            }
+            continue;
+        }
+
+        p++;
+        AX_U32 nCode = 0;
+        switch (*p) {
+            case 'b': nCode = '\b'; break;
+            case 'f': nCode = '\f'; break;
+            case 'n': nCode = '\n'; break;
+            case 'r': nCode = '\r'; break;
+            case 't': nCode = '\t'; break;
+            case 'u': {
+                AX_S32 nHigh = ParseHex4(p + 1);
+                p += 4;
+                nCode = (AX_U32)nHigh;
+                if (nHigh >= 0xD800 && nHigh <= 0xDBFF) {
+                    // surrogate pair
+                    AX_S32 nLow = (p[1] == '\\' && p[2] == 'u') ? ParseHex4(p + 3) : -1;
+                    if (nLow < 0xDC00 || nLow > 0xDFFF) {
+                        return AX_FALSE;
+                    }
+                    nCode = 0x10000 + (((AX_U32)nHigh - 0xD800) << 10) + ((AX_U32)nLow - 0xDC00);
+                    p += 6;
+                } else if (nHigh >= 0xDC00 && nHigh <= 0xDFFF) {
+                    return AX_FALSE;
+                }
+                break;
+            }
+            default:
+                nCode = (AX_U8)*p;
+                break;
+        }
+        p++;
+
+        AX_U32 nBytes = PutUtf8(nCode, pOut + nLen, nLeft - nLen);
+        if (0 == nBytes) {
+            bTruncated = AX_TRUE;
+        }
+        nLen += nBytes;
+    }
+
+    if (bTruncated) {
+        // drop a partially copied multi-byte character
+        AX_U32 nTail = nLen;
+        while (nTail > 0 && ((AX_U8)pOut[nTail - 1] & 0xC0) == 0x80) {
+            nTail--;
+        }
+        if (nTail > 0 && ((AX_U8)pOut[nTail - 1] & 0x80)) {
+            AX_U8 nLead = (AX_U8)pOut[nTail - 1];
+            AX_U32 nExpect = (nLead >= 0xF0) ? 4 : (nLead >= 0xE0) ? 3 : 2;
+            if (nLen - (nTail - 1) < nExpect) {
+                nLen = nTail - 1;
+            }
+        }
+    }
+
+    pOut[nLen] = '\0';
+
+    return AX_TRUE;
+}
+
+AX_BOOL CSkelMetaParser::DecodeNumber(const AX_CHAR *p, AX_F64 &fValue)
+{
+    if (!p || !SkipNumber(p)) {
+        return AX_FALSE;
+    }
+
+    fValue = strtod(p, nullptr);
+
+    return AX_TRUE;
+}
@@ -0,0 +1,57 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+#pragma once
+
+#include "global.h"
+
+#define SKEL_META_MAX_DEPTH (32)
+
+/**
+ * SKEL meta info (JSON) extractor
+ * Scans the C string in place and pulls single members out of the root object,
+ * no DOM is built and no heap is touched. Duplicated keys resolve to the last one,
+ * same as picojson.
+ */
+class CSkelMetaParser
+{
+public:
+    CSkelMetaParser(const AX_CHAR *pJson);
+
+    AX_BOOL IsValid(AX_VOID) const {
+        return m_bValid;
+    }
+
+    AX_BOOL HasKey(const AX_CHAR *pKey) const;
+
+    /* "key": "value" */
+    AX_BOOL GetString(const AX_CHAR *pKey, AX_CHAR *pOut, AX_U32 nSize) const;
+    /* "key": {"sub_key": "value"} */
+    AX_BOOL GetString(const AX_CHAR *pKey, const AX_CHAR *pSubKey, AX_CHAR *pOut, AX_U32 nSize) const;
+    /* "key": 1.0 */
+    AX_BOOL GetNumber(const AX_CHAR *pKey, AX_F64 &fValue) const;
+    /* "key": {"sub_key": 1.0} */
+    AX_BOOL GetNumber(const AX_CHAR *pKey, const AX_CHAR *pSubKey, AX_F64 &fValue) const;
+    /* "key": true */
+    AX_BOOL GetBool(const AX_CHAR *pKey, AX_BOOL &bValue) const;
+
+private:
+    static const AX_CHAR *SkipSpace(const AX_CHAR *p);
+    static const AX_CHAR *SkipString(const AX_CHAR *p);
+    static const AX_CHAR *SkipNumber(const AX_CHAR *p);
+    static const AX_CHAR *SkipValue(const AX_CHAR *p, AX_U32 nDepth);
+    static const AX_CHAR *FindMember(const AX_CHAR *pObject, const AX_CHAR *pKey);
+    static const AX_CHAR *FindMember(const AX_CHAR *pObject, const AX_CHAR *pKey, const AX_CHAR *pSubKey);
+    static AX_BOOL DecodeString(const AX_CHAR *p, AX_CHAR *pOut, AX_U32 nSize);
+    static AX_BOOL DecodeNumber(const AX_CHAR *p, AX_F64 &fValue);
+
+private:
+    const AX_CHAR *m_pRoot;
+    AX_BOOL m_bValid;
+};
@@ -0,0 +1,290 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+
+/**
+ * Stand-in for the AX_SKEL detection API, built with "make skelstub=yes".
+ * Models one serial NPU with a fixed inference time so the AI benchmark measures
+ * pipeline and result handler cost without models. Search API is not covered,
+ * disable search when using it.
+ *
+ * Environment:
+ *   AI_SKEL_STUB_LATENCY_MS=<n>  inference time per frame (default 30)
+ *   AI_SKEL_STUB_OBJECTS=<n>     body objects per result (default 2)
+ */
+#ifdef AX_SKEL_STUB
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include "global.h"
+#include "ax_skel_api.h"
+
+#define SKEL_STUB_LATENCY_ENV_STR "AI_SKEL_STUB_LATENCY_MS"
+#define SKEL_STUB_OBJECTS_ENV_STR "AI_SKEL_STUB_OBJECTS"
+#define SKEL_STUB_DEFAULT_LATENCY (30)
+#define SKEL_STUB_DEFAULT_OBJECTS (2)
+#define SKEL_STUB_MAX_OBJECTS (32)
+
+namespace {
+typedef struct _SKEL_STUB_FRAME_T {
+    AX_U64 nFrameId;
+    AX_VOID *pUserData;
+    std::chrono::steady_clock::time_point tpReady;
+} SKEL_STUB_FRAME_T;
+
+typedef struct _SKEL_STUB_HANDLE_T {
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::deque<SKEL_STUB_FRAME_T> qFrame;
+    std::chrono::steady_clock::time_point tpNpuFree;
+    AX_BOOL bCreated{AX_FALSE};
+    AX_U32 nWidth{0};
+    AX_U32 nHeight{0};
+    AX_U32 nDepth{1};
+    AX_U32 nLatency{SKEL_STUB_DEFAULT_LATENCY};
+    AX_U32 nObjects{SKEL_STUB_DEFAULT_OBJECTS};
+} SKEL_STUB_HANDLE_T;
+
+/* one stream only, never freed so that a blocked GetResult survives Destroy */
+SKEL_STUB_HANDLE_T g_tStubHandle;
+
+AX_SKEL_PPL_CONFIG_S g_arrStubPPL[] = {
+    {AX_SKEL_PPL_BODY, (AX_CHAR *)"body"},
+    {AX_SKEL_PPL_POSE, (AX_CHAR *)"pose"},
+    {AX_SKEL_PPL_FH, (AX_CHAR *)"fh"},
+    {AX_SKEL_PPL_HVCFP, (AX_CHAR *)"hvcfp"},
+    {AX_SKEL_PPL_FACE_FEATURE, (AX_CHAR *)"face_feature"},
+    {AX_SKEL_PPL_HVCP, (AX_CHAR *)"hvcp"},
+};
+
+AX_SKEL_CAPABILITY_S g_tStubCapability = {sizeof(g_arrStubPPL) / sizeof(g_arrStubPPL[0]), g_arrStubPPL, 0, NULL, NULL};
+AX_SKEL_VERSION_INFO_S g_tStubVersion = {(AX_CHAR *)"SKEL stub", 0, NULL, NULL};
+
+AX_U32 GetEnvU32(const AX_CHAR *szName, AX_U32 nDefault)
+{
+    const AX_CHAR *szValue = getenv(szName);
+    return szValue ? (AX_U32)atoi(szValue) : nDefault;
+}
+
+AX_SKEL_RESULT_S *CreateResult(const SKEL_STUB_FRAME_T &tFrame, const SKEL_STUB_HANDLE_T &tHandle)
+{
+    AX_SKEL_RESULT_S *pResult = new AX_SKEL_RESULT_S();
+    pResult->nFrameId = tFrame.nFrameId;
+    pResult->nOriginalWidth = tHandle.nWidth;
+    pResult->nOriginalHeight = tHandle.nHeight;
+    pResult->pUserData = tFrame.pUserData;
+
+    if (tHandle.nObjects > 0) {
+        pResult->nObjectSize = tHandle.nObjects;
+        pResult->pstObjectItems = new AX_SKEL_OBJECT_ITEM_S[tHandle.nObjects]();
+
+        // boxes drift with the frame id so that trackers and predictors see motion
+        AX_F32 fW = tHandle.nWidth / 8.0;
+        AX_F32 fH = tHandle.nHeight / 4.0;
+        AX_U64 nRange = AX_MAX((AX_U64)(tHandle.nWidth - fW), (AX_U64)1);
+        for (AX_U32 i = 0; i < tHandle.nObjects; i++) {
+            AX_SKEL_OBJECT_ITEM_S &tItem = pResult->pstObjectItems[i];
+            tItem.pstrObjectCategory = "body";
+            tItem.stRect.fX = (AX_F32)((tFrame.nFrameId * 4 + (AX_U64)(i * fW)) % nRange);
+            tItem.stRect.fY = (i % 3) * fH;
+            tItem.stRect.fW = fW;
+            tItem.stRect.fH = fH;
+            tItem.nFrameId = tFrame.nFrameId;
+            tItem.nTrackId = i + 1;
+            tItem.eTrackState = (1 == tFrame.nFrameId) ? AX_SKEL_TRACK_STATUS_NEW : AX_SKEL_TRACK_STATUS_UPDATE;
+            tItem.fConfidence = 0.9;
+        }
+    }
+
+    return pResult;
+}
+} // namespace
+
+AX_S32 AX_SKEL_Init(const AX_SKEL_INIT_PARAM_S *pstParam)
+{
+    return AX_SKEL_SUCC;
+}
+
+AX_S32 AX_SKEL_DeInit(AX_VOID)
+{
+    return AX_SKEL_SUCC;
+}
+
+AX_S32 AX_SKEL_Create(const AX_SKEL_HANDLE_PARAM_S *pstParam, AX_SKEL_HANDLE *pHandle)
+{
+    if (!pstParam || !pHandle) {
+        return AX_ERR_SKEL_NULL_PTR;
+    }
+
+    SKEL_STUB_HANDLE_T &tHandle = g_tStubHandle;
+    std::lock_guard<std::mutex> lck(tHandle.mtx);
+
+    tHandle.qFrame.clear();
+    tHandle.bCreated = AX_TRUE;
+    tHandle.nWidth = pstParam->nWidth;
+    tHandle.nHeight = pstParam->nHeight;
+    tHandle.nDepth = AX_MAX(pstParam->nFrameDepth + pstParam->nFrameCacheDepth, (AX_U32)1);
+    tHandle.nLatency = GetEnvU32(SKEL_STUB_LATENCY_ENV_STR, SKEL_STUB_DEFAULT_LATENCY);
+    tHandle.nObjects = AX_MIN(GetEnvU32(SKEL_STUB_OBJECTS_ENV_STR, SKEL_STUB_DEFAULT_OBJECTS), (AX_U32)SKEL_STUB_MAX_OBJECTS);
+    tHandle.tpNpuFree = std::chrono::steady_clock::now();
+
+    *pHandle = &tHandle;
+
+    return AX_SKEL_SUCC;
+}
+
+AX_S32 AX_SKEL_Destroy(AX_SKEL_HANDLE handle)
+{
+    SKEL_STUB_HANDLE_T *pHandle = (SKEL_STUB_HANDLE_T *)handle;
+    if (pHandle != &g_tStubHandle) {
+        return AX_ERR_SKEL_INVALID_HANDLE;
+    }
+
+    std::lock_guard<std::mutex> lck(pHandle->mtx);
+    pHandle->bCreated = AX_FALSE;
+    pHandle->qFrame.clear();
+    pHandle->cv.notify_all();
+
+    return AX_SKEL_SUCC;
+}
+
+AX_S32 AX_SKEL_RegisterResultCallback(AX_SKEL_HANDLE handle, AX_SKEL_RESULT_CALLBACK_FUNC callback, AX_VOID *pUserData)
+{
+    return AX_SKEL_SUCC;
+}
+
+AX_S32 AX_SKEL_SendFrame(AX_SKEL_HANDLE handle, const AX_SKEL_FRAME_S *pstFrame, AX_S32 nTimeout)
+{
+    SKEL_STUB_HANDLE_T *pHandle = (SKEL_STUB_HANDLE_T *)handle;
+    if (pHandle != &g_tStubHandle || !pstFrame) {
+        return AX_ERR_SKEL_NULL_PTR;
+    }
+
+    std::unique_lock<std::mutex> lck(pHandle->mtx);
+    auto Writable = [pHandle] {
+        return !pHandle->bCreated || pHandle->qFrame.size() < pHandle->nDepth;
+    };
+
+    if (nTimeout < 0) {
+        pHandle->cv.wait(lck, Writable);
+    } else if (!pHandle->cv.wait_for(lck, std::chrono::milliseconds(nTimeout), Writable)) {
+        return AX_ERR_SKEL_QUEUE_FULL;
+    }
+
+    if (!pHandle->bCreated) {
+        return AX_ERR_SKEL_INVALID_HANDLE;
+    }
+
+    // serial NPU: inference starts when the previous frame is done
+    auto tpNow = std::chrono::steady_clock::now();
+    auto tpStart = AX_MAX(tpNow, pHandle->tpNpuFree);
+    pHandle->tpNpuFree = tpStart + std::chrono::milliseconds(pHandle->nLatency);
+
+    SKEL_STUB_FRAME_T tFrame;
+    tFrame.nFrameId = pstFrame->nFrameId;
+    tFrame.pUserData = pstFrame->pUserData;
+    tFrame.tpReady = pHandle->tpNpuFree;
+    pHandle->qFrame.push_back(tFrame);
+    pHandle->cv.notify_all();
+
+    return AX_SKEL_SUCC;
+}
+
+AX_S32 AX_SKEL_GetResult(AX_SKEL_HANDLE handle, AX_SKEL_RESULT_S **ppstResult, AX_S32 nTimeout)
+{
+    SKEL_STUB_HANDLE_T *pHandle = (SKEL_STUB_HANDLE_T *)handle;
+    if (pHandle != &g_tStubHandle || !ppstResult) {
+        return AX_ERR_SKEL_NULL_PTR;
+    }
+
+    std::unique_lock<std::mutex> lck(pHandle->mtx);
+    auto tpDeadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(nTimeout < 0 ? 0 : nTimeout);
+
+    while (pHandle->bCreated) {
+        auto tpNow = std::chrono::steady_clock::now();
+        if (!pHandle->qFrame.empty() && pHandle->qFrame.front().tpReady <= tpNow) {
+            break;
+        }
+
+        if (nTimeout >= 0 && tpNow >= tpDeadline) {
+            return AX_ERR_SKEL_TIMEOUT;
+        }
+
+        if (pHandle->qFrame.empty()) {
+            if (nTimeout < 0) {
+                pHandle->cv.wait(lck);
+            } else {
+                pHandle->cv.wait_until(lck, tpDeadline);
+            }
+        } else {
+            auto tpWake = pHandle->qFrame.front().tpReady;
+            pHandle->cv.wait_until(lck, (nTimeout < 0) ? tpWake : AX_MIN(tpWake, tpDeadline));
+        }
+    }
+
+    if (!pHandle->bCreated) {
+        return AX_ERR_SKEL_QUEUE_EMPTY;
+    }
+
+    *ppstResult = CreateResult(pHandle->qFrame.front(), *pHandle);
+    pHandle->qFrame.pop_front();
+    pHandle->cv.notify_all();
+
+    return AX_SKEL_SUCC;
+}
+
+AX_S32 AX_SKEL_Release(AX_VOID *p)
+{
+    if (!p || p == &g_tStubCapability || p == &g_tStubVersion) {
+        return AX_SKEL_SUCC;
+    }
+
+    // everything else handed out by the stub is a result
+    AX_SKEL_RESULT_S *pResult = (AX_SKEL_RESULT_S *)p;
+    delete[] pResult->pstObjectItems;
+    delete pResult;
+
+    return AX_SKEL_SUCC;
+}
+
+AX_S32 AX_SKEL_GetCapability(const AX_SKEL_CAPABILITY_S **ppstCapability)
+{
+    if (!ppstCapability) {
+        return AX_ERR_SKEL_NULL_PTR;
+    }
+
+    *ppstCapability = &g_tStubCapability;
+
+    return AX_SKEL_SUCC;
+}
+
+AX_S32 AX_SKEL_GetVersion(const AX_SKEL_VERSION_INFO_S **ppstVersion)
+{
+    if (!ppstVersion) {
+        return AX_ERR_SKEL_NULL_PTR;
+    }
+
+    *ppstVersion = &g_tStubVersion;
+
+    return AX_SKEL_SUCC;
+}
+
+AX_S32 AX_SKEL_GetConfig(AX_SKEL_HANDLE handle, const AX_SKEL_CONFIG_S **ppstConfig)
+{
+    return AX_ERR_SKEL_ILLEGAL_PARAM;
+}
+
+AX_S32 AX_SKEL_SetConfig(AX_SKEL_HANDLE handle, const AX_SKEL_CONFIG_S *pstConfig)
+{
+    return AX_SKEL_SUCC;
+}
+
+#endif /* AX_SKEL_STUB */
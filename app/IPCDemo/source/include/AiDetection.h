@@ -19,6 +19,9 @@ extern "C" {
 /* Pose Point Detection */
 #define DETECT_POSE_POINT_COUNT 17
 
+/* Attribute string length (UTF8, include terminator) */
+#define AI_ATTR_STRING_LEN 32
+
 #define DETECT_DEFAULT_WIDTH 1280
 #define DETECT_DEFAULT_HEIGHT 720
 #define DETECT_DEFAULT_IVES_FRAMERATE_CTRL 1
@@ -81,13 +84,13 @@ typedef enum _AI_DRAW_RECT_TYPE_E {
 /* Not Support */
 typedef struct _AI_Body_Attr_t {
     AX_BOOL bExist;
-    std::string strSafetyCap;
-    std::string strHairLength;
+    AX_CHAR szSafetyCap[AI_ATTR_STRING_LEN];
+    AX_CHAR szHairLength[AI_ATTR_STRING_LEN];
 
     _AI_Body_Attr_t() {
         bExist = AX_FALSE;
-        strSafetyCap = "";
-        strHairLength = "";
+        memset(szSafetyCap, 0x00, sizeof(szSafetyCap));
+        memset(szHairLength, 0x00, sizeof(szHairLength));
     }
 } AI_Body_Attr_t;
 
@@ -106,48 +109,48 @@ typedef struct _AI_Plat_Attr_t {
         absence
         unknown
     */
-    std::string strPlateColor;
+    AX_CHAR szPlateColor[AI_ATTR_STRING_LEN];
     /*
     string:
         one_row
         two_rows
         unknown
     */
-    std::string strPlateType;
+    AX_CHAR szPlateType[AI_ATTR_STRING_LEN];
     /* string: UTF8*/
-    std::string strPlateCode;
+    AX_CHAR szPlateCode[AI_ATTR_STRING_LEN];
 
     _AI_Plat_Attr_t() {
         bExist = AX_FALSE;
         bValid = AX_FALSE;
-        strPlateColor = "";
-        strPlateType = "";
-        strPlateCode = "";
+        memset(szPlateColor, 0x00, sizeof(szPlateColor));
+        memset(szPlateType, 0x00, sizeof(szPlateType));
+        memset(szPlateCode, 0x00, sizeof(szPlateCode));
     }
 } AI_Plat_Attr_t;
 
 typedef struct _AI_Vehicle_Attr_t {
     AX_BOOL bExist;
-    std::string strVehicleColor;
-    std::string strVehicleSubclass;
+    AX_CHAR szVehicleColor[AI_ATTR_STRING_LEN];
+    AX_CHAR szVehicleSubclass[AI_ATTR_STRING_LEN];
 
     AI_Plat_Attr_t plate_attr;
 
     _AI_Vehicle_Attr_t() {
         bExist = AX_FALSE;
-        strVehicleColor = "";
-        strVehicleSubclass = "";
+        memset(szVehicleColor, 0x00, sizeof(szVehicleColor));
+        memset(szVehicleSubclass, 0x00, sizeof(szVehicleSubclass));
     }
 } AI_Vehicle_Attr_t;
 
 /* Not Support */
 typedef struct _AI_Cycle_Attr_t {
     AX_BOOL bExist;
-    std::string strCycleSubclass;
+    AX_CHAR szCycleSubclass[AI_ATTR_STRING_LEN];
 
     _AI_Cycle_Attr_t() {
         bExist = AX_FALSE;
-        strCycleSubclass = "";
+        memset(szCycleSubclass, 0x00, sizeof(szCycleSubclass));
     }
 } AI_Cycle_Attr_t;
 
@@ -165,13 +168,13 @@ typedef struct _AI_Face_Attr_t {
         kitchen_transparent
         unknown
     */
-    std::string strRespirator;
+    AX_CHAR szRespirator[AI_ATTR_STRING_LEN];
 
     _AI_Face_Attr_t() {
         bExist = AX_FALSE;
         nAge = 0;
         nGender = 0;
-        strRespirator = "";
+        memset(szRespirator, 0x00, sizeof(szRespirator));
     }
 } AI_Face_Attr_t;
 
@@ -311,7 +314,9 @@ typedef struct _AI_CONFIG_T
     AX_U32 nCacheDepth;
     AX_U32 nDetectFps;
     AX_U32 nAiFps;
+    AX_U32 nAiMinFps; /* heartbeat fps when idle, 0: adaptive scheduling off */
     AX_U32 nIvesFps;
+    AX_BOOL bRtspMeta; /* add ONVIF metadata track into RTSP sessions */
 } AI_CONFIG_T, *AI_CONFIG_PTR;
 
 typedef struct _DETECTOR_STREAM_PARAM_T {
@@ -12,6 +12,7 @@
 #define _CMEDIA_FRAME_H
 
 #include "global.h"
+#include <atomic>
 
 class CMediaFrame;
 class IFrameRelease
@@ -35,6 +36,7 @@ public:
     AX_U8                 nIvpsReleaseGrp;
     AX_U8                 nReleaseChannel;
     IFrameRelease*        pFrameRelease;
+    std::atomic<AX_S32>   nRefCount;    // released when the last holder calls FreeMem
 
     CMediaFrame() {
         memset(&tFrame, 0, sizeof(AX_IMG_INFO_T));
@@ -49,11 +51,20 @@ public:
         nIvpsReleaseGrp = 0;
         nReleaseChannel = 0;
         pFrameRelease = NULL;
+        nRefCount = 1;
     }
 
     virtual ~CMediaFrame() {}
 
+    AX_VOID AddRef(void) {
+        ++nRefCount;
+    }
+
     AX_VOID FreeMem(void) {
+        if (--nRefCount > 0) {
+            return;
+        }
+
         if (pFrameRelease) {
             pFrameRelease->MediaFrameRelease(this);
         }
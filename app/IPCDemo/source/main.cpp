@@ -42,6 +42,7 @@
 #include "Md.h"
 #include "Od.h"
 #include "Scd.h"
+#include "EventAggregator.h"
 #include "HotBalance.h"
 
 // add opencv by Yang
@@ -185,9 +186,15 @@ int main(int argc, const char *argv[])
     CMPEG4Encoder *pMpeg4Encoder = CMPEG4Encoder::GetInstance();
     RESULT_CHECK(pMpeg4Encoder);
 
-    CMD::GetInstance()->SetWebServer(&g_webserver);
-    COD::GetInstance()->SetWebServer(&g_webserver);
-    CSCD::GetInstance()->SetWebServer(&g_webserver);
+    CEventAggregator::GetInstance()->SetWebServer(&g_webserver);
+
+    if (gOptions.IsActivedDetect() && CStageOptionHelper().GetInstance()->GetAiAttr().tConfig.bRtspMeta) {
+        g_rtspServer.SetMetaEnable(AX_TRUE);
+        CDetector::GetInstance()->SetRTSPServer(&g_rtspServer);
+        CEventAggregator::GetInstance()->SetRTSPServer(&g_rtspServer);
+    }
+
+    CEventAggregator::GetInstance()->Start();
 
     /* Init encoder */
     // 不懂这个END_POINT 是什么意思
@@ -339,6 +346,7 @@ END:
 
     g_camera.Close();
 
+    CEventAggregator::GetInstance()->Stop();
     g_rtspServer.Stop();
     g_webserver.Stop();
     gPrintHelper.Stop();
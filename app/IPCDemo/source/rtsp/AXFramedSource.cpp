@@ -59,6 +59,7 @@ void AXFramedSource::AddFrameBuff(AX_U8 nChn, const AX_U8* pBuf, AX_U32 nLen, AX
     tFrame.pBuf = (AX_U8 *)malloc(nSize);
     memcpy(tFrame.pBuf, pBuf,nSize);
     tFrame.nSize = nSize;
+    tFrame.nPts = nPts;
     m_qFrame.push(tFrame);
 #else
     CAXRingElement ele((AX_U8*)pBuf, nLen, nChn, nPts, bIFrame);
@@ -93,6 +94,7 @@ void AXFramedSource::_deliverFrame() {
 
     u_int8_t* newFrameDataStart = (u_int8_t*)tFrame.pBuf; //%%% TO BE WRITTEN %%%
     unsigned newFrameSize = static_cast<unsigned int>(tFrame.nSize); //%%% TO BE WRITTEN %%%
+    AX_U64 nFramePts = tFrame.nPts;
 #else
     CAXRingElement *element = m_pRingBuf->Get();
     if (!element) {
@@ -100,6 +102,7 @@ void AXFramedSource::_deliverFrame() {
     }
     u_int8_t* newFrameDataStart = element->pBuf;
     AX_U32 newFrameSize = element->nSize;
+    AX_U64 nFramePts = element->nPts;
 
     if (0 == newFrameSize || nullptr == newFrameDataStart) {
         return;
@@ -114,6 +117,9 @@ void AXFramedSource::_deliverFrame() {
         fFrameSize = newFrameSize;
     }
     gettimeofday(&fPresentationTime, NULL); // If you have a more accurate time - e.g., from an encoder - then use that instead.
+    if (m_pClockAnchor && nFramePts) {
+        m_pClockAnchor->Update(nFramePts, fPresentationTime);
+    }
     // If the device is *not* a 'live source' (e.g., it comes instead from a file or buffer), then set "fDurationInMicroseconds" here.
     memmove(fTo, newFrameDataStart, fFrameSize);
 
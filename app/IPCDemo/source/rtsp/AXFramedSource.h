@@ -14,12 +14,14 @@
 #include "FramedSource.hh"
 #include "global.h"
 #include "AXRingBuffer.h"
+#include "AXRtspClockAnchor.h"
 #include <queue>
 
 typedef struct _FrameInfo_T
 {
     AX_U8 * pBuf;
     AX_U32  nSize;
+    AX_U64  nPts;
 } FrameInfo_T;
 
 class AXFramedSource: public FramedSource {
@@ -33,6 +35,7 @@ public:
     // You can, however, redefine this to be a non-static member variable.
     void AddFrameBuff(AX_U8 nChn, const AX_U8* pBuf, AX_U32 nLen, AX_U64 nPts=0, AX_BOOL bIFrame=AX_FALSE);
     virtual unsigned maxFrameSize() const;
+    void SetClockAnchor(AXRtspClockAnchor* pAnchor) { m_pClockAnchor = pAnchor; }
 
 protected:
     AXFramedSource(UsageEnvironment& env);
@@ -54,6 +57,7 @@ private:
     CAXRingBuffer* m_pRingBuf;
 
     u_int32_t m_nTriggerID;
+    AXRtspClockAnchor* m_pClockAnchor{nullptr};
 };
 
 
@@ -12,18 +12,20 @@
 #include <GroupsockHelper.hh>
 
 
-AXLiveServerMediaSession* AXLiveServerMediaSession::createNew(UsageEnvironment& env, bool reuseFirstSource, bool isH264)
+AXLiveServerMediaSession* AXLiveServerMediaSession::createNew(UsageEnvironment& env, bool reuseFirstSource, bool isH264,
+                                                              AXRtspClockAnchor* pClockAnchor)
 {
-    return new AXLiveServerMediaSession(env, reuseFirstSource, isH264);
+    return new AXLiveServerMediaSession(env, reuseFirstSource, isH264, pClockAnchor);
 }
 
-AXLiveServerMediaSession::AXLiveServerMediaSession(UsageEnvironment& env, bool reuseFirstSource, bool isH264)
+AXLiveServerMediaSession::AXLiveServerMediaSession(UsageEnvironment& env, bool reuseFirstSource, bool isH264, AXRtspClockAnchor* pClockAnchor)
 :OnDemandServerMediaSubsession(env,reuseFirstSource),
 m_bH264(isH264),
 fAuxSDPLine(NULL),
 fDoneFlag(0),
 fDummySink(NULL),
-m_pSource(NULL)
+m_pSource(NULL),
+m_pClockAnchor(pClockAnchor)
 {
     pthread_spin_init(&m_tLock, 0);
 }
@@ -93,6 +95,7 @@ FramedSource* AXLiveServerMediaSession::createNewStreamSource(unsigned clientSes
     // Based on encoder configuration i kept it 90000
     // estBitRate = 6000000;
     AXFramedSource *source = AXFramedSource::createNew(envir());
+    source->SetClockAnchor(m_pClockAnchor);
     pthread_spin_lock(&m_tLock);
     m_pSource = source;
     pthread_spin_unlock(&m_tLock);
@@ -20,12 +20,13 @@
 
 class AXLiveServerMediaSession: public OnDemandServerMediaSubsession {
 public:
-    static AXLiveServerMediaSession* createNew(UsageEnvironment& env, bool reuseFirstSource, bool isH264=true);
+    static AXLiveServerMediaSession* createNew(UsageEnvironment& env, bool reuseFirstSource, bool isH264=true,
+                                               AXRtspClockAnchor* pClockAnchor=NULL);
     void checkForAuxSDPLine1();
     void afterPlayingDummy1();
     void SendNalu(AX_U8 nChn, const AX_U8* pBuf, AX_U32 nLen, AX_U64 nPts=0, AX_BOOL bIFrame=AX_FALSE);
 protected:
-    AXLiveServerMediaSession(UsageEnvironment& env, bool reuseFirstSource, bool isH264);
+    AXLiveServerMediaSession(UsageEnvironment& env, bool reuseFirstSource, bool isH264, AXRtspClockAnchor* pClockAnchor);
     virtual ~AXLiveServerMediaSession(void);
     void setDoneFlag() { fDoneFlag = ~0; }
 
@@ -43,6 +44,7 @@ private:
     char fDoneFlag;
     RTPSink* fDummySink;
     AXFramedSource * m_pSource;
+    AXRtspClockAnchor* m_pClockAnchor;
     pthread_spinlock_t m_tLock;
 };
 
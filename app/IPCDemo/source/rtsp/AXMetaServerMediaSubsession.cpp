@@ -0,0 +1,143 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+
+#include "AXMetaServerMediaSubsession.h"
+#include <GroupsockHelper.hh>
+
+#define LIVE "LIVE"
+
+AXMetaFramedSource* AXMetaFramedSource::createNew(UsageEnvironment& env, AXRtspClockAnchor* pClockAnchor) {
+    return new AXMetaFramedSource(env, pClockAnchor);
+}
+
+AXMetaFramedSource::AXMetaFramedSource(UsageEnvironment& env, AXRtspClockAnchor* pClockAnchor)
+: FramedSource(env)
+, m_pClockAnchor(pClockAnchor) {
+    m_nTriggerID = envir().taskScheduler().createEventTrigger(deliverFrame);
+    m_pRingBuf = new CAXRingBuffer(RTSP_META_MAX_SIZE, RTSP_META_RING_COUNT, "RTSP_META");
+}
+
+AXMetaFramedSource::~AXMetaFramedSource() {
+    envir().taskScheduler().deleteEventTrigger(m_nTriggerID);
+    delete(m_pRingBuf);
+}
+
+void AXMetaFramedSource::AddMeta(const AX_U8* pBuf, AX_U32 nLen, AX_U64 nPts) {
+    CAXRingElement ele((AX_U8*)pBuf, nLen, 0, nPts);
+    m_pRingBuf->Put(ele);
+
+    envir().taskScheduler().triggerEvent(m_nTriggerID, this);
+}
+
+void AXMetaFramedSource::doGetNextFrame() {
+    _deliverFrame();
+}
+
+void AXMetaFramedSource::deliverFrame(void* clientData) {
+    ((AXMetaFramedSource*)clientData)->_deliverFrame();
+}
+
+void AXMetaFramedSource::_deliverFrame() {
+    if (!isCurrentlyAwaitingData()) {
+        return;
+    }
+
+    CAXRingElement *element = m_pRingBuf->Get();
+    if (!element) {
+        return;
+    }
+
+    if (0 == element->nSize || nullptr == element->pBuf) {
+        m_pRingBuf->Pop();
+        return;
+    }
+
+    if (element->nSize > fMaxSize) {
+        LOG_M_W(LIVE, "Exceeding max meta size: %d > fMaxSize:%d", element->nSize, fMaxSize);
+        fFrameSize = fMaxSize;
+        fNumTruncatedBytes = element->nSize - fMaxSize;
+    } else {
+        fFrameSize = element->nSize;
+    }
+
+    if (m_pClockAnchor) {
+        m_pClockAnchor->Map(element->nPts, fPresentationTime);
+    } else {
+        gettimeofday(&fPresentationTime, NULL);
+    }
+
+    memmove(fTo, element->pBuf, fFrameSize);
+
+    m_pRingBuf->Pop();
+
+    FramedSource::afterGetting(this);
+}
+
+unsigned AXMetaFramedSource::maxFrameSize() const {
+    return RTSP_META_MAX_SIZE;
+}
+
+AXMetaServerMediaSubsession* AXMetaServerMediaSubsession::createNew(UsageEnvironment& env, bool reuseFirstSource, AXRtspClockAnchor* pClockAnchor)
+{
+    return new AXMetaServerMediaSubsession(env, reuseFirstSource, pClockAnchor);
+}
+
+AXMetaServerMediaSubsession::AXMetaServerMediaSubsession(UsageEnvironment& env, bool reuseFirstSource, AXRtspClockAnchor* pClockAnchor)
+: OnDemandServerMediaSubsession(env, reuseFirstSource)
+, m_pSource(NULL)
+, m_pClockAnchor(pClockAnchor)
+{
+    pthread_spin_init(&m_tLock, 0);
+}
+
+AXMetaServerMediaSubsession::~AXMetaServerMediaSubsession(void) {
+    pthread_spin_destroy(&m_tLock);
+}
+
+FramedSource* AXMetaServerMediaSubsession::createNewStreamSource(unsigned clientSessionID, unsigned& estBitRate) {
+    estBitRate = 64; // kbps
+    AXMetaFramedSource *source = AXMetaFramedSource::createNew(envir(), m_pClockAnchor);
+    pthread_spin_lock(&m_tLock);
+    m_pSource = source;
+    pthread_spin_unlock(&m_tLock);
+
+    return source;
+}
+
+void AXMetaServerMediaSubsession::closeStreamSource(FramedSource *inputSource) {
+    pthread_spin_lock(&m_tLock);
+    m_pSource = NULL;
+    Medium::close(inputSource);
+    pthread_spin_unlock(&m_tLock);
+}
+
+RTPSink* AXMetaServerMediaSubsession::createNewRTPSink(Groupsock* rtpGroupsock, unsigned char rtpPayloadTypeIfDynamic, FramedSource* inputSource) {
+    // one xml document per frame, fragmented across packets with marker bit on the last one
+    return SimpleRTPSink::createNew(envir(), rtpGroupsock, rtpPayloadTypeIfDynamic, 90000,
+                                    "application", "VND.ONVIF.METADATA", 1, False, True);
+}
+
+bool AXMetaServerMediaSubsession::IsActive(void)
+{
+    pthread_spin_lock(&m_tLock);
+    bool bActive = (m_pSource != NULL);
+    pthread_spin_unlock(&m_tLock);
+
+    return bActive;
+}
+
+void AXMetaServerMediaSubsession::SendMeta(const AX_U8* pBuf, AX_U32 nLen, AX_U64 nPts)
+{
+    pthread_spin_lock(&m_tLock);
+    if (m_pSource) {
+        m_pSource->AddMeta(pBuf, nLen, nPts);
+    }
+    pthread_spin_unlock(&m_tLock);
+}
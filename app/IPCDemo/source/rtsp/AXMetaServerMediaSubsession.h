@@ -0,0 +1,74 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+
+#ifndef __AXMETASERVERMEDIASUBSESSION_H__
+#define __AXMETASERVERMEDIASUBSESSION_H__
+
+#include "liveMedia.hh"
+#include "OnDemandServerMediaSubsession.hh"
+#include "AXFramedSource.h"
+#include "global.h"
+#include <pthread.h>
+
+/**
+ * ONVIF style metadata track (application/VND.ONVIF.METADATA, 90kHz) next to the video track.
+ * Each packet is one tt:MetadataStream XML document, presentation time is mapped from the
+ * video PTS through the clock anchor of the video subsession, so RTCP aligns both tracks.
+ */
+#define RTSP_META_MAX_SIZE (32 * 1024)
+#define RTSP_META_RING_COUNT (4)
+
+class AXMetaFramedSource: public FramedSource {
+public:
+    static AXMetaFramedSource* createNew(UsageEnvironment& env, AXRtspClockAnchor* pClockAnchor);
+
+    void AddMeta(const AX_U8* pBuf, AX_U32 nLen, AX_U64 nPts);
+    virtual unsigned maxFrameSize() const;
+
+protected:
+    AXMetaFramedSource(UsageEnvironment& env, AXRtspClockAnchor* pClockAnchor);
+    virtual ~AXMetaFramedSource();
+
+private:
+    virtual void doGetNextFrame();
+
+    static void deliverFrame(void* clientData);
+    void _deliverFrame();
+
+private:
+    CAXRingBuffer* m_pRingBuf;
+    AXRtspClockAnchor* m_pClockAnchor;
+    u_int32_t m_nTriggerID;
+};
+
+class AXMetaServerMediaSubsession: public OnDemandServerMediaSubsession {
+public:
+    static AXMetaServerMediaSubsession* createNew(UsageEnvironment& env, bool reuseFirstSource, AXRtspClockAnchor* pClockAnchor);
+
+    /* returns false if no client is playing the track */
+    bool IsActive(void);
+    void SendMeta(const AX_U8* pBuf, AX_U32 nLen, AX_U64 nPts);
+
+protected:
+    AXMetaServerMediaSubsession(UsageEnvironment& env, bool reuseFirstSource, AXRtspClockAnchor* pClockAnchor);
+    virtual ~AXMetaServerMediaSubsession(void);
+
+protected:
+    virtual FramedSource* createNewStreamSource(unsigned clientSessionId, unsigned& estBitrate);
+    virtual RTPSink* createNewRTPSink(Groupsock* rtpGroupsock, unsigned char rtpPayloadTypeIfDynamic, FramedSource* inputSource);
+    virtual void closeStreamSource(FramedSource* inputSource);
+
+private:
+    AXMetaFramedSource* m_pSource;
+    AXRtspClockAnchor* m_pClockAnchor;
+    pthread_spinlock_t m_tLock;
+};
+
+#endif /*__AXMETASERVERMEDIASUBSESSION_H__*/
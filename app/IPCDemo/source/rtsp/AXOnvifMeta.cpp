@@ -0,0 +1,178 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+
+#include "AXOnvifMeta.h"
+#include <stdarg.h>
+
+#define ONVIF_META_HEAD "<?xml version=\"1.0\" encoding=\"UTF-8\"?>" \
+                        "<tt:MetadataStream xmlns:tt=\"http://www.onvif.org/ver10/schema\"" \
+                        " xmlns:wsnt=\"http://docs.oasis-open.org/wsn/b-2\"" \
+                        " xmlns:tns1=\"http://www.onvif.org/ver10/topics\">"
+#define ONVIF_META_TAIL "</tt:MetadataStream>"
+#define ONVIF_TOPIC_DIALECT "http://www.onvif.org/ver10/tev/topicExpression/ConcreteSet"
+
+namespace {
+class CXmlWriter
+{
+public:
+    CXmlWriter(AX_CHAR *pBuf, AX_U32 nSize)
+    : m_pBuf(pBuf)
+    , m_nSize(nSize)
+    , m_nLen(0)
+    , m_bOverflow(AX_FALSE) {
+    }
+
+    AX_VOID Append(const AX_CHAR *szFmt, ...) {
+        if (m_bOverflow) {
+            return;
+        }
+
+        va_list args;
+        va_start(args, szFmt);
+        AX_S32 nRet = vsnprintf(m_pBuf + m_nLen, m_nSize - m_nLen, szFmt, args);
+        va_end(args);
+
+        if (nRet < 0 || (AX_U32)nRet >= m_nSize - m_nLen) {
+            m_bOverflow = AX_TRUE;
+            return;
+        }
+        m_nLen += nRet;
+    }
+
+    AX_VOID AppendEscaped(const AX_CHAR *szText) {
+        for (const AX_CHAR *p = szText; *p && !m_bOverflow; p++) {
+            switch (*p) {
+                case '<': Append("&lt;"); break;
+                case '>': Append("&gt;"); break;
+                case '&': Append("&amp;"); break;
+                case '"': Append("&quot;"); break;
+                case '\'': Append("&apos;"); break;
+                default: Append("%c", *p); break;
+            }
+        }
+    }
+
+    AX_VOID AppendUtcTime(const struct timeval &tv) {
+        struct tm tmUtc;
+        time_t nSec = tv.tv_sec;
+        gmtime_r(&nSec, &tmUtc);
+        Append("%04d-%02d-%02dT%02d:%02d:%02d.%03dZ",
+               tmUtc.tm_year + 1900, tmUtc.tm_mon + 1, tmUtc.tm_mday,
+               tmUtc.tm_hour, tmUtc.tm_min, tmUtc.tm_sec, (AX_S32)(tv.tv_usec / 1000));
+    }
+
+    AX_U32 GetLen(AX_VOID) const {
+        return m_bOverflow ? 0 : m_nLen;
+    }
+
+private:
+    AX_CHAR *m_pBuf;
+    AX_U32 m_nSize;
+    AX_U32 m_nLen;
+    AX_BOOL m_bOverflow;
+};
+
+AX_VOID AppendObject(CXmlWriter &tXml, AX_U64 u64TrackId, const AI_Detection_Box_t &tBox, AX_F32 fConfidence,
+                     const AX_CHAR *szType, const AX_CHAR *szPlate = nullptr)
+{
+    AX_F32 fLeft = tBox.fX * 2 - 1;
+    AX_F32 fRight = (tBox.fX + tBox.fW) * 2 - 1;
+    AX_F32 fTop = 1 - tBox.fY * 2;
+    AX_F32 fBottom = 1 - (tBox.fY + tBox.fH) * 2;
+
+    tXml.Append("<tt:Object ObjectId=\"%llu\"><tt:Appearance><tt:Shape>", (unsigned long long)u64TrackId);
+    tXml.Append("<tt:BoundingBox left=\"%.4f\" top=\"%.4f\" right=\"%.4f\" bottom=\"%.4f\"/>", fLeft, fTop, fRight, fBottom);
+    tXml.Append("<tt:CenterOfGravity x=\"%.4f\" y=\"%.4f\"/>", (fLeft + fRight) / 2, (fTop + fBottom) / 2);
+    tXml.Append("</tt:Shape><tt:Class><tt:Type Likelihood=\"%.2f\">%s</tt:Type></tt:Class>", fConfidence, szType);
+    if (szPlate && szPlate[0]) {
+        tXml.Append("<tt:LicensePlateInfo><tt:PlateNumber>");
+        tXml.AppendEscaped(szPlate);
+        tXml.Append("</tt:PlateNumber></tt:LicensePlateInfo>");
+    }
+    tXml.Append("</tt:Appearance></tt:Object>");
+}
+}  // namespace
+
+#define ObjectFormat(Obj, Type) \
+    do { \
+        for (AX_U32 i = 0; i < tResult.n##Obj##Size; i++) { \
+            if (tResult.t##Obj##s[i].eTrackState == AX_SKEL_TRACK_STATUS_NEW \
+                || tResult.t##Obj##s[i].eTrackState == AX_SKEL_TRACK_STATUS_UPDATE) { \
+                AppendObject(tXml, tResult.t##Obj##s[i].u64TrackId, tResult.t##Obj##s[i].tBox, tResult.t##Obj##s[i].fConfidence, Type); \
+            } \
+        } \
+    } while (0)
+
+AX_U32 AXOnvifMeta::FormatFrame(const DETECT_RESULT_T& tResult, const struct timeval& tv, AX_CHAR* pBuf, AX_U32 nSize)
+{
+    CXmlWriter tXml(pBuf, nSize);
+
+    tXml.Append(ONVIF_META_HEAD "<tt:VideoAnalytics><tt:Frame UtcTime=\"");
+    tXml.AppendUtcTime(tv);
+    tXml.Append("\">");
+
+    ObjectFormat(Body, "Human");
+    ObjectFormat(Vehicle, "Vehicle");
+    ObjectFormat(Cycle, "Bike");
+    ObjectFormat(Face, "Face");
+
+    for (AX_U32 i = 0; i < tResult.nPlateSize; i++) {
+        const AI_Detection_PlateResult_t &tPlate = tResult.tPlates[i];
+        if (tPlate.eTrackState == AX_SKEL_TRACK_STATUS_NEW || tPlate.eTrackState == AX_SKEL_TRACK_STATUS_UPDATE) {
+            const AX_CHAR *szPlate = (tPlate.tPlateAttr.bExist && tPlate.tPlateAttr.bValid) ? tPlate.tPlateAttr.szPlateCode : nullptr;
+            AppendObject(tXml, tPlate.u64TrackId, tPlate.tBox, tPlate.fConfidence, "LicensePlate", szPlate);
+        }
+    }
+
+    tXml.Append("</tt:Frame></tt:VideoAnalytics>" ONVIF_META_TAIL);
+
+    return tXml.GetLen();
+}
+
+AX_U32 AXOnvifMeta::FormatEvent(const WEB_EVENTS_DATA_T& tEvent, const struct timeval& tv, AX_CHAR* pBuf, AX_U32 nSize)
+{
+    const AX_CHAR *szTopic = nullptr;
+    const AX_CHAR *szDataName = nullptr;
+    AX_U32 nAreaId = 0;
+
+    switch (tEvent.eType) {
+        case E_WEB_EVENTS_TYPE_MD:
+            szTopic = "tns1:RuleEngine/CellMotionDetector/Motion";
+            szDataName = "IsMotion";
+            nAreaId = tEvent.tMD.nAreaID;
+            break;
+        case E_WEB_EVENTS_TYPE_OD:
+            szTopic = "tns1:RuleEngine/TamperDetector/Tamper";
+            szDataName = "IsTamper";
+            nAreaId = tEvent.tOD.nAreaID;
+            break;
+        case E_WEB_EVENTS_TYPE_SCD:
+            szTopic = "tns1:VideoSource/GlobalSceneChange/ImagingService";
+            szDataName = "State";
+            nAreaId = tEvent.tSCD.nAreaID;
+            break;
+        default:
+            return 0;
+    }
+
+    CXmlWriter tXml(pBuf, nSize);
+
+    tXml.Append(ONVIF_META_HEAD "<tt:Event><wsnt:NotificationMessage>");
+    tXml.Append("<wsnt:Topic Dialect=\"" ONVIF_TOPIC_DIALECT "\">%s</wsnt:Topic>", szTopic);
+    tXml.Append("<wsnt:Message><tt:Message UtcTime=\"");
+    tXml.AppendUtcTime(tv);
+    tXml.Append((E_WEB_EVENTS_STATE_NONE == tEvent.eState) ? "\">" : "\" PropertyOperation=\"Changed\">");
+    tXml.Append("<tt:Source><tt:SimpleItem Name=\"Area\" Value=\"%u\"/></tt:Source>", nAreaId);
+    tXml.Append("<tt:Data><tt:SimpleItem Name=\"%s\" Value=\"%s\"/></tt:Data>", szDataName,
+                (E_WEB_EVENTS_STATE_END == tEvent.eState) ? "false" : "true");
+    tXml.Append("</tt:Message></wsnt:Message></wsnt:NotificationMessage></tt:Event>" ONVIF_META_TAIL);
+
+    return tXml.GetLen();
+}
@@ -0,0 +1,30 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+
+#ifndef __AXONVIFMETA_H__
+#define __AXONVIFMETA_H__
+
+#include "global.h"
+#include "OptionHelper.h"
+#include "WebServer.h"
+#include <sys/time.h>
+
+/**
+ * tt:MetadataStream documents for the RTSP metadata track.
+ * Boxes use ONVIF normalized coordinates: -1..1, origin at center, y up.
+ * Format functions return document length, 0 if the buffer is too small.
+ */
+class AXOnvifMeta {
+public:
+    static AX_U32 FormatFrame(const DETECT_RESULT_T& tResult, const struct timeval& tv, AX_CHAR* pBuf, AX_U32 nSize);
+    static AX_U32 FormatEvent(const WEB_EVENTS_DATA_T& tEvent, const struct timeval& tv, AX_CHAR* pBuf, AX_U32 nSize);
+};
+
+#endif /*__AXONVIFMETA_H__*/
@@ -0,0 +1,42 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+
+#include "AXRtspClockAnchor.h"
+
+AXRtspClockAnchor::AXRtspClockAnchor(void) {
+    pthread_spin_init(&m_tLock, 0);
+}
+
+AXRtspClockAnchor::~AXRtspClockAnchor(void) {
+    pthread_spin_destroy(&m_tLock);
+}
+
+void AXRtspClockAnchor::Update(AX_U64 nPts, const struct timeval& tv) {
+    pthread_spin_lock(&m_tLock);
+    m_nPts = nPts;
+    m_tv = tv;
+    pthread_spin_unlock(&m_tLock);
+}
+
+void AXRtspClockAnchor::Map(AX_U64 nPts, struct timeval& tv) {
+    pthread_spin_lock(&m_tLock);
+    AX_U64 nAnchorPts = m_nPts;
+    struct timeval tvAnchor = m_tv;
+    pthread_spin_unlock(&m_tLock);
+
+    if (0 == nAnchorPts || 0 == nPts) {
+        gettimeofday(&tv, NULL);
+        return;
+    }
+
+    AX_S64 nUs = (AX_S64)tvAnchor.tv_sec * 1000000 + tvAnchor.tv_usec + (AX_S64)(nPts - nAnchorPts);
+    tv.tv_sec = nUs / 1000000;
+    tv.tv_usec = nUs % 1000000;
+}
@@ -0,0 +1,33 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+
+#ifndef __AXRTSPCLOCKANCHOR_H__
+#define __AXRTSPCLOCKANCHOR_H__
+
+#include "global.h"
+#include <pthread.h>
+#include <sys/time.h>
+
+/* PTS (us) to wallclock mapping taken from video frames handed to live555, shared by subsessions of one stream */
+class AXRtspClockAnchor {
+public:
+    AXRtspClockAnchor(void);
+    ~AXRtspClockAnchor(void);
+
+    void Update(AX_U64 nPts, const struct timeval& tv);
+    void Map(AX_U64 nPts, struct timeval& tv);
+
+private:
+    AX_U64 m_nPts{0};
+    struct timeval m_tv{0, 0};
+    pthread_spinlock_t m_tLock;
+};
+
+#endif /*__AXRTSPCLOCKANCHOR_H__*/
@@ -19,6 +19,8 @@
 #include "liveMedia.hh"
 #include "BasicUsageEnvironment.hh"
 #include "AXLiveServerMediaSession.h"
+#include "AXMetaServerMediaSubsession.h"
+#include "AXOnvifMeta.h"
 
 extern COptionHelper gOptions;
 extern END_POINT_OPTIONS g_tEPOptions[MAX_VENC_CHANNEL_NUM];
@@ -151,8 +153,7 @@ void * RtspServerThreadFunc(void *args)
         ServerMediaSession* sms = ServerMediaSession::createNew(*pThis->m_pUEnv, strStream.c_str(), strStream.c_str(), "Live Stream");
         bool isH264 = !g_vecVEnc[nRTSPIndex]->IsH265();
 
-        pThis->m_pLiveServerMediaSession[i] = AXLiveServerMediaSession::createNew(*pThis->m_pUEnv, true, isH264);
-        sms->addSubsession(pThis->m_pLiveServerMediaSession[i]);
+        pThis->AddSubsessions(sms, i, isH264);
         pThis->m_rtspServer->addServerMediaSession(sms);
 
         char* url = nullptr;
@@ -209,6 +210,93 @@ void AXRtspServer::SendNalu(AX_U8 nChn, const AX_U8* pBuf, AX_U32 nLen, AX_U64 n
 #endif
 }
 
+AX_VOID AXRtspServer::AddSubsessions(ServerMediaSession* sms, size_t nIndex, bool isH264)
+{
+    m_pLiveServerMediaSession[nIndex] = AXLiveServerMediaSession::createNew(*m_pUEnv, true, isH264, &m_tClockAnchor[nIndex]);
+    sms->addSubsession(m_pLiveServerMediaSession[nIndex]);
+
+    if (m_bMetaEnable) {
+        AXMetaServerMediaSubsession* pMeta = AXMetaServerMediaSubsession::createNew(*m_pUEnv, true, &m_tClockAnchor[nIndex]);
+        sms->addSubsession(pMeta);
+
+        std::lock_guard<std::mutex> lck(m_mtxMeta);
+        m_pMetaSubsession[nIndex] = pMeta;
+    }
+}
+
+AX_BOOL AXRtspServer::IsMetaActive(void)
+{
+    if (!m_bMetaEnable) {
+        return AX_FALSE;
+    }
+
+    std::lock_guard<std::mutex> lck(m_mtxMeta);
+    for (size_t i = 0; i < MAX_VENC_CHANNEL_NUM; i++) {
+        if (m_pMetaSubsession[i] && m_pMetaSubsession[i]->IsActive()) {
+            return AX_TRUE;
+        }
+    }
+
+    return AX_FALSE;
+}
+
+void AXRtspServer::SendDetectResult(const DETECT_RESULT_T& tResult, AX_U64 nPts)
+{
+    if (!IsMetaActive()) {
+        return;
+    }
+
+    // subsessions are deleted on session restart, hold them while sending
+    std::lock_guard<std::mutex> lck(m_mtxMeta);
+    if (m_vecMetaXml.empty()) {
+        m_vecMetaXml.resize(RTSP_META_MAX_SIZE);
+    }
+
+    for (size_t i = 0; i < MAX_VENC_CHANNEL_NUM; i++) {
+        AXMetaServerMediaSubsession* pMeta = m_pMetaSubsession[i];
+        if (!pMeta || !pMeta->IsActive()) {
+            continue;
+        }
+
+        // utc time of the frame as seen on this channel's video track
+        struct timeval tv;
+        m_tClockAnchor[i].Map(nPts, tv);
+
+        AX_U32 nLen = AXOnvifMeta::FormatFrame(tResult, tv, m_vecMetaXml.data(), m_vecMetaXml.size());
+        if (0 == nLen) {
+            LOG_M_W(RTSPSERVER, "[%d] format metadata failed.", (AX_U32)i);
+            continue;
+        }
+
+        pMeta->SendMeta((const AX_U8*)m_vecMetaXml.data(), nLen, nPts);
+    }
+}
+
+AX_U32 AXRtspServer::SendEvent(const WEB_EVENTS_DATA_T& tEvent)
+{
+    if (!IsMetaActive()) {
+        return 0;
+    }
+
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+
+    AX_CHAR szXml[1024];
+    AX_U32 nLen = AXOnvifMeta::FormatEvent(tEvent, tv, szXml, sizeof(szXml));
+    if (0 == nLen) {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lck(m_mtxMeta);
+    for (size_t i = 0; i < MAX_VENC_CHANNEL_NUM; i++) {
+        if (m_pMetaSubsession[i]) {
+            m_pMetaSubsession[i]->SendMeta((const AX_U8*)szXml, nLen, 0);
+        }
+    }
+
+    return nLen;
+}
+
 AX_BOOL AXRtspServer::Start(void)
 {
     LOG_M_I(RTSPSERVER, "+++");
@@ -234,6 +322,7 @@ void AXRtspServer::Stop(void)
         if (E_END_POINT_VENC == g_tEPOptions[i].eEPType) {
             AX_U8 nRTSPIndex = g_tEPOptions[i].nInnerIndex;
             std::string strStream = CStringUtils::string_format("axstream%d", nRTSPIndex);
+            std::lock_guard<std::mutex> lck(m_mtxMeta);
             ServerMediaSession* sms = m_rtspServer->lookupServerMediaSession(strStream.c_str(), false);
             if (sms) {
                 m_rtspServer->deleteServerMediaSession(sms);
@@ -241,6 +330,7 @@ void AXRtspServer::Stop(void)
             }
 
             m_pLiveServerMediaSession[i] = NULL;
+            m_pMetaSubsession[i] = NULL;
         }
     }
 
@@ -270,16 +360,20 @@ void AXRtspServer::RestartSessons()
         AX_U8 nRTSPIndex = g_tEPOptions[i].nInnerIndex;
         std::string strStream = CStringUtils::string_format("axstream%d", nRTSPIndex);
         ServerMediaSession* sms = m_rtspServer->lookupServerMediaSession(strStream.c_str(), false);
-        if (sms) {
-            m_rtspServer->deleteServerMediaSession(sms);
-            LOG_M(RTSPSERVER, "Session %s is closed.", strStream.c_str());
+        {
+            // senders must not see the subsession while it is deleted
+            std::lock_guard<std::mutex> lck(m_mtxMeta);
+            if (sms) {
+                m_rtspServer->deleteServerMediaSession(sms);
+                LOG_M(RTSPSERVER, "Session %s is closed.", strStream.c_str());
+            }
+            m_pLiveServerMediaSession[i] = nullptr;
+            m_pMetaSubsession[i] = nullptr;
         }
-        m_pLiveServerMediaSession[i] = nullptr;
 
         sms = ServerMediaSession::createNew(*m_pUEnv, strStream.c_str(), strStream.c_str(), "Live Stream");
         bool isH264 = !g_vecVEnc[nRTSPIndex]->IsH265();
-        m_pLiveServerMediaSession[i] = AXLiveServerMediaSession::createNew(*m_pUEnv, true, isH264);
-        sms->addSubsession(m_pLiveServerMediaSession[i]);
+        AddSubsessions(sms, i, isH264);
         m_rtspServer->addServerMediaSession(sms);
         LOG_M(RTSPSERVER, "Session %s is started.", strStream.c_str());
     }
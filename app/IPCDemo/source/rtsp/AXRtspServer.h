@@ -12,9 +12,16 @@
 #define __AXRTSPSERVER_H__
 
 #include "global.h"
+#include "OptionHelper.h"
+#include "WebServer.h"
+#include "AXRtspClockAnchor.h"
+#include <mutex>
+#include <vector>
 
 class RTSPServer;
 class AXLiveServerMediaSession;
+class AXMetaServerMediaSubsession;
+class ServerMediaSession;
 class UsageEnvironment;
 
 class AXRtspServer {
@@ -30,14 +37,28 @@ public:
 
     void    SendNalu(AX_U8 nChn, const AX_U8* pBuf, AX_U32 nLen, AX_U64 nPts=0, AX_BOOL bIFrame=AX_FALSE);
 
+    /* metadata track, fed by detector and IVES events of all video channels */
+    void    SetMetaEnable(AX_BOOL bEnable) { m_bMetaEnable = bEnable; }
+    void    SendDetectResult(const DETECT_RESULT_T& tResult, AX_U64 nPts);
+    AX_U32  SendEvent(const WEB_EVENTS_DATA_T& tEvent);
+    AX_BOOL IsMetaActive(void);
+
+    /* video track plus optional metadata track of one channel */
+    AX_VOID AddSubsessions(ServerMediaSession* sms, size_t nIndex, bool isH264);
+
 public:
     RTSPServer*               m_rtspServer{nullptr};
     AX_U16                    m_uBasePort{0};
     AXLiveServerMediaSession* m_pLiveServerMediaSession[MAX_VENC_CHANNEL_NUM]{0};
+    AXMetaServerMediaSubsession* m_pMetaSubsession[MAX_VENC_CHANNEL_NUM]{0}; // guarded by m_mtxMeta
+    AXRtspClockAnchor         m_tClockAnchor[MAX_VENC_CHANNEL_NUM];
     UsageEnvironment*         m_pUEnv{nullptr};
 
 private:
     pthread_t                 m_tidServer{0};
+    AX_BOOL                   m_bMetaEnable{AX_FALSE};
+    std::mutex                m_mtxMeta;
+    std::vector<AX_CHAR>      m_vecMetaXml;
 };
 
 #endif /*__AXRTSPSERVER_H__*/
\ No newline at end of file
@@ -17,6 +17,7 @@
 #include "Od.h"
 #include "Md.h"
 #include "Scd.h"
+#include "DetectBench.h"
 
 #define DETECT "DETECT"
 
@@ -63,8 +64,10 @@ AX_VOID CDetectStage::FrameStrategy(AX_U64 nDetectFrameId, AX_BOOL &bAiFrameSkip
     AX_U32 nFrame_id = (AX_U32)nDetectFrameId;
 
     AX_S32 nSrcFrameRate = m_tStageInfo.nFrmFps;
-    AX_S32 nAlgoFramerate = CStageOptionHelper().GetInstance()->GetAiAttr().tConfig.nAiFps;
-    AX_S32 nAlgoIvesFramerate = CStageOptionHelper().GetInstance()->GetAiAttr().tConfig.nIvesFps;
+    const AI_CONFIG_T &tAiConfig = CStageOptionHelper().GetInstance()->GetAiAttr().tConfig;
+    AX_S32 nAlgoFramerate = tAiConfig.nAiFps;
+    AX_S32 nAlgoMinFramerate = tAiConfig.nAiMinFps;
+    AX_S32 nAlgoIvesFramerate = tAiConfig.nIvesFps;
 
     if (nSrcFrameRate <= nAlgoFramerate) {
         bAiFrameSkip = AX_FALSE;
@@ -74,18 +77,47 @@ AX_VOID CDetectStage::FrameStrategy(AX_U64 nDetectFrameId, AX_BOOL &bAiFrameSkip
 
         bIvesFrameSkip = CCommonUtils::FrameSkipCtrl(nSrcFrameRate, nAlgoIvesFramerate, nFrame_id);
     }
+    else if (nAlgoMinFramerate > 0 && nAlgoMinFramerate < nAlgoFramerate) {
+        // the scheduler is reset from the web thread, skip the frame rather than wait for it
+        std::unique_lock<std::mutex> lck(m_mtxReset, std::try_to_lock);
+        if (!lck.owns_lock() || m_bReseting) {
+            bAiFrameSkip = AX_TRUE;
+            bIvesFrameSkip = AX_TRUE;
+            return;
+        }
+
+        // adaptive: between heartbeat and ai fps, driven by motion and targets
+        AX_U32 nTargets = gOptions.IsActivedDetect() ? CDetector::GetInstance()->GetRecentTargets() : 0;
+        bAiFrameSkip = m_tAiScheduler.Schedule(nSrcFrameRate, nAlgoFramerate, nAlgoMinFramerate, m_bMotion, nTargets) ? AX_FALSE : AX_TRUE;
+
+        // ives picks from the frames left by ai, at the rate ai currently runs
+        if (bAiFrameSkip) {
+            ++m_nIvesFrameId;
+
+            AX_S32 nSrcAlgoIvesFramerate = nSrcFrameRate - (AX_S32)(m_tAiScheduler.GetCurFps() + 0.5f);
+
+            bIvesFrameSkip = CCommonUtils::FrameSkipCtrl(nSrcAlgoIvesFramerate, nAlgoIvesFramerate, m_nIvesFrameId);
+        }
+        else {
+            bIvesFrameSkip = AX_TRUE;
+        }
+
+        DET_SCHED_INFO_T tSchedInfo;
+        tSchedInfo.bSent = bAiFrameSkip ? AX_FALSE : AX_TRUE;
+        tSchedInfo.bActive = m_tAiScheduler.IsActive();
+        tSchedInfo.fCurFps = m_tAiScheduler.GetCurFps();
+        gPrintHelper.Add(E_PH_MOD_DET_SCHED, (AX_VOID *)&tSchedInfo);
+    }
     else {
         bAiFrameSkip = CCommonUtils::FrameSkipCtrl(nSrcFrameRate, nAlgoFramerate, nFrame_id);
 
         // if ai skip, will continue to ives handle
         if (bAiFrameSkip) {
-            static AX_U32 nIvesFrame_id = 0;
-
-            ++nIvesFrame_id;
+            ++m_nIvesFrameId;
 
             AX_S32 nSrcAlgoIvesFramerate = nSrcFrameRate - nAlgoFramerate;
 
-            bIvesFrameSkip = CCommonUtils::FrameSkipCtrl(nSrcAlgoIvesFramerate, nAlgoIvesFramerate, nIvesFrame_id);
+            bIvesFrameSkip = CCommonUtils::FrameSkipCtrl(nSrcAlgoIvesFramerate, nAlgoIvesFramerate, m_nIvesFrameId);
         }
         else {
             bIvesFrameSkip = AX_TRUE;
@@ -102,48 +134,181 @@ AX_BOOL CDetectStage::ProcessFrame(CMediaFrame* pFrame)
 
     FrameStrategy(m_nDetectFrameId, bAiFrameSkip, bIvesFrameSkip);
 
-    auto startTime = std::chrono::steady_clock::now();
+    AX_BOOL bAiFrame = (!bAiFrameSkip && gOptions.IsActivedDetect() && gOptions.IsActivedDetectFromWeb()) ? AX_TRUE : AX_FALSE;
+    if (bAiFrame && CDetectBench::GetInstance()->IsRunning()) {
+        // NPU is occupied by the offline benchmark
+        bAiFrame = AX_FALSE;
+    }
+    if (bIvesFrameSkip && !bAiFrame) {
+        return AX_TRUE;
+    }
+
+    /* a free slot always exists: at most JOB_NUM - 2 jobs are queued on IVES and one is in process */
+    AX_U32 nJob = m_nJobNext;
+    for (AX_U32 i = 0; i < DETECT_STAGE_JOB_NUM; i++, nJob = (nJob + 1) % DETECT_STAGE_JOB_NUM) {
+        if (!m_arrJob[nJob].bBusy) {
+            break;
+        }
+    }
+    m_nJobNext = (nJob + 1) % DETECT_STAGE_JOB_NUM;
+
+    DETECT_STAGE_JOB_T &tJob = m_arrJob[nJob];
+    tJob.bBusy = AX_TRUE;
+    tJob.tpStart = std::chrono::steady_clock::now();
+    tJob.nIvesElapsed = 0;
+    tJob.nNpuElapsed = 0;
+    tJob.bIvesDropped = AX_FALSE;
+    tJob.nPending = 1; // held by stage thread until submitting done
 
     if (!bIvesFrameSkip) {
-        m_mtxReset.lock();
-        if (!m_bReseting) {
-            if (gOptions.IsActivedOcclusionDetect()) {
-                COD::GetInstance()->ProcessFrame(pFrame);
-            }
+        // IVES worker holds its own reference of the frame
+        pFrame->AddRef();
+        ++tJob.nPending;
+        if (!IvesEnqueue(pFrame, nJob)) {
+            --tJob.nPending;
+            tJob.bIvesDropped = AX_TRUE;
+            pFrame->FreeMem();
+        }
+    }
 
-            if (gOptions.IsActivedMotionDetect()) {
-                CMD::GetInstance()->ProcessFrame(pFrame);
-            }
+    if (bAiFrame) {
+        AX_S32 nAIDetectGaps = -1;
+        AX_S32 nSrcFrameRate = m_tStageInfo.nFrmFps;
 
-            if (gOptions.IsActivedSceneChangeDetect()) {
-                CSCD::GetInstance()->ProcessFrame(pFrame);
+        // IVES no longer shares the frame interval with NPU submitting
+        if (nSrcFrameRate > 0) {
+            nAIDetectGaps = 1000 / nSrcFrameRate - DETECT_MARGIN_GAP_TIME;
+            if (nAIDetectGaps < 0) {
+                nAIDetectGaps = 0;
             }
         }
-        m_mtxReset.unlock();
+
+        auto startTime = std::chrono::steady_clock::now();
+
+        if (CDetector::GetInstance()->ProcessFrame(pFrame, nAIDetectGaps)) {
+            gPrintHelper.Add(E_PH_MOD_DET, 0, m_nChannel);
+        }
+
+        auto endTime = std::chrono::steady_clock::now();
+        tJob.nNpuElapsed = (AX_U32)(std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count());
     }
 
-    auto endTime = std::chrono::steady_clock::now();
-    AX_U32 nElapsed = (AX_U32)(std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count());
-
-    if (!bAiFrameSkip) {
-        if (gOptions.IsActivedDetect() && gOptions.IsActivedDetectFromWeb()) {
-            AX_S32 nAIDetectGaps = -1;
-            AX_S32 nSrcFrameRate = m_tStageInfo.nFrmFps;
-
-            if (nSrcFrameRate > 0) {
-                nAIDetectGaps = 1000 / nSrcFrameRate - nElapsed - DETECT_MARGIN_GAP_TIME;
-                if (nAIDetectGaps < 0) {
-                    nAIDetectGaps = 0;
-                }
+    JobFinish(tJob);
+
+    return AX_TRUE;
+}
+
+AX_BOOL CDetectStage::IvesEnqueue(CMediaFrame *pFrame, AX_U32 nJob)
+{
+    std::unique_lock<std::mutex> lck(m_mtxIves);
+    // queued jobs, the one in process and the next one of stage thread fit into the slots
+    if (!m_bIvesWorking || m_qIvesFrame.size() >= DETECT_STAGE_JOB_NUM - 2) {
+        return AX_FALSE;
+    }
+
+    m_qIvesFrame.push(std::make_pair(pFrame, nJob));
+    m_cvIves.notify_one();
+
+    return AX_TRUE;
+}
+
+AX_VOID CDetectStage::IvesThreadFunc(AX_VOID)
+{
+    prctl(PR_SET_NAME, "IPC_STG_IVES");
+
+    while (1) {
+        CMediaFrame *pFrame = nullptr;
+        AX_U32 nJob = 0;
+        {
+            std::unique_lock<std::mutex> lck(m_mtxIves);
+            m_cvIves.wait(lck, [this]() {
+                return (!m_qIvesFrame.empty() || !m_bIvesWorking);
+            });
+
+            if (!m_bIvesWorking) {
+                break;
             }
 
-            if (CDetector::GetInstance()->ProcessFrame(pFrame, nAIDetectGaps)) {
-                gPrintHelper.Add(E_PH_MOD_DET, 0, m_nChannel);
+            pFrame = m_qIvesFrame.front().first;
+            nJob = m_qIvesFrame.front().second;
+            m_qIvesFrame.pop();
+        }
+
+        auto startTime = std::chrono::steady_clock::now();
+
+        IvesProcess(pFrame);
+
+        auto endTime = std::chrono::steady_clock::now();
+
+        pFrame->FreeMem();
+
+        // the slot stays ours until our part is finished
+        DETECT_STAGE_JOB_T &tJob = m_arrJob[nJob];
+        tJob.nIvesElapsed = (AX_U32)(std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count());
+        JobFinish(tJob);
+    }
+
+    // drop frames not processed
+    std::unique_lock<std::mutex> lck(m_mtxIves);
+    while (!m_qIvesFrame.empty()) {
+        m_qIvesFrame.front().first->FreeMem();
+        m_arrJob[m_qIvesFrame.front().second].bIvesDropped = AX_TRUE;
+        JobFinish(m_arrJob[m_qIvesFrame.front().second]);
+        m_qIvesFrame.pop();
+    }
+}
+
+AX_VOID CDetectStage::IvesProcess(CMediaFrame *pFrame)
+{
+    std::lock_guard<std::mutex> lck(m_mtxReset);
+    if (m_bReseting) {
+        return;
+    }
+
+    if (gOptions.IsActivedOcclusionDetect()) {
+        COD::GetInstance()->ProcessFrame(pFrame);
+    }
+
+    if (gOptions.IsActivedMotionDetect()) {
+        const std::vector<AX_U8> &vecMdRslts = CMD::GetInstance()->ProcessFrame(pFrame);
+
+        AX_BOOL bMotion = AX_FALSE;
+        for (auto nRslt : vecMdRslts) {
+            if (nRslt) {
+                bMotion = AX_TRUE;
+                break;
             }
         }
+        m_bMotion = bMotion;
+    }
+    else {
+        m_bMotion = AX_FALSE;
     }
 
-    return AX_TRUE;
+    if (gOptions.IsActivedSceneChangeDetect()) {
+        CSCD::GetInstance()->ProcessFrame(pFrame);
+    }
+}
+
+/* the decrement is the claim, the last finished engine reports the joined result and frees the slot */
+AX_VOID CDetectStage::JobFinish(DETECT_STAGE_JOB_T &tJob)
+{
+    if (1 != tJob.nPending.fetch_sub(1)) {
+        return;
+    }
+
+    auto endTime = std::chrono::steady_clock::now();
+
+    DET_STAGE_INFO_T tStageInfo;
+    tStageInfo.nLatency = (AX_U32)(std::chrono::duration_cast<std::chrono::microseconds>(endTime - tJob.tpStart).count());
+    tStageInfo.nIvesElapsed = tJob.nIvesElapsed;
+    tStageInfo.nNpuElapsed = tJob.nNpuElapsed;
+    tStageInfo.bIvesDropped = tJob.bIvesDropped;
+
+    // the stage thread may take the slot from now on
+    tJob.bBusy = AX_FALSE;
+
+    gPrintHelper.Add(E_PH_MOD_DET_STAGE, (AX_VOID *)&tStageInfo);
 }
 
 AX_BOOL CDetectStage::Init()
@@ -208,11 +373,35 @@ AX_BOOL CDetectStage::Init()
         }
     }
 
-    return CStage::Init();
+    if (!CStage::Init()) {
+        return AX_FALSE;
+    }
+
+    for (AX_U32 i = 0; i < DETECT_STAGE_JOB_NUM; i++) {
+        m_arrJob[i].bBusy = AX_FALSE;
+        m_arrJob[i].nPending = 0;
+    }
+
+    m_bIvesWorking = AX_TRUE;
+    m_pIvesThread = new thread(&CDetectStage::IvesThreadFunc, this);
+
+    return AX_TRUE;
 }
 
 AX_VOID CDetectStage::DeInit()
 {
+    {
+        std::unique_lock<std::mutex> lck(m_mtxIves);
+        m_bIvesWorking = AX_FALSE;
+        m_cvIves.notify_one();
+    }
+
+    if (m_pIvesThread) {
+        m_pIvesThread->join();
+        delete m_pIvesThread;
+        m_pIvesThread = nullptr;
+    }
+
     if (gOptions.IsActivedDetect()) {
         CDetector::GetInstance()->Cleanup();
     }
@@ -233,6 +422,7 @@ AX_BOOL CDetectStage::Reset(const DETECT_STAGE_INFO_T &tInfo)
     COD::GetInstance()->Cleanup();
 
     ConfigStageInfo(tInfo);
+    m_tAiScheduler.Reset();
 
     const AX_U32 &nFrmW = m_tStageInfo.nFrmWidth;
     const AX_U32 &nFrmH = m_tStageInfo.nFrmHeight;
@@ -11,10 +11,13 @@
 #ifndef _DETECT_STAGE_H_
 #define _DETECT_STAGE_H_
 
+#include <atomic>
+#include <chrono>
 #include "global.h"
 #include "Stage.h"
 #include "Detector.h"
 #include "TrackCropStage.h"
+#include "AiScheduler.h"
 
 typedef struct axDETECT_STAGE_INFO_T {
     AX_U32 nFrmWidth;
@@ -23,6 +26,22 @@ typedef struct axDETECT_STAGE_INFO_T {
     AX_U16 nFrmFps;
 } DETECT_STAGE_INFO_T;
 
+/**
+ * IVES (OD/MD/SCD) runs on its own worker while the stage thread submits the same
+ * frame to NPU, the frame is shared by refcount and both parts are joined by a job slot
+ * queued along with the frame.
+ */
+#define DETECT_STAGE_JOB_NUM (8) // bounds frames queued on IVES worker
+
+typedef struct _DETECT_STAGE_JOB_T {
+    std::chrono::steady_clock::time_point tpStart;
+    std::atomic<AX_BOOL> bBusy; // slot taken until the joined result is reported
+    std::atomic<AX_S32> nPending;
+    AX_U32 nIvesElapsed; // us
+    AX_U32 nNpuElapsed;  // us
+    AX_BOOL bIvesDropped;
+} DETECT_STAGE_JOB_T;
+
 class CDetectStage : public CStage
 {
 public:
@@ -40,6 +59,12 @@ public:
     AX_VOID ConfigStageInfo(const DETECT_STAGE_INFO_T &tInfo);
     AX_BOOL Reset(const DETECT_STAGE_INFO_T &tInfo);
 
+private:
+    AX_VOID IvesThreadFunc(AX_VOID);
+    AX_VOID IvesProcess(CMediaFrame *pFrame);
+    AX_BOOL IvesEnqueue(CMediaFrame *pFrame, AX_U32 nJob);
+    AX_VOID JobFinish(DETECT_STAGE_JOB_T &tJob);
+
 public:
     AX_U8       m_nChannel;
     AX_U8       m_nCfgIndex;
@@ -50,6 +75,17 @@ private:
     DETECT_STAGE_INFO_T m_tStageInfo{0};
     AX_BOOL m_bReseting;
     mutex m_mtxReset;
+    CAiScheduler m_tAiScheduler;
+    std::atomic<AX_BOOL> m_bMotion{AX_FALSE};
+
+    DETECT_STAGE_JOB_T m_arrJob[DETECT_STAGE_JOB_NUM];
+    AX_U32 m_nJobNext{0};
+    queue<std::pair<CMediaFrame *, AX_U32>> m_qIvesFrame;
+    mutex m_mtxIves;
+    condition_variable m_cvIves;
+    thread *m_pIvesThread{nullptr};
+    AX_BOOL m_bIvesWorking{AX_FALSE};
+    AX_U32 m_nIvesFrameId{0};
 };
 
 #endif // _DETECT_STAGE_H_
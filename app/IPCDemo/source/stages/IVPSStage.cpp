@@ -31,6 +31,8 @@
 #define MAX_OSD_TIME_CHAR_LEN       (32)
 #define MAX_OSD_STRING_CHAR_LEN     (128)
 #define BASE_FONT_SIZE              (16)
+#define OSD_GLYPH_BENCH_ENV_STR     "OSD_GLYPH_BENCH"
+#define OSD_TIME_POLL_INTERVAL      (200)
 #define ROTATION_WIDTH_ALIGEMENT    (8)
 
 
@@ -566,9 +568,22 @@ AX_VOID CIVPSStage::RgnThreadFunc(IVPS_REGION_PARAM_PTR pThreadParam) {
         return;
     }
 
+    if (getenv(OSD_GLYPH_BENCH_ENV_STR)) {
+        AX_U16 nBenchSize = (0 == nIvpsGrp ? 128 : 24);
+        LOG_M(IVPS, "[%d] OSD (TIME) font %d: uncached %.3f ms, glyph cache %.3f ms", nIvpsGrp, nBenchSize,
+              m_osdWrapper.Benchmark(pOsdHandle, nBenchSize, AX_FALSE, 20), m_osdWrapper.Benchmark(pOsdHandle, nBenchSize, AX_TRUE, 20));
+    }
+
+    /* bitmap kept across updates, only the glyphs of the changed digits are drawn again */
     AX_U16 *pArgbData = nullptr;
+    AX_U32 nArgbSize = 0;
+    AX_U32 nLastPixWidth = 0;
+    AX_U32 nLastPixHeight = 0;
+    AX_U32 nLastDstXoffset = 0;
+    AX_U32 nLastDstYoffset = 0;
 
     wchar_t wszOsdDate[MAX_OSD_TIME_CHAR_LEN] = {0};
+    wchar_t wszLastOsdDate[MAX_OSD_TIME_CHAR_LEN] = {0};
     memset(&wszOsdDate[0], 0, sizeof(wchar_t) * MAX_OSD_TIME_CHAR_LEN);
 
     AX_S32 ret = AX_IVPS_SUCC;
@@ -629,10 +644,37 @@ AX_VOID CIVPSStage::RgnThreadFunc(IVPS_REGION_PARAM_PTR pThreadParam) {
         AX_U32 nFontColor = nARGB;
         nFontColor |= (1 << 24);
 
-        pArgbData = (AX_U16 *)malloc(nPicSize);
+        AX_U32 nDstXoffset = nSrcOffset + CCommonUtils::CalOsdOffsetX(
+            nSrcWidth, nPixWidth, (nPicOffset > 0 ? nPicOffsetBlock * OSD_ALIGN_WIDTH : nMarginX), eAlign);
+        AX_U32 nDstYoffset = CCommonUtils::CalOsdOffsetY(nSrcHeight, nPixHeight, nMarginY, eAlign);
+
+        if (nPicSize != nArgbSize) {
+            free(pArgbData);
+            pArgbData = (AX_U16 *)malloc(nPicSize);
+            if (nullptr == pArgbData) {
+                LOG_M_E(IVPS, "Failed to alloc %d bytes for date bitmap.", nPicSize);
+                break;
+            }
+            nArgbSize = nPicSize;
+            wszLastOsdDate[0] = 0;
+        }
+
+        AX_BOOL bSameRgn = (0 != wszLastOsdDate[0] && nPixWidth == nLastPixWidth && nPixHeight == nLastPixHeight &&
+                            nDstXoffset == nLastDstXoffset && nDstYoffset == nLastDstYoffset) ? AX_TRUE : AX_FALSE;
+        if (bSameRgn && 0 == wcscmp(wszLastOsdDate, wszOsdDate)) {
+            /* nothing visible changed, the region keeps its bitmap */
+            CTimeUtils::msSleep(OSD_TIME_POLL_INTERVAL);
+            continue;
+        }
 
         // 将时间字符串生成出ARGB数据，存储到pArgbData指向的buffer
-        if (nullptr == m_osdWrapper.GenARGB(pOsdHandle, (wchar_t *)&wszOsdDate[0], (AX_U16 *)pArgbData, nPixWidth, nPixHeight,
+        if (bSameRgn) {
+            if (m_osdWrapper.UpdateARGB(pOsdHandle, wszLastOsdDate, wszOsdDate, pArgbData, nPixWidth, nPixHeight, nPicOffset, 0,
+                                        nFontSize, AX_TRUE, nFontColor, 0xFFFFFF, 0xFF000000, eAlign) < 0) {
+                LOG_M_E(IVPS, "Failed to update bitmap for date string.");
+                break;
+            }
+        } else if (nullptr == m_osdWrapper.GenARGB(pOsdHandle, (wchar_t *)&wszOsdDate[0], (AX_U16 *)pArgbData, nPixWidth, nPixHeight,
                                         nPicOffset, 0, nFontSize, AX_TRUE, nFontColor, 0xFFFFFF, 0xFF000000,
                                         eAlign)) {
             LOG_M_E(IVPS, "Failed to generate bitmap for date string.");
@@ -649,9 +691,8 @@ AX_VOID CIVPSStage::RgnThreadFunc(IVPS_REGION_PARAM_PTR pThreadParam) {
         tDisp.arrDisp[0].uDisp.tOSD.u32BgColorHi = 0xFFFFFFFF;
         tDisp.arrDisp[0].uDisp.tOSD.u32BmpWidth = nPixWidth;
         tDisp.arrDisp[0].uDisp.tOSD.u32BmpHeight = nPixHeight;
-        tDisp.arrDisp[0].uDisp.tOSD.u32DstXoffset = nSrcOffset + CCommonUtils::CalOsdOffsetX(
-            nSrcWidth, nPixWidth, (nPicOffset > 0 ? nPicOffsetBlock * OSD_ALIGN_WIDTH : nMarginX), eAlign);
-        tDisp.arrDisp[0].uDisp.tOSD.u32DstYoffset = CCommonUtils::CalOsdOffsetY(nSrcHeight, nPixHeight, nMarginY, eAlign);
+        tDisp.arrDisp[0].uDisp.tOSD.u32DstXoffset = nDstXoffset;
+        tDisp.arrDisp[0].uDisp.tOSD.u32DstYoffset = nDstYoffset;
         tDisp.arrDisp[0].uDisp.tOSD.u64PhyAddr = 0;
         tDisp.arrDisp[0].uDisp.tOSD.pBitmap = (AX_U8 *)pArgbData;
 
@@ -668,15 +709,23 @@ AX_VOID CIVPSStage::RgnThreadFunc(IVPS_REGION_PARAM_PTR pThreadParam) {
         ret = AX_IVPS_RGN_Update(pThreadParam->hChnRgn, &tDisp);    // 更新 hRegion 对应的 region 显示信息
         if (AX_IVPS_SUCC != ret) {
             LOG_M_E(IVPS, "[%d][0x%02x] AX_IVPS_RGN_Update fail, ret=0x%x, hChnRgn=%d", nIvpsGrp, nFilter, ret, pThreadParam->hChnRgn);
+            /* bitmap is right, but shown by next round again */
+            wszLastOsdDate[0] = 0;
+        } else {
+            wcscpy(wszLastOsdDate, wszOsdDate);
+            nLastPixWidth = nPixWidth;
+            nLastPixHeight = nPixHeight;
+            nLastDstXoffset = nDstXoffset;
+            nLastDstYoffset = nDstYoffset;
         }
 
-        /* Free time osd resource */
-        free(pArgbData);
-        pArgbData = nullptr;
-
-        CTimeUtils::msSleep(1000);
+        CTimeUtils::msSleep(OSD_TIME_POLL_INTERVAL);
     }
 
+    /* Free time osd resource */
+    free(pArgbData);
+    pArgbData = nullptr;
+
     m_osdWrapper.ReleaseInstance(&pOsdHandle);
 
     LOG_M(IVPS, "[%d][0x%x] ---", nIvpsGrp, nFilter);
@@ -335,6 +335,14 @@ AX_BOOL CJsonCfgParser::GetAiCfg(const AX_U32 &nID, AI_CONFIG_T &stOutCfg)
     stOutCfg.nAiFps = objMediaIns["ai_fps"].get<double>();
     stOutCfg.nIvesFps = objMediaIns["ives_fps"].get<double>();
 
+    if (objMediaIns.end() != objMediaIns.find("ai_min_fps")) {
+        stOutCfg.nAiMinFps = objMediaIns["ai_min_fps"].get<double>();
+    }
+
+    if (objMediaIns.end() != objMediaIns.find("rtsp_meta")) {
+        stOutCfg.bRtspMeta = (AX_BOOL)objMediaIns["rtsp_meta"].get<bool>();
+    }
+
     if (objMediaIns.end() != objMediaIns.find("frame_depth")) {
         stOutCfg.nFrameDepth = objMediaIns["frame_depth"].get<double>();
     }
@@ -487,36 +487,36 @@ AX_VOID COptionHelper::SetNrEnabled(AX_BOOL bEnable)
     // }
 }
 
-AX_VOID COptionHelper::SetDetectResult(AX_U32 nPipeID, AI_Detection_Result_t *pResult)
+AX_VOID COptionHelper::SetDetectResult(AX_U32 nPipeID, AI_Detection_Result_t *pResult, AX_U64 u64Pts/* = 0*/)
 {
     std::lock_guard<std::mutex> lck(m_mtxOption);
     if (pResult) {
-        auto BodyAttrCopy = [&](_AI_Body_Attr_t &dst_attr, _AI_Body_Attr_t src_attr) {
+        auto BodyAttrCopy = [&](_AI_Body_Attr_t &dst_attr, const _AI_Body_Attr_t &src_attr) {
             dst_attr.bExist = src_attr.bExist;
-            dst_attr.strSafetyCap = src_attr.strSafetyCap;
-            dst_attr.strHairLength = src_attr.strHairLength;
+            memcpy(dst_attr.szSafetyCap, src_attr.szSafetyCap, sizeof(dst_attr.szSafetyCap));
+            memcpy(dst_attr.szHairLength, src_attr.szHairLength, sizeof(dst_attr.szHairLength));
             };
-        auto VehicleAttrCopy = [&](AI_Vehicle_Attr_t &dst_attr, AI_Vehicle_Attr_t src_attr) {
+        auto VehicleAttrCopy = [&](AI_Vehicle_Attr_t &dst_attr, const AI_Vehicle_Attr_t &src_attr) {
             dst_attr.bExist = src_attr.bExist;
-            dst_attr.strVehicleColor = src_attr.strVehicleColor;
-            dst_attr.strVehicleSubclass = src_attr.strVehicleSubclass;
+            memcpy(dst_attr.szVehicleColor, src_attr.szVehicleColor, sizeof(dst_attr.szVehicleColor));
+            memcpy(dst_attr.szVehicleSubclass, src_attr.szVehicleSubclass, sizeof(dst_attr.szVehicleSubclass));
             };
-        auto CycleAttrCopy = [&](AI_Cycle_Attr_t &dst_attr, AI_Cycle_Attr_t src_attr) {
+        auto CycleAttrCopy = [&](AI_Cycle_Attr_t &dst_attr, const AI_Cycle_Attr_t &src_attr) {
             dst_attr.bExist = src_attr.bExist;
-            dst_attr.strCycleSubclass = src_attr.strCycleSubclass;
+            memcpy(dst_attr.szCycleSubclass, src_attr.szCycleSubclass, sizeof(dst_attr.szCycleSubclass));
             };
-        auto FaceAttrCopy = [&](AI_Face_Attr_t &dst_attr, AI_Face_Attr_t src_attr) {
+        auto FaceAttrCopy = [&](AI_Face_Attr_t &dst_attr, const AI_Face_Attr_t &src_attr) {
             dst_attr.bExist = src_attr.bExist;
             dst_attr.nAge = src_attr.nAge;
             dst_attr.nGender = src_attr.nGender;
-            dst_attr.strRespirator = src_attr.strRespirator;
+            memcpy(dst_attr.szRespirator, src_attr.szRespirator, sizeof(dst_attr.szRespirator));
             };
-        auto PlateAttrCopy = [&](AI_Plat_Attr_t &dst_attr, AI_Plat_Attr_t src_attr) {
+        auto PlateAttrCopy = [&](AI_Plat_Attr_t &dst_attr, const AI_Plat_Attr_t &src_attr) {
             dst_attr.bExist = src_attr.bExist;
             dst_attr.bValid = src_attr.bValid;
-            dst_attr.strPlateColor = src_attr.strPlateColor;
-            dst_attr.strPlateType = src_attr.strPlateType;
-            dst_attr.strPlateCode = src_attr.strPlateCode;
+            memcpy(dst_attr.szPlateColor, src_attr.szPlateColor, sizeof(dst_attr.szPlateColor));
+            memcpy(dst_attr.szPlateType, src_attr.szPlateType, sizeof(dst_attr.szPlateType));
+            memcpy(dst_attr.szPlateCode, src_attr.szPlateCode, sizeof(dst_attr.szPlateCode));
             };
 
         #define ObjectCopy(Obj) \
@@ -558,6 +558,9 @@ AX_VOID COptionHelper::SetDetectResult(AX_U32 nPipeID, AI_Detection_Result_t *pR
     else {
         m_arrDetectResult[nPipeID].Clear();
     }
+
+    /* an empty result is as recent as a full one */
+    m_arrDetectResult[nPipeID].u64Pts = u64Pts;
 }
 
 DETECT_RESULT_T COptionHelper::GetDetectResult(AX_U32 nPipeID)
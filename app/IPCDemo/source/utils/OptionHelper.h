@@ -22,6 +22,7 @@
 /* Donot use memset/memcpy */
 typedef struct _DETECT_RESULT_T {
     AX_U32 nFrameId;
+    AX_U64 u64Pts;      /* of the detected frame, 0: unknown */
     AI_Detection_FaceResult_t tFaces[MAX_DECT_BOX_COUNT];
     AX_U32 nFaceSize;
     AI_Detection_BodyResult_t tBodys[MAX_DECT_BOX_COUNT];
@@ -41,6 +42,7 @@ typedef struct _DETECT_RESULT_T {
 
     AX_VOID Clear() {
         nFrameId = 0;
+        u64Pts = 0;
         nFaceSize = 0;
         nBodySize = 0;
         nVehicleSize = 0;
@@ -118,7 +120,7 @@ public:
     AX_VOID ActiveMotionDetect(AX_BOOL bActive);
     AX_VOID ActiveSceneChangeDetect(AX_BOOL bActive);
 
-    AX_VOID SetDetectResult(AX_U32 nPipeID, AI_Detection_Result_t *pResult);
+    AX_VOID SetDetectResult(AX_U32 nPipeID, AI_Detection_Result_t *pResult, AX_U64 u64Pts = 0);
     DETECT_RESULT_T GetDetectResult(AX_U32 nPipeID);
 
     const std::string &GetDetectionConfigPath(void) const;
@@ -9,6 +9,8 @@
  **********************************************************************************/
 
 #include "OSDHandler.h"
+#include <algorithm>
+#include <chrono>
 
 COSDHandler::COSDHandler() {
 }
@@ -28,12 +30,9 @@ AX_VOID *COSDHandler::GenARGB(wchar_t *pStr, AX_U16 *pArgbBuffer, AX_U32 u32OSDW
     AX_U16 u16SideColor = 0x0;
     AX_U8 uColor_H = 0x0;
     AX_U8 uColor_L = 0x0;
-    AX_U8 dot8 = 0x0;
 
     AX_U16 uLen = 0;
-    FT_Bitmap *ftBitmap;
     wchar_t *pTextStr = pStr;
-    AX_S32 sBearingY = 0;
 
     AX_U32 u32ArgbBufferSize = u32OSDHeight * u32OSDWidth * 2;
 
@@ -63,9 +62,13 @@ AX_VOID *COSDHandler::GenARGB(wchar_t *pStr, AX_U16 *pArgbBuffer, AX_U32 u32OSDW
     if (uColor_L == uColor_H) {
         memset(pArgbBuffer, uColor_L, u32ArgbBufferSize);
     } else {
-        for (AX_U32 i = 0; i < u32ArgbBufferSize / 2; i = i + 1) {
+        /* first line, then copied line by line */
+        for (AX_U32 i = 0; i < u32OSDWidth; i = i + 1) {
             pArgbBuffer[i] = u16BgColor;
         }
+        for (AX_U32 i = 1; i < u32OSDHeight; i = i + 1) {
+            memcpy(pArgbBuffer + i * u32OSDWidth, pArgbBuffer, u32OSDWidth * 2);
+        }
     }
 
     if (uLen == 0) {
@@ -80,44 +83,24 @@ AX_VOID *COSDHandler::GenARGB(wchar_t *pStr, AX_U16 *pArgbBuffer, AX_U32 u32OSDW
         y = 0;
     }
 
-    AX_S32 s32Error = FT_Set_Pixel_Sizes(m_fontFace, uFontSize, uFontSize);
-    if (0 != s32Error) {
-        printf("FT Set Size error!\r\n");
-        return nullptr;
-    }
+    AX_S32 nGap = (AX_S32)(5.0 * uFontSize / 64);
 
     switch (enAlign) {
         case OSD_ALIGN_TYPE_LEFT_TOP:
         case OSD_ALIGN_TYPE_LEFT_BOTTOM: {
             int x0 = x;
-            AX_BOOL bExit = AX_FALSE;
             for (AX_U16 i = 0; i < uLen; i++) {
-                if (bExit) {
-                    break;
+                const OSD_GLYPH_T *pGlyph = GetGlyph(pTextStr[i], uFontSize, bIsBrushSide, u16FontColor, u16SideColor);
+                if (!pGlyph) {
+                    continue;
                 }
-                ftBitmap = FTGetGlpyhBitMap(pTextStr[i]);
-                sBearingY = m_fontSlot->metrics.horiBearingY;
-                int y0 = y + uFontSize - (int)(5.0 * uFontSize / 64) - sBearingY / 64;
-                for (AX_U16 j = 0; j < ftBitmap->rows; j++) {
-                    for (AX_S16 k = 0; k < ftBitmap->pitch; k++) {
-                        dot8 = ftBitmap->buffer[k + j * ftBitmap->pitch];
-                        for (AX_U16 dot = 0; dot < 8; dot++) {
-                            if ((dot8 & 0x80) == 0x80) {
-                                if (bIsBrushSide) {
-                                    BrushSide(pArgbBuffer, x0 + k * 8 + dot, y0 + j, u16SideColor, u16BgColor, u32OSDWidth, u32OSDHeight);
-                                }
-                                if (OE_WIDTH_BACKWARD_RANGE ==
-                                    DrawPoint(pArgbBuffer, x0 + k * 8 + dot, y0 + j, u16FontColor, u32OSDWidth, u32OSDHeight)) {
-                                    if (!bExit) {
-                                        bExit = AX_TRUE;
-                                    }
-                                }
-                            }
-                            dot8 = dot8 << 1;
-                        }
-                    }
+
+                int y0 = y + uFontSize - nGap - pGlyph->nBearingY / 64;
+                if (BlitGlyph(*pGlyph, pArgbBuffer, x0, y0, bIsBrushSide, u16FontColor, u16BgColor, u16SideColor, u32OSDWidth,
+                              u32OSDHeight, OE_WIDTH_BACKWARD_RANGE)) {
+                    break;
                 }
-                x0 += ftBitmap->width + (int)(5.0 * uFontSize / 64);
+                x0 += pGlyph->nWidth + nGap;
             }
             break;
         }
@@ -127,33 +110,17 @@ AX_VOID *COSDHandler::GenARGB(wchar_t *pStr, AX_U16 *pArgbBuffer, AX_U32 u32OSDW
             if (x0 < 0) {
                 return nullptr;
             }
-            AX_BOOL bExit = AX_FALSE;
             for (AX_S16 i = uLen - 1; i >= 0; i--) {
-                if (bExit) {
-                    break;
+                const OSD_GLYPH_T *pGlyph = GetGlyph(pTextStr[i], uFontSize, bIsBrushSide, u16FontColor, u16SideColor);
+                if (!pGlyph) {
+                    continue;
                 }
-                ftBitmap = FTGetGlpyhBitMap(pTextStr[i]);
-                sBearingY = m_fontSlot->metrics.horiBearingY;
-                int y0 = y + uFontSize - (int)(5.0 * uFontSize / 64) - sBearingY / 64;
-                x0 -= ftBitmap->width + (int)(5.0 * uFontSize / 64);
-                for (AX_U16 j = 0; j < ftBitmap->rows; j++) {
-                    for (AX_S16 k = 0; k < ftBitmap->pitch; k++) {
-                        dot8 = ftBitmap->buffer[k + j * ftBitmap->pitch];
-                        for (AX_U16 dot = 0; dot < 8; dot++) {
-                            if ((dot8 & 0x80) == 0x80) {
-                                if (bIsBrushSide) {
-                                    BrushSide(pArgbBuffer, x0 + k * 8 + dot, y0 + j, u16SideColor, u16BgColor, u32OSDWidth, u32OSDHeight);
-                                }
-                                if (OE_WIDTH_FORWARD_RANGE ==
-                                    DrawPoint(pArgbBuffer, x0 + k * 8 + dot, y0 + j, u16FontColor, u32OSDWidth, u32OSDHeight)) {
-                                    if (!bExit) {
-                                        bExit = AX_TRUE;
-                                    }
-                                }
-                            }
-                            dot8 = dot8 << 1;
-                        }
-                    }
+
+                int y0 = y + uFontSize - nGap - pGlyph->nBearingY / 64;
+                x0 -= pGlyph->nWidth + nGap;
+                if (BlitGlyph(*pGlyph, pArgbBuffer, x0, y0, bIsBrushSide, u16FontColor, u16BgColor, u16SideColor, u32OSDWidth,
+                              u32OSDHeight, OE_WIDTH_FORWARD_RANGE)) {
+                    break;
                 }
             }
             break;
@@ -165,6 +132,302 @@ AX_VOID *COSDHandler::GenARGB(wchar_t *pStr, AX_U16 *pArgbBuffer, AX_U32 u32OSDW
     return pArgbBuffer;
 }
 
+AX_S32 COSDHandler::UpdateARGB(wchar_t *pLastStr, wchar_t *pTextStr, AX_U16 *pArgbBuffer, AX_U32 u32OSDWidth, AX_U32 u32OSDHeight,
+                               AX_S16 sX, AX_S16 sY, AX_U16 uFontSize, AX_BOOL bIsBrushSide, AX_U32 uFontColor, AX_U32 uBgColor,
+                               AX_U32 uSideColor, OSD_ALIGN_TYPE_E enAlign) {
+    if (!pLastStr || !pTextStr || !pArgbBuffer) {
+        return -1;
+    }
+
+    if (0 == wcscmp(pLastStr, pTextStr)) {
+        return 0;
+    }
+
+    AX_S16 x = (sX < 0) ? 0 : sX;
+    AX_S16 y = (sY < 0) ? 0 : sY;
+    AX_U16 u16FontColor = ConvertColor2Argb1555BE(uFontColor);
+    AX_U16 u16BgColor = ConvertColor2Argb1555BE(uBgColor);
+    AX_U16 u16SideColor = ConvertColor2Argb1555BE(uSideColor);
+
+    if (!m_bGlyphCache || wcslen(pLastStr) != wcslen(pTextStr) || u32OSDWidth > OSD_PIXEL_MAX_WIDTH ||
+        u32OSDHeight > OSD_PIXEL_MAX_HEIGHT ||
+        !LayoutGlyphs(pLastStr, u32OSDWidth, u32OSDHeight, x, y, uFontSize, bIsBrushSide, u16FontColor, u16SideColor, enAlign,
+                      m_vecLastPos) ||
+        !LayoutGlyphs(pTextStr, u32OSDWidth, u32OSDHeight, x, y, uFontSize, bIsBrushSide, u16FontColor, u16SideColor, enAlign, m_vecPos)) {
+        if (!GenARGB(pTextStr, pArgbBuffer, u32OSDWidth, u32OSDHeight, sX, sY, uFontSize, bIsBrushSide, uFontColor, uBgColor,
+                     uSideColor, enAlign)) {
+            return -1;
+        }
+        return (AX_S32)wcslen(pTextStr);
+    }
+
+    /* columns of changed glyphs, both where they were and where they are */
+    std::vector<std::pair<AX_S32, AX_S32>> vecSpans;
+    AX_S32 nChanged = 0;
+    for (size_t i = 0; i < m_vecPos.size(); i++) {
+        const OSD_GLYPH_POS_T &tLast = m_vecLastPos[i];
+        const OSD_GLYPH_POS_T &tNow = m_vecPos[i];
+        if (tLast.wChar == tNow.wChar && tLast.nX == tNow.nX && tLast.nY == tNow.nY) {
+            continue;
+        }
+
+        vecSpans.emplace_back(tLast.nX - 1, tLast.nX - 1 + tLast.nCellW);
+        vecSpans.emplace_back(tNow.nX - 1, tNow.nX - 1 + tNow.nCellW);
+        nChanged++;
+    }
+
+    std::sort(vecSpans.begin(), vecSpans.end());
+    size_t nSpans = 0;
+    for (size_t i = 0; i < vecSpans.size(); i++) {
+        if (nSpans > 0 && vecSpans[i].first <= vecSpans[nSpans - 1].second) {
+            vecSpans[nSpans - 1].second = std::max(vecSpans[nSpans - 1].second, vecSpans[i].second);
+        } else {
+            vecSpans[nSpans++] = vecSpans[i];
+        }
+    }
+    vecSpans.resize(nSpans);
+
+    for (AX_U32 r = 0; r < u32OSDHeight; r++) {
+        AX_U16 *pLine = pArgbBuffer + r * u32OSDWidth;
+        for (auto &tSpan : vecSpans) {
+            std::fill(pLine + tSpan.first, pLine + tSpan.second, u16BgColor);
+        }
+    }
+
+    /* every glyph over the cleared columns, in the order GenARGB draws them */
+    AX_S32 nCount = (AX_S32)m_vecPos.size();
+    AX_BOOL bRightAlign = (OSD_ALIGN_TYPE_RIGHT_TOP == enAlign || OSD_ALIGN_TYPE_RIGHT_BOTTOM == enAlign) ? AX_TRUE : AX_FALSE;
+    for (AX_S32 n = 0; n < nCount; n++) {
+        const OSD_GLYPH_POS_T &tPos = m_vecPos[bRightAlign ? nCount - 1 - n : n];
+        AX_S32 nLeft = tPos.nX - 1;
+        AX_S32 nRight = tPos.nX - 1 + tPos.nCellW;
+        for (auto &tSpan : vecSpans) {
+            if (nLeft < tSpan.second && tSpan.first < nRight) {
+                const OSD_GLYPH_T *pGlyph = GetGlyph(tPos.wChar, uFontSize, bIsBrushSide, u16FontColor, u16SideColor);
+                if (pGlyph) {
+                    BlitGlyph(*pGlyph, pArgbBuffer, tPos.nX, tPos.nY, bIsBrushSide, u16FontColor, u16BgColor, u16SideColor, u32OSDWidth,
+                              u32OSDHeight, OE_DRAW_OSD_SUCC);
+                }
+                break;
+            }
+        }
+    }
+
+    return nChanged;
+}
+
+AX_BOOL COSDHandler::LayoutGlyphs(wchar_t *pTextStr, AX_U32 u32OSDWidth, AX_U32 u32OSDHeight, AX_S16 x, AX_S16 y, AX_U16 uFontSize,
+                                  AX_BOOL bIsBrushSide, AX_U16 u16FontColor, AX_U16 u16SideColor, OSD_ALIGN_TYPE_E enAlign,
+                                  std::vector<OSD_GLYPH_POS_T> &vecPos) {
+    AX_S32 nLen = wcslen(pTextStr);
+    AX_S32 nGap = (AX_S32)(5.0 * uFontSize / 64);
+    AX_BOOL bRightAlign = AX_FALSE;
+    AX_S32 x0 = x;
+
+    switch (enAlign) {
+        case OSD_ALIGN_TYPE_LEFT_TOP:
+        case OSD_ALIGN_TYPE_LEFT_BOTTOM:
+            break;
+        case OSD_ALIGN_TYPE_RIGHT_TOP:
+        case OSD_ALIGN_TYPE_RIGHT_BOTTOM:
+            bRightAlign = AX_TRUE;
+            x0 = u32OSDWidth - x;
+            break;
+        default:
+            return AX_FALSE;
+    }
+
+    vecPos.resize(nLen);
+    for (AX_S32 n = 0; n < nLen; n++) {
+        AX_S32 i = bRightAlign ? nLen - 1 - n : n;
+        const OSD_GLYPH_T *pGlyph = GetGlyph(pTextStr[i], uFontSize, bIsBrushSide, u16FontColor, u16SideColor);
+        if (!pGlyph) {
+            return AX_FALSE;
+        }
+
+        if (bRightAlign) {
+            x0 -= pGlyph->nWidth + nGap;
+        }
+
+        AX_S32 y0 = y + uFontSize - nGap - pGlyph->nBearingY / 64;
+
+        /* only glyphs drawn whole, clipping and the stop at the edge are left to GenARGB */
+        if (x0 < 1 || y0 < 1 || x0 + pGlyph->nCellW - 2 > (AX_S32)u32OSDWidth - 1 || y0 + pGlyph->nRows > (AX_S32)u32OSDHeight - 1) {
+            return AX_FALSE;
+        }
+
+        vecPos[i].wChar = pTextStr[i];
+        vecPos[i].nX = x0;
+        vecPos[i].nY = y0;
+        vecPos[i].nCellW = pGlyph->nCellW;
+
+        if (!bRightAlign) {
+            x0 += pGlyph->nWidth + nGap;
+        }
+    }
+
+    return AX_TRUE;
+}
+
+AX_VOID COSDHandler::SetGlyphCache(AX_BOOL bEnable) {
+    m_bGlyphCache = bEnable;
+    if (!bEnable) {
+        m_mapGlyphs.clear();
+    }
+}
+
+const COSDHandler::OSD_GLYPH_T *COSDHandler::GetGlyph(wchar_t wChar, AX_U16 uFontSize, AX_BOOL bIsBrushSide, AX_U16 u16FontColor,
+                                                      AX_U16 u16SideColor) {
+    if (!m_bGlyphCache || uFontSize > OSD_GLYPH_CACHE_MAX_FONT_SIZE) {
+        return RenderGlyph(wChar, uFontSize, bIsBrushSide, u16FontColor, u16SideColor, m_tGlyphScratch) ? &m_tGlyphScratch : nullptr;
+    }
+
+    /* code: 21 bits, font size: 10 bits, brush side: 1 bit, font color: 16 bits, side color: 16 bits */
+    AX_U64 nKey = ((AX_U64)(wChar & 0x1FFFFF) << 43) | ((AX_U64)uFontSize << 33) | ((AX_U64)(bIsBrushSide ? 1 : 0) << 32) |
+                  ((AX_U64)u16FontColor << 16) | u16SideColor;
+    auto it = m_mapGlyphs.find(nKey);
+    if (it != m_mapGlyphs.end()) {
+        return &it->second;
+    }
+
+    OSD_GLYPH_T tGlyph;
+    if (!RenderGlyph(wChar, uFontSize, bIsBrushSide, u16FontColor, u16SideColor, tGlyph)) {
+        return nullptr;
+    }
+
+    if (m_mapGlyphs.size() >= OSD_GLYPH_CACHE_MAX) {
+        m_mapGlyphs.clear();
+    }
+
+    OSD_GLYPH_T &tCached = m_mapGlyphs[nKey];
+    tCached = std::move(tGlyph);
+    return &tCached;
+}
+
+AX_BOOL COSDHandler::RenderGlyph(wchar_t wChar, AX_U16 uFontSize, AX_BOOL bIsBrushSide, AX_U16 u16FontColor, AX_U16 u16SideColor,
+                                 OSD_GLYPH_T &tGlyph) {
+    if (m_uFaceSize != uFontSize) {
+        AX_S32 s32Error = FT_Set_Pixel_Sizes(m_fontFace, uFontSize, uFontSize);
+        if (0 != s32Error) {
+            printf("FT Set Size error!\r\n");
+            return AX_FALSE;
+        }
+        m_uFaceSize = uFontSize;
+    }
+
+    FT_Bitmap *ftBitmap = FTGetGlpyhBitMap(wChar);
+    if (!ftBitmap) {
+        return AX_FALSE;
+    }
+
+    /* every bit of pitch is drawn, as it is by the bitmap loop */
+    AX_S32 nPitch = (ftBitmap->pitch > 0) ? ftBitmap->pitch : 0;
+    tGlyph.nWidth = ftBitmap->width;
+    tGlyph.nRows = ftBitmap->rows;
+    tGlyph.nBearingY = m_fontSlot->metrics.horiBearingY;
+    tGlyph.nCellW = nPitch * 8 + 2;
+    tGlyph.nCellH = tGlyph.nRows + 2;
+    tGlyph.vecMask.assign(tGlyph.nCellW * tGlyph.nCellH, 0);
+    tGlyph.vecArgb.assign(tGlyph.nCellW * tGlyph.nCellH, 0);
+
+    for (AX_S32 j = 0; j < tGlyph.nRows; j++) {
+        const AX_U8 *pBits = ftBitmap->buffer + j * ftBitmap->pitch;
+        for (AX_S32 k = 0; k < nPitch * 8; k++) {
+            if (0 == (pBits[k >> 3] & (0x80 >> (k & 7)))) {
+                continue;
+            }
+
+            AX_S32 nIndex = (j + 1) * tGlyph.nCellW + k + 1;
+            tGlyph.vecMask[nIndex] = 2;
+            tGlyph.vecArgb[nIndex] = u16FontColor;
+
+            if (bIsBrushSide) {
+                for (AX_S32 dy = -1; dy <= 1; dy++) {
+                    for (AX_S32 dx = -1; dx <= 1; dx++) {
+                        AX_S32 nSide = nIndex + dy * tGlyph.nCellW + dx;
+                        if (0 == tGlyph.vecMask[nSide]) {
+                            tGlyph.vecMask[nSide] = 1;
+                            tGlyph.vecArgb[nSide] = u16SideColor;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return AX_TRUE;
+}
+
+AX_BOOL COSDHandler::BlitGlyph(const OSD_GLYPH_T &tGlyph, AX_U16 *pArgbBuffer, AX_S32 x0, AX_S32 y0, AX_BOOL bIsBrushSide,
+                               AX_U16 u16FontColor, AX_U16 u16BgColor, AX_U16 u16SideColor, AX_U32 u32OSDWidth, AX_U32 u32OSDHeight,
+                               OSD_ERROR eExit) {
+    AX_S32 nBitsW = tGlyph.nCellW - 2;
+
+    /* font pixels and their sides all inside: the side goes to background only, font overwrites */
+    if (x0 >= 1 && y0 >= 1 && x0 + nBitsW <= (AX_S32)u32OSDWidth - 1 && y0 + tGlyph.nRows <= (AX_S32)u32OSDHeight - 1) {
+        for (AX_S32 r = 0; r < tGlyph.nCellH; r++) {
+            const AX_U8 *pMask = &tGlyph.vecMask[r * tGlyph.nCellW];
+            const AX_U16 *pSrc = &tGlyph.vecArgb[r * tGlyph.nCellW];
+            AX_U16 *pDst = pArgbBuffer + (y0 - 1 + r) * u32OSDWidth + (x0 - 1);
+            for (AX_S32 c = 0; c < tGlyph.nCellW; c++) {
+                if (2 == pMask[c] || (1 == pMask[c] && u16BgColor == pDst[c])) {
+                    pDst[c] = pSrc[c];
+                }
+            }
+        }
+        return AX_FALSE;
+    }
+
+    /* near the edges, point by point as the bounds of DrawPoint and BrushSide decide */
+    AX_BOOL bExit = AX_FALSE;
+    for (AX_S32 j = 0; j < tGlyph.nRows; j++) {
+        const AX_U8 *pMask = &tGlyph.vecMask[(j + 1) * tGlyph.nCellW + 1];
+        for (AX_S32 k = 0; k < nBitsW; k++) {
+            if (2 != pMask[k]) {
+                continue;
+            }
+            if (bIsBrushSide) {
+                BrushSide(pArgbBuffer, x0 + k, y0 + j, u16SideColor, u16BgColor, u32OSDWidth, u32OSDHeight);
+            }
+            if (eExit == DrawPoint(pArgbBuffer, x0 + k, y0 + j, u16FontColor, u32OSDWidth, u32OSDHeight)) {
+                bExit = AX_TRUE;
+            }
+        }
+    }
+
+    return bExit;
+}
+
+AX_F32 COSDHandler::Benchmark(AX_U16 uFontSize, AX_BOOL bCached, AX_U32 nLoops) {
+    wchar_t wszText[] = L"2022-12-31 23:59:59";
+    AX_U32 nLen = wcslen(wszText);
+    AX_U32 nWidth = std::min((AX_U32)(uFontSize * nLen), (AX_U32)OSD_PIXEL_MAX_WIDTH);
+    AX_U32 nHeight = std::min((AX_U32)uFontSize, (AX_U32)OSD_PIXEL_MAX_HEIGHT);
+    if (0 == nLoops || 0 == nWidth || 0 == nHeight) {
+        return 0;
+    }
+
+    AX_BOOL bLastCache = m_bGlyphCache;
+    SetGlyphCache(bCached);
+
+    std::vector<AX_U16> vecArgb(nWidth * nHeight);
+    AX_U64 nTotalUs = 0;
+    for (AX_U32 i = 0; i < nLoops; i++) {
+        /* seconds tick like the time OSD */
+        wszText[nLen - 1] = L'0' + i % 10;
+        wszText[nLen - 2] = L'0' + (i / 10) % 6;
+
+        auto tpStart = std::chrono::steady_clock::now();
+        GenARGB(wszText, vecArgb.data(), nWidth, nHeight, 0, 0, uFontSize, AX_TRUE, 0xFFFFFFFF, 0xFFFFFF, 0xFF000000);
+        auto tpEnd = std::chrono::steady_clock::now();
+        nTotalUs += std::chrono::duration_cast<std::chrono::microseconds>(tpEnd - tpStart).count();
+    }
+
+    SetGlyphCache(bLastCache);
+
+    return (AX_F32)nTotalUs / 1000 / nLoops;
+}
+
 AX_BOOL COSDHandler::InitOSDHandler(const AX_CHAR *fontFilePath) {
     AX_S32 s32Error = 0;
 
@@ -230,7 +493,7 @@ COSDHandler::OSD_ERROR COSDHandler::DrawPoint(AX_U16 *pDataBuffer, AX_S16 x, AX_
     }
 }
 
-COSDHandler::OSD_ERROR COSDHandler::BrushSide(AX_U16 *pDataBuffer, AX_S16 x, AX_S16 y, AX_U16 uSideColor, AX_S16 uBgColor,
+COSDHandler::OSD_ERROR COSDHandler::BrushSide(AX_U16 *pDataBuffer, AX_S16 x, AX_S16 y, AX_U16 uSideColor, AX_U16 uBgColor,
                                               AX_U32 u32OSDWidth, AX_U32 u32OSDHeight) {
     if ((x >= static_cast<AX_S16>(u32OSDWidth)) || ((x + 1) >= static_cast<AX_S16>(u32OSDWidth))) {
         return OE_WIDTH_BACKWARD_RANGE;
@@ -23,9 +23,13 @@
 #include <cmath>
 #include <iostream>
 #include <mutex>
+#include <unordered_map>
+#include <vector>
 
 #define OSD_PIXEL_MAX_WIDTH 3840
 #define OSD_PIXEL_MAX_HEIGHT 2160
+#define OSD_GLYPH_CACHE_MAX 512
+#define OSD_GLYPH_CACHE_MAX_FONT_SIZE 1023
 
 class COSDHandler {
 public:
@@ -71,16 +75,77 @@ public:
                      AX_U16 uFontSize, AX_BOOL bIsBrushSide = AX_FALSE, AX_U32 uFontColor = 0xFFFFFFFF, AX_U32 uBgColor = 0xFF0000,
                      AX_U32 uSideColor = 0, OSD_ALIGN_TYPE_E enAlign = OSD_ALIGN_TYPE_LEFT_TOP);
 
+    /* Update argb data generated by GenARGB to a new text
+       @param - [IN] pLastStr: text on pArgbBuffer now, generated with the same other parameters
+       @param - [IN] pTextStr: new text
+       other parameters are the ones of GenARGB
+       @return - glyphs drawn, 0 if nothing changed, -1 if error
+
+       description:
+       1. Only the columns of glyphs which changed (code or position) are cleared and the glyphs
+          over them are drawn again, the result is the same as GenARGB of pTextStr.
+       2. Falls back to GenARGB if the texts differ in length, any glyph is clipped or the glyph
+          cache is disabled.
+     */
+    AX_S32 UpdateARGB(wchar_t *pLastStr, wchar_t *pTextStr, AX_U16 *pArgbBuffer, AX_U32 u32OSDWidth, AX_U32 u32OSDHeight, AX_S16 sX,
+                      AX_S16 sY, AX_U16 uFontSize, AX_BOOL bIsBrushSide = AX_FALSE, AX_U32 uFontColor = 0xFFFFFFFF,
+                      AX_U32 uBgColor = 0xFF0000, AX_U32 uSideColor = 0, OSD_ALIGN_TYPE_E enAlign = OSD_ALIGN_TYPE_LEFT_TOP);
+
+    /* Enable glyph cache (default)
+       @param - [IN]     bEnable: AX_FALSE renders every character by freetype on every call
+
+       description:
+       1. Glyphs are cached per handler (so per font) by code, font size, brush side and colors,
+          pre-rendered to ARGB1555 with the brushed side, composing a string is a sequence of blits.
+     */
+    AX_VOID SetGlyphCache(AX_BOOL bEnable);
+
+    /* Measure GenARGB of a date string
+       @param - [IN]     uFontSize: font size
+       @param - [IN]     bCached: with or without glyph cache
+       @param - [IN]     nLoops: strings to render
+       @return - ms per string
+     */
+    AX_F32 Benchmark(AX_U16 uFontSize, AX_BOOL bCached, AX_U32 nLoops);
+
 private:
+    /* glyph cell has 1 pixel border for the brushed side */
+    typedef struct {
+        AX_S32 nWidth;    // advance width of bitmap
+        AX_S32 nRows;
+        AX_S32 nBearingY; // 26.6
+        AX_S32 nCellW;
+        AX_S32 nCellH;
+        std::vector<AX_U8> vecMask;   // 0: none, 1: side, 2: font
+        std::vector<AX_U16> vecArgb;
+    } OSD_GLYPH_T;
+
+    /* where GenARGB draws a glyph, columns of the cell are [nX - 1, nX + nCellW - 1) */
+    typedef struct {
+        wchar_t wChar;
+        AX_S32 nX;
+        AX_S32 nY;
+        AX_S32 nCellW;
+    } OSD_GLYPH_POS_T;
+
     AX_BOOL DeinitOSDHandler(AX_VOID);
 
     OSD_ERROR DrawPoint(AX_U16 *pDataBuffer, AX_S16 x, AX_S16 y, AX_U16 uFontColor, AX_U32 u32OSDWidth, AX_U32 u32OSDHeight);
-    OSD_ERROR BrushSide(AX_U16 *pDataBuffer, AX_S16 x, AX_S16 y, AX_U16 uSideColor, AX_S16 uBgColor, AX_U32 u32OSDWidth,
+    OSD_ERROR BrushSide(AX_U16 *pDataBuffer, AX_S16 x, AX_S16 y, AX_U16 uSideColor, AX_U16 uBgColor, AX_U32 u32OSDWidth,
                         AX_U32 u32OSDHeight);
 
     AX_U16 ConvertColor2Argb1555BE(AX_U32 &uColor);
     FT_Bitmap *FTGetGlpyhBitMap(AX_U16 u16CharCode);
 
+    const OSD_GLYPH_T *GetGlyph(wchar_t wChar, AX_U16 uFontSize, AX_BOOL bIsBrushSide, AX_U16 u16FontColor, AX_U16 u16SideColor);
+    AX_BOOL RenderGlyph(wchar_t wChar, AX_U16 uFontSize, AX_BOOL bIsBrushSide, AX_U16 u16FontColor, AX_U16 u16SideColor,
+                        OSD_GLYPH_T &tGlyph);
+    AX_BOOL BlitGlyph(const OSD_GLYPH_T &tGlyph, AX_U16 *pArgbBuffer, AX_S32 x0, AX_S32 y0, AX_BOOL bIsBrushSide, AX_U16 u16FontColor,
+                      AX_U16 u16BgColor, AX_U16 u16SideColor, AX_U32 u32OSDWidth, AX_U32 u32OSDHeight, OSD_ERROR eExit);
+    AX_BOOL LayoutGlyphs(wchar_t *pTextStr, AX_U32 u32OSDWidth, AX_U32 u32OSDHeight, AX_S16 x, AX_S16 y, AX_U16 uFontSize,
+                         AX_BOOL bIsBrushSide, AX_U16 u16FontColor, AX_U16 u16SideColor, OSD_ALIGN_TYPE_E enAlign,
+                         std::vector<OSD_GLYPH_POS_T> &vecPos);
+
 private:
     AX_U32 m_uHandle;
     AX_U32 m_u32ArgbBufferSize;
@@ -90,4 +155,11 @@ private:
     FT_GlyphSlot m_fontSlot;
 
     AX_S32 m_maxHoriAdvance;
+
+    AX_BOOL m_bGlyphCache{AX_TRUE};
+    AX_U16 m_uFaceSize{0};
+    std::unordered_map<AX_U64, OSD_GLYPH_T> m_mapGlyphs;
+    OSD_GLYPH_T m_tGlyphScratch;
+    std::vector<OSD_GLYPH_POS_T> m_vecLastPos;
+    std::vector<OSD_GLYPH_POS_T> m_vecPos;
 };
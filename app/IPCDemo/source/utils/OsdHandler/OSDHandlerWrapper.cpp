@@ -41,3 +41,15 @@ AX_VOID* COSDHandlerWrapper::GenARGB(COSDHandler *pOSDHandler, wchar_t *pTextStr
     return pOSDHandler->GenARGB(pTextStr, pArgbBuffer, u32OSDWidth, u32OSDHeight, sX, sY, uFontSize, bIsBrushSide, uFontColor,
                                            uBgColor, uSideColor, enAlign);
 }
+
+AX_S32 COSDHandlerWrapper::UpdateARGB(COSDHandler *pOSDHandler, wchar_t *pLastStr, wchar_t *pTextStr, AX_U16 *pArgbBuffer,
+                                      AX_U32 u32OSDWidth, AX_U32 u32OSDHeight, AX_S16 sX, AX_S16 sY, AX_U16 uFontSize,
+                                      AX_BOOL bIsBrushSide, AX_U32 uFontColor, AX_U32 uBgColor, AX_U32 uSideColor,
+                                      OSD_ALIGN_TYPE_E enAlign) {
+    return pOSDHandler->UpdateARGB(pLastStr, pTextStr, pArgbBuffer, u32OSDWidth, u32OSDHeight, sX, sY, uFontSize, bIsBrushSide,
+                                   uFontColor, uBgColor, uSideColor, enAlign);
+}
+
+AX_F32 COSDHandlerWrapper::Benchmark(COSDHandler *pOSDHandler, AX_U16 uFontSize, AX_BOOL bCached, AX_U32 nLoops) {
+    return pOSDHandler->Benchmark(uFontSize, bCached, nLoops);
+}
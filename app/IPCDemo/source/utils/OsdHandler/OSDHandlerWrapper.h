@@ -67,5 +67,24 @@ public:
                                 AX_U32 u32OSDHeight, AX_S16 sX, AX_S16 sY, AX_U16 uFontSize, AX_BOOL bIsBrushSide = AX_FALSE,
                                 AX_U32 uFontColor = 0xFFFFFFFF, AX_U32 uBgColor = 0xFF0000, AX_U32 uSideColor = 0,
                                 OSD_ALIGN_TYPE_E enAlign = OSD_ALIGN_TYPE_LEFT_TOP);
+    /* Update argb data generated by GenARGB to a new text, only the changed glyphs are drawn again
+      @param - [IN]pOSDHanlder: osdhandler instance pointer.
+      @param - [IN] pLastStr: text on pArgbBuffer now, generated with the same other parameters
+      @param - [IN] pTextStr: new text
+      other parameters are the ones of GenARGB
+      @return - glyphs drawn, 0 if nothing changed, -1 if error
+    */
+    AX_S32 UpdateARGB(COSDHandler *pOSDHandler, wchar_t *pLastStr, wchar_t *pTextStr, AX_U16 *pArgbBuffer, AX_U32 u32OSDWidth,
+                      AX_U32 u32OSDHeight, AX_S16 sX, AX_S16 sY, AX_U16 uFontSize, AX_BOOL bIsBrushSide = AX_FALSE,
+                      AX_U32 uFontColor = 0xFFFFFFFF, AX_U32 uBgColor = 0xFF0000, AX_U32 uSideColor = 0,
+                      OSD_ALIGN_TYPE_E enAlign = OSD_ALIGN_TYPE_LEFT_TOP);
+    /* Measure GenARGB of a date string
+      @param - [IN]pOSDHanlder: osdhandler instance pointer.
+      @param - [IN]     uFontSize: font size
+      @param - [IN]     bCached: with or without glyph cache
+      @param - [IN]     nLoops: strings to render
+      @return - ms per string
+    */
+    AX_F32 Benchmark(COSDHandler *pOSDHandler, AX_U16 uFontSize, AX_BOOL bCached, AX_U32 nLoops);
 
 };
@@ -49,6 +49,9 @@ AX_VOID CPrintHelper::PrintThreadFunc()
             m_stVencStatisticsInfo.Print();
             if (gOptions.IsActivedDetect() && gOptions.IsActivedDetectFromWeb()) {
                 m_stDetPerfStatisticsInfo.Print();
+                m_stDetSchedStatisticsInfo.Print();
+                m_stDetStageStatisticsInfo.Print();
+                m_stDetSearchStatisticsInfo.Print();
             }
             m_stWebStatisticsInfo.Print();
 
@@ -120,6 +123,15 @@ AX_VOID CPrintHelper::Add(PRINT_HELPER_MOD_E eModType, AX_VOID *pCtx)
         case E_PH_MOD_DET_PERF:
             m_stDetPerfStatisticsInfo.Add(pCtx);
             break;
+        case E_PH_MOD_DET_SCHED:
+            m_stDetSchedStatisticsInfo.Add(pCtx);
+            break;
+        case E_PH_MOD_DET_STAGE:
+            m_stDetStageStatisticsInfo.Add(pCtx);
+            break;
+        case E_PH_MOD_DET_SEARCH:
+            m_stDetSearchStatisticsInfo.Add(pCtx);
+            break;
         default:
             break;
     }
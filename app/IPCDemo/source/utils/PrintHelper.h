@@ -35,6 +35,9 @@ typedef enum _PRINT_HELPER_MOD_E
     E_PH_MOD_WEB_CONN,
     E_PH_MOD_DET,
     E_PH_MOD_DET_PERF,
+    E_PH_MOD_DET_SCHED,
+    E_PH_MOD_DET_STAGE,
+    E_PH_MOD_DET_SEARCH,
     E_PH_MOD_MAX,
 } PRINT_HELPER_MOD_E;
 
@@ -278,6 +281,14 @@ typedef struct _DET_PERF_INFO_T
     AX_U32 nElapsed;
     DET_PERF_INFO_DETAIL_T tTargets;
     DET_PERF_INFO_DETAIL_T tTracks;
+    AX_U32 nInflightDepth;
+    AX_U32 nInflightMaxDepth;
+    AX_U32 nInflightCollisions;
+    AX_U32 nInflightTimeouts;
+    AX_U32 nArenaUsed;
+    AX_U32 nArenaMaxUsed;
+    AX_U32 nArenaCapacity;
+    AX_U32 nArenaHeapAllocs;
 } DET_PERF_INFO_T;
 
 typedef struct _DET_PERF_PRINT_INFO_T
@@ -291,6 +302,13 @@ typedef struct _DET_PERF_PRINT_INFO_T
     DET_PERF_INFO_DETAIL_T tPeroidTracks;
     AX_U32 nMaxTargets;
     AX_U32 nMaxTracks;
+    AX_U32 nInflightDepth;
+    AX_U32 nInflightMaxDepth;
+    AX_U32 nInflightCollisions;
+    AX_U32 nInflightTimeouts;
+    AX_U32 nArenaMaxUsed;
+    AX_U32 nArenaCapacity;
+    AX_U32 nArenaHeapAllocs;
 
     _DET_PERF_PRINT_INFO_T() {
         memset(this, 0, sizeof(_DET_PERF_PRINT_INFO_T));
@@ -332,6 +350,17 @@ typedef struct _DET_PERF_PRINT_INFO_T
                                 + pPerfInfo->tTracks.nCycles + pPerfInfo->tTracks.nFaces
                                 + pPerfInfo->tTracks.nPlates;
             nMaxTracks = AX_MAX(nMaxTracks, nTracks);
+
+            // in-flight
+            nInflightDepth = pPerfInfo->nInflightDepth;
+            nInflightMaxDepth = AX_MAX(nInflightMaxDepth, pPerfInfo->nInflightMaxDepth);
+            nInflightCollisions += pPerfInfo->nInflightCollisions;
+            nInflightTimeouts += pPerfInfo->nInflightTimeouts;
+
+            // result arena
+            nArenaMaxUsed = AX_MAX(nArenaMaxUsed, AX_MAX(pPerfInfo->nArenaUsed, pPerfInfo->nArenaMaxUsed));
+            nArenaCapacity = pPerfInfo->nArenaCapacity;
+            nArenaHeapAllocs += pPerfInfo->nArenaHeapAllocs;
         }
     }
 
@@ -367,6 +396,21 @@ typedef struct _DET_PERF_PRINT_INFO_T
             nTotalTargets, nMaxTargets,
             nTotalTracks, nMaxTracks);
 
+        LOG_M("DETECTION", "[%d] [%d] [%s] AI inflight(cur: %u, max: %u, collision: %u, timeout: %u)",
+            0,
+            DETECTOR_IVPS_CHANNEL_NO,
+            CTimeUtils::GetCurrTimeStr(&szHMS[0]),
+            nInflightDepth, nInflightMaxDepth,
+            nInflightCollisions, nInflightTimeouts);
+
+        LOG_M("DETECTION", "[%d] [%d] [%s] AI arena(max used: %u, capacity: %u, heap alloc: %u, per result: %.2f)",
+            0,
+            DETECTOR_IVPS_CHANNEL_NO,
+            CTimeUtils::GetCurrTimeStr(&szHMS[0]),
+            nArenaMaxUsed, nArenaCapacity,
+            nArenaHeapAllocs,
+            (nPeroidFrames == 0) ? 0 : (nArenaHeapAllocs * 1.0 / nPeroidFrames));
+
         nPeroidElapsed = 0;
         nPeroidFrames = 0;
         nMinElapsed = 0xFFFFFFFF;
@@ -376,9 +420,197 @@ typedef struct _DET_PERF_PRINT_INFO_T
         memset(&tPeroidTracks, 0x00, sizeof(tPeroidTracks));
         nMaxTargets = 0;
         nMaxTracks = 0;
+        nInflightMaxDepth = nInflightDepth;
+        nInflightCollisions = 0;
+        nInflightTimeouts = 0;
+        nArenaMaxUsed = 0;
+        nArenaHeapAllocs = 0;
     }
 } DET_PERF_PRINT_INFO_T;
 
+typedef struct _DET_SCHED_INFO_T
+{
+    AX_BOOL bSent;
+    AX_BOOL bActive;
+    AX_F32 fCurFps;
+} DET_SCHED_INFO_T;
+
+typedef struct _DET_SCHED_PRINT_INFO_T
+{
+    AX_U32 nPeroidFrames;
+    AX_U32 nPeroidSent;
+    AX_U32 nPeroidActive;
+    AX_F32 fCurFps;
+    AX_F32 fMinFps;
+    AX_F32 fMaxFps;
+
+    _DET_SCHED_PRINT_INFO_T() {
+        memset(this, 0, sizeof(_DET_SCHED_PRINT_INFO_T));
+    }
+
+    AX_VOID Add(AX_VOID *pCtx) {
+        if (pCtx) {
+            DET_SCHED_INFO_T *pSchedInfo = (DET_SCHED_INFO_T *)pCtx;
+
+            if (0 == nPeroidFrames) {
+                fMinFps = pSchedInfo->fCurFps;
+                fMaxFps = pSchedInfo->fCurFps;
+            }
+
+            nPeroidFrames ++;
+            nPeroidSent += pSchedInfo->bSent ? 1 : 0;
+            nPeroidActive += pSchedInfo->bActive ? 1 : 0;
+            fCurFps = pSchedInfo->fCurFps;
+            fMinFps = AX_MIN(fMinFps, pSchedInfo->fCurFps);
+            fMaxFps = AX_MAX(fMaxFps, pSchedInfo->fCurFps);
+        }
+    }
+
+    AX_VOID Print() {
+        if (0 == nPeroidFrames) {
+            return;
+        }
+
+        AX_CHAR szHMS[10] = {0};
+        LOG_M("DETECTION", "[%d] [%d] [%s] AI sched(duty: %5.1f%%, sent: %u/%u, active: %5.1f%%, fps cur: %.1f min: %.1f max: %.1f)",
+            0,
+            DETECTOR_IVPS_CHANNEL_NO,
+            CTimeUtils::GetCurrTimeStr(&szHMS[0]),
+            nPeroidSent * 100.0 / nPeroidFrames,
+            nPeroidSent, nPeroidFrames,
+            nPeroidActive * 100.0 / nPeroidFrames,
+            fCurFps, fMinFps, fMaxFps);
+
+        nPeroidFrames = 0;
+        nPeroidSent = 0;
+        nPeroidActive = 0;
+    }
+} DET_SCHED_PRINT_INFO_T;
+
+typedef struct _DET_STAGE_INFO_T
+{
+    AX_U32 nLatency;     // us, from stage receiving to both IVES and NPU submitting done
+    AX_U32 nIvesElapsed; // us
+    AX_U32 nNpuElapsed;  // us
+    AX_BOOL bIvesDropped;
+} DET_STAGE_INFO_T;
+
+typedef struct _DET_STAGE_PRINT_INFO_T
+{
+    AX_U32 nPeroidFrames;
+    AX_U32 nPeroidIvesDropped;
+    AX_U64 nPeroidLatency;
+    AX_U32 nMinLatency;
+    AX_U32 nMaxLatency;
+    AX_U64 nPeroidIvesBusy;
+    AX_U64 nPeroidNpuBusy;
+    AX_U64 nTickStart;
+
+    _DET_STAGE_PRINT_INFO_T() {
+        memset(this, 0, sizeof(_DET_STAGE_PRINT_INFO_T));
+    }
+
+    AX_VOID Add(AX_VOID *pCtx) {
+        if (pCtx) {
+            DET_STAGE_INFO_T *pStageInfo = (DET_STAGE_INFO_T *)pCtx;
+
+            if (0 == nPeroidFrames) {
+                nMinLatency = pStageInfo->nLatency;
+                nMaxLatency = pStageInfo->nLatency;
+            }
+
+            if (0 == nTickStart) {
+                nTickStart = CTimeUtils::GetTickCount();
+            }
+
+            nPeroidFrames ++;
+            nPeroidIvesDropped += pStageInfo->bIvesDropped ? 1 : 0;
+            nPeroidLatency += pStageInfo->nLatency;
+            nMinLatency = AX_MIN(nMinLatency, pStageInfo->nLatency);
+            nMaxLatency = AX_MAX(nMaxLatency, pStageInfo->nLatency);
+            nPeroidIvesBusy += pStageInfo->nIvesElapsed;
+            nPeroidNpuBusy += pStageInfo->nNpuElapsed;
+        }
+    }
+
+    AX_VOID Print() {
+        if (0 == nPeroidFrames) {
+            return;
+        }
+
+        AX_U64 nWindow = (CTimeUtils::GetTickCount() - nTickStart) * 1000;
+        if (0 == nWindow) {
+            nWindow = 1;
+        }
+
+        AX_CHAR szHMS[10] = {0};
+        LOG_M("DETECTION", "[%d] [%d] [%s] AI stage(latency min: %.2fms avg: %.2fms max: %.2fms, ives util: %5.1f%%, npu submit util: %5.1f%%, ives drop: %u/%u)",
+            0,
+            DETECTOR_IVPS_CHANNEL_NO,
+            CTimeUtils::GetCurrTimeStr(&szHMS[0]),
+            nMinLatency / 1000.0,
+            nPeroidLatency / 1000.0 / nPeroidFrames,
+            nMaxLatency / 1000.0,
+            nPeroidIvesBusy * 100.0 / nWindow,
+            nPeroidNpuBusy * 100.0 / nWindow,
+            nPeroidIvesDropped, nPeroidFrames);
+
+        memset(this, 0, sizeof(_DET_STAGE_PRINT_INFO_T));
+    }
+} DET_STAGE_PRINT_INFO_T;
+
+typedef struct _DET_SEARCH_INFO_T
+{
+    AX_U32 nObjects;  // objects with feature in one frame
+    AX_U32 nHits;     // answered by the track cache
+    AX_U32 nPending;  // feature accumulated for averaging, not searched yet
+    AX_U32 nSearched; // features sent to search
+    AX_U32 nTracks;   // tracks in cache
+} DET_SEARCH_INFO_T;
+
+typedef struct _DET_SEARCH_PRINT_INFO_T
+{
+    AX_U32 nPeroidObjects;
+    AX_U32 nPeroidHits;
+    AX_U32 nPeroidPending;
+    AX_U32 nPeroidSearched;
+    AX_U32 nTracks;
+
+    _DET_SEARCH_PRINT_INFO_T() {
+        memset(this, 0, sizeof(_DET_SEARCH_PRINT_INFO_T));
+    }
+
+    AX_VOID Add(AX_VOID *pCtx) {
+        if (pCtx) {
+            DET_SEARCH_INFO_T *pSearchInfo = (DET_SEARCH_INFO_T *)pCtx;
+
+            nPeroidObjects += pSearchInfo->nObjects;
+            nPeroidHits += pSearchInfo->nHits;
+            nPeroidPending += pSearchInfo->nPending;
+            nPeroidSearched += pSearchInfo->nSearched;
+            nTracks = pSearchInfo->nTracks;
+        }
+    }
+
+    AX_VOID Print() {
+        if (0 == nPeroidObjects) {
+            return;
+        }
+
+        AX_CHAR szHMS[10] = {0};
+        LOG_M("DETECTION", "[%d] [%d] [%s] AI search cache(tracks: %u, hit: %5.1f%%, pending: %5.1f%%, searched: %u/%u)",
+            0,
+            DETECTOR_IVPS_CHANNEL_NO,
+            CTimeUtils::GetCurrTimeStr(&szHMS[0]),
+            nTracks,
+            nPeroidHits * 100.0 / nPeroidObjects,
+            nPeroidPending * 100.0 / nPeroidObjects,
+            nPeroidSearched, nPeroidObjects);
+
+        memset(this, 0, sizeof(_DET_SEARCH_PRINT_INFO_T));
+    }
+} DET_SEARCH_PRINT_INFO_T;
+
 class CPrintHelper
 {
 public:
@@ -412,6 +644,9 @@ private:
     VENC_PRINT_INFO_T    m_stVencStatisticsInfo;
     WEB_PRINT_INFO_T     m_stWebStatisticsInfo;
     DET_PERF_PRINT_INFO_T m_stDetPerfStatisticsInfo;
+    DET_SCHED_PRINT_INFO_T m_stDetSchedStatisticsInfo;
+    DET_STAGE_PRINT_INFO_T m_stDetStageStatisticsInfo;
+    DET_SEARCH_PRINT_INFO_T m_stDetSearchStatisticsInfo;
 
     PIPE_POINT_TIMESPAN_INFO_T m_stPipePtTsInfo;
     map<tuple<AX_U32, AX_U32>, std::chrono::high_resolution_clock::time_point> m_mapFrameTS;
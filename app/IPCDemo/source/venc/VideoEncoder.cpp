@@ -18,6 +18,7 @@
 #include "JsonCfgParser.h"
 #include "IVPSStage.h"
 #include <sys/time.h>
+#include <algorithm>
 #include <atomic>
 #include <mutex>
 #include <queue>
@@ -26,8 +27,12 @@
 #include <unistd.h>
 #include <map>
 #include "Detector.h"
+#include "BoxPredictor.h"
+#include "Md.h"
 
 #define VENC "VENC"
+#define YUV_DRAW_BENCH_ENV_STR "YUV_DRAW_BENCH"
+#define PRIVACY_MASK_BENCH_ENV_STR "PRIVACY_MASK_BENCH"
 #define SAVE_MAX_FPS(arg) if(arg > g_nVENCMaxFPS) { g_nVENCMaxFPS = arg; }
 
 extern COptionHelper gOptions;
@@ -187,6 +192,8 @@ static AX_VOID *GetThreadFunc(AX_VOID *__this)
             LOG_M_E(VENC, "AX_VENC_ReleaseStream failed!");
             continue;
         }
+
+        pThis->ProcMotionRoi();
     }
 
     LOG_M(VENC, "[%d] ---", pThis->m_nChannel);
@@ -230,6 +237,16 @@ AX_BOOL CVideoEncoder::LoadConfig()
 
     m_bH265 = (m_tVideoConfig.ePayloadType == PT_H265 ? AX_TRUE : AX_FALSE);
 
+    LoadPrivacyConfig();
+
+    /* masks are applied in ProcOSD, a channel linked from IVPS to VENC never gets there */
+    if (AX_BIT_CHECK(m_tPrivacyConfig.nStreams, m_nChannel) && gOptions.IsLinkMode()
+        && 1 == g_tIvpsGroupConfig[nISPChn].arrLinkModeFlag[nIvpsInnerIndex]) {
+        LOG_M_E(VENC, "[%d] privacy mask on a linked channel, IVPS(Grp: %d, Chn: %d) is unlinked to send frames through ProcOSD",
+                m_nChannel, nISPChn, nIvpsInnerIndex);
+        g_tIvpsGroupConfig[nISPChn].arrLinkModeFlag[nIvpsInnerIndex] = 0;
+    }
+
     LOG_M(VENC, "[%d] ---", m_nChannel);
 
     return InitParams(m_tVideoConfig);
@@ -275,6 +292,10 @@ AX_BOOL CVideoEncoder::Start(AX_BOOL bReload /*= AX_TRUE*/)
         }
     }
 
+    /* a new channel has no ROI */
+    m_nRoiSeqNum = 0;
+    m_nRoiCount = 0;
+
     m_bGetThreadRunning = AX_TRUE;
     m_pGetThread = new thread(GetThreadFunc, this);         // 线程处理函数，从编码模块获取编码后的帧。
 
@@ -544,6 +565,24 @@ AX_BOOL CVideoEncoder::InitParams(VIDEO_CONFIG_T &config)
 
     if (0 == m_nChannel) {
         LoadFont();
+
+        if (getenv(YUV_DRAW_BENCH_ENV_STR)) {
+            const AX_IMG_FORMAT_E arrFormats[] = {AX_YUV420_SEMIPLANAR, AX_YUV420_PLANAR, AX_YUV422_INTERLEAVED_UYVY};
+            const AX_CHAR *arrNames[] = {"NV12", "I420", "UYVY"};
+            for (AX_U32 i = 0; i < sizeof(arrFormats) / sizeof(arrFormats[0]); i++) {
+                LOG_M(VENC, "DrawRect %s: 1080p %.2f us/box, 4K %.2f us/box", arrNames[i],
+                      CYuvHandler::Benchmark(arrFormats[i], 1920, 1080, 1000), CYuvHandler::Benchmark(arrFormats[i], 3840, 2160, 1000));
+            }
+        }
+
+        if (getenv(PRIVACY_MASK_BENCH_ENV_STR)) {
+            LOG_M(VENC, "Privacy mosaic %d: 1080p %.3f ms/MP, 4K %.3f ms/MP", m_tPrivacyConfig.nBlockSize,
+                  CPrivacyMask::Benchmark(PRIVACY_MASK_MOSAIC, m_tPrivacyConfig.nBlockSize, 1920, 1080, 100),
+                  CPrivacyMask::Benchmark(PRIVACY_MASK_MOSAIC, m_tPrivacyConfig.nBlockSize, 3840, 2160, 50));
+            LOG_M(VENC, "Privacy blur %d: 1080p %.3f ms/MP, 4K %.3f ms/MP", m_tPrivacyConfig.nBlurRadius,
+                  CPrivacyMask::Benchmark(PRIVACY_MASK_BLUR, m_tPrivacyConfig.nBlurRadius, 1920, 1080, 100),
+                  CPrivacyMask::Benchmark(PRIVACY_MASK_BLUR, m_tPrivacyConfig.nBlurRadius, 3840, 2160, 50));
+        }
     }
 
     MPEG4EC_INFO_T stMp4EcInfo;
@@ -799,7 +838,22 @@ AX_VOID CVideoEncoder::ProcOSD(CMediaFrame* pFrame)
     AX_U32 nHeight = tFrame.stVFrame.u32Height;
     CYuvHandler YUV((const AX_U8 *)nVirAddr, tFrame.stVFrame.u32PicStride[0], nHeight, AX_YUV420_SEMIPLANAR, 0);
 
+    /* UV plane is not always right behind Y, the pool may pad the Y height */
+    AX_U64 nVirAddrUV = tFrame.stVFrame.u64VirAddr[1];
+    if (0 == nVirAddrUV) {
+        nVirAddrUV = (tFrame.stVFrame.u64PhyAddr[1] > tFrame.stVFrame.u64PhyAddr[0])
+                         ? nVirAddr + (tFrame.stVFrame.u64PhyAddr[1] - tFrame.stVFrame.u64PhyAddr[0])
+                         : nVirAddr + tFrame.stVFrame.u32PicStride[0] * nHeight;
+    }
+
+    AX_BOOL bMask = AX_BIT_CHECK(m_tPrivacyConfig.nStreams, m_nChannel) ? AX_TRUE : AX_FALSE;
+
     if (gOptions.IsActivedDetect() && gOptions.IsActivedDetectFromWeb()) {
+        AX_BOOL bSendMeta = (m_pWebServer && m_pWebServer->IsMetaConnected(m_nChannel)) ? AX_TRUE : AX_FALSE;
+        if (!bSendMeta && !m_bDrawDetect && !bMask) {
+            return;
+        }
+
         auto OSDRect = [&](AI_Detection_Box_t *p, CYuvHandler::YUV_COLOR eColor) {
             AX_S16 x0 = p->fX * nWidth;
             AX_S16 y0 = p->fY * nHeight;
@@ -883,6 +937,37 @@ AX_VOID CVideoEncoder::ProcOSD(CMediaFrame* pFrame)
 
         DETECT_RESULT_T tResult = gOptions.GetDetectResult(0);
 
+        // catch up with objects moved since the detected frame
+        CBoxPredictor::GetInstance()->Predict(tResult, tFrame.stVFrame.u64PTS);
+
+        // masked under the overlay, whatever is drawn stays visible
+        if (bMask) {
+            /* boxes are not predicted further than the horizon, an older result (or none yet) covers the whole frame */
+            AX_U64 u64Pts = tFrame.stVFrame.u64PTS;
+            AX_BOOL bStale = (0 == tResult.u64Pts || (u64Pts > tResult.u64Pts && u64Pts - tResult.u64Pts > BOX_PREDICTOR_MAX_HORIZON))
+                                 ? AX_TRUE : AX_FALSE;
+            if (bStale != m_bPrivacyFullFrame) {
+                if (bStale) {
+                    LOG_M_W(VENC, "[%d] detection result of pts %lld is stale at %lld, privacy mask covers the whole frame", m_nChannel,
+                            tResult.u64Pts, u64Pts);
+                } else {
+                    LOG_M(VENC, "[%d] privacy mask follows the boxes again", m_nChannel);
+                }
+                m_bPrivacyFullFrame = bStale;
+            }
+
+            ProcPrivacyMask(bStale ? nullptr : &tResult, (AX_U8 *)nVirAddr, (AX_U8 *)nVirAddrUV, tFrame.stVFrame.u32PicStride[0], nWidth,
+                            nHeight);
+        }
+
+        if (bSendMeta) {
+            m_pWebServer->SendMetaData(m_nChannel, tResult, tFrame.stVFrame.u64PTS);
+        }
+
+        if (!m_bDrawDetect) {
+            return;
+        }
+
         DETECTOR_CONFIG_PARAM_T Conf = CDetector::GetInstance()->GetConfig();
 
         if (AX_BIT_CHECK(Conf.nDrawRectType, AI_DRAW_RECT_TYPE_BODY)) {
@@ -903,6 +988,206 @@ AX_VOID CVideoEncoder::ProcOSD(CMediaFrame* pFrame)
         if (AX_BIT_CHECK(Conf.nDrawRectType, AI_DRAW_RECT_TYPE_POSE)) {
             ObjectDrawPose(Pose, CYuvHandler::YUV_DARK_GREEN);
         }
+    } else if (bMask) {
+        /* no boxes without detection, masking fails closed over the whole frame */
+        if (!m_bPrivacyFullFrame) {
+            LOG_M_W(VENC, "[%d] detection is off, privacy mask covers the whole frame", m_nChannel);
+            m_bPrivacyFullFrame = AX_TRUE;
+        }
+
+        ProcPrivacyMask(nullptr, (AX_U8 *)nVirAddr, (AX_U8 *)nVirAddrUV, tFrame.stVFrame.u32PicStride[0], nWidth, nHeight);
+    }
+}
+
+AX_VOID CVideoEncoder::ProcMotionRoi(AX_VOID)
+{
+    AX_S32 nQp = CMD::GetInstance()->GetRoiQp();
+    if (0 == nQp && 0 == m_nRoiCount) {
+        return;
+    }
+
+    std::vector<MD_REGION_T> vecRegions;
+    AX_U32 nImgW = 0;
+    AX_U32 nImgH = 0;
+    AX_U64 nSeqNum = 0;
+    if (0 != nQp && gOptions.IsActivedMotionDetect()) {
+        nSeqNum = CMD::GetInstance()->GetRegions(vecRegions, nImgW, nImgH);
+    }
+
+    /* seq 0: nothing published or ROI off, indexes left over are disabled once */
+    if (nSeqNum == m_nRoiSeqNum && (0 != nSeqNum || 0 == m_nRoiCount)) {
+        return;
+    }
+    m_nRoiSeqNum = nSeqNum;
+
+    // the largest regions take the ROI indexes
+    std::sort(vecRegions.begin(), vecRegions.end(), [](const MD_REGION_T &a, const MD_REGION_T &b) {
+        return a.tRegion.nW * a.tRegion.nH > b.tRegion.nW * b.tRegion.nH;
+    });
+
+    /* MD image is the whole field of view, so is the encoder input before crop */
+    const AX_BOOL bCrop = (m_tVideoConfig.nOffsetCropW > 0 && m_tVideoConfig.nOffsetCropH > 0) ? AX_TRUE : AX_FALSE;
+    const AX_U32 nPicW = bCrop ? m_tVideoConfig.nOffsetCropW : m_tVideoConfig.nInWidth;
+    const AX_U32 nPicH = bCrop ? m_tVideoConfig.nOffsetCropH : m_tVideoConfig.nInHeight;
+    const AX_U32 nCropX = bCrop ? m_tVideoConfig.nOffsetCropX : 0;
+    const AX_U32 nCropY = bCrop ? m_tVideoConfig.nOffsetCropY : 0;
+
+    AX_U32 nCount = 0;
+    for (const auto &tRegion : vecRegions) {
+        if (nCount == VENC_MOTION_ROI_NUM || 0 == nImgW || 0 == nImgH) {
+            break;
+        }
+
+        const MOTION_REGION_T &r = tRegion.tRegion;
+        AX_S32 x0 = (AX_S32)((AX_U64)r.nX * m_tVideoConfig.nInWidth / nImgW) - (AX_S32)nCropX;
+        AX_S32 y0 = (AX_S32)((AX_U64)r.nY * m_tVideoConfig.nInHeight / nImgH) - (AX_S32)nCropY;
+        AX_S32 x1 = (AX_S32)((AX_U64)(r.nX + r.nW) * m_tVideoConfig.nInWidth / nImgW) - (AX_S32)nCropX;
+        AX_S32 y1 = (AX_S32)((AX_U64)(r.nY + r.nH) * m_tVideoConfig.nInHeight / nImgH) - (AX_S32)nCropY;
+
+        /* whole 16x16 blocks covering the region, inside the picture */
+        x0 = std::max(x0, 0) & ~15;
+        y0 = std::max(y0, 0) & ~15;
+        x1 = std::min((AX_S32)ALIGN_UP(std::max(x1, 0), 16), (AX_S32)nPicW);
+        y1 = std::min((AX_S32)ALIGN_UP(std::max(y1, 0), 16), (AX_S32)nPicH);
+        if (x1 <= x0 || y1 <= y0) {
+            continue;
+        }
+
+        AX_VENC_ROI_ATTR_S tRoi;
+        memset(&tRoi, 0, sizeof(tRoi));
+        tRoi.u32Index = nCount;
+        tRoi.bEnable = AX_TRUE;
+        tRoi.bAbsQp = AX_FALSE;
+        tRoi.s32RoiQp = nQp;
+        tRoi.stRoiArea.u32X = x0;
+        tRoi.stRoiArea.u32Y = y0;
+        tRoi.stRoiArea.u32Width = x1 - x0;
+        tRoi.stRoiArea.u32Height = y1 - y0;
+
+        AX_S32 nRet = AX_VENC_SetRoiAttr(m_nChannel, &tRoi);
+        if (AX_SUCCESS != nRet) {
+            LOG_M_E(VENC, "[%d] AX_VENC_SetRoiAttr %d failed, ret=0x%x", m_nChannel, nCount, nRet);
+            continue;
+        }
+        nCount++;
+    }
+
+    /* indexes used by the previous frame only */
+    for (AX_U32 i = nCount; i < m_nRoiCount; i++) {
+        AX_VENC_ROI_ATTR_S tRoi;
+        memset(&tRoi, 0, sizeof(tRoi));
+        tRoi.u32Index = i;
+        tRoi.bEnable = AX_FALSE;
+        tRoi.stRoiArea.u32Width = 16;
+        tRoi.stRoiArea.u32Height = 16;
+
+        AX_S32 nRet = AX_VENC_SetRoiAttr(m_nChannel, &tRoi);
+        if (AX_SUCCESS != nRet) {
+            LOG_M_E(VENC, "[%d] disable ROI %d failed, ret=0x%x", m_nChannel, i, nRet);
+        }
+    }
+
+    LOG_M_I(VENC, "[%d] frame id: %lld, %d motion ROI", m_nChannel, nSeqNum, nCount);
+    m_nRoiCount = nCount;
+}
+
+AX_BOOL CVideoEncoder::LoadPrivacyConfig()
+{
+    inifile::IniFile f;
+    std::string strIniFile{"./config/ive.conf"};
+    if (0 != f.Load(strIniFile)) {
+        LOG_M_E(VENC, "load %s fail", strIniFile.c_str());
+        return AX_FALSE;
+    }
+
+    std::string strSect = "PRIVACY";
+    if (!f.HasSection(strSect)) {
+        /* defaults, masking off */
+        return AX_TRUE;
+    }
+
+    PRIVACY_CONFIG_T tConfig;
+    AX_S32 nVal = 0;
+    if (0 == f.GetIntValue(strSect, "streams", &nVal) && nVal >= 0) {
+        tConfig.nStreams = nVal;
+    }
+    if (0 == f.GetIntValue(strSect, "type", &nVal) && nVal >= 0 && nVal < PRIVACY_MASK_BUTT) {
+        tConfig.eType = (PRIVACY_MASK_TYPE_E)nVal;
+    }
+    if (0 == f.GetIntValue(strSect, "block size", &nVal) && nVal > 0) {
+        tConfig.nBlockSize = nVal;
+    }
+    if (0 == f.GetIntValue(strSect, "blur radius", &nVal) && nVal > 0) {
+        tConfig.nBlurRadius = nVal;
+    }
+    if (0 == f.GetIntValue(strSect, "face", &nVal)) {
+        tConfig.bFace = nVal ? AX_TRUE : AX_FALSE;
+    }
+    if (0 == f.GetIntValue(strSect, "plate", &nVal)) {
+        tConfig.bPlate = nVal ? AX_TRUE : AX_FALSE;
+    }
+    if (0 == f.GetIntValue(strSect, "margin", &nVal) && nVal >= 0) {
+        tConfig.nMargin = nVal;
+    }
+
+    m_tPrivacyConfig = tConfig;
+
+    if (AX_BIT_CHECK(m_tPrivacyConfig.nStreams, m_nChannel)) {
+        LOG_M(VENC, "[%d] privacy %s %d, face: %d, plate: %d, margin: %d%%", m_nChannel,
+              (PRIVACY_MASK_MOSAIC == m_tPrivacyConfig.eType) ? "mosaic" : "blur",
+              (PRIVACY_MASK_MOSAIC == m_tPrivacyConfig.eType) ? m_tPrivacyConfig.nBlockSize : m_tPrivacyConfig.nBlurRadius,
+              m_tPrivacyConfig.bFace, m_tPrivacyConfig.bPlate, m_tPrivacyConfig.nMargin);
+    }
+
+    return AX_TRUE;
+}
+
+AX_VOID CVideoEncoder::ProcPrivacyMask(const DETECT_RESULT_T *pResult, AX_U8 *pImage, AX_U8 *pUV, AX_U32 nStride, AX_U32 nWidth,
+                                       AX_U32 nHeight)
+{
+    AX_U32 nSize = (PRIVACY_MASK_MOSAIC == m_tPrivacyConfig.eType) ? m_tPrivacyConfig.nBlockSize : m_tPrivacyConfig.nBlurRadius;
+
+    if (!pResult) {
+        PRIVACY_MASK_RECT_T tRect;
+        tRect.nX = 0;
+        tRect.nY = 0;
+        tRect.nW = nWidth;
+        tRect.nH = nHeight;
+        m_tPrivacyMask.Apply(m_tPrivacyConfig.eType, pImage, pUV, nStride, nWidth, nHeight, tRect, nSize);
+        return;
+    }
+
+    const DETECT_RESULT_T &tResult = *pResult;
+
+    /* every box of the result, a lost track may still be a face on the frame */
+    auto Mask = [&](const AI_Detection_Box_t &tBox) {
+        AX_F32 fMarginX = tBox.fW * m_tPrivacyConfig.nMargin / 100;
+        AX_F32 fMarginY = tBox.fH * m_tPrivacyConfig.nMargin / 100;
+        AX_F32 fX0 = AX_MAX(tBox.fX - fMarginX, 0.0f);
+        AX_F32 fY0 = AX_MAX(tBox.fY - fMarginY, 0.0f);
+        AX_F32 fX1 = AX_MIN(tBox.fX + tBox.fW + fMarginX, 1.0f);
+        AX_F32 fY1 = AX_MIN(tBox.fY + tBox.fH + fMarginY, 1.0f);
+        if (fX1 <= fX0 || fY1 <= fY0) {
+            return;
+        }
+
+        PRIVACY_MASK_RECT_T tRect;
+        tRect.nX = (AX_U32)(fX0 * nWidth);
+        tRect.nY = (AX_U32)(fY0 * nHeight);
+        tRect.nW = (AX_U32)(fX1 * nWidth + 0.5f) - tRect.nX;
+        tRect.nH = (AX_U32)(fY1 * nHeight + 0.5f) - tRect.nY;
+        m_tPrivacyMask.Apply(m_tPrivacyConfig.eType, pImage, pUV, nStride, nWidth, nHeight, tRect, nSize);
+    };
+
+    if (m_tPrivacyConfig.bFace) {
+        for (AX_U32 i = 0; i < tResult.nFaceSize; ++i) {
+            Mask(tResult.tFaces[i].tBox);
+        }
+    }
+    if (m_tPrivacyConfig.bPlate) {
+        for (AX_U32 i = 0; i < tResult.nPlateSize; ++i) {
+            Mask(tResult.tPlates[i].tBox);
+        }
     }
 }
 
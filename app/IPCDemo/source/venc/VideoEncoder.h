@@ -17,6 +17,7 @@
 #include "BaseSensor.h"
 #include "WebServer.h"
 #include "Mpeg4Encoder.h"
+#include "PrivacyMask.h"
 #include <iostream>
 #include <memory>
 #include <stdio.h>
@@ -26,6 +27,7 @@
 #include <queue>
 
 #define OSD_BUFF_SIZE (512)
+#define VENC_MOTION_ROI_NUM (8) /* ROI indexes of AX_VENC_ROI_ATTR_S */
 
 enum class RcType
 {
@@ -150,6 +152,28 @@ typedef struct _VIDEO_ATTR_T
 
 } VIDEO_ATTR_T, *VIDEO_ATTR_PTR;
 
+/* faces and plates masked before encoding, [PRIVACY] of ive.conf, the whole frame while detection is off */
+typedef struct _PRIVACY_CONFIG_T
+{
+    AX_U32 nStreams;                /* bit n masks venc channel n, 0: off */
+    PRIVACY_MASK_TYPE_E eType;
+    AX_U32 nBlockSize;              /* mosaic block in pixels */
+    AX_U32 nBlurRadius;             /* box blur radius in pixels */
+    AX_BOOL bFace;
+    AX_BOOL bPlate;
+    AX_U32 nMargin;                 /* percent of box size added on each side */
+
+    _PRIVACY_CONFIG_T() {
+        nStreams = 0;
+        eType = PRIVACY_MASK_MOSAIC;
+        nBlockSize = 16;
+        nBlurRadius = 8;
+        bFace = AX_TRUE;
+        bPlate = AX_TRUE;
+        nMargin = 10;
+    }
+} PRIVACY_CONFIG_T;
+
 class AXRtspServer;
 class CVideoEncoder : public CStage
 {
@@ -173,6 +197,9 @@ public:
     AX_BOOL UpdateRCParam(AX_U32 nRcType, AX_BOOL bRcTypeChange, AX_U32 u32MaxIprop);
     AX_BOOL ChangeRCType(AX_U32 nRcType, AX_U32 u32MaxIprop);
     AX_BOOL IsH265(AX_VOID) const { return m_bH265; }
+    /* burn detection overlays into the stream, clients of meta stream may draw them instead */
+    AX_VOID SetDrawDetectEnable(AX_BOOL bEnable) { m_bDrawDetect = bEnable; }
+    AX_BOOL IsDrawDetectEnable(AX_VOID) const { return m_bDrawDetect; }
 
 protected:
     AX_BOOL LoadConfig();
@@ -180,6 +207,15 @@ protected:
     AX_VOID ProcOSD(CMediaFrame* pFrame);
 
     AX_BOOL LoadFont();
+    AX_BOOL LoadPrivacyConfig();
+    /* pResult nullptr masks the whole frame */
+    AX_VOID ProcPrivacyMask(const DETECT_RESULT_T *pResult, AX_U8 *pImage, AX_U8 *pUV, AX_U32 nStride, AX_U32 nWidth, AX_U32 nHeight);
+
+public:
+    /* the largest motion regions of CMD as ROI, applied when CMD publishes another frame, stream thread only */
+    AX_VOID ProcMotionRoi(AX_VOID);
+
+protected:
 
     AX_VOID InitRcParam(AX_PAYLOAD_TYPE_E eType, AX_U32 nSrcFrameRate, const VIDEO_CONFIG_T& tConfig);
     AX_VOID StartRecv();
@@ -209,6 +245,12 @@ private:
     AX_VENC_H265_FIXQP_S m_tH265FixQp{0};
 
     AX_BOOL              bEnableProcessFrame;
+    AX_BOOL              m_bDrawDetect{AX_TRUE};
+    PRIVACY_CONFIG_T     m_tPrivacyConfig;
+    CPrivacyMask         m_tPrivacyMask;
+    AX_BOOL              m_bPrivacyFullFrame{AX_FALSE};
+    AX_U64               m_nRoiSeqNum{0};
+    AX_U32               m_nRoiCount{0};
 
     static CBmpOSD  m_sfont;
 };
@@ -0,0 +1,193 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+#include "DetectMeta.h"
+
+static_assert(sizeof(AI_Detection_Point_t) == sizeof(DETECT_META_POINT_T), "pose point layout mismatch");
+
+namespace {
+class CMetaWriter
+{
+public:
+    CMetaWriter(AX_U8 *pBuf, AX_U32 nBufSize)
+    : m_pBuf(pBuf)
+    , m_nBufSize(nBufSize)
+    , m_nLen(0)
+    , m_bOverflow(AX_FALSE) {
+    }
+
+    AX_U8 *Reserve(AX_U32 nSize) {
+        if (m_bOverflow || m_nLen + nSize > m_nBufSize) {
+            m_bOverflow = AX_TRUE;
+            return nullptr;
+        }
+
+        AX_U8 *p = m_pBuf + m_nLen;
+        m_nLen += nSize;
+        return p;
+    }
+
+    AX_BOOL Write(const AX_VOID *pData, AX_U32 nSize) {
+        AX_U8 *p = Reserve(nSize);
+        if (!p) {
+            return AX_FALSE;
+        }
+
+        memcpy(p, pData, nSize);
+        return AX_TRUE;
+    }
+
+    AX_U32 GetLen(AX_VOID) const {
+        return m_nLen;
+    }
+
+    AX_BOOL IsOverflow(AX_VOID) const {
+        return m_bOverflow;
+    }
+
+private:
+    AX_U8 *m_pBuf;
+    AX_U32 m_nBufSize;
+    AX_U32 m_nLen;
+    AX_BOOL m_bOverflow;
+};
+
+/* object record is written first, attribute count is patched as attributes are appended */
+class CMetaObject
+{
+public:
+    CMetaObject(CMetaWriter &tWriter, DETECT_META_OBJECT_E eType, AX_SKEL_TRACK_STATUS_E eState, AX_U64 u64TrackId,
+                const AI_Detection_Box_t &tBox, AX_F32 fConfidence)
+    : m_tWriter(tWriter) {
+        m_pObject = (DETECT_META_OBJECT_T *)m_tWriter.Reserve(sizeof(DETECT_META_OBJECT_T));
+        if (m_pObject) {
+            DETECT_META_OBJECT_T tObject;
+            tObject.nType = (AX_U8)eType;
+            tObject.nTrackState = (AX_U8)eState;
+            tObject.nAttrCount = 0;
+            tObject.nReserved = 0;
+            tObject.u64TrackId = u64TrackId;
+            tObject.fX = tBox.fX;
+            tObject.fY = tBox.fY;
+            tObject.fW = tBox.fW;
+            tObject.fH = tBox.fH;
+            tObject.fConfidence = fConfidence;
+            memcpy(m_pObject, &tObject, sizeof(tObject));
+        }
+    }
+
+    AX_VOID AddAttr(DETECT_META_ATTR_E eKey, const AX_CHAR *szValue) {
+        if (!m_pObject || !szValue || 0 == szValue[0]) {
+            return;
+        }
+
+        DETECT_META_ATTR_T tAttr;
+        tAttr.nKey = (AX_U8)eKey;
+        tAttr.nLen = (AX_U8)strnlen(szValue, AI_ATTR_STRING_LEN);
+        if (m_tWriter.Write(&tAttr, sizeof(tAttr)) && m_tWriter.Write(szValue, tAttr.nLen)) {
+            ++m_pObject->nAttrCount;
+        }
+    }
+
+private:
+    CMetaWriter &m_tWriter;
+    DETECT_META_OBJECT_T *m_pObject;
+};
+}  // namespace
+
+AX_U32 CDetectMetaPacker::Pack(const DETECT_RESULT_T &tResult, AX_U8 nStream, AX_U64 u64Pts, AX_U8 *pBuf, AX_U32 nBufSize)
+{
+    if (!pBuf) {
+        return 0;
+    }
+
+    CMetaWriter tWriter(pBuf, nBufSize);
+    DETECT_META_HEAD_T *pHead = (DETECT_META_HEAD_T *)tWriter.Reserve(sizeof(DETECT_META_HEAD_T));
+    if (!pHead) {
+        return 0;
+    }
+
+    AX_U16 nObjectCount = 0;
+    AX_CHAR szNum[8] = {0};
+
+    // bodies first, pose records refer to body index
+    for (AX_U32 i = 0; i < tResult.nBodySize; i++, nObjectCount++) {
+        const AI_Detection_BodyResult_t &tBody = tResult.tBodys[i];
+        CMetaObject tObject(tWriter, DETECT_META_OBJECT_BODY, tBody.eTrackState, tBody.u64TrackId, tBody.tBox, tBody.fConfidence);
+    }
+
+    for (AX_U32 i = 0; i < tResult.nVehicleSize; i++, nObjectCount++) {
+        const AI_Detection_VehicleResult_t &tVehicle = tResult.tVehicles[i];
+        CMetaObject tObject(tWriter, DETECT_META_OBJECT_VEHICLE, tVehicle.eTrackState, tVehicle.u64TrackId, tVehicle.tBox, tVehicle.fConfidence);
+        if (tVehicle.tVehicleAttr.bExist) {
+            tObject.AddAttr(DETECT_META_ATTR_VEHICLE_COLOR, tVehicle.tVehicleAttr.szVehicleColor);
+            tObject.AddAttr(DETECT_META_ATTR_VEHICLE_SUBCLASS, tVehicle.tVehicleAttr.szVehicleSubclass);
+        }
+    }
+
+    for (AX_U32 i = 0; i < tResult.nCycleSize; i++, nObjectCount++) {
+        const AI_Detection_CycleResult_t &tCycle = tResult.tCycles[i];
+        CMetaObject tObject(tWriter, DETECT_META_OBJECT_CYCLE, tCycle.eTrackState, tCycle.u64TrackId, tCycle.tBox, tCycle.fConfidence);
+    }
+
+    for (AX_U32 i = 0; i < tResult.nFaceSize; i++, nObjectCount++) {
+        const AI_Detection_FaceResult_t &tFace = tResult.tFaces[i];
+        CMetaObject tObject(tWriter, DETECT_META_OBJECT_FACE, tFace.eTrackState, tFace.u64TrackId, tFace.tBox, tFace.fConfidence);
+        if (tFace.tFaceAttr.bExist) {
+            snprintf(szNum, sizeof(szNum), "%d", tFace.tFaceAttr.nAge);
+            tObject.AddAttr(DETECT_META_ATTR_AGE, szNum);
+            snprintf(szNum, sizeof(szNum), "%d", tFace.tFaceAttr.nGender);
+            tObject.AddAttr(DETECT_META_ATTR_GENDER, szNum);
+            tObject.AddAttr(DETECT_META_ATTR_RESPIRATOR, tFace.tFaceAttr.szRespirator);
+        }
+    }
+
+    for (AX_U32 i = 0; i < tResult.nPlateSize; i++, nObjectCount++) {
+        const AI_Detection_PlateResult_t &tPlate = tResult.tPlates[i];
+        CMetaObject tObject(tWriter, DETECT_META_OBJECT_PLATE, tPlate.eTrackState, tPlate.u64TrackId, tPlate.tBox, tPlate.fConfidence);
+        if (tPlate.tPlateAttr.bExist && tPlate.tPlateAttr.bValid) {
+            tObject.AddAttr(DETECT_META_ATTR_PLATE_CODE, tPlate.tPlateAttr.szPlateCode);
+            tObject.AddAttr(DETECT_META_ATTR_PLATE_COLOR, tPlate.tPlateAttr.szPlateColor);
+        }
+    }
+
+    AX_U16 nPoseCount = 0;
+    for (AX_U32 i = 0; i < tResult.nPoseSize && i < tResult.nBodySize; i++) {
+        const AI_Detection_PoseResult_t &tPose = tResult.tPoses[i];
+        if (0 == tPose.nPointNum) {
+            continue;
+        }
+
+        DETECT_META_POSE_T tMetaPose;
+        tMetaPose.nBodyIndex = (AX_U8)i;
+        tMetaPose.nPointNum = AX_MIN(tPose.nPointNum, (AX_U8)DETECT_POSE_POINT_COUNT);
+        if (!tWriter.Write(&tMetaPose, sizeof(tMetaPose))
+            || !tWriter.Write(&tPose.tPoint[0], tMetaPose.nPointNum * sizeof(DETECT_META_POINT_T))) {
+            break;
+        }
+        nPoseCount++;
+    }
+
+    if (tWriter.IsOverflow()) {
+        return 0;
+    }
+
+    DETECT_META_HEAD_T tHead;
+    tHead.nMagic = DETECT_META_MAGIC;
+    tHead.nVersion = DETECT_META_VERSION;
+    tHead.nStream = nStream;
+    tHead.nTotalLen = tWriter.GetLen();
+    tHead.nFrameId = tResult.nFrameId;
+    tHead.u64Pts = u64Pts;
+    tHead.nObjectCount = nObjectCount;
+    tHead.nPoseCount = nPoseCount;
+    memcpy(pHead, &tHead, sizeof(tHead));
+
+    return tWriter.GetLen();
+}
@@ -0,0 +1,88 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+#pragma once
+#include "global.h"
+#include "OptionHelper.h"
+
+/**
+ * Binary detection metadata sent over websocket "/meta", one packet per encoded frame.
+ * All fields are little endian, coordinates are 0-1 relative to the frame.
+ *
+ * packet:  DETECT_META_HEAD_T
+ *          nObjectCount x (DETECT_META_OBJECT_T + nAttrCount x (DETECT_META_ATTR_T + nLen bytes UTF8, no terminator))
+ *          nPoseCount   x (DETECT_META_POSE_T + nPointNum x DETECT_META_POINT_T)
+ */
+#define DETECT_META_MAGIC (0x544D5841) // "AXMT"
+#define DETECT_META_VERSION (1)
+#define DETECT_META_MAX_SIZE (16 * 1024)
+
+typedef enum _DETECT_META_OBJECT_E {
+    DETECT_META_OBJECT_BODY = 0,
+    DETECT_META_OBJECT_VEHICLE,
+    DETECT_META_OBJECT_CYCLE,
+    DETECT_META_OBJECT_FACE,
+    DETECT_META_OBJECT_PLATE,
+    DETECT_META_OBJECT_BUTT
+} DETECT_META_OBJECT_E;
+
+typedef enum _DETECT_META_ATTR_E {
+    DETECT_META_ATTR_AGE = 0,      // decimal string
+    DETECT_META_ATTR_GENDER,       // "0": female, "1": male
+    DETECT_META_ATTR_RESPIRATOR,
+    DETECT_META_ATTR_PLATE_CODE,
+    DETECT_META_ATTR_PLATE_COLOR,
+    DETECT_META_ATTR_VEHICLE_COLOR,
+    DETECT_META_ATTR_VEHICLE_SUBCLASS,
+    DETECT_META_ATTR_BUTT
+} DETECT_META_ATTR_E;
+
+#pragma pack(push, 1)
+typedef struct _DETECT_META_HEAD_T {
+    AX_U32 nMagic;
+    AX_U16 nVersion;
+    AX_U16 nStream;      // inner index of venc channel
+    AX_U32 nTotalLen;    // include head
+    AX_U32 nFrameId;     // detected frame
+    AX_U64 u64Pts;       // us, pts of the encoded frame the boxes apply to
+    AX_U16 nObjectCount;
+    AX_U16 nPoseCount;
+} DETECT_META_HEAD_T;
+
+typedef struct _DETECT_META_OBJECT_T {
+    AX_U8 nType;         // DETECT_META_OBJECT_E
+    AX_U8 nTrackState;   // AX_SKEL_TRACK_STATUS_E
+    AX_U8 nAttrCount;
+    AX_U8 nReserved;
+    AX_U64 u64TrackId;
+    AX_F32 fX, fY, fW, fH;
+    AX_F32 fConfidence;
+} DETECT_META_OBJECT_T;
+
+typedef struct _DETECT_META_ATTR_T {
+    AX_U8 nKey;          // DETECT_META_ATTR_E
+    AX_U8 nLen;
+} DETECT_META_ATTR_T;
+
+typedef struct _DETECT_META_POSE_T {
+    AX_U8 nBodyIndex;    // index of body objects in this packet
+    AX_U8 nPointNum;
+} DETECT_META_POSE_T;
+
+typedef struct _DETECT_META_POINT_T {
+    AX_F32 fX, fY;
+} DETECT_META_POINT_T;
+#pragma pack(pop)
+
+class CDetectMetaPacker
+{
+public:
+    /* returns packet length, 0 if buffer too small */
+    static AX_U32 Pack(const DETECT_RESULT_T &tResult, AX_U8 nStream, AX_U64 u64Pts, AX_U8 *pBuf, AX_U32 nBufSize);
+};
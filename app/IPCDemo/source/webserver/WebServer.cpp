@@ -26,6 +26,7 @@
 #include "Md.h"
 #include "Od.h"
 #include "Scd.h"
+#include "DetectMeta.h"
 
 #define WEB "WEB SERVER"
 
@@ -65,6 +66,8 @@
 #define PARAM_KEY_PREVIEW_SOURCE "src"
 #define PARAM_KEY_PREVIEW_CHANNEL "stream"
 #define PARAM_KEY_PREVIEW_FACEINFO "faceinfo"
+#define PARAM_KEY_PREVIEW_FACEINFO_ID "id"
+#define PARAM_KEY_DRAW_DETECT "draw_detect"
 
 #define PARAM_KEY_APP_VERSION "appVersion"
 #define PARAM_KEY_SDK_VERSION "sdkVersion"
@@ -368,12 +371,22 @@ static void FaceinfoAction(HttpConn* conn)
         return;
     }
 
-    AX_S32 status = CSearch::GetInstance()->GetFeatureInfo(NULL);
+    // with id: status of a queued enrollment, without: queue a new one
+    // status 4 (pending) means the request is still running, poll again with the returned id
+    cchar* szId = httpGetParam(conn, PARAM_KEY_PREVIEW_FACEINFO_ID, nullptr);
+    AX_U32 nId = 0;
+    AX_S32 status = 0;
+    if (szId) {
+        nId = (AX_U32)atoi(szId);
+        status = CSearch::GetInstance()->GetEnrollStatus(nId);
+    } else {
+        status = CSearch::GetInstance()->GetFeatureInfo(NULL, &nId);
+    }
 
     MprJson* pResponseBody = ConstructBaseResponse(RESPONSE_STATUS_OK, 0);
 
     AX_CHAR szData[256] = {0};
-    sprintf(szData, "{status: %d}", status);
+    sprintf(szData, "{status: %d, id: %d}", status, nId);
 
     mprWriteJsonObj(mprGetJsonObj(pResponseBody, PARAM_KEY_DATA), "faceinfo", mprParseJson(szData));
 
@@ -888,6 +901,50 @@ static void AssistInfoAction(HttpConn* conn)
     httpFinalize(conn);
 }
 
+static void MetaInfoAction(HttpConn* conn)
+{
+    if (!IsAuthorized(conn, AX_TRUE)) {
+        ResponseUnauthorized(conn);
+        return;
+    }
+
+    AX_U8 nInnerIndex = atoi(httpGetParam(conn, PARAM_KEY_PREVIEW_CHANNEL, "0"));
+    CVideoEncoder* pVenc = GetVenc(nInnerIndex);
+    if (!pVenc) {
+        LOG_M_E(WEB, "Invalid meta stream: %d", nInnerIndex);
+        httpSetStatus(conn, 404);
+        httpFinalize(conn);
+        return;
+    }
+
+    if (strcmp(conn->rx->method, "GET") != 0) {
+        MprJson* jsonMeta = httpGetParams(conn);
+        LOG_M(WEB, "recv:%s", mprJsonToString(jsonMeta, MPR_JSON_QUOTES));
+
+        cchar* szDraw = mprGetJson(jsonMeta, PARAM_KEY_DRAW_DETECT);
+        if (szDraw) {
+            pVenc->SetDrawDetectEnable(ADAPTER_BOOLSTR2INT(szDraw) ? AX_TRUE : AX_FALSE);
+        }
+    }
+
+    MprJson* pResponseBody = ConstructBaseResponse(RESPONSE_STATUS_OK, 0);
+
+    AX_CHAR szData[64] = {0};
+    sprintf(szData, "{%s: %d, %s: %s}",
+            PARAM_KEY_PREVIEW_CHANNEL, nInnerIndex,
+            PARAM_KEY_DRAW_DETECT, pVenc->IsDrawDetectEnable() ? "true" : "false");
+
+    mprWriteJsonObj(mprGetJsonObj(pResponseBody, PARAM_KEY_DATA), "meta", mprParseJson(szData));
+
+    LOG_M_I(WEB, "resp:%s", mprJsonToString(pResponseBody, MPR_JSON_QUOTES));
+
+    httpSetContentType(conn, "application/json");
+    httpWrite(conn->writeq, mprJsonToString(pResponseBody, MPR_JSON_QUOTES));
+
+    httpSetStatus(conn, 200);
+    httpFinalize(conn);
+}
+
 static void WebNotifier(HttpConn *conn, int event, int arg)
 {
     AX_BOOL bNeedClose = AX_FALSE;
@@ -993,6 +1050,31 @@ static void WSEventsAction(HttpConn* conn)
     httpSetConnNotifier(conn, WebNotifier);
 }
 
+static void WSMetaAction(HttpConn* conn)
+{
+    if (!IsAuthorized(conn, AX_FALSE)) {
+        LOG_M_E(WEB, "Unauthorized, try to login again.");
+        return;
+    }
+
+    AX_U8 nInnerIndex = atoi(httpGetParam(conn, PARAM_KEY_PREVIEW_CHANNEL, "0"));
+    AX_U8 nUniChn = GetChannelID(nInnerIndex, E_END_POINT_VENC);
+
+    // AX_U16 LOW_BYTE: Sensor ID; HIGH_BYTE: Channel ID
+    AX_U16 nChnID = (0x0/*sensor id*/ | (((WS_META_CHANNEL_BASE + nUniChn) & 0x00FF) << 8));
+
+    MprBuf *buf = mprCreateBuf(32, 0);
+    mprAddRoot(buf);
+    mprPutUint16ToBuf(buf, nChnID);
+    mprRemoveRoot(buf);
+
+    httpSetWebSocketData(conn, buf);
+    LOG_M(WEB, "[%d] meta connected: %p", nInnerIndex, conn);
+
+    mprAddItem(g_pClients, conn);
+    httpSetConnNotifier(conn, WebNotifier);
+}
+
 typedef struct _HTTP_ACTION_INFO {
     cchar*     name;
     HttpAction action;
@@ -1005,6 +1087,7 @@ const HTTP_ACTION_INFO g_httpActionInfo[] = {
     {"/action/preview/faceinfo", FaceinfoAction},
     {"/action/preview/snapshot", SnapshotAction},
     {"/action/preview/assist",   AssistInfoAction},
+    {"/action/preview/meta",     MetaInfoAction},
     {"/action/setting/system",   SystemAction},
     {"/action/setting/camera",   CameraAction},
     {"/action/setting/video",    VideoAction},
@@ -1014,6 +1097,7 @@ const HTTP_ACTION_INFO g_httpActionInfo[] = {
     {"/capture_0",               WSCaptureAction_0},
     {"/capture_1",               WSCaptureAction_1},
     {"/events",                  WSEventsAction},
+    {"/meta",                    WSMetaAction},
 };
 
 CWebServer::CWebServer(void)
@@ -1081,6 +1165,16 @@ AX_VOID CWebServer::Init(const AX_VIN_CHN_ATTR_T& tAttr)
                 sprintf(szName, "SNAPSHOT_CH%d", WS_SNAPSHOT_CHANNEL);
                 break;
             }
+            case E_WS_CHANNEL_TYPE_META: {
+                AX_U8 nVencChn = index - WS_META_CHANNEL_BASE;
+                channelData.nInnerIndex = g_tEPOptions[nVencChn].nInnerIndex;
+                if (E_END_POINT_VENC == g_tEPOptions[nVencChn].eEPType) {
+                    nElementCount = AX_WEB_VENC_RING_BUFF_COUNT;
+                    nElementBuffSize = DETECT_META_MAX_SIZE;
+                }
+                sprintf(szName, "META_CH%d", channelData.nInnerIndex);
+                break;
+            }
             default: {
                 LOG_M_E(WEB, "Not recognized channel type: %d", eType);
                 break;
@@ -1385,10 +1479,10 @@ AX_VOID CWebServer::SendSnapshotData(AX_U8 nStreamID, AX_VOID* data, AX_U32 size
     }
 }
 
-AX_VOID CWebServer::SendEventsData(WEB_EVENTS_DATA_T* data)
+AX_U32 CWebServer::SendEventsData(WEB_EVENTS_DATA_T* data)
 {
     if (!m_bServerStarted) {
-        return;
+        return 0;
     }
 
     {
@@ -1396,7 +1490,7 @@ AX_VOID CWebServer::SendEventsData(WEB_EVENTS_DATA_T* data)
         std::lock_guard<std::mutex> guard(m_mtxConnStatus);
         AX_BOOL bConnect = m_arrConnStatus[WS_EVENTS_CHANNEL];
         if (!bConnect) {
-            return;
+            return 0;
         }
     }
 
@@ -1405,6 +1499,40 @@ AX_VOID CWebServer::SendEventsData(WEB_EVENTS_DATA_T* data)
 
     CAXRingElement ele((AX_U8*)strEventsJson.c_str(), strEventsJson.length(), nChnnelID);
     m_arrChannelData[WS_EVENTS_CHANNEL].pRingBuffer->Put(ele);
+
+    return strEventsJson.length();
+}
+
+AX_BOOL CWebServer::IsMetaConnected(AX_U8 nStreamID)
+{
+    if (!m_bServerStarted || nStreamID >= MAX_VENC_CHANNEL_NUM) {
+        return AX_FALSE;
+    }
+
+    std::lock_guard<std::mutex> guard(m_mtxConnStatus);
+    return m_arrConnStatus[WS_META_CHANNEL_BASE + nStreamID];
+}
+
+AX_VOID CWebServer::SendMetaData(AX_U8 nStreamID, const DETECT_RESULT_T& tResult, AX_U64 nPts)
+{
+    if (!IsMetaConnected(nStreamID)) {
+        return;
+    }
+
+    ChannelData& channelData = m_arrChannelData[WS_META_CHANNEL_BASE + nStreamID];
+    if (!channelData.pRingBuffer) {
+        return;
+    }
+
+    AX_U8 szMeta[DETECT_META_MAX_SIZE];
+    AX_U32 nSize = CDetectMetaPacker::Pack(tResult, channelData.nInnerIndex, nPts, szMeta, sizeof(szMeta));
+    if (0 == nSize) {
+        LOG_M_W(WEB, "[%d] pack detection meta failed.", nStreamID);
+        return;
+    }
+
+    CAXRingElement ele(szMeta, nSize, channelData.nInnerIndex, nPts);
+    channelData.pRingBuffer->Put(ele);
 }
 
 AX_BOOL CWebServer::IsJencChannel(AX_U8 nStreamID)
@@ -1416,7 +1544,9 @@ AX_BOOL CWebServer::IsJencChannel(AX_U8 nStreamID)
 
 WS_CHANNEL_TYPE_E CWebServer::GetChnType(AX_U8 nStreamID)
 {
-    if (WS_EVENTS_CHANNEL == nStreamID) {
+    if (nStreamID >= WS_META_CHANNEL_BASE && nStreamID < MAX_WS_CONN_NUM) {
+        return E_WS_CHANNEL_TYPE_META;
+    } else if (WS_EVENTS_CHANNEL == nStreamID) {
         return E_WS_CHANNEL_TYPE_EVENTS;
     } else if (WS_SNAPSHOT_CHANNEL == nStreamID) {
         return E_WS_CHANNEL_TYPE_SNAPSHOT;
@@ -1436,7 +1566,14 @@ std::string CWebServer::FormatEventsJson(WEB_EVENTS_DATA_T* pEvent)
     AX_CHAR szEventJson[MAX_EVENTS_CHN_SIZE] = {0};
     AX_CHAR szDate[64] = {0};
     CTimeUtils::GetCurrTimeStr(szDate);
-    if (E_WEB_EVENTS_TYPE_MD == pEvent->eType) {
+    if (E_WEB_EVENTS_STATE_NONE != pEvent->eState) {
+        /* MD/OD/SCD by CEventAggregator */
+        static const AX_CHAR *arrState[] = {"", "start", "ongoing", "end"};
+        snprintf(szEventJson, MAX_EVENTS_CHN_SIZE,
+                 "{\"events\": [{\"type\": %d, \"date\": \"%s\", \"info\": \"%s\", \"state\": \"%s\", \"area\": %d, \"count\": %d, \"duration\": %d}]}",
+                 pEvent->eType, szDate, pEvent->tMD.szDisplay, arrState[pEvent->eState], pEvent->tMD.nAreaID, pEvent->nCount,
+                 pEvent->nDuration);
+    } else if (E_WEB_EVENTS_TYPE_MD == pEvent->eType) {
         snprintf(szEventJson, MAX_EVENTS_CHN_SIZE, "{\"events\": [{\"type\": %d, \"date\": \"%s\", \"info\": \"%s\"}]}", pEvent->eType, szDate, pEvent->tMD.szDisplay);
     } else if (E_WEB_EVENTS_TYPE_OD == pEvent->eType) {
         snprintf(szEventJson, MAX_EVENTS_CHN_SIZE, "{\"events\": [{\"type\": %d, \"date\": \"%s\", \"info\": \"%s\"}]}", pEvent->eType, szDate, pEvent->tOD.szDisplay);
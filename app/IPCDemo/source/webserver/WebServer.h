@@ -13,13 +13,15 @@
 
 #include "global.h"
 #include "AXRingBuffer.h"
+#include "OptionHelper.h"
 #include <thread>
 #include <mutex>
 
-/* One stream to dispatch OD/MD events, one stream to capture snapshot */
-#define MAX_WS_CONN_NUM  (MAX_VENC_CHANNEL_NUM + 2)
+/* One stream to dispatch OD/MD events, one stream to capture snapshot, one detection meta stream per venc channel */
+#define MAX_WS_CONN_NUM  (MAX_VENC_CHANNEL_NUM * 2 + 2)
 #define WS_EVENTS_CHANNEL (MAX_VENC_CHANNEL_NUM)
 #define WS_SNAPSHOT_CHANNEL (MAX_VENC_CHANNEL_NUM + 1)
+#define WS_META_CHANNEL_BASE (MAX_VENC_CHANNEL_NUM + 2)
 
 #define MAX_EVENTS_CHN_SIZE 256
 
@@ -28,6 +30,7 @@ typedef enum _WS_CHANNEL_TYPE_E{
     E_WS_CHANNEL_TYPE_JENC,
     E_WS_CHANNEL_TYPE_EVENTS,
     E_WS_CHANNEL_TYPE_SNAPSHOT,
+    E_WS_CHANNEL_TYPE_META,
     E_WS_CHANNEL_TYPE_MAX
 } WS_CHANNEL_TYPE_E;
 
@@ -39,6 +42,14 @@ typedef enum _WEB_EVENTS_TYPE_E {
     E_WEB_EVENTS_TYPE_MAX
 } WEB_EVENTS_TYPE_E;
 
+/* NONE: single event, others are raised by CEventAggregator */
+typedef enum _WEB_EVENTS_STATE_E {
+    E_WEB_EVENTS_STATE_NONE = 0,
+    E_WEB_EVENTS_STATE_START,
+    E_WEB_EVENTS_STATE_ONGOING,
+    E_WEB_EVENTS_STATE_END
+} WEB_EVENTS_STATE_E;
+
 typedef struct _AI_EVENTS_MD_INFO_T {
     AX_CHAR szDisplay[64];
     AX_U32 nAreaID;
@@ -73,6 +84,9 @@ typedef struct _WEB_EVENTS_DATA {
     WEB_EVENTS_TYPE_E eType;
     AX_U64 nTime;
     AX_U32 nReserved;
+    WEB_EVENTS_STATE_E eState;
+    AX_U32 nCount;    // triggered frames since start
+    AX_U32 nDuration; // ms since start
     union {
         AI_EVENTS_MD_INFO_T tMD;
         AI_EVENTS_OD_INFO_T tOD;
@@ -156,7 +170,9 @@ public:
     AX_VOID SendCaptureData(AX_U8 nStreamID, AX_VOID* data, AX_U32 size, AX_U64 nPts=0, AX_BOOL bIFrame=AX_TRUE,
                             JpegDataInfo* pJpegInfo = nullptr);
     AX_VOID SendSnapshotData(AX_U8 nStreamID, AX_VOID* data, AX_U32 size);
-    AX_VOID SendEventsData(WEB_EVENTS_DATA_T* data);
+    AX_U32 SendEventsData(WEB_EVENTS_DATA_T* data);
+    AX_VOID SendMetaData(AX_U8 nStreamID, const DETECT_RESULT_T& tResult, AX_U64 nPts);
+    AX_BOOL IsMetaConnected(AX_U8 nStreamID);
     AX_BOOL IsJencChannel(AX_U8 nStreamID);
 
     // AX_BOOL DispatchAIEvent(AX_U8 nEventType, AX_VOID* data);
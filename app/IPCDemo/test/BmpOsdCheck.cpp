@@ -0,0 +1,205 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+
+/**
+ * Host check: CBmpOSD timestamps drawn by spans of the shared CBmpFontAtlas.
+ * - FillString to NV12 and I420 images from 704x576 to 4K, at the CStage::DrawTimeRect scale and
+ *   at scale 1, placed at the corner, mid image and pushed past the right/bottom edges, against
+ *   the point path it replaced: every set font bit an nScale x nScale block of white written
+ *   pixel by pixel as CYuvHandler::DrawPoint does, clipped to the image.
+ * - ms per timestamp of both at 1080p (x6) and 4K (x12), the BMP_OSD_BENCH numbers; the spans
+ *   must be at least CHECK_MIN_SPEEDUP times faster.
+ * The 1-bit font (17 random symbols of 24x32, as res/font.bmp is laid out) is written to the
+ * current directory.
+ *
+ * cd app/IPCDemo/test
+ * g++ -std=c++11 -O2 -I../source -I../source/include -I../source/utils -I../source/components -I../source/tracker/FDSSTTracker \
+ *     -I../../../msp/out/include -I../../../msp/out/include/ai_kit $(pkg-config --cflags opencv4) BmpOsdCheck.cpp \
+ *     ../source/components/BmpOSD.cpp ../source/components/BmpFontAtlas.cpp ../source/components/YuvHandler.cpp \
+ *     -o BmpOsdCheck -lpthread && ./BmpOsdCheck
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "BmpFontAtlas.h"
+#include "BmpOSD.h"
+
+#define CHECK_FONT_FILE "bmp_osd_check.bmp"
+#define CHECK_SYMBOL_W (24)
+#define CHECK_SYMBOL_H (32)
+#define CHECK_TEXT "2022-12-31 23:59:59"
+#define CHECK_MIN_SPEEDUP (2.0f)
+
+AX_VOID APP_Log(AX_U32, const char *, ...) {
+}
+
+namespace {
+AX_VOID WriteFont(AX_VOID) {
+    const AX_U32 nW = BMP_FONT_SYMBOL_NUM * CHECK_SYMBOL_W;
+    const AX_U32 nRowBytes = ((nW + 7) / 8 + 3) / 4 * 4;
+    const AX_U32 nBits = nRowBytes * CHECK_SYMBOL_H;
+    const AX_U32 nOffset = 14 + 40 + 8;
+
+    std::vector<AX_U8> vecFile(nOffset + nBits, 0);
+    AX_U8 *p = vecFile.data();
+    auto put16 = [](AX_U8 *d, AX_U16 v) { memcpy(d, &v, 2); };
+    auto put32 = [](AX_U8 *d, AX_U32 v) { memcpy(d, &v, 4); };
+    put16(p, 0x4D42);
+    put32(p + 2, vecFile.size());
+    put32(p + 10, nOffset);
+    put32(p + 14, 40);
+    put32(p + 18, nW);
+    put32(p + 22, CHECK_SYMBOL_H);
+    put16(p + 26, 1);
+    put16(p + 28, 1);
+    put32(p + 34, nBits);
+    put32(p + 46, 2);
+    put32(p + 58, 0x00FFFFFF);
+
+    srand(5);
+    for (AX_U32 i = 0; i < nBits; i++) {
+        p[nOffset + i] = (rand() % 10 < 8) ? (AX_U8)rand() : 0;
+    }
+
+    FILE *fp = fopen(CHECK_FONT_FILE, "wb");
+    fwrite(p, 1, vecFile.size(), fp);
+    fclose(fp);
+}
+
+/* FONT_MAP of BmpOSD.cpp */
+AX_U32 SymbolIndex(AX_CHAR c) {
+    const AX_CHAR *pSymbols = " -0123456789:FHPV";
+    const AX_CHAR *pFound = strchr(pSymbols, c);
+    return (pFound && c) ? (AX_U32)(pFound - pSymbols) : 0;
+}
+
+AX_VOID PlainPoint(AX_U8 *pImg, AX_IMG_FORMAT_E eType, AX_S32 nW, AX_S32 nH, AX_S32 x, AX_S32 y) {
+    if (x < 0 || y < 0 || x >= nW || y >= nH) {
+        return;
+    }
+
+    pImg[y * nW + x] = 0xFF;
+    if (AX_YUV420_PLANAR == eType) {
+        AX_U8 *pU = pImg + nW * nH;
+        pU[(y / 2) * (nW / 2) + x / 2] = 0x80;
+        pU[nW * nH / 4 + (y / 2) * (nW / 2) + x / 2] = 0x80;
+    }
+}
+
+/* the FillString point path with the colour passed as colour */
+AX_VOID PlainFillString(const AX_CHAR *pText, AX_S32 x, AX_S32 y, AX_U8 *pImg, AX_IMG_FORMAT_E eType, AX_S32 nW, AX_S32 nH, AX_U8 nScale) {
+    CBmpFontAtlas *pAtlas = CBmpFontAtlas::GetInstance();
+    const AX_U8 *pFont = pAtlas->GetBits();
+    const AX_S32 nLen = strlen(pText);
+    const AX_S32 nSymbolBytes = (pAtlas->GetWidth() / BMP_FONT_SYMBOL_NUM + 7) / 8;
+    const AX_S32 nFontBytes = ((pAtlas->GetWidth() + 7) / 8 + 3) / 4 * 4;
+    const AX_S32 nRows = pAtlas->GetHeight();
+
+    x = (x + nSymbolBytes * nLen * 8 > nW) ? nW - nSymbolBytes * nLen * 8 : x;
+    y = (y + nRows > nH) ? nH - nRows : y;
+    x = (x < 0) ? 0 : x;
+    y = (y < 0) ? 0 : y;
+
+    for (AX_S32 i = 0; i < nLen; i++) {
+        const AX_U8 *pSrc = pFont + SymbolIndex(pText[i]) * nSymbolBytes;
+        for (AX_S32 j = 0; j < nRows; j++) {
+            for (AX_S32 k = 0; k < nSymbolBytes * 8; k++) {
+                if (0 == ((pSrc[j * nFontBytes + k / 8] >> (k % 8)) & 1)) {
+                    continue;
+                }
+                AX_S32 px = (x + i * nSymbolBytes * 8 + k) * nScale;
+                AX_S32 py = (y + j) * nScale;
+                for (AX_S32 r = 0; r < nScale; r++) {
+                    for (AX_S32 c = 0; c < nScale; c++) {
+                        PlainPoint(pImg, eType, nW, nH, px + c, py + r);
+                    }
+                }
+            }
+        }
+    }
+}
+
+AX_U32 CheckOutput(CBmpOSD &tOsd) {
+    const struct {
+        AX_S32 nW;
+        AX_S32 nH;
+        AX_S16 x;
+        AX_S16 y;
+    } arrCases[] = {{1920, 1080, 4, 4}, {3840, 2160, 4, 4}, {1280, 720, 300, 10}, {704, 576, 4, 200}, {1920, 1080, 500, 500}, {704, 576, 600, 560}};
+
+    AX_U32 nBad = 0;
+    for (AX_IMG_FORMAT_E eType : {AX_YUV420_SEMIPLANAR, AX_YUV420_PLANAR}) {
+        for (auto &tCase : arrCases) {
+            const AX_U8 nScale = (tCase.nW + 720) / 720 * 2;
+            const size_t nSize = (size_t)tCase.nW * tCase.nH * 3 / 2;
+            std::vector<AX_U8> vecOut(nSize, 0x10);
+            std::vector<AX_U8> vecRef(nSize, 0x10);
+
+            CYuvHandler tYuv(vecOut.data(), tCase.nW, tCase.nH, eType);
+            tOsd.FillString(CHECK_TEXT, tCase.x, tCase.y, &tYuv, tCase.nW, tCase.nH, nScale);
+            tOsd.FillString("FHPV: -0", tCase.x, tCase.y + 40, &tYuv, tCase.nW, tCase.nH, 1);
+            PlainFillString(CHECK_TEXT, tCase.x, tCase.y, vecRef.data(), eType, tCase.nW, tCase.nH, nScale);
+            PlainFillString("FHPV: -0", tCase.x, tCase.y + 40, vecRef.data(), eType, tCase.nW, tCase.nH, 1);
+
+            AX_BOOL bSame = (vecOut == vecRef) ? AX_TRUE : AX_FALSE;
+            printf("  %s %4dx%-4d at (%3d, %3d) x%-2d %s\n", (AX_YUV420_PLANAR == eType) ? "I420" : "NV12", tCase.nW, tCase.nH, tCase.x,
+                   tCase.y, nScale, bSame ? "identical" : "differs");
+            nBad += bSame ? 0 : 1;
+        }
+    }
+
+    return nBad;
+}
+
+AX_F64 PlainBenchmark(AX_S32 nW, AX_S32 nH, AX_U32 nLoops) {
+    std::vector<AX_U8> vecImg((size_t)nW * nH * 3 / 2, 0x10);
+    const AX_U8 nScale = (nW + 720) / 720 * 2;
+    auto tStart = std::chrono::steady_clock::now();
+    for (AX_U32 i = 0; i < nLoops; i++) {
+        PlainFillString(CHECK_TEXT, 4, 4, vecImg.data(), AX_YUV420_SEMIPLANAR, nW, nH, nScale);
+    }
+    return std::chrono::duration<AX_F64, std::milli>(std::chrono::steady_clock::now() - tStart).count() / nLoops;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+    WriteFont();
+
+    CBmpOSD tOsd;
+    AX_U16 nW = 0;
+    AX_U16 nH = 0;
+    AX_U32 nSize = 0;
+    if (!tOsd.LoadBmp(CHECK_FONT_FILE, nW, nH, nSize)) {
+        printf("load %s fail\n", CHECK_FONT_FILE);
+        return 1;
+    }
+
+    AX_U32 nBad = 0;
+    printf("spans against the point path\n");
+    nBad += CheckOutput(tOsd);
+
+    for (AX_S32 nWidth : {1920, 3840}) {
+        AX_S32 nHeight = nWidth * 9 / 16;
+        AX_F64 fPoint = PlainBenchmark(nWidth, nHeight, 50);
+        AX_F64 fSpan = tOsd.Benchmark(nWidth, nHeight, 50);
+        printf("%4dx%-4d x%-2d: point path %.3f ms, spans %.3f ms per timestamp\n", nWidth, nHeight, (nWidth + 720) / 720 * 2, fPoint, fSpan);
+        if (fSpan * CHECK_MIN_SPEEDUP > fPoint) {
+            printf("    spans gain less than %.0fx\n", CHECK_MIN_SPEEDUP);
+            nBad++;
+        }
+    }
+
+    remove(CHECK_FONT_FILE);
+    printf("%u failures\n", nBad);
+
+    return nBad ? 1 : 0;
+}
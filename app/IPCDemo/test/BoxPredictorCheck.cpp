@@ -0,0 +1,199 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+
+/**
+ * Host check: CBoxPredictor overlay error at a reduced NPU rate.
+ * 1920x1080 at 30 fps, 600 frames of walking, turning, braking and crossing objects, +-2 px detection jitter.
+ * A result is published one video frame after the frame it was detected on and is drawn until the next one.
+ * For each NPU rate the mean centre error and IoU of the drawn box against the true box are reported,
+ * stale (as drawn before the predictor) and extrapolated to the encoded frame PTS.
+ * Passes if the extrapolated boxes at half the NPU rate are no worse than the stale boxes at the full rate.
+ *
+ * cd app/IPCDemo/test
+ * g++ -std=c++11 -O2 -I../source -I../source/include -I../source/utils -I../source/detector -I../../../msp/out/include \
+ *     BoxPredictorCheck.cpp ../source/detector/BoxPredictor.cpp -o BoxPredictorCheck && ./BoxPredictorCheck
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include "BoxPredictor.h"
+
+#define CHECK_WIDTH (1920.0f)
+#define CHECK_HEIGHT (1080.0f)
+#define CHECK_FPS (30)
+#define CHECK_FRAMES (600)
+#define CHECK_JITTER (2) // px
+#define CHECK_LATENCY (1) // video frames from detection to publish
+
+namespace {
+typedef struct {
+    AX_F32 fX, fY, fW, fH; // px
+} BOX_T;
+
+typedef struct {
+    const AX_CHAR *pName;
+    AX_U64 u64TrackId;
+    BOX_T (*Path)(AX_F32 t); // t in seconds
+} OBJECT_T;
+
+typedef struct {
+    AX_F64 fCentre;
+    AX_F64 fIoU;
+} ERROR_T;
+
+BOX_T Walk(AX_F32 t) {
+    return {100 + 90 * t, 500, 64, 160};
+}
+
+BOX_T Turn(AX_F32 t) {
+    return {900 + 300 * cosf(0.6f * t), 400 + 200 * sinf(0.6f * t), 64, 160};
+}
+
+BOX_T Brake(AX_F32 t) {
+    AX_F32 fT = t < 8 ? t : 8;
+    return {1700 - (200 * fT - 12.5f * fT * fT), 300, 48, 128};
+}
+
+BOX_T Car(AX_F32 t) {
+    AX_F32 fX = fmodf(400 * t, 2400) - 320;
+    return {fX, 700, 320, 160};
+}
+
+BOX_T Approach(AX_F32 t) {
+    AX_F32 fS = 1 + 0.15f * t;
+    return {800 - 16 * fS, 200 + 20 * t, 32 * fS, 80 * fS};
+}
+
+const OBJECT_T g_arrObjects[] = {
+    {"walk", 11, Walk}, {"turn", 12, Turn}, {"brake", 13, Brake}, {"car", 14, Car}, {"approach", 15, Approach},
+};
+const AX_U32 g_nObjects = sizeof(g_arrObjects) / sizeof(g_arrObjects[0]);
+
+AX_F32 Jitter() {
+    return (AX_F32)(rand() % (2 * CHECK_JITTER + 1) - CHECK_JITTER);
+}
+
+AX_F64 IoU(const BOX_T &a, const BOX_T &b) {
+    AX_F32 fW = AX_MIN(a.fX + a.fW, b.fX + b.fW) - AX_MAX(a.fX, b.fX);
+    AX_F32 fH = AX_MIN(a.fY + a.fH, b.fY + b.fH) - AX_MAX(a.fY, b.fY);
+    AX_F32 fInter = (fW > 0 && fH > 0) ? fW * fH : 0;
+    return fInter / (a.fW * a.fH + b.fW * b.fH - fInter);
+}
+
+// frames the true box lies fully in the picture, boxes are clamped by the predictor
+AX_BOOL Inside(const BOX_T &t) {
+    return (t.fX >= 0 && t.fY >= 0 && t.fX + t.fW <= CHECK_WIDTH && t.fY + t.fH <= CHECK_HEIGHT) ? AX_TRUE : AX_FALSE;
+}
+
+ERROR_T Run(AX_U32 nNpuInterval, AX_BOOL bPredict) {
+    CBoxPredictor *pPredictor = CBoxPredictor::GetInstance();
+    pPredictor->Update(nullptr, 0);
+    srand(7);
+
+    std::vector<AI_Detection_BodyResult_t> vecBodys(g_nObjects);
+    AI_Detection_Result_t tNpu;
+    DETECT_RESULT_T tPublished;
+    AX_BOOL bPending = AX_FALSE;
+    AX_U32 nPublishAt = 0;
+    AX_U64 u64DetectPts = 0;
+    DETECT_RESULT_T tDetected;
+
+    ERROR_T tErr = {0, 0};
+    AX_U32 nSamples = 0;
+
+    for (AX_U32 f = 0; f < CHECK_FRAMES; f++) {
+        AX_U64 u64Pts = (AX_U64)f * 1000000 / CHECK_FPS;
+        AX_F32 t = (AX_F32)f / CHECK_FPS;
+
+        if (bPending && f >= nPublishAt) {
+            tPublished = tDetected;
+            for (AX_U32 i = 0; i < tDetected.nBodySize; i++) {
+                vecBodys[i] = tDetected.tBodys[i];
+            }
+            tNpu.pBodys = vecBodys.data();
+            tNpu.nBodySize = tDetected.nBodySize;
+            pPredictor->Update(&tNpu, u64DetectPts);
+            bPending = AX_FALSE;
+        }
+
+        if (0 == f % nNpuInterval) {
+            tDetected.Clear();
+            for (AX_U32 i = 0; i < g_nObjects; i++) {
+                BOX_T tBox = g_arrObjects[i].Path(t);
+                if (!Inside(tBox)) {
+                    continue;
+                }
+                AI_Detection_BodyResult_t &tBody = tDetected.tBodys[tDetected.nBodySize++];
+                tBody.u64TrackId = g_arrObjects[i].u64TrackId;
+                tBody.tBox.fX = (tBox.fX + Jitter()) / CHECK_WIDTH;
+                tBody.tBox.fY = (tBox.fY + Jitter()) / CHECK_HEIGHT;
+                tBody.tBox.fW = (tBox.fW + Jitter()) / CHECK_WIDTH;
+                tBody.tBox.fH = (tBox.fH + Jitter()) / CHECK_HEIGHT;
+            }
+            bPending = AX_TRUE;
+            nPublishAt = f + CHECK_LATENCY;
+            u64DetectPts = u64Pts;
+        }
+
+        DETECT_RESULT_T tDrawn = tPublished;
+        if (bPredict) {
+            pPredictor->Predict(tDrawn, u64Pts);
+        }
+
+        for (AX_U32 i = 0; i < tDrawn.nBodySize; i++) {
+            const AI_Detection_BodyResult_t &tBody = tDrawn.tBodys[i];
+            BOX_T tTruth = g_arrObjects[tBody.u64TrackId - g_arrObjects[0].u64TrackId].Path(t);
+            if (!Inside(tTruth)) {
+                continue;
+            }
+            BOX_T tBox = {tBody.tBox.fX * CHECK_WIDTH, tBody.tBox.fY * CHECK_HEIGHT, tBody.tBox.fW * CHECK_WIDTH,
+                          tBody.tBox.fH * CHECK_HEIGHT};
+            tErr.fCentre += hypotf(tBox.fX + tBox.fW / 2 - tTruth.fX - tTruth.fW / 2, tBox.fY + tBox.fH / 2 - tTruth.fY - tTruth.fH / 2);
+            tErr.fIoU += IoU(tBox, tTruth);
+            nSamples++;
+        }
+    }
+
+    if (0 == nSamples) {
+        tErr.fCentre = CHECK_WIDTH;
+        return tErr;
+    }
+
+    tErr.fCentre /= nSamples;
+    tErr.fIoU /= nSamples;
+    return tErr;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+    AX_U32 nBad = 0;
+
+    printf("npu fps   stale centre/IoU      predicted centre/IoU\n");
+    for (AX_U32 nInterval = 1; nInterval <= 8; nInterval *= 2) {
+        ERROR_T tStale = Run(nInterval, AX_FALSE);
+        ERROR_T tPredicted = Run(nInterval, AX_TRUE);
+        printf("%7.2f   %6.1f px  %.3f      %6.1f px  %.3f\n", (AX_F32)CHECK_FPS / nInterval, tStale.fCentre, tStale.fIoU,
+               tPredicted.fCentre, tPredicted.fIoU);
+
+        if (nInterval > 1) {
+            ERROR_T tFull = Run(nInterval / 2, AX_FALSE);
+            if (tPredicted.fCentre > tFull.fCentre || tPredicted.fIoU < tFull.fIoU) {
+                printf("  predicted boxes at %.2f fps are worse than stale boxes at %.2f fps\n", (AX_F32)CHECK_FPS / nInterval,
+                       (AX_F32)CHECK_FPS * 2 / nInterval);
+                nBad++;
+            }
+        }
+    }
+
+    printf("%u failures\n", nBad);
+
+    return nBad ? 1 : 0;
+}
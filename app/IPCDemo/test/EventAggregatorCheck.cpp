@@ -0,0 +1,222 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+
+/**
+ * Host check: CEventAggregator event rate and sink isolation, with default [EVENT] settings.
+ * 1. Simulated clock: N MD areas at 25 fps for 60 s, each triggering on a random share of frames,
+ *    driven through Trigger(tEvent, nNow) and Poll(nNow) as the detectors and the aggregator thread
+ *    would. Reports per frame / rising edge (before the aggregator) against aggregated events and
+ *    bytes per second from GetStat. Every sink must stay within rate + burst, every start must get
+ *    its end and only ongoing events may be coalesced or dropped.
+ * 2. Real clock with the aggregator thread: the web sink takes CHECK_SLOW_SINK_MS per event, a
+ *    detector triggering a new area every frame must never wait for it longer than CHECK_MAX_TRIGGER_MS.
+ * The sinks are stubs that never touch their object: the web one counts the bytes of the JSON CWebServer formats, the RTSP
+ * one formats the ONVIF metadata as AXRtspServer does. global.h pulls in the tracker, so OpenCV
+ * headers are needed to compile.
+ *
+ * cd app/IPCDemo/test
+ * g++ -std=c++11 -O2 -I../source -I../source/include -I../source/utils -I../source/detector -I../source/webserver -I../source/osd \
+ *     -I../source/rtsp -I../source/tracker/FDSSTTracker -I../../../msp/out/include -I../../../msp/out/include/ai_kit \
+ *     $(pkg-config --cflags opencv4) EventAggregatorCheck.cpp ../source/detector/EventAggregator.cpp \
+ *     ../source/rtsp/AXOnvifMeta.cpp ../source/utils/TimeUtil.cpp ../source/utils/inifile.cpp \
+ *     -o EventAggregatorCheck -lpthread && ./EventAggregatorCheck
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "AXOnvifMeta.h"
+#include "EventAggregator.h"
+
+#define CHECK_FPS (25)
+#define CHECK_SECONDS (60)
+#define CHECK_SLOW_SINK_MS (50)
+#define CHECK_MAX_TRIGGER_MS (5.0)
+
+AX_VOID APP_Log(AX_U32, const char *, ...) {
+}
+
+namespace {
+AX_U32 g_arrWebStates[E_WEB_EVENTS_STATE_END + 1] = {0};
+std::atomic<AX_BOOL> g_bSlowSink{AX_FALSE};
+
+/* length of the event JSON of CWebServer::FormatEventsJson */
+AX_U32 JsonLen(const WEB_EVENTS_DATA_T &tEvent) {
+    const AX_CHAR *arrState[] = {"", "start", "ongoing", "end"};
+    AX_CHAR szJson[256];
+    if (E_WEB_EVENTS_STATE_NONE == tEvent.eState) {
+        return snprintf(szJson, sizeof(szJson), "{\"events\": [{\"type\": %d, \"date\": \"2022-01-01 12:00:00\", \"info\": \"%s\"}]}",
+                        tEvent.eType, tEvent.tMD.szDisplay);
+    }
+
+    return snprintf(szJson, sizeof(szJson),
+                    "{\"events\": [{\"type\": %d, \"date\": \"2022-01-01 12:00:00\", \"info\": \"%s\", \"state\": \"%s\", \"area\": %d, "
+                    "\"count\": %d, \"duration\": %d}]}",
+                    tEvent.eType, tEvent.tMD.szDisplay, arrState[tEvent.eState], tEvent.tMD.nAreaID, tEvent.nCount, tEvent.nDuration);
+}
+
+AX_U32 OnvifLen(const WEB_EVENTS_DATA_T &tEvent) {
+    AX_CHAR szMeta[1024];
+    struct timeval tv = {0, 0};
+    return AXOnvifMeta::FormatEvent(tEvent, tv, szMeta, sizeof(szMeta));
+}
+} // namespace
+
+AX_U32 CWebServer::SendEventsData(WEB_EVENTS_DATA_T *pEvent) {
+    if (g_bSlowSink) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(CHECK_SLOW_SINK_MS));
+    }
+    g_arrWebStates[pEvent->eState]++;
+    return JsonLen(*pEvent);
+}
+
+AX_U32 AXRtspServer::SendEvent(const WEB_EVENTS_DATA_T &tEvent) {
+    return OnvifLen(tEvent);
+}
+
+namespace {
+WEB_EVENTS_DATA_T MdEvent(AX_U32 nAreaId) {
+    WEB_EVENTS_DATA_T tEvent;
+    tEvent.eType = E_WEB_EVENTS_TYPE_MD;
+    tEvent.tMD.nAreaID = nAreaId;
+    snprintf(tEvent.tMD.szDisplay, sizeof(tEvent.tMD.szDisplay), "MD area %d", nAreaId);
+    return tEvent;
+}
+
+EVENT_AGGR_STAT_T Delta(const EVENT_AGGR_STAT_T &a, const EVENT_AGGR_STAT_T &b) {
+    return {a.nTriggers - b.nTriggers, a.nEvents - b.nEvents, a.nSent - b.nSent,
+            a.nBytes - b.nBytes,       a.nCoalesced - b.nCoalesced, a.nDropped - b.nDropped};
+}
+
+AX_U32 Simulate(AX_U32 nAreas, AX_F64 fMotion) {
+    CEventAggregator *pAggr = CEventAggregator::GetInstance();
+    EVENT_AGGR_CONFIG_T tConfig;
+    EVENT_AGGR_STAT_T arrBase[E_EVENT_AGGR_SINK_MAX];
+    for (AX_U32 i = 0; i < E_EVENT_AGGR_SINK_MAX; i++) {
+        arrBase[i] = pAggr->GetStat((EVENT_AGGR_SINK_E)i);
+    }
+    memset(g_arrWebStates, 0, sizeof(g_arrWebStates));
+
+    srand(nAreas);
+    const AX_U64 nBase = 1000000;
+    AX_U64 nPerFrame = 0;
+    AX_U64 nPerFrameBytes = 0;
+    AX_U64 nEdge = 0;
+    AX_U64 nEdgeBytes = 0;
+    AX_U64 nEdgeOnvifBytes = 0;
+    std::vector<AX_BOOL> vecLast(nAreas, AX_FALSE);
+    for (AX_U32 f = 0; f < CHECK_FPS * CHECK_SECONDS; f++) {
+        AX_U64 nNow = nBase + f * 1000 / CHECK_FPS;
+        for (AX_U32 i = 0; i < nAreas; i++) {
+            AX_BOOL bMotion = ((rand() % 1000) < fMotion * 1000) ? AX_TRUE : AX_FALSE;
+            if (bMotion) {
+                WEB_EVENTS_DATA_T tEvent = MdEvent(i);
+                nPerFrame++;
+                nPerFrameBytes += JsonLen(tEvent);
+                if (!vecLast[i]) {
+                    nEdge++;
+                    nEdgeBytes += JsonLen(tEvent);
+                    nEdgeOnvifBytes += OnvifLen(tEvent);
+                }
+                pAggr->Trigger(tEvent, nNow);
+            }
+            vecLast[i] = bMotion;
+        }
+
+        // the aggregator thread polls every 100 ms
+        if (0 == f % (CHECK_FPS / 10)) {
+            pAggr->Poll(nNow);
+        }
+    }
+
+    // quiet for 10 s, every area ends and the backlogs drain
+    for (AX_U32 k = 1; k <= 100; k++) {
+        pAggr->Poll(nBase + CHECK_SECONDS * 1000 + k * 100);
+    }
+
+    EVENT_AGGR_STAT_T tWeb = Delta(pAggr->GetStat(E_EVENT_AGGR_SINK_WEB), arrBase[E_EVENT_AGGR_SINK_WEB]);
+    EVENT_AGGR_STAT_T tRtsp = Delta(pAggr->GetStat(E_EVENT_AGGR_SINK_RTSP), arrBase[E_EVENT_AGGR_SINK_RTSP]);
+    const AX_F64 fSeconds = CHECK_SECONDS;
+    printf("%2u areas, motion on %.0f%% of frames\n", nAreas, fMotion * 100);
+    printf("  per frame:   %7.2f ev/s %8.0f B/s\n", nPerFrame / fSeconds, nPerFrameBytes / fSeconds);
+    printf("  rising edge: %7.2f ev/s %8.0f B/s web, %8.0f B/s rtsp\n", nEdge / fSeconds, nEdgeBytes / fSeconds, nEdgeOnvifBytes / fSeconds);
+    printf("  aggregated:  %7.2f ev/s %8.1f B/s web, %8.1f B/s rtsp (start %u, ongoing %u, end %u), coalesced %llu, dropped %llu\n",
+           tWeb.nSent / fSeconds, tWeb.nBytes / fSeconds, tRtsp.nBytes / fSeconds, g_arrWebStates[E_WEB_EVENTS_STATE_START],
+           g_arrWebStates[E_WEB_EVENTS_STATE_ONGOING], g_arrWebStates[E_WEB_EVENTS_STATE_END], (unsigned long long)tWeb.nCoalesced,
+           (unsigned long long)tWeb.nDropped);
+
+    AX_U32 nBad = 0;
+    for (auto &tStat : {tWeb, tRtsp}) {
+        // 10 s of quiet polls added to the budget of the run
+        if (tStat.nSent > (AX_U64)tConfig.nRate * (CHECK_SECONDS + 10) + tConfig.nBurst) {
+            printf("    %llu sent, over rate + burst\n", (unsigned long long)tStat.nSent);
+            nBad++;
+        }
+        if (tStat.nTriggers != nPerFrame) {
+            printf("    %llu triggers counted\n", (unsigned long long)tStat.nTriggers);
+            nBad++;
+        }
+    }
+    if (g_arrWebStates[E_WEB_EVENTS_STATE_START] != g_arrWebStates[E_WEB_EVENTS_STATE_END]
+        || g_arrWebStates[E_WEB_EVENTS_STATE_START] + g_arrWebStates[E_WEB_EVENTS_STATE_ONGOING] + g_arrWebStates[E_WEB_EVENTS_STATE_END]
+               + tWeb.nCoalesced + tWeb.nDropped != tWeb.nEvents) {
+        printf("    start/end lost\n");
+        nBad++;
+    }
+
+    return nBad;
+}
+
+AX_U32 CheckSlowSink(AX_VOID) {
+    CEventAggregator *pAggr = CEventAggregator::GetInstance();
+    pAggr->Start();
+    g_bSlowSink = AX_TRUE;
+
+    // a new area every frame raises a start each time, each one wakes the aggregator thread
+    AX_F64 fMaxMs = 0;
+    for (AX_U32 f = 0; f < CHECK_FPS * 2; f++) {
+        WEB_EVENTS_DATA_T tEvent = MdEvent(1000 + f);
+        auto tStart = std::chrono::steady_clock::now();
+        pAggr->Trigger(tEvent);
+        fMaxMs = std::max(fMaxMs, std::chrono::duration<AX_F64, std::milli>(std::chrono::steady_clock::now() - tStart).count());
+        std::this_thread::sleep_for(std::chrono::milliseconds(1000 / CHECK_FPS));
+    }
+
+    g_bSlowSink = AX_FALSE;
+    pAggr->Stop();
+
+    printf("web sink taking %d ms per event: Trigger max %.3f ms\n", CHECK_SLOW_SINK_MS, fMaxMs);
+    if (fMaxMs > CHECK_MAX_TRIGGER_MS) {
+        printf("    detectors wait for the sink\n");
+        return 1;
+    }
+    return 0;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+    CEventAggregator::GetInstance()->SetWebServer((CWebServer *)1);
+    CEventAggregator::GetInstance()->SetRTSPServer((AXRtspServer *)1);
+
+    AX_U32 nBad = 0;
+    nBad += Simulate(4, 0.8);
+    nBad += Simulate(16, 0.3);
+    nBad += Simulate(16, 0.95);
+    nBad += CheckSlowSink();
+
+    printf("%u failures\n", nBad);
+
+    return nBad ? 1 : 0;
+}
@@ -0,0 +1,154 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+
+/**
+ * Host check: CFeatureIndex float search, top-k against a naive scan and latency versus gallery size.
+ * 128-d random unit features, queries are gallery features plus Gaussian noise, top 5.
+ * Every returned score must match the naive double precision top k at the same rank within 0.01,
+ * and removed rows must never be returned. Search time is the mean over CHECK_LOOPS calls.
+ *
+ * cd app/IPCDemo/test
+ * g++ -std=c++11 -O2 -I../source -I../source/include -I../source/utils -I../source/detector -I../../../msp/out/include \
+ *     FeatureIndexCheck.cpp ../source/detector/FeatureIndex.cpp -o FeatureIndexCheck && ./FeatureIndexCheck
+ */
+#include <math.h>
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "FeatureIndex.h"
+
+#define CHECK_DIM (128)
+#define CHECK_TOP_K (5)
+#define CHECK_MAX_BATCH (8)
+#define CHECK_LOOPS (20)
+#define CHECK_NOISE (0.05f) // per element, unit features have elements around 0.09
+#define CHECK_SCORE_TOLERANCE (0.01f)
+
+namespace {
+typedef struct {
+    AX_U64 nObjectId;
+    AX_F64 fScore;
+} NAIVE_RESULT_T;
+
+std::mt19937 g_tRand(7);
+
+AX_VOID RandomUnit(AX_F32 *pFeature) {
+    std::normal_distribution<AX_F32> tNormal(0.0f, 1.0f);
+    AX_F64 fNorm = 0;
+    for (AX_U32 i = 0; i < CHECK_DIM; i++) {
+        pFeature[i] = tNormal(g_tRand);
+        fNorm += pFeature[i] * pFeature[i];
+    }
+    for (AX_U32 i = 0; i < CHECK_DIM; i++) {
+        pFeature[i] /= (AX_F32)sqrt(fNorm);
+    }
+}
+
+std::vector<NAIVE_RESULT_T> NaiveTopK(const std::vector<AX_F32> &vecGallery, const std::vector<AX_U8> &vecAlive, const AX_F32 *pQuery) {
+    AX_F64 fQueryNorm = 0;
+    for (AX_U32 i = 0; i < CHECK_DIM; i++) {
+        fQueryNorm += (AX_F64)pQuery[i] * pQuery[i];
+    }
+
+    std::vector<NAIVE_RESULT_T> vecAll;
+    for (AX_U32 r = 0; r < vecAlive.size(); r++) {
+        if (!vecAlive[r]) {
+            continue;
+        }
+        AX_F64 fDot = 0;
+        for (AX_U32 i = 0; i < CHECK_DIM; i++) {
+            fDot += (AX_F64)vecGallery[r * CHECK_DIM + i] * pQuery[i];
+        }
+        vecAll.push_back({r + 1, 100.0 * fDot / sqrt(fQueryNorm)});
+    }
+
+    std::partial_sort(vecAll.begin(), vecAll.begin() + CHECK_TOP_K, vecAll.end(),
+                      [](const NAIVE_RESULT_T &a, const NAIVE_RESULT_T &b) { return a.fScore > b.fScore; });
+    vecAll.resize(CHECK_TOP_K);
+    return vecAll;
+}
+
+AX_U32 RunGallery(AX_U32 nGallery) {
+    CFeatureIndex tIndex;
+    std::vector<AX_F32> vecGallery(nGallery * CHECK_DIM);
+    std::vector<AX_U64> vecIds(nGallery);
+    std::vector<std::string> vecKeys(nGallery);
+    std::vector<AX_U8> vecAlive(nGallery, 1);
+    for (AX_U32 r = 0; r < nGallery; r++) {
+        RandomUnit(&vecGallery[r * CHECK_DIM]);
+        vecIds[r] = r + 1;
+        vecKeys[r] = "id" + std::to_string(r + 1);
+    }
+
+    tIndex.Reserve(nGallery, CHECK_DIM * sizeof(AX_F32));
+    if (!tIndex.Insert(nGallery, vecIds.data(), (const AX_U8 *)vecGallery.data(), CHECK_DIM * sizeof(AX_F32), vecKeys.data())) {
+        printf("gallery %u: insert failed\n", nGallery);
+        return 1;
+    }
+
+    // every 10th row is removed, their queries must find other rows
+    for (AX_U32 r = 0; r < nGallery; r += 10) {
+        tIndex.Remove(r + 1);
+        vecAlive[r] = 0;
+    }
+
+    std::normal_distribution<AX_F32> tNoise(0.0f, CHECK_NOISE);
+    std::uniform_int_distribution<AX_U32> tPick(0, nGallery - 1);
+    std::vector<AX_F32> vecQueries(CHECK_MAX_BATCH * CHECK_DIM);
+    for (AX_U32 b = 0; b < CHECK_MAX_BATCH; b++) {
+        AX_U32 r = tPick(g_tRand);
+        for (AX_U32 i = 0; i < CHECK_DIM; i++) {
+            vecQueries[b * CHECK_DIM + i] = vecGallery[r * CHECK_DIM + i] + tNoise(g_tRand);
+        }
+    }
+
+    AX_U32 nBad = 0;
+    std::vector<FEATURE_INDEX_RESULT_T> vecResults(CHECK_MAX_BATCH * CHECK_TOP_K);
+    tIndex.Search((const AX_U8 *)vecQueries.data(), CHECK_DIM * sizeof(AX_F32), CHECK_MAX_BATCH, CHECK_TOP_K, vecResults.data());
+    for (AX_U32 b = 0; b < CHECK_MAX_BATCH; b++) {
+        std::vector<NAIVE_RESULT_T> vecNaive = NaiveTopK(vecGallery, vecAlive, &vecQueries[b * CHECK_DIM]);
+        for (AX_U32 k = 0; k < CHECK_TOP_K; k++) {
+            const FEATURE_INDEX_RESULT_T &tResult = vecResults[b * CHECK_TOP_K + k];
+            if (fabs(tResult.fScore - vecNaive[k].fScore) > CHECK_SCORE_TOLERANCE
+                || (tResult.nObjectId > 0 && !vecAlive[tResult.nObjectId - 1])) {
+                printf("  query %u rank %u: got %llu %.3f, naive %llu %.3f\n", b, k, (unsigned long long)tResult.nObjectId,
+                       tResult.fScore, (unsigned long long)vecNaive[k].nObjectId, vecNaive[k].fScore);
+                nBad++;
+            }
+        }
+    }
+
+    printf("gallery %6u:", nGallery);
+    for (AX_U32 nBatch = 1; nBatch <= CHECK_MAX_BATCH; nBatch *= 8) {
+        auto tStart = std::chrono::steady_clock::now();
+        for (AX_U32 i = 0; i < CHECK_LOOPS; i++) {
+            tIndex.Search((const AX_U8 *)vecQueries.data(), CHECK_DIM * sizeof(AX_F32), nBatch, CHECK_TOP_K, vecResults.data());
+        }
+        AX_F64 fMs = std::chrono::duration<AX_F64, std::milli>(std::chrono::steady_clock::now() - tStart).count() / CHECK_LOOPS;
+        printf("  batch%u %.3f ms", nBatch, fMs);
+    }
+    printf("  (%s)\n", nBad ? "mismatch" : "top-k ok");
+
+    return nBad;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+    AX_U32 nBad = 0;
+    for (AX_U32 nGallery = 1000; nGallery <= 100000; nGallery *= 10) {
+        nBad += RunGallery(nGallery);
+    }
+
+    printf("%u failures\n", nBad);
+
+    return nBad ? 1 : 0;
+}
@@ -0,0 +1,252 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+
+/**
+ * Host check: CFeatureIndex int16/int8 rows with float re-rank.
+ * 1. 100k identities of 128-d N(0,1) features, 1000 queries of a gallery feature plus N(0,2) noise, top 5.
+ *    Reports recall@1, top-1 agreement with float rows, batch 1 scan time and bytes per identity.
+ *    Quantised rows must agree with float rows on CHECK_MIN_AGREE of the queries, lose no more
+ *    than CHECK_MAX_RECALL_LOSS recall and take at most 51% (int16) / 26% (int8) of the float bytes,
+ *    the rest being the row scale.
+ * 2. Re-rank through CFeatureStore::Get with a gallery of CHECK_STORE_GALLERY, a tenth of it deleted
+ *    from the store only: those candidates fail to fetch and must never be returned. Search time is
+ *    reported with and without an enrollment thread appending to the store at the same time.
+ * The store file is created in the current directory.
+ *
+ * cd app/IPCDemo/test
+ * g++ -std=c++11 -O2 -I../source -I../source/include -I../source/utils -I../source/detector -I../../../msp/out/include \
+ *     FeatureIndexQuantCheck.cpp ../source/detector/FeatureIndex.cpp ../source/detector/FeatureStore.cpp \
+ *     -o FeatureIndexQuantCheck -lpthread && ./FeatureIndexQuantCheck
+ */
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "FeatureIndex.h"
+#include "FeatureStore.h"
+
+#define CHECK_GALLERY (100000)
+#define CHECK_DIM (128)
+#define CHECK_QUERIES (1000)
+#define CHECK_SIGMA (2.0f)
+#define CHECK_TOP_K (5)
+#define CHECK_MIN_AGREE (0.99)
+#define CHECK_MAX_RECALL_LOSS (0.005)
+#define CHECK_STORE_GALLERY (2000)
+#define CHECK_DB "feature_index_quant_check.db"
+
+AX_VOID APP_Log(AX_U32, const char *, ...) {
+}
+
+namespace {
+const AX_U32 FEATURE_SIZE = CHECK_DIM * sizeof(AX_F32);
+
+typedef struct {
+    AX_F64 fRecall;
+    AX_F64 fAgree;
+    AX_F64 fScanMs;
+    AX_F64 fBytes;
+} QUANT_RESULT_T;
+
+std::string Key(AX_U64 nObjectId) {
+    return "id" + std::to_string(nObjectId);
+}
+
+QUANT_RESULT_T RunPrecision(FEATURE_INDEX_PRECISION_E ePrecision, AX_BOOL bRerank, const std::vector<AX_F32> &vecGallery,
+                            const std::vector<AX_F32> &vecQueries, const std::vector<AX_U64> &vecTruth, std::vector<AX_U64> &vecFloatTop1) {
+    CFeatureIndex tIndex;
+    tIndex.SetPrecision(ePrecision);
+    if (bRerank) {
+        tIndex.SetFetcher([&](AX_U64 nObjectId, const AX_CHAR *, AX_U8 *pFeature, AX_U32 nSize) {
+            memcpy(pFeature, &vecGallery[nObjectId * CHECK_DIM], nSize);
+            return AX_TRUE;
+        });
+    }
+
+    std::vector<AX_U64> vecIds(CHECK_GALLERY);
+    std::vector<std::string> vecKeys(CHECK_GALLERY);
+    for (AX_U32 i = 0; i < CHECK_GALLERY; i++) {
+        vecIds[i] = i;
+        vecKeys[i] = Key(i);
+    }
+    tIndex.Reserve(CHECK_GALLERY, FEATURE_SIZE);
+    tIndex.Insert(CHECK_GALLERY, vecIds.data(), (const AX_U8 *)vecGallery.data(), FEATURE_SIZE, vecKeys.data());
+
+    QUANT_RESULT_T tResult = {0, 0, 0, 0};
+    FEATURE_INDEX_RESULT_T arrResults[CHECK_TOP_K];
+    for (AX_U32 q = 0; q < CHECK_QUERIES; q++) {
+        auto tStart = std::chrono::steady_clock::now();
+        tIndex.Search((const AX_U8 *)&vecQueries[q * CHECK_DIM], FEATURE_SIZE, 1, CHECK_TOP_K, arrResults);
+        tResult.fScanMs += std::chrono::duration<AX_F64, std::milli>(std::chrono::steady_clock::now() - tStart).count();
+
+        tResult.fRecall += (arrResults[0].nObjectId == vecTruth[q]) ? 1 : 0;
+        if (FEATURE_INDEX_PRECISION_F32 == ePrecision) {
+            vecFloatTop1[q] = arrResults[0].nObjectId;
+        }
+        tResult.fAgree += (arrResults[0].nObjectId == vecFloatTop1[q]) ? 1 : 0;
+    }
+
+    tResult.fRecall /= CHECK_QUERIES;
+    tResult.fAgree /= CHECK_QUERIES;
+    tResult.fScanMs /= CHECK_QUERIES;
+    tResult.fBytes = (AX_F64)tIndex.MemorySize() / CHECK_GALLERY;
+    return tResult;
+}
+
+AX_U32 CheckPrecision(AX_VOID) {
+    std::mt19937 tRand(1);
+    std::normal_distribution<AX_F32> tNormal(0.0f, 1.0f);
+
+    std::vector<AX_F32> vecGallery((size_t)CHECK_GALLERY * CHECK_DIM);
+    for (auto &f : vecGallery) {
+        f = tNormal(tRand);
+    }
+
+    std::vector<AX_F32> vecQueries((size_t)CHECK_QUERIES * CHECK_DIM);
+    std::vector<AX_U64> vecTruth(CHECK_QUERIES);
+    for (AX_U32 q = 0; q < CHECK_QUERIES; q++) {
+        vecTruth[q] = tRand() % CHECK_GALLERY;
+        for (AX_U32 i = 0; i < CHECK_DIM; i++) {
+            vecQueries[q * CHECK_DIM + i] = vecGallery[vecTruth[q] * CHECK_DIM + i] + CHECK_SIGMA * tNormal(tRand);
+        }
+    }
+
+    const struct {
+        const AX_CHAR *pName;
+        FEATURE_INDEX_PRECISION_E ePrecision;
+        AX_BOOL bRerank;
+        AX_F64 fMaxBytesRatio;
+    } arrModes[] = {
+        {"f32", FEATURE_INDEX_PRECISION_F32, AX_FALSE, 1.0},
+        {"s16", FEATURE_INDEX_PRECISION_S16, AX_TRUE, 0.51},
+        {"s8", FEATURE_INDEX_PRECISION_S8, AX_TRUE, 0.26},
+        {"s8 no re-rank", FEATURE_INDEX_PRECISION_S8, AX_FALSE, 0.26},
+    };
+
+    printf("%ux%u-d, sigma %.1f: recall@1 / top-1 agreement with f32 / b1 scan / bytes per identity\n", CHECK_GALLERY, CHECK_DIM,
+           CHECK_SIGMA);
+
+    AX_U32 nBad = 0;
+    std::vector<AX_U64> vecFloatTop1(CHECK_QUERIES);
+    QUANT_RESULT_T tFloat = {0, 0, 0, 0};
+    for (auto &tMode : arrModes) {
+        QUANT_RESULT_T tResult = RunPrecision(tMode.ePrecision, tMode.bRerank, vecGallery, vecQueries, vecTruth, vecFloatTop1);
+        if (FEATURE_INDEX_PRECISION_F32 == tMode.ePrecision) {
+            tFloat = tResult;
+        }
+
+        printf("  %-14s %.3f / %.3f / %.2f ms / %.0f\n", tMode.pName, tResult.fRecall, tResult.fAgree, tResult.fScanMs, tResult.fBytes);
+
+        if (tResult.fBytes > tFloat.fBytes * tMode.fMaxBytesRatio) {
+            printf("    rows take %.0f bytes per identity\n", tResult.fBytes);
+            nBad++;
+        }
+        if (tMode.bRerank && (tResult.fAgree < CHECK_MIN_AGREE || tResult.fRecall < tFloat.fRecall - CHECK_MAX_RECALL_LOSS)) {
+            printf("    re-ranked results drift from float rows\n");
+            nBad++;
+        }
+    }
+
+    return nBad;
+}
+
+AX_U32 CheckStoreRerank(AX_VOID) {
+    unlink(CHECK_DB);
+
+    std::mt19937 tRand(3);
+    std::normal_distribution<AX_F32> tNormal(0.0f, 1.0f);
+    std::vector<AX_F32> vecGallery((size_t)CHECK_STORE_GALLERY * CHECK_DIM);
+    for (auto &f : vecGallery) {
+        f = tNormal(tRand);
+    }
+
+    CFeatureStore tStore;
+    CFeatureIndex tIndex;
+    tStore.Open(CHECK_DB);
+    tIndex.SetPrecision(FEATURE_INDEX_PRECISION_S8);
+    tIndex.SetFetcher([&](AX_U64, const AX_CHAR *szKey, AX_U8 *pFeature, AX_U32 nSize) {
+        return tStore.Get(szKey, pFeature, nSize);
+    });
+
+    for (AX_U64 i = 0; i < CHECK_STORE_GALLERY; i++) {
+        tStore.Put(Key(i), (const AX_U8 *)&vecGallery[i * CHECK_DIM], FEATURE_SIZE);
+        tIndex.Insert(i, (const AX_U8 *)&vecGallery[i * CHECK_DIM], FEATURE_SIZE, Key(i));
+    }
+
+    // gone from the store but still in the index, as during a removal in flight
+    for (AX_U64 i = 0; i < CHECK_STORE_GALLERY; i += 10) {
+        tStore.Delete(Key(i));
+    }
+
+    AX_U32 nBad = 0;
+    AX_U32 nStale = 0;
+    FEATURE_INDEX_RESULT_T arrResults[CHECK_TOP_K];
+    auto Query = [&](AX_U32 nQueries) {
+        std::vector<AX_F64> vecMs;
+        for (AX_U32 q = 0; q < nQueries; q++) {
+            // the query is the deleted identity itself, its quantised score would win
+            AX_U64 nTarget = (q * 10) % CHECK_STORE_GALLERY;
+            auto tStart = std::chrono::steady_clock::now();
+            tIndex.Search((const AX_U8 *)&vecGallery[nTarget * CHECK_DIM], FEATURE_SIZE, 1, CHECK_TOP_K, arrResults);
+            vecMs.push_back(std::chrono::duration<AX_F64, std::milli>(std::chrono::steady_clock::now() - tStart).count());
+            for (auto &tResult : arrResults) {
+                nStale += (tResult.fScore > -100.0f && 0 == tResult.nObjectId % 10) ? 1 : 0;
+            }
+        }
+        std::sort(vecMs.begin(), vecMs.end());
+        printf("  search mean %.3f ms, max %.3f ms", std::accumulate(vecMs.begin(), vecMs.end(), 0.0) / vecMs.size(), vecMs.back());
+    };
+
+    printf("s8 re-rank from CFeatureStore, %u identities, a tenth deleted from the store\n", CHECK_STORE_GALLERY);
+    Query(200);
+    printf(" alone\n");
+
+    std::atomic<AX_BOOL> bStop{AX_FALSE};
+    std::atomic<AX_U32> nPuts{0};
+    std::thread tEnroll([&] {
+        std::vector<AX_F32> vecFeature(CHECK_DIM, 0.1f);
+        while (!bStop) {
+            tStore.Put("enroll" + std::to_string(nPuts % 64), (const AX_U8 *)vecFeature.data(), FEATURE_SIZE);
+            nPuts++;
+        }
+    });
+    Query(200);
+    bStop = AX_TRUE;
+    tEnroll.join();
+    printf(" during %u enrollments\n", (AX_U32)nPuts);
+
+    if (nStale > 0) {
+        printf("    %u results whose feature fetch failed\n", nStale);
+        nBad++;
+    }
+
+    tStore.Close();
+    unlink(CHECK_DB);
+
+    return nBad;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+    AX_U32 nBad = 0;
+    nBad += CheckPrecision();
+    nBad += CheckStoreRerank();
+
+    printf("%u failures\n", nBad);
+
+    return nBad ? 1 : 0;
+}
@@ -0,0 +1,230 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+
+/**
+ * Host check: CFeatureStore recovery and compaction retry.
+ * - a torn tail record and trailing garbage are cut off on open
+ * - a corrupt DEL tombstone mid file fails the open and leaves the file byte for byte as it was
+ * - a file of neither format is refused, a previous format file is migrated and kept as .legacy
+ * - a failing compaction (its .tmp path is a directory) is not retried before another
+ *   FEATURE_STORE_COMPACT_MIN_BYTES of records died, and runs once the path is free again
+ * Files are created in the current directory.
+ *
+ * cd app/IPCDemo/test
+ * g++ -std=c++11 -O2 -I../source -I../source/include -I../source/utils -I../source/detector -I../../../msp/out/include \
+ *     FeatureStoreCheck.cpp ../source/detector/FeatureStore.cpp -o FeatureStoreCheck -lpthread && ./FeatureStoreCheck
+ */
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include "FeatureStore.h"
+
+#define CHECK_DB "feature_store_check.db"
+#define CHECK_FEATURE_SIZE (100)
+
+static std::atomic<AX_U32> g_nCompactFail{0};
+
+AX_VOID APP_Log(AX_U32, const char *pFmt, ...) {
+    if (strstr(pFmt, "compaction retried")) {
+        g_nCompactFail++;
+    }
+}
+
+namespace {
+AX_U32 g_nBad = 0;
+
+#define CHECK(_cond_, _msg_)                     \
+    do {                                         \
+        if (!(_cond_)) {                         \
+            printf("  failed: %s\n", _msg_);     \
+            g_nBad++;                            \
+        }                                        \
+    } while (0)
+
+std::vector<AX_U8> ReadAll(const AX_CHAR *pPath) {
+    std::vector<AX_U8> vec;
+    FILE *fp = fopen(pPath, "rb");
+    if (fp) {
+        AX_U8 buf[4096];
+        size_t n = 0;
+        while ((n = fread(buf, 1, sizeof(buf), fp)) > 0) {
+            vec.insert(vec.end(), buf, buf + n);
+        }
+        fclose(fp);
+    }
+    return vec;
+}
+
+AX_VOID WriteAt(const AX_CHAR *pPath, AX_U64 nOffset, const AX_VOID *pData, AX_U32 nSize) {
+    FILE *fp = fopen(pPath, "r+b");
+    fseek(fp, nOffset, SEEK_SET);
+    fwrite(pData, 1, nSize, fp);
+    fclose(fp);
+}
+
+AX_U64 FileSize(const AX_CHAR *pPath) {
+    struct stat tStat;
+    return (0 == stat(pPath, &tStat)) ? tStat.st_size : 0;
+}
+
+AX_U32 RecordSize(AX_U32 nFeatureSize) {
+    return sizeof(FEATURE_STORE_RECORD_T) + ((nFeatureSize + 3) & ~3);
+}
+
+/* k0..k9, DEL k3, k10 */
+AX_VOID Populate(AX_VOID) {
+    unlink(CHECK_DB);
+    CFeatureStore tStore;
+    tStore.Open(CHECK_DB);
+    std::vector<AX_U8> vecFeature(CHECK_FEATURE_SIZE);
+    for (AX_U32 i = 0; i <= 10; i++) {
+        if (10 == i) {
+            tStore.Delete("k3");
+        }
+        vecFeature[0] = (AX_U8)i;
+        tStore.Put("k" + std::to_string(i), vecFeature.data(), vecFeature.size());
+    }
+}
+
+const AX_U64 DEL_OFFSET = sizeof(FEATURE_STORE_HEAD_T) + 10 * RecordSize(CHECK_FEATURE_SIZE);
+const AX_U64 LAST_OFFSET = DEL_OFFSET + RecordSize(0);
+
+AX_VOID CheckRecover(AX_VOID) {
+    printf("recover\n");
+
+    Populate();
+    const AX_CHAR szTorn[] = "torn";
+    FILE *fp = fopen(CHECK_DB, "ab");
+    fwrite(szTorn, 1, 4, fp);
+    fclose(fp);
+    {
+        CFeatureStore tStore;
+        CHECK(tStore.Open(CHECK_DB), "open with trailing garbage");
+        CHECK(10 == tStore.Size() && !tStore.IsExist("k3") && tStore.IsExist("k10"), "records before the garbage");
+    }
+    CHECK(FileSize(CHECK_DB) == LAST_OFFSET + RecordSize(CHECK_FEATURE_SIZE), "trailing garbage cut off");
+
+    // torn last record
+    Populate();
+    AX_U8 nByte = 0x55;
+    WriteAt(CHECK_DB, LAST_OFFSET + sizeof(FEATURE_STORE_RECORD_T) + 10, &nByte, 1);
+    {
+        CFeatureStore tStore;
+        CHECK(tStore.Open(CHECK_DB), "open with torn tail");
+        CHECK(9 == tStore.Size() && !tStore.IsExist("k3") && !tStore.IsExist("k10"), "records before the torn tail");
+    }
+    CHECK(FileSize(CHECK_DB) == LAST_OFFSET, "torn tail cut off");
+
+    // corrupt tombstone: k3 must not come back
+    Populate();
+    WriteAt(CHECK_DB, DEL_OFFSET + 12, &nByte, 1);
+    std::vector<AX_U8> vecBefore = ReadAll(CHECK_DB);
+    {
+        CFeatureStore tStore;
+        CHECK(!tStore.Open(CHECK_DB), "open with a corrupt DEL mid file refused");
+        CHECK(!tStore.IsExist("k3"), "deleted record not served");
+    }
+    CHECK(ReadAll(CHECK_DB) == vecBefore, "file untouched after refused open");
+
+    // unknown format
+    const AX_CHAR szGarbage[] = "hello world, not a feature store at all.";
+    fp = fopen(CHECK_DB, "wb");
+    fwrite(szGarbage, 1, sizeof(szGarbage), fp);
+    fclose(fp);
+    {
+        CFeatureStore tStore;
+        CHECK(!tStore.Open(CHECK_DB), "unknown format refused");
+    }
+    CHECK(ReadAll(CHECK_DB).size() == sizeof(szGarbage), "unknown format untouched");
+
+    // previous format
+    std::string strLegacy = std::string(CHECK_DB) + ".legacy";
+    unlink(strLegacy.c_str());
+    fp = fopen(CHECK_DB, "wb");
+    for (AX_U32 i = 0; i < 3; i++) {
+        AX_CHAR szInfo[FEATURE_STORE_INFO_SIZE] = {0};
+        snprintf(szInfo, sizeof(szInfo), "old%u", i);
+        AX_U32 nSize = 512;
+        std::vector<AX_U8> vecFeature(nSize, (AX_U8)i);
+        fwrite(szInfo, 1, sizeof(szInfo), fp);
+        fwrite(&nSize, 1, sizeof(nSize), fp);
+        fwrite(vecFeature.data(), 1, nSize, fp);
+    }
+    fclose(fp);
+    {
+        CFeatureStore tStore;
+        CHECK(tStore.Open(CHECK_DB), "previous format migrated");
+        std::vector<AX_U8> vecFeature(512);
+        CHECK(3 == tStore.Size() && tStore.Get("old2", vecFeature.data(), 512) && 2 == vecFeature[511], "migrated records");
+    }
+    CHECK(FileSize(strLegacy.c_str()) == 3 * (FEATURE_STORE_INFO_SIZE + 4 + 512), "original kept as .legacy");
+    unlink(strLegacy.c_str());
+}
+
+/* puts one key over and over, each put kills one record */
+AX_VOID Churn(CFeatureStore &tStore, AX_U32 nCount) {
+    std::vector<AX_U8> vecFeature(CHECK_FEATURE_SIZE);
+    for (AX_U32 i = 0; i < nCount; i++) {
+        vecFeature[0] = (AX_U8)i;
+        tStore.Put("churn", vecFeature.data(), vecFeature.size());
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+}
+
+AX_VOID CheckCompactRetry(AX_VOID) {
+    printf("compaction retry\n");
+
+    const AX_U32 nPerMinBytes = FEATURE_STORE_COMPACT_MIN_BYTES / RecordSize(CHECK_FEATURE_SIZE);
+    std::string strTmp = std::string(CHECK_DB) + ".tmp";
+    unlink(CHECK_DB);
+    rmdir(strTmp.c_str());
+    mkdir(strTmp.c_str(), 0777);
+
+    CFeatureStore tStore;
+    tStore.Open(CHECK_DB);
+
+    Churn(tStore, nPerMinBytes + 10);
+    AX_U32 nFail = g_nCompactFail;
+    printf("  %u failed compactions after the first trigger\n", nFail);
+    CHECK(nFail >= 1, "compaction attempted");
+
+    Churn(tStore, nPerMinBytes * 9 / 10);
+    CHECK(g_nCompactFail == nFail, "no retry before FEATURE_STORE_COMPACT_MIN_BYTES more dead bytes");
+
+    Churn(tStore, nPerMinBytes / 5);
+    CHECK(g_nCompactFail > nFail, "retried after FEATURE_STORE_COMPACT_MIN_BYTES more dead bytes");
+    nFail = g_nCompactFail;
+
+    rmdir(strTmp.c_str());
+    AX_U64 nBefore = FileSize(CHECK_DB);
+    Churn(tStore, nPerMinBytes + 10);
+    printf("  %llu -> %llu bytes once the path is free\n", (unsigned long long)nBefore, (unsigned long long)FileSize(CHECK_DB));
+    CHECK(g_nCompactFail == nFail && FileSize(CHECK_DB) < nBefore, "compaction runs again");
+    CHECK(1 == tStore.Size(), "live record kept");
+
+    tStore.Close();
+    unlink(CHECK_DB);
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+    CheckRecover();
+    CheckCompactRetry();
+
+    printf("%u failures\n", g_nBad);
+
+    return g_nBad ? 1 : 0;
+}
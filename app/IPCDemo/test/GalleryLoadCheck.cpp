@@ -0,0 +1,164 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+
+/**
+ * Host check: gallery load time at startup.
+ * Writes a feature store of N identities, drops it from the page cache, then times what
+ * CSearch::AsyncLoadFeatureThread does with cpu_index set: Open (recovery scan of the mapping),
+ * Load in file order into a batch buffer and CFeatureIndex::Insert per SEARCH_LOAD_BATCH_SIZE.
+ * Every identity must be searchable afterwards and 10k identities must load within CHECK_BUDGET_MS.
+ * The file is created in the current directory.
+ *
+ * cd app/IPCDemo/test
+ * g++ -std=c++11 -O2 -I../source -I../source/include -I../source/utils -I../source/detector -I../../../msp/out/include \
+ *     GalleryLoadCheck.cpp ../source/detector/FeatureStore.cpp ../source/detector/FeatureIndex.cpp -o GalleryLoadCheck \
+ *     -lpthread && ./GalleryLoadCheck
+ */
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+#include "FeatureIndex.h"
+#include "FeatureStore.h"
+
+#define CHECK_DB "gallery_load_check.db"
+#define CHECK_BATCH (256) // SEARCH_LOAD_BATCH_SIZE
+#define CHECK_BUDGET_MS (1000)
+
+AX_VOID APP_Log(AX_U32, const char *, ...) {
+}
+
+namespace {
+/* same layout as CFeatureStore appends, written in one go so that setup does not fdatasync per record */
+AX_VOID WriteGallery(AX_U32 nCount, AX_U32 nDim) {
+    std::mt19937 tRand(7);
+    std::normal_distribution<AX_F32> tNormal(0.0f, 1.0f);
+
+    FILE *fp = fopen(CHECK_DB, "wb");
+    FEATURE_STORE_HEAD_T tHead;
+    memset(&tHead, 0x00, sizeof(tHead));
+    tHead.nMagic = FEATURE_STORE_MAGIC;
+    tHead.nVersion = FEATURE_STORE_VERSION;
+    tHead.nHeadSize = sizeof(FEATURE_STORE_HEAD_T);
+    tHead.nCrc = CFeatureStore::Crc32(0, &tHead, sizeof(tHead));
+    fwrite(&tHead, 1, sizeof(tHead), fp);
+
+    std::vector<AX_F32> vecFeature(nDim);
+    for (AX_U32 i = 0; i < nCount; i++) {
+        for (auto &f : vecFeature) {
+            f = tNormal(tRand);
+        }
+
+        FEATURE_STORE_RECORD_T tRecord;
+        memset(&tRecord, 0x00, sizeof(tRecord));
+        tRecord.nMagic = FEATURE_STORE_RECORD_MAGIC;
+        tRecord.nType = FEATURE_STORE_RECORD_PUT;
+        tRecord.nFeatureSize = nDim * sizeof(AX_F32);
+        snprintf(tRecord.szInfo, sizeof(tRecord.szInfo), "id%u", i);
+        tRecord.nCrc = CFeatureStore::Crc32(CFeatureStore::Crc32(0, &tRecord, sizeof(tRecord)), vecFeature.data(), tRecord.nFeatureSize);
+
+        fwrite(&tRecord, 1, sizeof(tRecord), fp);
+        fwrite(vecFeature.data(), 1, tRecord.nFeatureSize, fp);
+    }
+
+    fflush(fp);
+    fsync(fileno(fp));
+    posix_fadvise(fileno(fp), 0, 0, POSIX_FADV_DONTNEED);
+    fclose(fp);
+}
+
+AX_U32 Run(AX_U32 nCount, AX_U32 nDim) {
+    WriteGallery(nCount, nDim);
+
+    auto tStart = std::chrono::steady_clock::now();
+
+    CFeatureStore tStore;
+    CFeatureIndex tIndex;
+    std::vector<std::string> vecInfo;
+    std::vector<AX_U64> vecIds;
+    std::vector<AX_U8> vecFeature;
+    AX_U32 nFeatureSize = 0;
+    AX_U64 nObjectId = 0;
+
+    vecInfo.reserve(CHECK_BATCH);
+    vecFeature.reserve((size_t)CHECK_BATCH * 1024);
+    auto flush = [&]() {
+        if (vecInfo.size() > 0) {
+            tIndex.Insert(vecInfo.size(), vecIds.data(), vecFeature.data(), nFeatureSize, vecInfo.data());
+            vecInfo.clear();
+            vecIds.clear();
+            vecFeature.clear();
+        }
+    };
+
+    AX_BOOL bOpen = tStore.Open(CHECK_DB);
+    auto tOpened = std::chrono::steady_clock::now();
+    if (bOpen) {
+        tStore.Load([&](const std::string &strInfo, const AX_U8 *pFeature, AX_U32 nSize) {
+            if (nSize != nFeatureSize || vecInfo.size() == CHECK_BATCH) {
+                flush();
+                nFeatureSize = nSize;
+            }
+
+            vecInfo.emplace_back(strInfo);
+            vecIds.push_back(++nObjectId);
+            vecFeature.insert(vecFeature.end(), pFeature, pFeature + nSize);
+            return AX_TRUE;
+        });
+        flush();
+    }
+
+    auto tEnd = std::chrono::steady_clock::now();
+    AX_F64 fOpenMs = std::chrono::duration<AX_F64, std::milli>(tOpened - tStart).count();
+    AX_F64 fTotalMs = std::chrono::duration<AX_F64, std::milli>(tEnd - tStart).count();
+
+    // the last identity must answer a search for itself
+    std::vector<AX_F32> vecQuery(nDim);
+    AX_BOOL bFound = AX_FALSE;
+    if (tStore.Get("id" + std::to_string(nCount - 1), (AX_U8 *)vecQuery.data(), nDim * sizeof(AX_F32))) {
+        FEATURE_INDEX_RESULT_T tResult;
+        bFound = (tIndex.Search((const AX_U8 *)vecQuery.data(), nDim * sizeof(AX_F32), 1, 1, &tResult)
+                  && 0 == strcmp(tResult.szKey, ("id" + std::to_string(nCount - 1)).c_str())) ? AX_TRUE : AX_FALSE;
+    }
+
+    printf("%6u x %3u-d: open %.1f ms, open + load %.1f ms, %.1f ms per 10k, %u loaded\n", nCount, nDim, fOpenMs, fTotalMs,
+           fTotalMs * 10000 / nCount, tIndex.Size());
+
+    tStore.Close();
+    unlink(CHECK_DB);
+
+    AX_U32 nBad = 0;
+    if (tIndex.Size() != nCount || !bFound) {
+        printf("  gallery not usable after load\n");
+        nBad++;
+    }
+    if (nCount <= 10000 && fTotalMs > CHECK_BUDGET_MS) {
+        printf("  over the %d ms budget\n", CHECK_BUDGET_MS);
+        nBad++;
+    }
+
+    return nBad;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+    AX_U32 nBad = 0;
+    nBad += Run(10000, 128);
+    nBad += Run(10000, 256);
+    nBad += Run(100000, 128);
+
+    printf("%u failures\n", nBad);
+
+    return nBad ? 1 : 0;
+}
@@ -0,0 +1,189 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+
+/**
+ * Host check: CMotionDetector SIMD kernels and ms per frame.
+ * - Downsample, Sad and Learn (every shift) against plain loops on random rows of 1..96 pixels,
+ *   so that vector bodies and scalar tails are both covered
+ * - Process against a plain per-pixel detector on 60 noisy 1080p frames with moving squares,
+ *   block for block
+ * - CMotionDetector::Benchmark (the MD_SOFT_BENCH numbers) at 1080p and 4K next to the plain
+ *   detector on the same scene
+ *
+ * cd app/IPCDemo/test
+ * g++ -std=c++11 -O2 -I../source -I../source/include -I../source/utils -I../source/detector -I../../../msp/out/include \
+ *     MotionDetectorCheck.cpp ../source/detector/MotionDetector.cpp -o MotionDetectorCheck && ./MotionDetectorCheck
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "MotionDetector.h"
+
+#define CHECK_MB (32)
+#define CHECK_THR_Y (20)
+#define CHECK_SHIFT (3)
+
+namespace {
+/* the algorithm of CMotionDetector spelt out per pixel */
+class CPlainDetector
+{
+public:
+    CPlainDetector(AX_U32 nW, AX_U32 nH) : m_nW(nW / 2), m_nH(nH / 2), m_nCols(nW / CHECK_MB), m_nRows(nH / CHECK_MB) {
+        m_vecBg.resize((size_t)m_nW * m_nH);
+        m_vecBlock.resize((size_t)m_nCols * m_nRows);
+    }
+
+    const std::vector<AX_U8> &Process(const AX_U8 *pY, AX_U32 nStride) {
+        std::vector<AX_U32> vecSad(m_vecBlock.size(), 0);
+        for (AX_U32 r = 0; r < m_nH; r++) {
+            for (AX_U32 c = 0; c < m_nW; c++) {
+                const AX_U8 *p = pY + (size_t)2 * r * nStride + 2 * c;
+                AX_U32 nCur = (p[0] + p[1] + p[nStride] + p[nStride + 1] + 2) >> 2;
+                AX_U8 &nBg = m_vecBg[(size_t)r * m_nW + c];
+                if (!m_bPrimed) {
+                    nBg = (AX_U8)nCur;
+                    continue;
+                }
+                vecSad[(r / (CHECK_MB / 2)) * m_nCols + c / (CHECK_MB / 2)] += abs((AX_S32)nCur - nBg);
+                nBg = (AX_U8)((nBg * ((1 << CHECK_SHIFT) - 1) + nCur + (1 << (CHECK_SHIFT - 1))) >> CHECK_SHIFT);
+            }
+        }
+
+        for (size_t i = 0; i < m_vecBlock.size(); i++) {
+            m_vecBlock[i] = (m_bPrimed && vecSad[i] >= (AX_U32)CHECK_THR_Y * (CHECK_MB / 2) * (CHECK_MB / 2)) ? 1 : 0;
+        }
+        m_bPrimed = AX_TRUE;
+
+        return m_vecBlock;
+    }
+
+private:
+    AX_U32 m_nW, m_nH, m_nCols, m_nRows;
+    AX_BOOL m_bPrimed{AX_FALSE};
+    std::vector<AX_U8> m_vecBg;
+    std::vector<AX_U8> m_vecBlock;
+};
+
+AX_U32 CheckKernels(AX_VOID) {
+    AX_U32 nBad = 0;
+    srand(7);
+
+    for (AX_U32 n = 1; n <= 96; n++) {
+        for (AX_U32 nLoop = 0; nLoop < 20; nLoop++) {
+            std::vector<AX_U8> vecRow0(2 * n), vecRow1(2 * n), vecA(n), vecB(n), vecDst(n);
+            for (AX_U32 i = 0; i < 2 * n; i++) {
+                vecRow0[i] = (AX_U8)rand();
+                vecRow1[i] = (AX_U8)rand();
+            }
+            for (AX_U32 i = 0; i < n; i++) {
+                // extremes included, they hit saturation and rounding
+                vecA[i] = (0 == nLoop) ? 255 : (AX_U8)rand();
+                vecB[i] = (1 == nLoop) ? 255 : (AX_U8)rand();
+            }
+
+            CMotionDetector::Downsample(vecRow0.data(), vecRow1.data(), vecDst.data(), n);
+            AX_U32 nSad = 0;
+            for (AX_U32 i = 0; i < n; i++) {
+                AX_U32 nRef = (vecRow0[2 * i] + vecRow0[2 * i + 1] + vecRow1[2 * i] + vecRow1[2 * i + 1] + 2) >> 2;
+                nBad += (vecDst[i] != nRef) ? 1 : 0;
+                nSad += abs((AX_S32)vecA[i] - vecB[i]);
+            }
+            nBad += (CMotionDetector::Sad(vecA.data(), vecB.data(), n) != nSad) ? 1 : 0;
+
+            for (AX_U32 nShift = 1; nShift <= 7; nShift++) {
+                std::vector<AX_U8> vecBg = vecA;
+                CMotionDetector::Learn(vecBg.data(), vecB.data(), n, nShift);
+                for (AX_U32 i = 0; i < n; i++) {
+                    AX_U32 nRef = (vecA[i] * ((1 << nShift) - 1) + vecB[i] + (1 << (nShift - 1))) >> nShift;
+                    nBad += (vecBg[i] != nRef) ? 1 : 0;
+                }
+            }
+        }
+    }
+
+    printf("kernels: %u mismatches\n", nBad);
+    return nBad;
+}
+
+AX_VOID DrawScene(std::vector<AX_U8> &vecY, AX_U32 nW, AX_U32 nH, AX_U32 f, AX_BOOL bNoise) {
+    for (AX_U32 y = 0; y < nH; y++) {
+        for (AX_U32 x = 0; x < nW; x++) {
+            vecY[(size_t)y * nW + x] = (AX_U8)(((x * 7 + y * 13) & 0x7F) + (bNoise ? rand() % 9 : 0));
+        }
+    }
+
+    const AX_U32 nSquare = nH / 4;
+    AX_U32 nLeft = (f * 16) % (nW - nSquare);
+    for (AX_U32 y = nH / 4; y < nH / 4 + nSquare; y++) {
+        memset(vecY.data() + (size_t)y * nW + nLeft, 0xF0, nSquare);
+    }
+    AX_U32 nTop = (f * 9) % (nH - 64);
+    for (AX_U32 y = nTop; y < nTop + 64; y++) {
+        memset(vecY.data() + (size_t)y * nW + nW / 2, 0x10, 48);
+    }
+}
+
+AX_U32 CheckProcess(AX_VOID) {
+    const AX_U32 nW = 1920;
+    const AX_U32 nH = 1056;
+    CMotionDetector tDetector;
+    CPlainDetector tPlain(nW, nH);
+    tDetector.Init(0, 0, nW, nH, CHECK_MB, CHECK_MB, CHECK_THR_Y, CHECK_SHIFT);
+
+    std::vector<AX_U8> vecY((size_t)nW * nH);
+    AX_U32 nBad = 0;
+    AX_U32 nMoving = 0;
+    srand(11);
+    for (AX_U32 f = 0; f < 60; f++) {
+        DrawScene(vecY, nW, nH, f, AX_TRUE);
+        nMoving += tDetector.Process(vecY.data(), nW);
+        if (tDetector.GetBlocks() != tPlain.Process(vecY.data(), nW)) {
+            nBad++;
+        }
+    }
+
+    printf("process: %u moving blocks over 60 frames, %u frames differ from the plain detector\n", nMoving, nBad);
+    return (nBad > 0 || 0 == nMoving) ? 1 : 0;
+}
+
+AX_F64 PlainBenchmark(AX_U32 nW, AX_U32 nH, AX_U32 nFrames) {
+    nW = nW / CHECK_MB * CHECK_MB;
+    nH = nH / CHECK_MB * CHECK_MB;
+    CPlainDetector tPlain(nW, nH);
+    std::vector<AX_U8> vecY((size_t)nW * nH);
+
+    AX_F64 fMs = 0;
+    for (AX_U32 f = 0; f <= nFrames; f++) {
+        DrawScene(vecY, nW, nH, f, AX_FALSE);
+        auto tStart = std::chrono::steady_clock::now();
+        tPlain.Process(vecY.data(), nW);
+        if (f > 0) {
+            fMs += std::chrono::duration<AX_F64, std::milli>(std::chrono::steady_clock::now() - tStart).count();
+        }
+    }
+
+    return fMs / nFrames;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+    AX_U32 nBad = 0;
+    nBad += CheckKernels();
+    nBad += CheckProcess();
+
+    printf("1080p: %.3f ms/frame, plain loops %.3f ms/frame\n", CMotionDetector::Benchmark(1920, 1080, 100), PlainBenchmark(1920, 1080, 100));
+    printf("4K:    %.3f ms/frame, plain loops %.3f ms/frame\n", CMotionDetector::Benchmark(3840, 2160, 50), PlainBenchmark(3840, 2160, 50));
+
+    printf("%u failures\n", nBad);
+
+    return nBad ? 1 : 0;
+}
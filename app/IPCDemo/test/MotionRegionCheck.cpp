@@ -0,0 +1,180 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+
+/**
+ * Host check: CMotionDetector + CMotionRegion on synthetic scenes.
+ * 1920x1056, 32x32 MB, textured background with +-4 noise and bright moving boxes, 200 frames.
+ * A static scene must raise no region, every block flagged by the detector must lie in a region,
+ * every moving box must touch one, and the regions cover at most a few times the moving area.
+ * The inside of a slow solid box is learned into the background, so only its edges are flagged.
+ *
+ * cd app/IPCDemo/test
+ * g++ -std=c++11 -O2 -I../source -I../source/include -I../source/utils -I../source/detector -I../../../msp/out/include \
+ *     MotionRegionCheck.cpp ../source/detector/MotionDetector.cpp ../source/detector/MotionRegion.cpp -o MotionRegionCheck \
+ *     && ./MotionRegionCheck
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include "MotionDetector.h"
+#include "MotionRegion.h"
+
+#define CHECK_WIDTH (1920)
+#define CHECK_HEIGHT (1056)
+#define CHECK_MB (32)
+#define CHECK_THR_Y (20)
+#define CHECK_FRAMES (200)
+#define CHECK_MAX_COVER_RATIO (8.0) // covered pixels per moving pixel, a small box grows by MB alignment and margin
+
+AX_VOID APP_Log(AX_U32, const char *, ...) {
+}
+
+namespace {
+typedef struct {
+    AX_S32 nX;
+    AX_S32 nY;
+    AX_S32 nW;
+    AX_S32 nH;
+    AX_S32 nDx;
+    AX_S32 nDy;
+} OBJECT_T;
+
+typedef struct {
+    const AX_CHAR *pName;
+    std::vector<OBJECT_T> vecObjects;
+} SCENE_T;
+
+AX_BOOL IsCovered(const std::vector<MOTION_REGION_T> &vecRegions, AX_S32 x, AX_S32 y) {
+    for (auto &tRegion : vecRegions) {
+        if (x >= (AX_S32)tRegion.nX && x < (AX_S32)(tRegion.nX + tRegion.nW) && y >= (AX_S32)tRegion.nY
+            && y < (AX_S32)(tRegion.nY + tRegion.nH)) {
+            return AX_TRUE;
+        }
+    }
+
+    return AX_FALSE;
+}
+
+AX_U32 RunScene(const SCENE_T &tScene) {
+    CMotionDetector tDetector;
+    CMotionRegion tRegion;
+    tDetector.Init(0, 0, CHECK_WIDTH, CHECK_HEIGHT, CHECK_MB, CHECK_MB, CHECK_THR_Y);
+    tRegion.Init(0, 0, CHECK_WIDTH / CHECK_MB, CHECK_HEIGHT / CHECK_MB, CHECK_MB, CHECK_MB);
+
+    std::vector<AX_U8> vecY(CHECK_WIDTH * CHECK_HEIGHT);
+    std::vector<OBJECT_T> vecObjects = tScene.vecObjects;
+    AX_U64 nCovered = 0;
+    AX_U64 nMoving = 0;
+    AX_U32 nRegions = 0;
+    AX_U32 nMissed = 0;
+    AX_U32 nLost = 0;
+    srand(7);
+
+    for (AX_U32 f = 0; f <= CHECK_FRAMES; f++) {
+        for (AX_S32 r = 0; r < CHECK_HEIGHT; r++) {
+            for (AX_S32 c = 0; c < CHECK_WIDTH; c++) {
+                vecY[r * CHECK_WIDTH + c] = (AX_U8)(((c * 7 + r * 13) & 0x7F) + rand() % 9);
+            }
+        }
+
+        std::vector<OBJECT_T> vecDrawn = vecObjects;
+        for (auto &tObj : vecObjects) {
+            for (AX_S32 r = AX_MAX(tObj.nY, 0); r < tObj.nY + tObj.nH && r < CHECK_HEIGHT; r++) {
+                for (AX_S32 c = AX_MAX(tObj.nX, 0); c < tObj.nX + tObj.nW && c < CHECK_WIDTH; c++) {
+                    vecY[r * CHECK_WIDTH + c] = 220;
+                }
+            }
+
+            tObj.nX += tObj.nDx;
+            tObj.nY += tObj.nDy;
+            if (tObj.nX < 0 || tObj.nX + tObj.nW > CHECK_WIDTH) {
+                tObj.nDx = -tObj.nDx;
+            }
+            if (tObj.nY < 0 || tObj.nY + tObj.nH > CHECK_HEIGHT) {
+                tObj.nDy = -tObj.nDy;
+            }
+        }
+
+        tDetector.Process(vecY.data(), CHECK_WIDTH);
+        const std::vector<MOTION_REGION_T> &vecRegions = tRegion.Update(tDetector.GetBlocks().data());
+
+        // the first frame primes the background
+        if (0 == f) {
+            continue;
+        }
+
+        for (auto &tRect : vecRegions) {
+            nCovered += tRect.nW * tRect.nH;
+        }
+        nRegions += vecRegions.size();
+
+        const std::vector<AX_U8> &vecBlocks = tDetector.GetBlocks();
+        for (AX_U32 i = 0; i < vecBlocks.size(); i++) {
+            AX_S32 x = (i % tDetector.GetCols()) * CHECK_MB + CHECK_MB / 2;
+            AX_S32 y = (i / tDetector.GetCols()) * CHECK_MB + CHECK_MB / 2;
+            if (vecBlocks[i] && !IsCovered(vecRegions, x, y)) {
+                nMissed++;
+            }
+        }
+
+        for (auto &tObj : vecDrawn) {
+            AX_BOOL bTouched = AX_FALSE;
+            nMoving += tObj.nW * tObj.nH;
+            for (AX_S32 y = AX_MAX(tObj.nY, 0); y < tObj.nY + tObj.nH && y < CHECK_HEIGHT; y += CHECK_MB / 2) {
+                for (AX_S32 x = AX_MAX(tObj.nX, 0); x < tObj.nX + tObj.nW && x < CHECK_WIDTH; x += CHECK_MB / 2) {
+                    bTouched = (bTouched || IsCovered(vecRegions, x, y)) ? AX_TRUE : AX_FALSE;
+                }
+            }
+            nLost += bTouched ? 0 : 1;
+        }
+    }
+
+    printf("%-14s regions/frame %.2f, covered %.1f%%, missed blocks %u, lost objects %u\n", tScene.pName,
+           (AX_F64)nRegions / CHECK_FRAMES, 100.0 * nCovered / CHECK_FRAMES / (CHECK_WIDTH * CHECK_HEIGHT), nMissed, nLost);
+
+    AX_U32 nBad = 0;
+    if (0 == nMoving && 0 != nRegions) {
+        printf("  static scene raised regions\n");
+        nBad++;
+    }
+    if (nMissed > 0) {
+        printf("  moving blocks outside of any region\n");
+        nBad++;
+    }
+    if (nLost > 0) {
+        printf("  moving objects without a region\n");
+        nBad++;
+    }
+    if (nMoving > 0 && nCovered > nMoving * CHECK_MAX_COVER_RATIO) {
+        printf("  regions cover %.1f times the moving area\n", (AX_F64)nCovered / nMoving);
+        nBad++;
+    }
+
+    return nBad;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::vector<SCENE_T> vecScenes = {
+        {"static", {}},
+        {"one person", {{100, 500, 64, 160, 6, 0}}},
+        {"three people", {{100, 500, 64, 160, 6, 0}, {1500, 300, 48, 128, -4, 1}, {800, 800, 64, 160, 3, -2}}},
+        {"car crossing", {{0, 600, 320, 160, 24, 0}}},
+    };
+
+    AX_U32 nBad = 0;
+    for (auto &tScene : vecScenes) {
+        nBad += RunScene(tScene);
+    }
+
+    printf("%u failures\n", nBad);
+
+    return nBad ? 1 : 0;
+}
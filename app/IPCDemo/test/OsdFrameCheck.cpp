@@ -0,0 +1,174 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+
+/**
+ * Host check: detection overlay of a whole encoder frame, as CVideoEncoder::ProcOSD draws it.
+ * - frames at ProcOSD limits, 10 boxes of each of the 5 kinds and 10 poses of 17 points and the
+ *   19 limbs of the skeleton table, on NV12 images addressed by their stride as ProcOSD does.
+ *   CYuvHandler must give the same bytes as the point path of YuvPointPath.h, 20 frames each
+ *   at 1080p and 4K.
+ * - ms per frame of both and the time saved per frame, spans must not be slower.
+ *
+ * cd app/IPCDemo/test
+ * g++ -std=c++11 -O2 -I../source -I../source/include -I../source/utils -I../source/components -I../source/tracker/FDSSTTracker \
+ *     -I../../../msp/out/include -I../../../msp/out/include/ai_kit $(pkg-config --cflags opencv4) OsdFrameCheck.cpp \
+ *     ../source/components/YuvHandler.cpp -o OsdFrameCheck && ./OsdFrameCheck
+ */
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+#include "YuvPointPath.h"
+
+AX_VOID APP_Log(AX_U32, const char *, ...) {
+}
+
+namespace {
+/* pairs of VideoEncoder.cpp */
+const AX_S32 g_arrLimbs[19][2] = {{15, 13}, {13, 11}, {16, 14}, {14, 12}, {11, 12}, {5, 11}, {6, 12}, {5, 6}, {5, 7}, {6, 8},
+                                  {7, 9},   {8, 10},  {1, 2},   {0, 1},   {0, 2},   {1, 3},  {2, 4},  {0, 5}, {0, 6}};
+
+typedef enum { OSD_CMD_RECT, OSD_CMD_POINT, OSD_CMD_LINE } OSD_CMD_E;
+
+typedef struct {
+    OSD_CMD_E eCmd;
+    AX_S32 x0;
+    AX_S32 y0;
+    AX_S32 x1;
+    AX_S32 y1;
+    CYuvHandler::YUV_COLOR eColor;
+} OSD_CMD_T;
+
+/* one frame of ProcOSD calls, in its order */
+std::vector<OSD_CMD_T> MakeFrame(AX_S32 nWidth, AX_S32 nHeight, AX_U32 &nSeed) {
+    auto Rand = [&nSeed](AX_S32 nMax) {
+        nSeed = nSeed * 1103515245 + 12345;
+        return (AX_S32)((nSeed >> 8) % nMax);
+    };
+
+    const CYuvHandler::YUV_COLOR arrBoxColors[] = {CYuvHandler::YUV_WHITE, CYuvHandler::YUV_PURPLE, CYuvHandler::YUV_PURPLE,
+                                                   CYuvHandler::YUV_YELLOW, CYuvHandler::YUV_RED};
+    std::vector<OSD_CMD_T> vecCmds;
+    for (auto eColor : arrBoxColors) {
+        for (AX_U32 i = 0; i < 10; i++) {
+            AX_S32 w = 16 + Rand(nWidth / 4);
+            AX_S32 h = 16 + Rand(nHeight / 3);
+            vecCmds.push_back({OSD_CMD_RECT, Rand(nWidth - 8), Rand(nHeight - 8), w, h, eColor});
+        }
+    }
+
+    for (AX_U32 i = 0; i < 10; i++) {
+        AX_S32 w = 32 + Rand(nWidth / 8);
+        AX_S32 h = 64 + Rand(nHeight / 3);
+        AX_S32 x = Rand(nWidth - w / 2);
+        AX_S32 y = Rand(nHeight - h / 2);
+        AX_S32 arrX[17];
+        AX_S32 arrY[17];
+        for (AX_U32 j = 0; j < 17; j++) {
+            arrX[j] = x + Rand(w);
+            arrY[j] = y + h * j / 17 + Rand(h / 8);
+            if (arrX[j] < nWidth && arrY[j] < nHeight) {
+                vecCmds.push_back({OSD_CMD_POINT, arrX[j], arrY[j], 0, 0, CYuvHandler::YUV_DARK_GREEN});
+            }
+        }
+        for (auto &arrLimb : g_arrLimbs) {
+            auto Clamp = [](AX_S32 v, AX_S32 nMax) { return (v >= nMax) ? nMax - 1 : v; };
+            vecCmds.push_back({OSD_CMD_LINE, Clamp(arrX[arrLimb[0]], nWidth), Clamp(arrY[arrLimb[0]], nHeight), Clamp(arrX[arrLimb[1]], nWidth),
+                               Clamp(arrY[arrLimb[1]], nHeight), CYuvHandler::YUV_BLUE});
+        }
+    }
+
+    return vecCmds;
+}
+
+template <typename T>
+AX_VOID DrawFrame(const T &tDraw, const std::vector<OSD_CMD_T> &vecCmds) {
+    for (const auto &tCmd : vecCmds) {
+        switch (tCmd.eCmd) {
+        case OSD_CMD_RECT:
+            tDraw.DrawRect(tCmd.x0, tCmd.y0, tCmd.x1, tCmd.y1, tCmd.eColor);
+            break;
+        case OSD_CMD_POINT:
+            tDraw.DrawPoint(tCmd.x0, tCmd.y0, 8, tCmd.x0 * 7, tCmd.y0 * 7, tCmd.eColor);
+            break;
+        default:
+            tDraw.DrawLine(tCmd.x0, tCmd.y0, tCmd.x1, tCmd.y1, tCmd.eColor, 4);
+            break;
+        }
+    }
+}
+
+/* CYuvHandler draws through non-const methods */
+struct SPAN_DRAW_T {
+    CYuvHandler *pYuv;
+    AX_VOID DrawRect(AX_S32 x, AX_S32 y, AX_S32 w, AX_S32 h, CYuvHandler::YUV_COLOR eColor) const {
+        pYuv->DrawRect(x, y, w, h, eColor);
+    }
+    AX_VOID DrawPoint(AX_S32 x, AX_S32 y, AX_S32 nScale, AX_S32 xo, AX_S32 yo, CYuvHandler::YUV_COLOR eColor) const {
+        pYuv->DrawPoint(x, y, nScale, xo, yo, eColor);
+    }
+    AX_VOID DrawLine(AX_S32 x0, AX_S32 y0, AX_S32 x1, AX_S32 y1, CYuvHandler::YUV_COLOR eColor, AX_S32 nScale) const {
+        pYuv->DrawLine(x0, y0, x1, y1, eColor, nScale);
+    }
+};
+
+AX_U32 CheckSize(AX_S32 nWidth, AX_S32 nHeight) {
+    /* ProcOSD hands the stride over as the width */
+    const AX_S32 nStride = (nWidth + 255) / 256 * 256;
+    std::vector<AX_U8> vecOut(CYuvHandler::CalcImgSize(nStride, nHeight, AX_YUV420_SEMIPLANAR));
+    std::vector<AX_U8> vecRef(vecOut.size());
+    CYuvHandler tYuv(vecOut.data(), nStride, nHeight, AX_YUV420_SEMIPLANAR);
+    SPAN_DRAW_T tSpan = {&tYuv};
+    CYuvPointPath tRef(vecRef.data(), nStride, nHeight, AX_YUV420_SEMIPLANAR);
+
+    AX_U32 nSeed = nWidth;
+    AX_U32 nDiffer = 0;
+    AX_F64 fSpanMs = 0;
+    AX_F64 fPointMs = 0;
+    const AX_U32 nFrames = 20;
+    for (AX_U32 f = 0; f < nFrames; f++) {
+        std::vector<OSD_CMD_T> vecCmds = MakeFrame(nWidth, nHeight, nSeed);
+        for (size_t i = 0; i < vecOut.size(); i++) {
+            vecOut[i] = (AX_U8)(i * 131 + f);
+        }
+        vecRef = vecOut;
+
+        auto tStart = std::chrono::steady_clock::now();
+        DrawFrame(tRef, vecCmds);
+        auto tMid = std::chrono::steady_clock::now();
+        DrawFrame(tSpan, vecCmds);
+        auto tEnd = std::chrono::steady_clock::now();
+        fPointMs += std::chrono::duration<AX_F64, std::milli>(tMid - tStart).count();
+        fSpanMs += std::chrono::duration<AX_F64, std::milli>(tEnd - tMid).count();
+
+        nDiffer += (vecOut != vecRef) ? 1 : 0;
+    }
+
+    printf("  %4dx%-4d stride %4d: %u of %u frames differ, point path %.3f ms, spans %.3f ms, saved %.3f ms/frame\n", nWidth, nHeight,
+           nStride, nDiffer, nFrames, fPointMs / nFrames, fSpanMs / nFrames, (fPointMs - fSpanMs) / nFrames);
+
+    if (fSpanMs > fPointMs) {
+        printf("    spans slower\n");
+        nDiffer++;
+    }
+
+    return nDiffer ? 1 : 0;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+    AX_U32 nBad = 0;
+    printf("ProcOSD frames, spans against the point path\n");
+    nBad += CheckSize(1920, 1080);
+    nBad += CheckSize(3840, 2160);
+
+    printf("%u failures\n", nBad);
+
+    return nBad ? 1 : 0;
+}
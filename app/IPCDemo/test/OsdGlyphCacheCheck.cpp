@@ -0,0 +1,109 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+
+/**
+ * Host check: COSDHandler glyph cache.
+ * - GenARGB with the cache must give the same ARGB1555 bitmap as with SetGlyphCache(AX_FALSE),
+ *   which renders every character by FreeType and brushes the side point by point as GenARGB
+ *   always did: 24 to 128 px, outlined or not, left/right alignment, strings clipped on either side
+ *   and a background with the alpha bit set. Every case is rendered twice so the second call is
+ *   composed from cache hits only.
+ * - COSDHandler::Benchmark (the OSD_GLYPH_BENCH numbers) of a ticking date string with and without
+ *   the cache; the cache must be at least CHECK_MIN_SPEEDUP times faster.
+ * The font is the first argument, DejaVu Sans Mono by default (the board uses res/GB2312.ttf).
+ *
+ * cd app/IPCDemo/test
+ * g++ -std=c++11 -O2 -I../source -I../source/include -I../source/utils -I../source/osd -I../source/utils/OsdHandler \
+ *     -I../source/utils/OsdHandler/freetype -I../source/tracker/FDSSTTracker -I../../../msp/out/include \
+ *     -I../../../msp/out/include/ai_kit $(pkg-config --cflags opencv4) OsdGlyphCacheCheck.cpp \
+ *     ../source/utils/OsdHandler/OSDHandler.cpp -o OsdGlyphCacheCheck -lfreetype && ./OsdGlyphCacheCheck
+ */
+#include <stdio.h>
+#include <vector>
+#include "OSDHandler.h"
+
+#define CHECK_FONT "/usr/share/fonts/truetype/dejavu/DejaVuSansMono.ttf"
+#define CHECK_MIN_SPEEDUP (3.0f)
+
+AX_VOID APP_Log(AX_U32, const char *, ...) {
+}
+
+namespace {
+AX_U32 CheckOutput(COSDHandler &tCached, COSDHandler &tUncached) {
+    const struct {
+        const wchar_t *pText;
+        AX_U16 nSize;
+        AX_U32 nW;
+        AX_U32 nH;
+        AX_S16 nX;
+        AX_S16 nY;
+        OSD_ALIGN_TYPE_E eAlign;
+        AX_BOOL bBrush;
+        AX_U32 nBgColor;
+        const AX_CHAR *pName;
+    } arrCases[] = {
+        {L"2022-12-31 23:59:59", 128, 128 * 19, 128, 0, 0, OSD_ALIGN_TYPE_LEFT_TOP, AX_TRUE, 0xFFFFFF, "128 px"},
+        {L"2022-12-31 23:59:59", 24, 24 * 19, 32, 14, 0, OSD_ALIGN_TYPE_LEFT_TOP, AX_TRUE, 0xFFFFFF, "24 px"},
+        {L"2022-12-31 23:59:59", 24, 200, 24, 1, 0, OSD_ALIGN_TYPE_LEFT_TOP, AX_TRUE, 0xFFFFFF, "clipped right"},
+        {L"2022-12-31 23:59:59", 24, 300, 26, 30, 0, OSD_ALIGN_TYPE_RIGHT_TOP, AX_TRUE, 0xFFFFFF, "right aligned, clipped left"},
+        {L"Hello, OSD gjpq", 48, 800, 64, 3, 5, OSD_ALIGN_TYPE_LEFT_TOP, AX_FALSE, 0x123456, "no side"},
+        {L"Hello, OSD gjpq", 48, 800, 64, 3, 5, OSD_ALIGN_TYPE_LEFT_TOP, AX_TRUE, 0x80FF0000, "alpha bit background"},
+    };
+
+    AX_U32 nBad = 0;
+    for (auto &tCase : arrCases) {
+        std::vector<AX_U16> vecRef((size_t)tCase.nW * tCase.nH);
+        tUncached.GenARGB((wchar_t *)tCase.pText, vecRef.data(), tCase.nW, tCase.nH, tCase.nX, tCase.nY, tCase.nSize, tCase.bBrush,
+                          0x01FFFFFF, tCase.nBgColor, 0xFF000000, tCase.eAlign);
+
+        AX_BOOL bSame = AX_TRUE;
+        for (AX_U32 nRound = 0; nRound < 2; nRound++) {
+            std::vector<AX_U16> vecOut(vecRef.size(), 0x5A5A);
+            tCached.GenARGB((wchar_t *)tCase.pText, vecOut.data(), tCase.nW, tCase.nH, tCase.nX, tCase.nY, tCase.nSize, tCase.bBrush,
+                            0x01FFFFFF, tCase.nBgColor, 0xFF000000, tCase.eAlign);
+            bSame = (vecOut == vecRef) ? bSame : AX_FALSE;
+        }
+
+        printf("  %-28s %s\n", tCase.pName, bSame ? "identical" : "differs");
+        nBad += bSame ? 0 : 1;
+    }
+
+    return nBad;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+    const AX_CHAR *pFont = (argc > 1) ? argv[1] : CHECK_FONT;
+    COSDHandler tCached;
+    COSDHandler tUncached;
+    if (!tCached.InitOSDHandler(pFont) || !tUncached.InitOSDHandler(pFont)) {
+        printf("load %s fail\n", pFont);
+        return 1;
+    }
+    tUncached.SetGlyphCache(AX_FALSE);
+
+    AX_U32 nBad = 0;
+    printf("cached against FreeType per call, %s\n", pFont);
+    nBad += CheckOutput(tCached, tUncached);
+
+    for (AX_U16 nSize : {24, 48, 128}) {
+        AX_F32 fUncached = tCached.Benchmark(nSize, AX_FALSE, 200);
+        AX_F32 fCached = tCached.Benchmark(nSize, AX_TRUE, 200);
+        printf("size %3d: uncached %.3f ms, cached %.3f ms per string\n", nSize, fUncached, fCached);
+        if (fCached * CHECK_MIN_SPEEDUP > fUncached) {
+            printf("    cache gains less than %.0fx\n", CHECK_MIN_SPEEDUP);
+            nBad++;
+        }
+    }
+
+    printf("%u failures\n", nBad);
+
+    return nBad ? 1 : 0;
+}
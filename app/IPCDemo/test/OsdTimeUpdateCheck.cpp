@@ -0,0 +1,164 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+
+/**
+ * Host check: incremental time OSD, COSDHandler::UpdateARGB.
+ * - A clock ticking over 4000 s (with jumps of 13 s) is kept in one bitmap by UpdateARGB and
+ *   must equal a fresh GenARGB of the same string after every update: monospace and proportional
+ *   font, 128 and 24 px, left/right alignment and a layout clipped on the right.
+ * - Work per second of the time region thread, 600 simulated seconds: before, a bitmap was
+ *   allocated, fully rendered by GenARGB and freed every second; now one bitmap is kept and
+ *   UpdateARGB redraws the changed glyphs. Reports ms per second and glyphs redrawn per update.
+ * Fonts are DejaVu Sans Mono and DejaVu Sans, or the first two arguments.
+ *
+ * cd app/IPCDemo/test
+ * g++ -std=c++11 -O2 -I../source -I../source/include -I../source/utils -I../source/osd -I../source/utils/OsdHandler \
+ *     -I../source/utils/OsdHandler/freetype -I../source/tracker/FDSSTTracker -I../../../msp/out/include \
+ *     -I../../../msp/out/include/ai_kit $(pkg-config --cflags opencv4) OsdTimeUpdateCheck.cpp \
+ *     ../source/utils/OsdHandler/OSDHandler.cpp -o OsdTimeUpdateCheck -lfreetype && ./OsdTimeUpdateCheck
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <wchar.h>
+#include <chrono>
+#include <vector>
+#include "OSDHandler.h"
+
+#define CHECK_FONT_MONO "/usr/share/fonts/truetype/dejavu/DejaVuSansMono.ttf"
+#define CHECK_FONT_PROP "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf"
+#define CHECK_SIDE_COLOR (0xFF000000)
+#define CHECK_FONT_COLOR (0x01FFFFFF)
+#define CHECK_BG_COLOR (0xFFFFFF)
+
+AX_VOID APP_Log(AX_U32, const char *, ...) {
+}
+
+namespace {
+AX_VOID FormatTime(wchar_t *pText, AX_S64 nSeconds) {
+    swprintf(pText, 32, L"2022-12-%02lld %02lld:%02lld:%02lld", 1 + (nSeconds / 86400) % 28, (nSeconds / 3600) % 24,
+             (nSeconds / 60) % 60, nSeconds % 60);
+}
+
+AX_U32 CheckFont(const AX_CHAR *pFont) {
+    COSDHandler tFull;
+    COSDHandler tIncremental;
+    if (!tFull.InitOSDHandler(pFont) || !tIncremental.InitOSDHandler(pFont)) {
+        printf("load %s fail\n", pFont);
+        return 1;
+    }
+
+    const struct {
+        AX_U16 nSize;
+        AX_U32 nW;
+        AX_U32 nH;
+        AX_S16 nX;
+        OSD_ALIGN_TYPE_E eAlign;
+        const AX_CHAR *pName;
+    } arrCases[] = {
+        {128, 2496, 128, 48, OSD_ALIGN_TYPE_LEFT_TOP, "128 px"},
+        {24, 32 * 19, 32, 14, OSD_ALIGN_TYPE_LEFT_TOP, "24 px"},
+        {24, 32 * 19, 32, 14, OSD_ALIGN_TYPE_RIGHT_TOP, "24 px right aligned"},
+        {24, 300, 32, 3, OSD_ALIGN_TYPE_LEFT_TOP, "24 px clipped"},
+    };
+
+    AX_U32 nBad = 0;
+    for (auto &tCase : arrCases) {
+        std::vector<AX_U16> vecRef((size_t)tCase.nW * tCase.nH);
+        std::vector<AX_U16> vecOut(vecRef.size());
+        wchar_t szLast[32];
+        wchar_t szNow[32];
+
+        const AX_S64 nStart = 86400 * 3 + 3600 * 23 + 58 * 60 + 50;
+        FormatTime(szLast, nStart);
+        tIncremental.GenARGB(szLast, vecOut.data(), tCase.nW, tCase.nH, tCase.nX, 0, tCase.nSize, AX_TRUE, CHECK_FONT_COLOR,
+                             CHECK_BG_COLOR, CHECK_SIDE_COLOR, tCase.eAlign);
+
+        AX_U32 nUpdates = 0;
+        AX_U32 nDiffer = 0;
+        AX_S64 nDrawn = 0;
+        for (AX_S64 t = nStart + 1; t < nStart + 4000; t += (0 == t % 7) ? 13 : 1) {
+            FormatTime(szNow, t);
+            tFull.GenARGB(szNow, vecRef.data(), tCase.nW, tCase.nH, tCase.nX, 0, tCase.nSize, AX_TRUE, CHECK_FONT_COLOR, CHECK_BG_COLOR,
+                          CHECK_SIDE_COLOR, tCase.eAlign);
+            AX_S32 nGlyphs = tIncremental.UpdateARGB(szLast, szNow, vecOut.data(), tCase.nW, tCase.nH, tCase.nX, 0, tCase.nSize, AX_TRUE,
+                                                     CHECK_FONT_COLOR, CHECK_BG_COLOR, CHECK_SIDE_COLOR, tCase.eAlign);
+            nDrawn += nGlyphs;
+            nUpdates++;
+            if (nGlyphs <= 0 || vecOut != vecRef) {
+                nDiffer++;
+            }
+            wcscpy(szLast, szNow);
+        }
+
+        printf("  %-22s %u updates, %u differ from GenARGB, %.2f glyphs drawn per update\n", tCase.pName, nUpdates, nDiffer,
+               (AX_F64)nDrawn / nUpdates);
+        nBad += nDiffer ? 1 : 0;
+    }
+
+    return nBad;
+}
+
+AX_VOID ThreadCost(const AX_CHAR *pFont) {
+    COSDHandler tHandler;
+    if (!tHandler.InitOSDHandler(pFont)) {
+        return;
+    }
+
+    const AX_U32 nSeconds = 600;
+    for (AX_U16 nSize : {128, 24}) {
+        AX_U32 nW = (128 == nSize) ? 2496 : 32 * 19 + 32;
+        AX_U32 nH = (128 == nSize) ? 128 : 32;
+        wchar_t szNow[32];
+        wchar_t szLast[32];
+
+        auto tStart = std::chrono::steady_clock::now();
+        for (AX_U32 i = 0; i < nSeconds; i++) {
+            FormatTime(szNow, 3600 + i);
+            AX_U16 *pArgb = (AX_U16 *)malloc(nW * nH * 2);
+            tHandler.GenARGB(szNow, pArgb, nW, nH, 48, 0, nSize, AX_TRUE, CHECK_FONT_COLOR, CHECK_BG_COLOR, CHECK_SIDE_COLOR);
+            free(pArgb);
+        }
+        AX_F64 fFullMs = std::chrono::duration<AX_F64, std::milli>(std::chrono::steady_clock::now() - tStart).count() / nSeconds;
+
+        std::vector<AX_U16> vecArgb((size_t)nW * nH);
+        FormatTime(szLast, 3600 - 1);
+        tHandler.GenARGB(szLast, vecArgb.data(), nW, nH, 48, 0, nSize, AX_TRUE, CHECK_FONT_COLOR, CHECK_BG_COLOR, CHECK_SIDE_COLOR);
+        AX_S64 nDrawn = 0;
+        tStart = std::chrono::steady_clock::now();
+        for (AX_U32 i = 0; i < nSeconds; i++) {
+            FormatTime(szNow, 3600 + i);
+            nDrawn += tHandler.UpdateARGB(szLast, szNow, vecArgb.data(), nW, nH, 48, 0, nSize, AX_TRUE, CHECK_FONT_COLOR, CHECK_BG_COLOR,
+                                          CHECK_SIDE_COLOR);
+            wcscpy(szLast, szNow);
+        }
+        AX_F64 fUpdateMs = std::chrono::duration<AX_F64, std::milli>(std::chrono::steady_clock::now() - tStart).count() / nSeconds;
+
+        printf("  size %3d, %4u KB bitmap: full render %.3f ms/s, incremental %.3f ms/s, %.2f glyphs per update\n", nSize,
+               nW * nH * 2 / 1024, fFullMs, fUpdateMs, (AX_F64)nDrawn / nSeconds);
+    }
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+    const AX_CHAR *arrFonts[] = {(argc > 1) ? argv[1] : CHECK_FONT_MONO, (argc > 2) ? argv[2] : CHECK_FONT_PROP};
+
+    AX_U32 nBad = 0;
+    for (auto pFont : arrFonts) {
+        printf("%s\n", pFont);
+        nBad += CheckFont(pFont);
+    }
+
+    printf("time region thread, %s\n", arrFonts[0]);
+    ThreadCost(arrFonts[0]);
+
+    printf("%u failures\n", nBad);
+
+    return nBad ? 1 : 0;
+}
@@ -0,0 +1,248 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+
+/**
+ * Host check: CPrivacyMask kernels against a per-pixel reference.
+ * - Mosaic and Blur of random rectangles on NV12 images of random size and stride, rectangles
+ *   inside, across and past the right/bottom edges, block sizes and radii below, within and above
+ *   the limits. The reference averages each block, and blurs by summing every tap of the vertical
+ *   and then the horizontal box, rows and columns outside the rectangle repeating its edge, chroma
+ *   interleaved at half the size. Both passes round with the kernel reciprocal,
+ *   ((sum + n / 2) * ceil(65536 / n)) >> 16, which is one off a division for some sums of 17 taps
+ *   and more. The whole buffer must be byte-identical.
+ * - ms per masked megapixel of both on the boxes of CPrivacyMask::Benchmark at 1080p and 4K, the
+ *   PRIVACY_MASK_BENCH numbers; the kernels must not be slower than the reference.
+ *
+ * cd app/IPCDemo/test
+ * g++ -std=c++11 -O2 -I../source -I../source/include -I../source/utils -I../source/components -I../source/tracker/FDSSTTracker \
+ *     -I../../../msp/out/include -I../../../msp/out/include/ai_kit $(pkg-config --cflags opencv4) PrivacyMaskCheck.cpp \
+ *     ../source/components/PrivacyMask.cpp -o PrivacyMaskCheck && ./PrivacyMaskCheck
+ */
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "PrivacyMask.h"
+
+AX_VOID APP_Log(AX_U32, const char *, ...) {
+}
+
+namespace {
+AX_U32 g_nSeed = 3;
+AX_S32 Rand(AX_S32 nMax) {
+    g_nSeed = g_nSeed * 1103515245 + 12345;
+    return (g_nSeed >> 8) % nMax;
+}
+
+/* CPrivacyMask::ClipRect */
+AX_BOOL RefClip(const PRIVACY_MASK_RECT_T &tRect, AX_S32 nWidth, AX_S32 nHeight, AX_S32 &x0, AX_S32 &y0, AX_S32 &x1, AX_S32 &y1) {
+    AX_S32 x = std::min((AX_S32)tRect.nX, nWidth);
+    AX_S32 y = std::min((AX_S32)tRect.nY, nHeight);
+    x0 = x & ~1;
+    y0 = y & ~1;
+    x1 = std::min((x + std::min((AX_S32)tRect.nW, nWidth) + 1) & ~1, nWidth & ~1);
+    y1 = std::min((y + std::min((AX_S32)tRect.nH, nHeight) + 1) & ~1, nHeight & ~1);
+
+    return (x0 < x1 && y0 < y1) ? AX_TRUE : AX_FALSE;
+}
+
+AX_VOID RefMosaicPlane(AX_U8 *pPlane, AX_S32 nStride, AX_S32 x0, AX_S32 x1, AX_S32 y0, AX_S32 y1, AX_S32 nBlockW, AX_S32 nBlockH,
+                       AX_S32 nComps) {
+    for (AX_S32 by = y0 / nBlockH * nBlockH; by < y1; by += nBlockH) {
+        for (AX_S32 bx = x0 / nBlockW * nBlockW; bx < x1; bx += nBlockW) {
+            AX_S32 r0 = std::max(by, y0);
+            AX_S32 r1 = std::min(by + nBlockH, y1);
+            AX_S32 c0 = std::max(bx, x0);
+            AX_S32 c1 = std::min(bx + nBlockW, x1);
+            for (AX_S32 c = 0; c < nComps; c++) {
+                AX_U32 nSum = 0;
+                AX_U32 n = 0;
+                for (AX_S32 r = r0; r < r1; r++) {
+                    for (AX_S32 i = c0 + c; i < c1; i += nComps) {
+                        nSum += pPlane[r * nStride + i];
+                        n++;
+                    }
+                }
+                for (AX_S32 r = r0; r < r1; r++) {
+                    for (AX_S32 i = c0 + c; i < c1; i += nComps) {
+                        pPlane[r * nStride + i] = (AX_U8)((nSum + n / 2) / n);
+                    }
+                }
+            }
+        }
+    }
+}
+
+AX_VOID RefBlurPlane(AX_U8 *pPlane, AX_S32 nStride, AX_S32 x0, AX_S32 x1, AX_S32 y0, AX_S32 y1, AX_S32 nRadius, AX_S32 nComps) {
+    AX_S32 w = x1 - x0;
+    AX_S32 h = y1 - y0;
+    AX_S32 m = w / nComps;
+    AX_U32 n = 2 * nRadius + 1;
+    AX_U32 nHalf = n / 2;
+    AX_U32 nInv = (65536 + n - 1) / n;
+    auto Clamp = [](AX_S32 v, AX_S32 nMax) { return std::min(std::max(v, 0), nMax - 1); };
+
+    std::vector<AX_U8> vecTmp(w * h);
+    for (AX_S32 y = 0; y < h; y++) {
+        for (AX_S32 x = 0; x < w; x++) {
+            AX_U32 nSum = 0;
+            for (AX_S32 k = -nRadius; k <= nRadius; k++) {
+                nSum += pPlane[(y0 + Clamp(y + k, h)) * nStride + x0 + x];
+            }
+            vecTmp[y * w + x] = (AX_U8)(((nSum + nHalf) * nInv) >> 16);
+        }
+    }
+
+    for (AX_S32 y = 0; y < h; y++) {
+        for (AX_S32 c = 0; c < nComps; c++) {
+            for (AX_S32 i = 0; i < m; i++) {
+                AX_U32 nSum = 0;
+                for (AX_S32 k = -nRadius; k <= nRadius; k++) {
+                    nSum += vecTmp[y * w + Clamp(i + k, m) * nComps + c];
+                }
+                pPlane[(y0 + y) * nStride + x0 + i * nComps + c] = (AX_U8)(((nSum + nHalf) * nInv) >> 16);
+            }
+        }
+    }
+}
+
+/* CPrivacyMask::Apply, nSize limited as the kernels do */
+AX_VOID RefApply(PRIVACY_MASK_TYPE_E eType, AX_U8 *pY, AX_U8 *pUV, AX_S32 nStride, AX_S32 nWidth, AX_S32 nHeight,
+                 const PRIVACY_MASK_RECT_T &tRect, AX_S32 nSize) {
+    AX_S32 x0, y0, x1, y1;
+    if (!RefClip(tRect, nWidth, nHeight, x0, y0, x1, y1)) {
+        return;
+    }
+
+    if (PRIVACY_MASK_MOSAIC == eType) {
+        AX_S32 nBlock = std::min(std::max(nSize, 2), PRIVACY_MASK_MAX_BLOCK) & ~1;
+        RefMosaicPlane(pY, nStride, x0, x1, y0, y1, nBlock, nBlock, 1);
+        RefMosaicPlane(pUV, nStride, x0, x1, y0 / 2, y1 / 2, nBlock, nBlock / 2, 2);
+    } else {
+        AX_S32 nRadius = std::min(std::max(nSize, 1), PRIVACY_MASK_MAX_RADIUS);
+        RefBlurPlane(pY, nStride, x0, x1, y0, y1, nRadius, 1);
+        RefBlurPlane(pUV, nStride, x0, x1, y0 / 2, y1 / 2, std::max(nRadius / 2, 1), 2);
+    }
+}
+
+AX_U32 CheckOutput(PRIVACY_MASK_TYPE_E eType, const AX_CHAR *szName) {
+    CPrivacyMask tMask;
+    AX_U32 nDiffer = 0;
+    const AX_U32 nRuns = 400;
+    for (AX_U32 i = 0; i < nRuns; i++) {
+        AX_S32 nWidth = 64 + Rand(300) * 2;
+        AX_S32 nHeight = 64 + Rand(200) * 2;
+        AX_S32 nStride = nWidth + Rand(3) * 16;
+        std::vector<AX_U8> vecOut(nStride * nHeight * 3 / 2);
+        for (auto &nByte : vecOut) {
+            nByte = (AX_U8)Rand(256);
+        }
+        std::vector<AX_U8> vecRef(vecOut);
+
+        PRIVACY_MASK_RECT_T tRect;
+        tRect.nX = Rand(nWidth + 20);
+        tRect.nY = Rand(nHeight + 20);
+        tRect.nW = Rand(nWidth);
+        tRect.nH = Rand(nHeight);
+        AX_S32 nSize = Rand(70);
+
+        tMask.Apply(eType, vecOut.data(), vecOut.data() + nStride * nHeight, nStride, nWidth, nHeight, tRect, nSize);
+        RefApply(eType, vecRef.data(), vecRef.data() + nStride * nHeight, nStride, nWidth, nHeight, tRect, nSize);
+        if (vecOut != vecRef) {
+            if (0 == nDiffer) {
+                printf("    %dx%d stride %d rect %u %u %u %u size %d\n", nWidth, nHeight, nStride, tRect.nX, tRect.nY, tRect.nW, tRect.nH,
+                       nSize);
+            }
+            nDiffer++;
+        }
+    }
+
+    printf("  %-6s: %u of %u images differ\n", szName, nDiffer, nRuns);
+
+    return nDiffer ? 1 : 0;
+}
+
+/* the boxes and image of CPrivacyMask::Benchmark */
+AX_F32 RefBenchmark(PRIVACY_MASK_TYPE_E eType, AX_U32 nSize, AX_U32 nWidth, AX_U32 nHeight, AX_U32 nLoops) {
+    std::vector<AX_U8> vecImage((size_t)nWidth * nHeight * 3 / 2);
+    for (AX_U32 y = 0; y < nHeight * 3 / 2; y++) {
+        for (AX_U32 x = 0; x < nWidth; x++) {
+            vecImage[(size_t)y * nWidth + x] = (AX_U8)((x * 7 + y * 13) & 0xFF);
+        }
+    }
+
+    AX_U32 nSeed = 1;
+    auto BoxRand = [&nSeed](AX_U32 nMax) {
+        nSeed = nSeed * 1103515245 + 12345;
+        return (nSeed >> 8) % nMax;
+    };
+
+    std::vector<PRIVACY_MASK_RECT_T> vecRects;
+    for (AX_U32 i = 0; i < 20; i++) {
+        PRIVACY_MASK_RECT_T tRect;
+        tRect.nW = 48 + BoxRand(nWidth / 10);
+        tRect.nH = (i < 10) ? tRect.nW * 5 / 4 : tRect.nW / 3;
+        tRect.nX = BoxRand(nWidth - tRect.nW);
+        tRect.nY = BoxRand(nHeight - std::min(tRect.nH, nHeight / 2));
+        vecRects.push_back(tRect);
+    }
+
+    AX_U64 nArea = 0;
+    for (auto &tRect : vecRects) {
+        AX_S32 x0, y0, x1, y1;
+        if (RefClip(tRect, nWidth, nHeight, x0, y0, x1, y1)) {
+            nArea += (AX_U64)(x1 - x0) * (y1 - y0);
+        }
+    }
+
+    AX_U8 *pY = vecImage.data();
+    AX_U8 *pUV = pY + (size_t)nWidth * nHeight;
+    auto tStart = std::chrono::steady_clock::now();
+    for (AX_U32 i = 0; i < nLoops; i++) {
+        for (auto &tRect : vecRects) {
+            RefApply(eType, pY, pUV, nWidth, nWidth, nHeight, tRect, nSize);
+        }
+    }
+    auto tEnd = std::chrono::steady_clock::now();
+
+    AX_F32 fMs = std::chrono::duration<AX_F32, std::milli>(tEnd - tStart).count() / nLoops;
+    return fMs * 1000000 / nArea;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+    AX_U32 nBad = 0;
+    printf("kernels against the per-pixel reference\n");
+    nBad += CheckOutput(PRIVACY_MASK_MOSAIC, "mosaic");
+    nBad += CheckOutput(PRIVACY_MASK_BLUR, "blur");
+
+    const struct {
+        PRIVACY_MASK_TYPE_E eType;
+        AX_U32 nSize;
+        const AX_CHAR *szName;
+    } arrCases[] = {{PRIVACY_MASK_MOSAIC, 16, "mosaic 16"}, {PRIVACY_MASK_BLUR, 8, "blur 8"}};
+    for (const auto &tCase : arrCases) {
+        for (AX_U32 nWidth : {1920, 3840}) {
+            AX_U32 nHeight = nWidth * 9 / 16;
+            AX_U32 nLoops = (1920 == nWidth) ? 20 : 10;
+            AX_F32 fRef = RefBenchmark(tCase.eType, tCase.nSize, nWidth, nHeight, nLoops);
+            AX_F32 fKernel = CPrivacyMask::Benchmark(tCase.eType, tCase.nSize, nWidth, nHeight, nLoops);
+            printf("%-9s %4ux%-4u: reference %6.2f ms/MP, kernels %6.2f ms/MP\n", tCase.szName, nWidth, nHeight, fRef, fKernel);
+            if (fKernel > fRef) {
+                printf("    kernels slower\n");
+                nBad++;
+            }
+        }
+    }
+
+    printf("%u failures\n", nBad);
+
+    return nBad ? 1 : 0;
+}
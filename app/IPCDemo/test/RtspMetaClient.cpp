@@ -0,0 +1,383 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+
+/**
+ * Host check: RTSP client for the metadata track of IPCDemo (rtsp server started with meta enabled).
+ * Plays video and metadata over RTP/TCP interleaved, reassembles the XML documents and maps both
+ * tracks to wallclock through their RTCP sender reports. Reports, for every metadata document,
+ * the distance to the nearest video frame and to the UtcTime written in the XML.
+ *
+ * g++ -std=c++11 -O2 RtspMetaClient.cpp -o RtspMetaClient
+ * ./RtspMetaClient rtsp://<ip>:8554/axstream0 [seconds] [max offset ms]
+ */
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#define CLIENT_VIDEO_CHANNEL (0)
+#define CLIENT_META_CHANNEL (2)
+#define CLIENT_CLOCK_RATE (90000.0)
+#define CLIENT_NTP_EPOCH_OFFSET (2208988800ULL)
+
+namespace {
+typedef struct {
+    bool bValid;
+    double fWallclock; // s since 1970 of the sender report
+    uint32_t nRtpTime;
+} SENDER_REPORT_T;
+
+typedef struct {
+    uint32_t nRtpTime;
+    double fUtcTime; // from the XML, < 0 if absent
+} META_DOC_T;
+
+class CRtspClient
+{
+public:
+    ~CRtspClient() {
+        if (m_nSock >= 0) {
+            close(m_nSock);
+        }
+    }
+
+    bool Connect(const std::string &strUrl) {
+        if (0 != strUrl.compare(0, 7, "rtsp://")) {
+            return false;
+        }
+
+        std::string strHost = strUrl.substr(7, strUrl.find('/', 7) - 7);
+        std::string strPort = "554";
+        size_t nColon = strHost.find(':');
+        if (nColon != std::string::npos) {
+            strPort = strHost.substr(nColon + 1);
+            strHost = strHost.substr(0, nColon);
+        }
+
+        struct addrinfo tHints;
+        memset(&tHints, 0, sizeof(tHints));
+        tHints.ai_family = AF_INET;
+        tHints.ai_socktype = SOCK_STREAM;
+        struct addrinfo *pAddr = nullptr;
+        if (0 != getaddrinfo(strHost.c_str(), strPort.c_str(), &tHints, &pAddr)) {
+            return false;
+        }
+
+        m_nSock = socket(AF_INET, SOCK_STREAM, 0);
+        bool bRet = (m_nSock >= 0 && 0 == connect(m_nSock, pAddr->ai_addr, pAddr->ai_addrlen));
+        freeaddrinfo(pAddr);
+
+        return bRet;
+    }
+
+    /* returns the status code, headers and body of the response */
+    int Request(const std::string &strMethod, const std::string &strUrl, const std::string &strHeaders,
+                std::string &strResponse, std::string &strBody) {
+        std::string strReq = strMethod + " " + strUrl + " RTSP/1.0\r\nCSeq: " + std::to_string(++m_nCSeq) + "\r\n";
+        if (!m_strSession.empty()) {
+            strReq += "Session: " + m_strSession + "\r\n";
+        }
+        strReq += strHeaders + "\r\n";
+        if (!SendAll(strReq)) {
+            return -1;
+        }
+
+        // only used before PLAY, no interleaved data to skip
+        strResponse.clear();
+        while (strResponse.find("\r\n\r\n") == std::string::npos) {
+            char c;
+            if (!RecvAll(&c, 1)) {
+                return -1;
+            }
+            strResponse += c;
+        }
+
+        strBody.clear();
+        std::string strLen = Header(strResponse, "Content-Length");
+        if (!strLen.empty()) {
+            strBody.resize(atoi(strLen.c_str()));
+            if (!strBody.empty() && !RecvAll(&strBody[0], strBody.size())) {
+                return -1;
+            }
+        }
+
+        std::string strSession = Header(strResponse, "Session");
+        if (!strSession.empty()) {
+            m_strSession = strSession.substr(0, strSession.find(';'));
+        }
+
+        return atoi(strResponse.c_str() + strlen("RTSP/1.0 "));
+    }
+
+    /* one interleaved packet, '$' channel length payload */
+    bool ReadPacket(int &nChannel, std::vector<uint8_t> &vecPacket) {
+        uint8_t arrHead[4];
+        do {
+            if (!RecvAll((char *)arrHead, 1)) {
+                return false;
+            }
+        } while (arrHead[0] != '$');
+
+        if (!RecvAll((char *)arrHead + 1, 3)) {
+            return false;
+        }
+
+        nChannel = arrHead[1];
+        vecPacket.resize((arrHead[2] << 8) | arrHead[3]);
+
+        return vecPacket.empty() || RecvAll((char *)vecPacket.data(), vecPacket.size());
+    }
+
+    static std::string Header(const std::string &strResponse, const std::string &strName) {
+        size_t nPos = strResponse.find("\r\n" + strName + ":");
+        if (nPos == std::string::npos) {
+            return "";
+        }
+
+        nPos += strName.size() + 3;
+        size_t nEnd = strResponse.find("\r\n", nPos);
+        std::string strValue = strResponse.substr(nPos, nEnd - nPos);
+
+        return strValue.substr(strValue.find_first_not_of(' '));
+    }
+
+private:
+    bool SendAll(const std::string &strData) {
+        size_t nSent = 0;
+        while (nSent < strData.size()) {
+            ssize_t nRet = send(m_nSock, strData.data() + nSent, strData.size() - nSent, 0);
+            if (nRet <= 0) {
+                return false;
+            }
+            nSent += nRet;
+        }
+
+        return true;
+    }
+
+    bool RecvAll(char *pBuf, size_t nLen) {
+        while (nLen > 0) {
+            ssize_t nRet = recv(m_nSock, pBuf, nLen, 0);
+            if (nRet <= 0) {
+                return false;
+            }
+            pBuf += nRet;
+            nLen -= nRet;
+        }
+
+        return true;
+    }
+
+private:
+    int m_nSock{-1};
+    int m_nCSeq{0};
+    std::string m_strSession;
+};
+
+/* a=control of the media section whose m= line starts with strMedia */
+std::string TrackControl(const std::string &strSdp, const std::string &strMedia, const std::string &strRtpmap) {
+    size_t nPos = strSdp.find("m=" + strMedia);
+    if (nPos == std::string::npos) {
+        return "";
+    }
+
+    size_t nEnd = strSdp.find("\nm=", nPos + 1);
+    std::string strSection = strSdp.substr(nPos, nEnd == std::string::npos ? std::string::npos : nEnd - nPos);
+    if (!strRtpmap.empty() && strSection.find(strRtpmap) == std::string::npos) {
+        return "";
+    }
+
+    size_t nCtrl = strSection.find("a=control:");
+    if (nCtrl == std::string::npos) {
+        return "";
+    }
+
+    nCtrl += strlen("a=control:");
+    return strSection.substr(nCtrl, strSection.find_first_of("\r\n", nCtrl) - nCtrl);
+}
+
+std::string TrackUrl(const std::string &strBase, const std::string &strControl) {
+    if (0 == strControl.compare(0, 7, "rtsp://")) {
+        return strControl;
+    }
+
+    return (strBase.empty() || strBase.back() == '/') ? strBase + strControl : strBase + "/" + strControl;
+}
+
+/* RTCP compound packet, keeps the sender report */
+void ParseRtcp(const std::vector<uint8_t> &vecPacket, SENDER_REPORT_T &tReport) {
+    size_t nPos = 0;
+    while (nPos + 20 <= vecPacket.size()) {
+        const uint8_t *p = vecPacket.data() + nPos;
+        size_t nLen = (((p[2] << 8) | p[3]) + 1) * 4;
+        if (200 == p[1]) {
+            uint32_t nNtpSec = ((uint32_t)p[8] << 24) | (p[9] << 16) | (p[10] << 8) | p[11];
+            uint32_t nNtpFrac = ((uint32_t)p[12] << 24) | (p[13] << 16) | (p[14] << 8) | p[15];
+            tReport.fWallclock = (double)(nNtpSec - CLIENT_NTP_EPOCH_OFFSET) + nNtpFrac / 4294967296.0;
+            tReport.nRtpTime = ((uint32_t)p[16] << 24) | (p[17] << 16) | (p[18] << 8) | p[19];
+            tReport.bValid = true;
+        }
+        nPos += nLen;
+    }
+}
+
+double ToWallclock(const SENDER_REPORT_T &tReport, uint32_t nRtpTime) {
+    return tReport.fWallclock + (int32_t)(nRtpTime - tReport.nRtpTime) / CLIENT_CLOCK_RATE;
+}
+
+/* UtcTime="YYYY-MM-DDThh:mm:ss.mmmZ", s since 1970 */
+double ParseUtcTime(const std::string &strXml) {
+    size_t nPos = strXml.find("UtcTime=\"");
+    if (nPos == std::string::npos) {
+        return -1;
+    }
+
+    struct tm tmUtc;
+    memset(&tmUtc, 0, sizeof(tmUtc));
+    int nMs = 0;
+    if (7 != sscanf(strXml.c_str() + nPos + 9, "%d-%d-%dT%d:%d:%d.%dZ", &tmUtc.tm_year, &tmUtc.tm_mon, &tmUtc.tm_mday,
+                    &tmUtc.tm_hour, &tmUtc.tm_min, &tmUtc.tm_sec, &nMs)) {
+        return -1;
+    }
+    tmUtc.tm_year -= 1900;
+    tmUtc.tm_mon -= 1;
+
+    return (double)timegm(&tmUtc) + nMs / 1000.0;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        printf("usage: %s rtsp://<ip>:8554/axstream0 [seconds] [max offset ms]\n", argv[0]);
+        return 1;
+    }
+
+    std::string strUrl = argv[1];
+    int nSeconds = (argc > 2) ? atoi(argv[2]) : 10;
+    double fMaxOffset = (argc > 3) ? atof(argv[3]) / 1000.0 : 0.05;
+
+    CRtspClient tClient;
+    if (!tClient.Connect(strUrl)) {
+        printf("connect %s failed\n", strUrl.c_str());
+        return 1;
+    }
+
+    std::string strResp;
+    std::string strSdp;
+    if (200 != tClient.Request("DESCRIBE", strUrl, "Accept: application/sdp\r\n", strResp, strSdp)) {
+        printf("DESCRIBE failed:\n%s\n", strResp.c_str());
+        return 1;
+    }
+
+    std::string strBase = CRtspClient::Header(strResp, "Content-Base");
+    strBase = strBase.empty() ? strUrl : strBase;
+    std::string strVideo = TrackControl(strSdp, "video", "");
+    std::string strMeta = TrackControl(strSdp, "application", "VND.ONVIF.METADATA/90000");
+    if (strVideo.empty() || strMeta.empty()) {
+        printf("video or metadata track missing in SDP:\n%s\n", strSdp.c_str());
+        return 1;
+    }
+
+    std::string strBody;
+    if (200 != tClient.Request("SETUP", TrackUrl(strBase, strVideo), "Transport: RTP/AVP/TCP;unicast;interleaved=0-1\r\n", strResp, strBody)
+        || 200 != tClient.Request("SETUP", TrackUrl(strBase, strMeta), "Transport: RTP/AVP/TCP;unicast;interleaved=2-3\r\n", strResp, strBody)
+        || 200 != tClient.Request("PLAY", strBase, "Range: npt=0.000-\r\n", strResp, strBody)) {
+        printf("SETUP/PLAY failed:\n%s\n", strResp.c_str());
+        return 1;
+    }
+
+    SENDER_REPORT_T tVideoSr = {false, 0, 0};
+    SENDER_REPORT_T tMetaSr = {false, 0, 0};
+    std::vector<uint32_t> vecVideoTimes;
+    std::vector<META_DOC_T> vecDocs;
+    std::string strDoc;
+    size_t nBadDocs = 0;
+
+    time_t nEnd = time(nullptr) + nSeconds;
+    int nChannel = 0;
+    std::vector<uint8_t> vecPacket;
+    while (time(nullptr) < nEnd && tClient.ReadPacket(nChannel, vecPacket)) {
+        if (CLIENT_VIDEO_CHANNEL + 1 == nChannel) {
+            ParseRtcp(vecPacket, tVideoSr);
+            continue;
+        }
+        if (CLIENT_META_CHANNEL + 1 == nChannel) {
+            ParseRtcp(vecPacket, tMetaSr);
+            continue;
+        }
+        if (vecPacket.size() < 12) {
+            continue;
+        }
+
+        size_t nHeader = 12 + (vecPacket[0] & 0x0F) * 4;
+        bool bMarker = (vecPacket[1] & 0x80) ? true : false;
+        uint32_t nRtpTime = ((uint32_t)vecPacket[4] << 24) | (vecPacket[5] << 16) | (vecPacket[6] << 8) | vecPacket[7];
+        if (nHeader > vecPacket.size()) {
+            continue;
+        }
+
+        if (CLIENT_VIDEO_CHANNEL == nChannel) {
+            if (vecVideoTimes.empty() || vecVideoTimes.back() != nRtpTime) {
+                vecVideoTimes.push_back(nRtpTime);
+            }
+        } else if (CLIENT_META_CHANNEL == nChannel) {
+            strDoc.append((const char *)vecPacket.data() + nHeader, vecPacket.size() - nHeader);
+            if (bMarker) {
+                if (0 != strDoc.compare(0, 5, "<?xml") || strDoc.find("</tt:MetadataStream>") == std::string::npos) {
+                    nBadDocs++;
+                } else {
+                    vecDocs.push_back({nRtpTime, ParseUtcTime(strDoc)});
+                }
+                strDoc.clear();
+            }
+        }
+    }
+
+    // closing the connection tears the session down
+
+    printf("video frames: %zu, metadata documents: %zu, malformed: %zu\n", vecVideoTimes.size(), vecDocs.size(), nBadDocs);
+    if (vecDocs.empty() || !tVideoSr.bValid || !tMetaSr.bValid) {
+        printf("no metadata or no sender reports, sr video %d meta %d\n", tVideoSr.bValid, tMetaSr.bValid);
+        return 1;
+    }
+
+    // event documents are not tied to a frame, only frame documents carry UtcTime
+    double fMaxFrame = 0;
+    double fMaxUtc = 0;
+    size_t nFrameDocs = 0;
+    for (const auto &tDoc : vecDocs) {
+        if (tDoc.fUtcTime < 0) {
+            continue;
+        }
+
+        double fMeta = ToWallclock(tMetaSr, tDoc.nRtpTime);
+        double fNearest = 1e9;
+        for (auto nVideo : vecVideoTimes) {
+            fNearest = std::min(fNearest, std::fabs(ToWallclock(tVideoSr, nVideo) - fMeta));
+        }
+
+        fMaxFrame = std::max(fMaxFrame, fNearest);
+        fMaxUtc = std::max(fMaxUtc, std::fabs(tDoc.fUtcTime - fMeta));
+        nFrameDocs++;
+    }
+
+    printf("frame documents: %zu, max offset to nearest video frame: %.1f ms, max offset to UtcTime: %.1f ms\n",
+           nFrameDocs, fMaxFrame * 1000, fMaxUtc * 1000);
+
+    return (nBadDocs || fMaxFrame > fMaxOffset || fMaxUtc > fMaxOffset) ? 1 : 0;
+}
@@ -0,0 +1,175 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+
+/**
+ * Host check: CSceneDetector events, frame size guard and ms per frame.
+ * - a 1080p sequence of a textured scene: a slow lighting ramp must raise nothing, a 7x7 box blur
+ *   DEFOCUS, a flat dark frame COVER and a cut to another scene CHANGE, each within nFrames + 1
+ * - frames of another size than Init (a 720p buffer, a stride shorter than the width) are skipped
+ *   without reading past them and without disturbing the reference
+ * - CSceneDetector::Benchmark (the SCD_SOFT_BENCH numbers) at 1080p and 4K. The request budget is
+ *   1 ms per frame on the A7, which cannot be run here: host time must stay under a tenth of it,
+ *   a Cortex-A7 being taken as ten times slower than a desktop core on this scalar code.
+ *
+ * cd app/IPCDemo/test
+ * g++ -std=c++11 -O2 -I../source -I../source/include -I../source/utils -I../source/detector -I../../../msp/out/include \
+ *     SceneDetectorCheck.cpp ../source/detector/SceneDetector.cpp -o SceneDetectorCheck && ./SceneDetectorCheck
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <functional>
+#include <vector>
+#include "SceneDetector.h"
+
+#define CHECK_W (1920)
+#define CHECK_H (1080)
+#define CHECK_HOST_BUDGET_MS (0.1f)
+
+namespace {
+/* blocks of gradient with per pixel texture and noise, nSeed picks the scene */
+AX_VOID DrawScene(std::vector<AX_U8> &vecY, AX_U32 nSeed, AX_F32 fGain) {
+    for (AX_U32 r = 0; r < CHECK_H; r++) {
+        for (AX_U32 c = 0; c < CHECK_W; c++) {
+            AX_U32 nHash = (c * 73856093u) ^ (r * 19349663u) ^ (nSeed * 83492791u);
+            AX_S32 nBase = (AX_S32)(((c / 16) * (nSeed * 3 + 5) + (r / 16) * (nSeed + 11)) % 160 + 40) + (AX_S32)(nHash % 41) - 20;
+            AX_S32 v = (AX_S32)(nBase * fGain) + rand() % 5 - 2;
+            vecY[(size_t)r * CHECK_W + c] = (AX_U8)(v < 0 ? 0 : (v > 255 ? 255 : v));
+        }
+    }
+}
+
+AX_VOID Blur(std::vector<AX_U8> &vecY) {
+    std::vector<AX_U8> vecSrc = vecY;
+    for (AX_U32 r = 3; r < CHECK_H - 3; r++) {
+        for (AX_U32 c = 3; c < CHECK_W - 3; c++) {
+            AX_U32 nSum = 0;
+            for (AX_S32 i = -3; i <= 3; i++) {
+                for (AX_S32 j = -3; j <= 3; j++) {
+                    nSum += vecSrc[(size_t)(r + i) * CHECK_W + c + j];
+                }
+            }
+            vecY[(size_t)r * CHECK_W + c] = (AX_U8)(nSum / 49);
+        }
+    }
+}
+
+/* runs nFrames of a segment, returns the first event and the frame it came on (-1: none) */
+SCENE_DETECTOR_EVENT_E RunSegment(CSceneDetector &tDetector, std::vector<AX_U8> &vecY, AX_U32 nFrames,
+                                  const std::function<AX_VOID(AX_U32)> &fnDraw, AX_S32 &nAt) {
+    SCENE_DETECTOR_EVENT_E eFirst = SCENE_DETECTOR_EVENT_NONE;
+    nAt = -1;
+    for (AX_U32 f = 0; f < nFrames; f++) {
+        fnDraw(f);
+        SCENE_DETECTOR_EVENT_E eEvent = tDetector.Process(vecY.data(), CHECK_W, CHECK_W, CHECK_H);
+        if (SCENE_DETECTOR_EVENT_NONE != eEvent && SCENE_DETECTOR_EVENT_NONE == eFirst) {
+            eFirst = eEvent;
+            nAt = (AX_S32)f;
+        }
+    }
+    return eFirst;
+}
+
+AX_U32 CheckEvents(AX_VOID) {
+    CSceneDetector tDetector;
+    SCENE_DETECTOR_CONFIG_T tConfig;
+    tConfig.nChangeThrd = 40;
+    tDetector.Init(CHECK_W, CHECK_H, tConfig);
+
+    srand(1);
+    std::vector<AX_U8> vecY((size_t)CHECK_W * CHECK_H);
+    std::vector<AX_U8> vecBlur(vecY.size());
+    DrawScene(vecBlur, 1, 1.0f);
+    Blur(vecBlur);
+
+    const struct {
+        const AX_CHAR *pName;
+        AX_U32 nFrames;
+        SCENE_DETECTOR_EVENT_E eExpect;
+        std::function<AX_VOID(AX_U32)> fnDraw;
+    } arrSegments[] = {
+        {"normal", 50, SCENE_DETECTOR_EVENT_NONE, [&](AX_U32) { DrawScene(vecY, 1, 1.0f); }},
+        {"lighting ramp to 60%", 200, SCENE_DETECTOR_EVENT_NONE, [&](AX_U32 f) { DrawScene(vecY, 1, 1.0f - 0.4f * f / 200); }},
+        {"back to normal", 100, SCENE_DETECTOR_EVENT_NONE, [&](AX_U32) { DrawScene(vecY, 1, 1.0f); }},
+        {"blur", 30, SCENE_DETECTOR_EVENT_DEFOCUS, [&](AX_U32) { vecY = vecBlur; }},
+        {"normal", 30, SCENE_DETECTOR_EVENT_NONE, [&](AX_U32) { DrawScene(vecY, 1, 1.0f); }},
+        {"cover", 30, SCENE_DETECTOR_EVENT_COVER, [&](AX_U32) {
+             for (auto &v : vecY) {
+                 v = (AX_U8)(8 + rand() % 3);
+             }
+         }},
+        {"normal", 30, SCENE_DETECTOR_EVENT_NONE, [&](AX_U32) { DrawScene(vecY, 1, 1.0f); }},
+        {"cut", 30, SCENE_DETECTOR_EVENT_CHANGE, [&](AX_U32) { DrawScene(vecY, 2, 0.5f); }},
+    };
+
+    AX_U32 nBad = 0;
+    for (auto &tSegment : arrSegments) {
+        AX_S32 nAt = -1;
+        SCENE_DETECTOR_EVENT_E eEvent = RunSegment(tDetector, vecY, tSegment.nFrames, tSegment.fnDraw, nAt);
+        printf("  %-20s %-12s frame %d\n", tSegment.pName, CSceneDetector::EventName(eEvent), nAt);
+
+        // only the event raised on entering the segment counts, the end of a condition is not an event
+        if (eEvent != tSegment.eExpect || (SCENE_DETECTOR_EVENT_NONE != eEvent && nAt > (AX_S32)tConfig.nFrames + 1)) {
+            printf("    expected %s\n", CSceneDetector::EventName(tSegment.eExpect));
+            nBad++;
+        }
+    }
+
+    return nBad;
+}
+
+AX_U32 CheckFrameSize(AX_VOID) {
+    CSceneDetector tDetector;
+    SCENE_DETECTOR_CONFIG_T tConfig;
+    tDetector.Init(CHECK_W, CHECK_H, tConfig);
+
+    srand(2);
+    std::vector<AX_U8> vecY((size_t)CHECK_W * CHECK_H);
+    DrawScene(vecY, 1, 1.0f);
+    for (AX_U32 f = 0; f < 20; f++) {
+        tDetector.Process(vecY.data(), CHECK_W, CHECK_W, CHECK_H);
+    }
+
+    // a 720p frame after a resolution switch: exactly its size on the heap, so ASan would catch a read past it
+    std::vector<AX_U8> vecSmall((size_t)1280 * 720, 0);
+    AX_U32 nBad = 0;
+    for (AX_U32 f = 0; f < 20; f++) {
+        nBad += (SCENE_DETECTOR_EVENT_NONE != tDetector.Process(vecSmall.data(), 1280, 1280, 720)) ? 1 : 0;
+        nBad += (SCENE_DETECTOR_EVENT_NONE != tDetector.Process(vecY.data(), CHECK_W / 2, CHECK_W, CHECK_H)) ? 1 : 0;
+    }
+    nBad += (SCENE_DETECTOR_EVENT_NONE != tDetector.GetState()) ? 1 : 0;
+
+    // the black 720p frames were not taken as a cover
+    AX_S32 nAt = -1;
+    nBad += (SCENE_DETECTOR_EVENT_NONE != RunSegment(tDetector, vecY, 20, [&](AX_U32) {}, nAt)) ? 1 : 0;
+
+    printf("  frames of another size: %s\n", nBad ? "processed" : "skipped");
+    return nBad;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+    AX_U32 nBad = 0;
+    printf("events\n");
+    nBad += CheckEvents();
+    printf("frame size\n");
+    nBad += CheckFrameSize();
+
+    AX_F32 fMs1080p = CSceneDetector::Benchmark(1920, 1080, 500);
+    AX_F32 fMs4K = CSceneDetector::Benchmark(3840, 2160, 500);
+    printf("1080p: %.3f ms/frame, 4K: %.3f ms/frame, host budget %.3f ms\n", fMs1080p, fMs4K, CHECK_HOST_BUDGET_MS);
+    if (fMs1080p > CHECK_HOST_BUDGET_MS || fMs4K > CHECK_HOST_BUDGET_MS) {
+        printf("  over budget\n");
+        nBad++;
+    }
+
+    printf("%u failures\n", nBad);
+
+    return nBad ? 1 : 0;
+}
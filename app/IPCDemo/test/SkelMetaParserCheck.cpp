@@ -0,0 +1,168 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+
+/**
+ * Host check: CSkelMetaParser against picojson on random and corrupted documents.
+ * Validity and every getter must agree with what picojson yields for the same text.
+ *
+ * cd app/IPCDemo/test
+ * g++ -std=c++11 -O2 -I../source -I../source/include -I../source/utils -I../source/detector -I../../../msp/out/include \
+ *     SkelMetaParserCheck.cpp ../source/detector/SkelMetaParser.cpp -o SkelMetaParserCheck && ./SkelMetaParserCheck
+ */
+#include <stdio.h>
+#include <string.h>
+#include <random>
+#include <string>
+#include "SkelMetaParser.h"
+#include "picojson.h"
+
+#define CHECK_DOCS (200000)
+#define CHECK_MAX_DEPTH (3)
+
+namespace {
+/* escaped key, "a\\u0062" decodes to "ab" */
+const AX_CHAR *g_arrRawKeys[] = {"color", "name", "code_result", "age", "a\\u0062", "x", "code_killed"};
+const AX_CHAR *g_arrKeys[] = {"color", "name", "code_result", "age", "ab", "x", "code_killed"};
+
+const AX_CHAR *g_arrStrings[] = {
+    "blue", "\\u4eacA12345", "na\\\"me", "\\ud83d\\ude00", "x", "", "\\n\\t",
+    "\xe4\xba\xac" "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789"
+};
+
+std::mt19937 g_tRand(1);
+
+AX_U32 Rand(AX_U32 nMax) {
+    return g_tRand() % nMax;
+}
+
+std::string RandValue(AX_U32 nDepth) {
+    switch (Rand(nDepth > CHECK_MAX_DEPTH ? 4 : 7)) {
+        case 0:
+            return std::string("\"") + g_arrStrings[Rand(sizeof(g_arrStrings) / sizeof(g_arrStrings[0]))] + "\"";
+        case 1:
+            return std::to_string((AX_S32)Rand(200) - 50) + (Rand(2) ? ".5" : "");
+        case 2:
+            return Rand(2) ? "true" : "false";
+        case 3:
+            return "null";
+        case 4:
+        case 5: {
+            std::string strObj = "{";
+            AX_U32 nMembers = Rand(4);
+            for (AX_U32 i = 0; i < nMembers; i++) {
+                strObj += i ? " , \"" : "\"";
+                strObj += g_arrRawKeys[Rand(sizeof(g_arrRawKeys) / sizeof(g_arrRawKeys[0]))];
+                strObj += "\": " + RandValue(nDepth + 1);
+            }
+            return strObj + "}";
+        }
+        default: {
+            std::string strArr = "[";
+            AX_U32 nItems = Rand(3);
+            for (AX_U32 i = 0; i < nItems; i++) {
+                strArr += i ? "," : "";
+                strArr += RandValue(nDepth + 1);
+            }
+            return strArr + "]";
+        }
+    }
+}
+
+AX_U32 CheckMember(const std::string &strDoc, const CSkelMetaParser &tParser, const picojson::object &tObj, const AX_CHAR *pKey) {
+    AX_U32 nBad = 0;
+    auto it = tObj.find(pKey);
+    AX_BOOL bFound = (it != tObj.end()) ? AX_TRUE : AX_FALSE;
+
+    AX_CHAR szBuf[256];
+    AX_BOOL bPico = (bFound && it->second.is<std::string>()) ? AX_TRUE : AX_FALSE;
+    AX_BOOL bRet = tParser.GetString(pKey, szBuf, sizeof(szBuf));
+    if (bRet != bPico || (bPico && it->second.get<std::string>() != szBuf)) {
+        printf("string mismatch, key %s: %s\n", pKey, strDoc.c_str());
+        nBad++;
+    }
+
+    if (bPico) {
+        /* truncated output is a prefix cut at a character boundary */
+        AX_CHAR szShort[8];
+        tParser.GetString(pKey, szShort, sizeof(szShort));
+        if (0 != it->second.get<std::string>().compare(0, strlen(szShort), szShort)) {
+            printf("truncation mismatch, key %s: %s\n", pKey, strDoc.c_str());
+            nBad++;
+        }
+    }
+
+    AX_F64 fValue = 0;
+    bPico = (bFound && it->second.is<double>()) ? AX_TRUE : AX_FALSE;
+    bRet = tParser.GetNumber(pKey, fValue);
+    if (bRet != bPico || (bPico && it->second.get<double>() != fValue)) {
+        printf("number mismatch, key %s: %s\n", pKey, strDoc.c_str());
+        nBad++;
+    }
+
+    AX_BOOL bValue = AX_FALSE;
+    bPico = (bFound && it->second.is<bool>()) ? AX_TRUE : AX_FALSE;
+    bRet = tParser.GetBool(pKey, bValue);
+    if (bRet != bPico || (bPico && it->second.get<bool>() != (bool)bValue)) {
+        printf("bool mismatch, key %s: %s\n", pKey, strDoc.c_str());
+        nBad++;
+    }
+
+    if (bFound && it->second.is<picojson::object>()) {
+        const picojson::object &tSub = it->second.get<picojson::object>();
+        auto itName = tSub.find("name");
+        bPico = (itName != tSub.end() && itName->second.is<std::string>()) ? AX_TRUE : AX_FALSE;
+        bRet = tParser.GetString(pKey, "name", szBuf, sizeof(szBuf));
+        if (bRet != bPico || (bPico && itName->second.get<std::string>() != szBuf)) {
+            printf("sub string mismatch, key %s: %s\n", pKey, strDoc.c_str());
+            nBad++;
+        }
+    }
+
+    return nBad;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+    AX_U32 nValid = 0;
+    AX_U32 nBad = 0;
+
+    for (AX_U32 n = 0; n < CHECK_DOCS && nBad < 10; n++) {
+        std::string strDoc = RandValue(0);
+        if (0 == Rand(10) && strDoc.size() > 2) {
+            // corrupt one character
+            strDoc.erase(Rand(strDoc.size()), 1);
+        }
+
+        picojson::value tValue;
+        std::string strErr = picojson::parse(tValue, strDoc);
+        AX_BOOL bPicoValid = (strErr.empty() && tValue.is<picojson::object>()) ? AX_TRUE : AX_FALSE;
+
+        CSkelMetaParser tParser(strDoc.c_str());
+        if (tParser.IsValid() != bPicoValid) {
+            printf("validity mismatch, picojson %d: %s\n", bPicoValid, strDoc.c_str());
+            nBad++;
+            continue;
+        }
+
+        if (!bPicoValid) {
+            continue;
+        }
+
+        nValid++;
+        const picojson::object &tObj = tValue.get<picojson::object>();
+        for (auto pKey : g_arrKeys) {
+            nBad += CheckMember(strDoc, tParser, tObj, pKey);
+        }
+    }
+
+    printf("%u valid documents checked, %u mismatches\n", nValid, nBad);
+
+    return nBad ? 1 : 0;
+}
@@ -0,0 +1,159 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+
+/**
+ * Host check: CYuvHandler span rasteriser.
+ * - DrawRect, DrawLine (thin, 4 px, exact diagonals, end points off the image) and scaled DrawPoint
+ *   on NV12, NV21, I420, UYVY and YUYV, with and without a stride, against the point path of
+ *   YuvPointPath.h: the whole buffer must be byte-identical after every batch of commands.
+ * - us per DrawRect of both at 1080p and 4K for NV12, I420 and UYVY, the YUV_DRAW_BENCH numbers.
+ *   The spans must not be slower than the point path for any of them.
+ *
+ * cd app/IPCDemo/test
+ * g++ -std=c++11 -O2 -I../source -I../source/include -I../source/utils -I../source/components -I../source/tracker/FDSSTTracker \
+ *     -I../../../msp/out/include -I../../../msp/out/include/ai_kit $(pkg-config --cflags opencv4) YuvDrawCheck.cpp \
+ *     ../source/components/YuvHandler.cpp -o YuvDrawCheck && ./YuvDrawCheck
+ */
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+#include "YuvPointPath.h"
+
+AX_VOID APP_Log(AX_U32, const char *, ...) {
+}
+
+namespace {
+const AX_IMG_FORMAT_E g_arrFormats[] = {AX_YUV420_SEMIPLANAR, AX_YUV420_SEMIPLANAR_VU, AX_YUV420_PLANAR, AX_YUV422_INTERLEAVED_UYVY,
+                                        AX_YUV422_INTERLEAVED_YUYV};
+const AX_CHAR *g_arrNames[] = {"NV12", "NV21", "I420", "UYVY", "YUYV"};
+
+AX_U32 g_nSeed = 7;
+AX_S32 Rand(AX_S32 nMax) {
+    g_nSeed = g_nSeed * 1103515245 + 12345;
+    return (g_nSeed >> 8) % nMax;
+}
+
+AX_U32 CheckOutput(AX_VOID) {
+    const AX_S32 nW = 640;
+    const AX_S32 nH = 360;
+
+    AX_U32 nBad = 0;
+    for (AX_U32 k = 0; k < sizeof(g_arrFormats) / sizeof(g_arrFormats[0]); k++) {
+        for (AX_S32 nStride : {0, nW + 32}) {
+            AX_IMG_FORMAT_E eType = g_arrFormats[k];
+            std::vector<AX_U8> vecOut(CYuvHandler::CalcImgSize(nW, nH, eType, nStride), 0x10);
+            std::vector<AX_U8> vecRef(vecOut);
+            CYuvHandler tYuv(vecOut.data(), nW, nH, eType, nStride);
+            CYuvPointPath tRef(vecRef.data(), nW, nH, eType, nStride);
+
+            AX_U32 nDiffer = 0;
+            for (AX_U32 i = 0; i < 2000; i++) {
+                CYuvHandler::YUV_COLOR eColor = (CYuvHandler::YUV_COLOR)Rand(CYuvHandler::YUV_COLOR_MAX);
+                switch (i % 5) {
+                case 0: {
+                    AX_S32 x = Rand(nW + 100) - 50, y = Rand(nH + 100) - 50, w = Rand(nW), h = Rand(nH);
+                    tYuv.DrawRect(x, y, w, h, eColor);
+                    tRef.DrawRect(x, y, w, h, eColor);
+                    break;
+                }
+                case 1: {
+                    AX_S32 x0 = Rand(nW + 40) - 20, y0 = Rand(nH + 40) - 20, x1 = Rand(nW + 40) - 20, y1 = Rand(nH + 40) - 20;
+                    tYuv.DrawLine(x0, y0, x1, y1, eColor, 1);
+                    tRef.DrawLine(x0, y0, x1, y1, eColor, 1);
+                    break;
+                }
+                case 2: {
+                    /* pose limbs: any slope, straight and diagonal ones, some ending at the border */
+                    AX_S32 x0 = Rand(nW), y0 = Rand(nH), x1 = Rand(nW), y1 = Rand(nH);
+                    if (0 == Rand(3)) {
+                        AX_S32 d = Rand(120);
+                        x1 = x0 + (Rand(2) ? d : -d);
+                        y1 = y0 + d;
+                    } else if (0 == Rand(3)) {
+                        x1 = x0;
+                    }
+                    tYuv.DrawLine(x0, y0, x1, y1, eColor, 4);
+                    tRef.DrawLine(x0, y0, x1, y1, eColor, 4);
+                    break;
+                }
+                case 3: {
+                    /* ProcOSD pose points */
+                    AX_S32 x = Rand(nW), y = Rand(nH);
+                    tYuv.DrawPoint(x, y, 8, x * 7, y * 7, eColor);
+                    tRef.DrawPoint(x, y, 8, x * 7, y * 7, eColor);
+                    break;
+                }
+                default: {
+                    AX_S32 x = Rand(nW / 2), y = Rand(nH / 2), nScale = 1 + Rand(3), xo = Rand(9) - 4, yo = Rand(9) - 4;
+                    tYuv.DrawPoint(x, y, nScale, xo, yo, eColor);
+                    tRef.DrawPoint(x, y, nScale, xo, yo, eColor);
+                    break;
+                }
+                }
+
+                if (0 == i % 100 && vecOut != vecRef) {
+                    nDiffer++;
+                    vecRef = vecOut;
+                }
+            }
+            nDiffer += (vecOut != vecRef) ? 1 : 0;
+
+            printf("  %s stride %3d: %s\n", g_arrNames[k], nStride, nDiffer ? "differs" : "identical");
+            nBad += nDiffer ? 1 : 0;
+        }
+    }
+
+    return nBad;
+}
+
+/* the boxes of CYuvHandler::Benchmark */
+AX_F32 PointPathBenchmark(AX_IMG_FORMAT_E eType, AX_U16 nWidth, AX_U16 nHeight, AX_U32 nBoxes) {
+    std::vector<AX_U8> vecImage(CYuvHandler::CalcImgSize(nWidth, nHeight, eType));
+    CYuvPointPath tRef(vecImage.data(), nWidth, nHeight, eType);
+
+    AX_U32 nSeed = 1;
+    auto BoxRand = [&nSeed](AX_U32 nMax) {
+        nSeed = nSeed * 1103515245 + 12345;
+        return (nSeed >> 8) % nMax;
+    };
+
+    auto tStart = std::chrono::steady_clock::now();
+    for (AX_U32 i = 0; i < nBoxes; ++i) {
+        AX_U16 w = 32 + BoxRand(nWidth / 4);
+        AX_U16 h = 32 + BoxRand(nHeight / 3);
+        tRef.DrawRect(BoxRand(nWidth - w), BoxRand(nHeight - h), w, h, (CYuvHandler::YUV_COLOR)(i % CYuvHandler::YUV_COLOR_MAX));
+    }
+
+    return std::chrono::duration<AX_F32, std::micro>(std::chrono::steady_clock::now() - tStart).count() / nBoxes;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+    AX_U32 nBad = 0;
+    printf("spans against the point path\n");
+    nBad += CheckOutput();
+
+    for (AX_U32 k : {0, 2, 3}) {
+        for (AX_U16 nWidth : {1920, 3840}) {
+            AX_U16 nHeight = nWidth * 9 / 16;
+            AX_F32 fPoint = PointPathBenchmark(g_arrFormats[k], nWidth, nHeight, 2000);
+            AX_F32 fSpan = CYuvHandler::Benchmark(g_arrFormats[k], nWidth, nHeight, 2000);
+            printf("%s %4dx%-4d: point path %6.2f us/box, spans %6.2f us/box\n", g_arrNames[k], nWidth, nHeight, fPoint, fSpan);
+            if (fSpan > fPoint) {
+                printf("    spans slower\n");
+                nBad++;
+            }
+        }
+    }
+
+    printf("%u failures\n", nBad);
+
+    return nBad ? 1 : 0;
+}
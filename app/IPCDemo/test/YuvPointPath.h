@@ -0,0 +1,146 @@
+/**********************************************************************************
+ *
+ * Copyright (c) 2019-2022 Beijing AXera Technology Co., Ltd. All Rights Reserved.
+ *
+ * This source file is the property of Beijing AXera Technology Co., Ltd. and
+ * may not be copied or distributed in any isomorphic form without the prior
+ * written consent of Beijing AXera Technology Co., Ltd.
+ *
+ **********************************************************************************/
+
+
+
+#ifndef _YUV_POINT_PATH_7A41C0D2_9E35_4B8F_B6A4_2F1D83E5C960_H_
+#define _YUV_POINT_PATH_7A41C0D2_9E35_4B8F_B6A4_2F1D83E5C960_H_
+
+#include "YuvHandler.h"
+
+/**
+ *  Reference of the host checks: CYuvHandler drawing as it was before spans, one DrawPoint per
+ *  pixel with the format switch each time. Bresenham lines with end points clamped into the image,
+ *  rects of four lines, thick lines and scaled points as nScale x nScale blocks. Blocks are clipped
+ *  to the image, the old code let them write column == width and row == height.
+ */
+class CYuvPointPath
+{
+public:
+    CYuvPointPath(AX_U8 *pImage, AX_S32 nWidth, AX_S32 nHeight, AX_IMG_FORMAT_E eType, AX_S32 nStride = 0)
+        : m_pImage(pImage), m_nWidth(nWidth), m_nHeight(nHeight), m_nStride(nStride ? nStride : nWidth), m_eType(eType) {
+    }
+
+    AX_VOID DrawPoint(AX_S32 x0, AX_S32 y0, CYuvHandler::YUV_COLOR eColor) const {
+        static const AX_U8 arrColors[CYuvHandler::YUV_COLOR_MAX][3] = {
+            {0x00, 0x00, 0x00}, {0x00, 0x00, 0xff}, {0x00, 0xff, 0x00}, {0x00, 0xff, 0xff}, {0xff, 0x00, 0x00}, {0xff, 0x00, 0xff},
+            {0xff, 0xff, 0x00}, {0xff, 0xff, 0xff}, {0x00, 0x80, 0x80}, {0x80, 0x80, 0x80}, {0xff, 0x80, 0x80}};
+        const AX_U8 *pColor = arrColors[eColor];
+        if (x0 < 0 || y0 < 0 || x0 >= m_nWidth || y0 >= m_nHeight) {
+            return;
+        }
+
+        AX_U8 *pY = m_pImage + y0 * m_nStride + x0;
+        AX_U8 *pUV = m_pImage + m_nStride * m_nHeight;
+        AX_U8 *pPacked = m_pImage + y0 * m_nStride * 2 + x0 / 2 * 4;
+        switch (m_eType) {
+        case AX_YUV420_PLANAR:
+            *pY = pColor[0];
+            pUV[(y0 / 2) * (m_nStride / 2) + x0 / 2] = pColor[1];
+            pUV[m_nStride * m_nHeight / 4 + (y0 / 2) * (m_nStride / 2) + x0 / 2] = pColor[2];
+            break;
+        case AX_YUV420_SEMIPLANAR:
+            if (0xFF == pColor[0]) {
+                *pY = pColor[0];
+            } else {
+                pUV[(y0 / 2) * m_nStride + x0 / 2 * 2] = pColor[1];
+                pUV[(y0 / 2) * m_nStride + x0 / 2 * 2 + 1] = pColor[2];
+            }
+            break;
+        case AX_YUV420_SEMIPLANAR_VU:
+            *pY = pColor[0];
+            pUV[(y0 / 2) * m_nStride + x0 / 2 * 2] = pColor[2];
+            pUV[(y0 / 2) * m_nStride + x0 / 2 * 2 + 1] = pColor[1];
+            break;
+        case AX_YUV422_INTERLEAVED_UYVY:
+            pPacked[0] = pColor[1];
+            pPacked[1] = pColor[0];
+            pPacked[2] = pColor[2];
+            pPacked[3] = pColor[0];
+            break;
+        case AX_YUV422_INTERLEAVED_YUYV:
+            pPacked[0] = pColor[0];
+            pPacked[1] = pColor[1];
+            pPacked[2] = pColor[0];
+            pPacked[3] = pColor[2];
+            break;
+        default:
+            break;
+        }
+    }
+
+    AX_VOID DrawBlock(AX_S32 x, AX_S32 y, AX_S32 nScale, CYuvHandler::YUV_COLOR eColor) const {
+        for (AX_S32 r = 0; r < nScale; r++) {
+            for (AX_S32 c = 0; c < nScale; c++) {
+                DrawPoint(x + c, y + r, eColor);
+            }
+        }
+    }
+
+    /* CYuvHandler::DrawPoint(x, y, nScale, x_offset, y_offset, eColor) */
+    AX_VOID DrawPoint(AX_S32 x, AX_S32 y, AX_S32 nScale, AX_S32 x_offset, AX_S32 y_offset, CYuvHandler::YUV_COLOR eColor) const {
+        DrawBlock(x * nScale - x_offset, y * nScale - y_offset, nScale, eColor);
+    }
+
+    AX_VOID DrawLine(AX_S32 x0, AX_S32 y0, AX_S32 x1, AX_S32 y1, CYuvHandler::YUV_COLOR eColor, AX_S32 nScale = 1) const {
+        auto Clamp = [](AX_S32 v, AX_S32 nMax) { return (v < 0) ? 0 : ((v >= nMax) ? nMax - 1 : v); };
+        x0 = Clamp(x0, m_nWidth);
+        x1 = Clamp(x1, m_nWidth);
+        y0 = Clamp(y0, m_nHeight);
+        y1 = Clamp(y1, m_nHeight);
+
+        AX_S32 dx = (x0 > x1) ? x0 - x1 : x1 - x0;
+        AX_S32 dy = (y0 > y1) ? y0 - y1 : y1 - y0;
+        AX_S32 xstep = (x0 < x1) ? 1 : -1;
+        AX_S32 ystep = (y0 < y1) ? 1 : -1;
+        AX_S32 eps = 0;
+        AX_S32 x = x0;
+        AX_S32 y = y0;
+        if (dx > dy) {
+            for (AX_S32 n = 0; n <= dx; n++) {
+                DrawBlock(x, y, nScale, eColor);
+                eps += dy;
+                if ((eps << 1) >= dx) {
+                    y += ystep;
+                    eps -= dx;
+                }
+                x += xstep;
+            }
+        } else {
+            for (AX_S32 n = 0; n <= dy; n++) {
+                DrawBlock(x, y, nScale, eColor);
+                eps += dx;
+                if ((eps << 1) >= dy) {
+                    x += xstep;
+                    eps -= dy;
+                }
+                y += ystep;
+            }
+        }
+    }
+
+    AX_VOID DrawRect(AX_S32 x0, AX_S32 y0, AX_S32 w, AX_S32 h, CYuvHandler::YUV_COLOR eColor) const {
+        if (w > 0 && h > 0) {
+            DrawLine(x0, y0, x0 + w, y0, eColor);
+            DrawLine(x0, y0, x0, y0 + h, eColor);
+            DrawLine(x0 + w, y0, x0 + w, y0 + h, eColor);
+            DrawLine(x0, y0 + h, x0 + w, y0 + h, eColor);
+        }
+    }
+
+private:
+    AX_U8 *m_pImage;
+    AX_S32 m_nWidth;
+    AX_S32 m_nHeight;
+    AX_S32 m_nStride;
+    AX_IMG_FORMAT_E m_eType;
+};
+
+#endif /* _YUV_POINT_PATH_7A41C0D2_9E35_4B8F_B6A4_2F1D83E5C960_H_ */